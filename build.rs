@@ -18,7 +18,19 @@ fn main() {
 
     drop(fs::create_dir_all(&dest_include_path));
 
-    for header in &["cxx_enumext.h", "cxx_enumext_macros.h"] {
+    for header in &[
+        "cxx_enumext.cppm",
+        "cxx_enumext.h",
+        "cxx_enumext_atomic.h",
+        "cxx_enumext_compare.h",
+        "cxx_enumext_core.h",
+        "cxx_enumext_expected.h",
+        "cxx_enumext_flat.h",
+        "cxx_enumext_hash.h",
+        "cxx_enumext_macros.h",
+        "cxx_enumext_optional.h",
+        "cxx_enumext_ranges.h",
+    ] {
         drop(fs::copy(
             Path::join(&src_include_path, header),
             Path::join(&dest_include_path, header),
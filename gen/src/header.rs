@@ -0,0 +1,571 @@
+//! Writes the C++ definitions of the `#[extern_type]` items of a file. They
+//! have the same members as the ones of the `CXX_DEFINE_*` macros in
+//! `rust/cxx_enumext_macros.h`, followed by `static_assert`s on the layout
+//! computed by `layout`.
+
+use std::fmt::Write as _;
+
+use proc_macro2::TokenStream;
+use quote::ToTokens;
+use syn::ext::IdentExt;
+use syn::{
+    Attribute, Error, Fields, GenericArgument, Item as RustItem, Meta, PathArguments, Result, Type,
+};
+
+use crate::layout::{fields_layout, item_layout, Target};
+use crate::syntax::{AstPieces, Enum, Item};
+
+pub fn generate(source: &str, file_name: &str, target: Option<Target>) -> Result<String> {
+    let file = syn::parse_file(source)?;
+    let mut items = Vec::new();
+    collect(file.items, &mut items)?;
+
+    let mut definitions = String::new();
+    for pieces in &items {
+        definitions.push('\n');
+        let namespace = pieces.cxx_namespace().join("::");
+        if !namespace.is_empty() {
+            writeln!(definitions, "namespace {namespace} {{").unwrap();
+        }
+        write_item(&mut definitions, pieces, &items, target)?;
+        if !namespace.is_empty() {
+            writeln!(definitions, "}} // namespace {namespace}").unwrap();
+        }
+    }
+
+    let mut out = String::new();
+    writeln!(
+        out,
+        "// Generated by cxx-enumext-build from {file_name}, do not edit."
+    )
+    .unwrap();
+    out.push_str("\n#pragma once\n\n");
+    let mut std_headers = vec!["cstddef", "type_traits"];
+    let mut enumext_headers = vec!["rust/cxx_enumext_core.h"];
+    for (spelling, header) in INCLUDES {
+        let headers = match header.strip_prefix("rust/") {
+            Some(_) => &mut enumext_headers,
+            None => &mut std_headers,
+        };
+        if definitions.contains(spelling) && !headers.contains(header) {
+            headers.push(header);
+        }
+    }
+    std_headers.sort_unstable();
+    for header in std_headers {
+        writeln!(out, "#include <{header}>").unwrap();
+    }
+    out.push_str("\n#include \"rust/cxx.h\"\n");
+    for header in enumext_headers {
+        writeln!(out, "#include \"{header}\"").unwrap();
+    }
+    if target.is_none() {
+        out.push_str("\n// The layout isn't asserted on this target.\n");
+    }
+    out.push_str(&definitions);
+    Ok(out)
+}
+
+/// The headers needed by the definitions beyond `rust/cxx.h` and the core of
+/// `cxx_enumext`, by what the definitions spell. Translation units including
+/// the generated header only parse the parts of the library their enums use.
+const INCLUDES: &[(&str, &str)] = &[
+    ("std::tie(", "tuple"),
+    ("std::reference_wrapper<", "functional"),
+    ("std::unique_ptr<", "memory"),
+    ("std::shared_ptr<", "memory"),
+    ("std::weak_ptr<", "memory"),
+    ("::rust::enm::optional<", "rust/cxx_enumext_optional.h"),
+    ("::rust::enm::nullable<", "rust/cxx_enumext_optional.h"),
+    ("::rust::enm::expected<", "rust/cxx_enumext_expected.h"),
+    ("::rust::enm::atomic_variant<", "rust/cxx_enumext_atomic.h"),
+];
+
+/// The items with an `extern_type` attribute, including the ones of inline
+/// modules.
+fn collect(items: Vec<RustItem>, pieces: &mut Vec<AstPieces>) -> Result<()> {
+    for mut item in items {
+        let attrs = match &mut item {
+            RustItem::Enum(item) => &mut item.attrs,
+            RustItem::Type(item) => &mut item.attrs,
+            RustItem::Mod(module) => {
+                if let Some((_, items)) = module.content.take() {
+                    collect(items, pieces)?;
+                }
+                continue;
+            }
+            _ => continue,
+        };
+        let Some(index) = attrs.iter().position(is_extern_type) else {
+            continue;
+        };
+        let args = match attrs.remove(index).meta {
+            Meta::Path(_) => TokenStream::new(),
+            Meta::List(list) => list.tokens,
+            Meta::NameValue(meta) => {
+                return Err(Error::new_spanned(
+                    meta,
+                    "unsupported extern_type attribute",
+                ))
+            }
+        };
+        pieces.push(AstPieces::parse(args, item)?);
+    }
+    Ok(())
+}
+
+/// `#[extern_type]` and `#[cxx_enumext::extern_type]`
+fn is_extern_type(attr: &Attribute) -> bool {
+    attr.path()
+        .segments
+        .last()
+        .is_some_and(|segment| segment.ident == "extern_type")
+}
+
+fn write_item(
+    out: &mut String,
+    pieces: &AstPieces,
+    items: &[AstPieces],
+    target: Option<Target>,
+) -> Result<()> {
+    let name = pieces.cxx_ident();
+    match &pieces.item {
+        Item::Enum(enm) => write_enum(out, &name, enm)?,
+        Item::Optional(optional) => write_wrapper(
+            out,
+            &name,
+            &format!("::rust::enm::optional<{}>", cxx_type(&optional.inner)?),
+            ["Some", "None"],
+        ),
+        Item::Expected(expected) => {
+            let expected_t = match &expected.expected {
+                Type::Tuple(unit) if unit.elems.is_empty() => "void".to_owned(),
+                ty => cxx_type(ty)?,
+            };
+            write_wrapper(
+                out,
+                &name,
+                &format!(
+                    "::rust::enm::expected<{expected_t}, {}>",
+                    cxx_type(&expected.unexpected)?
+                ),
+                ["Ok", "Err"],
+            )
+        }
+        Item::Nullable(nullable) => write_wrapper(
+            out,
+            &name,
+            &format!("::rust::enm::nullable<{}>", cxx_type(&nullable.inner)?),
+            ["Some", "None"],
+        ),
+        // `atomic_variant` has the layout of `AtomicEnum`, no wrapper needed
+        Item::Atomic(atomic) => writeln!(
+            out,
+            "using {name} = ::rust::enm::atomic_variant<{}>;",
+            cxx_type(&atomic.inner)?
+        )
+        .unwrap(),
+    }
+
+    let Some(target) = target else {
+        return Ok(());
+    };
+    if let Some(layout) = item_layout(&pieces.item, target) {
+        write_layout_assert(out, &name, layout.size, layout.align, "type");
+    }
+    if let Item::Atomic(atomic) = &pieces.item {
+        // `AtomicEnum` holds the smallest atomic integer the enum fits in
+        let layout = find_item(&atomic.inner, items).and_then(|inner| item_layout(inner, target));
+        if let Some(size) = layout.map(|layout| layout.size.next_power_of_two()) {
+            if size <= 8 {
+                write_layout_assert(out, &name, size, size, "AtomicEnum");
+            }
+        }
+    }
+    if let Item::Enum(enm) = &pieces.item {
+        for variant in &enm.variants {
+            if variant.fields.is_empty() {
+                continue;
+            }
+            let Some((layout, offsets)) = fields_layout(&variant.fields, target) else {
+                continue;
+            };
+            let alternative = format!("{name}::{}", variant.ident.unraw());
+            write_layout_assert(out, &alternative, layout.size, layout.align, "variant");
+            if is_alias(&variant.fields)
+                || variant.fields.iter().any(|field| is_smart_ptr(&field.ty))
+            {
+                continue;
+            }
+            for ((index, field), offset) in variant.fields.iter().enumerate().zip(offsets).skip(1) {
+                let field = field_name(index, field.ident.as_ref());
+                writeln!(
+                    out,
+                    "static_assert(offsetof({alternative}, {field}) == {offset},\n              \
+                     \"{alternative}::{field} must have the offset of the Rust field\");"
+                )
+                .unwrap();
+            }
+        }
+    }
+    Ok(())
+}
+
+/// The item of the file named by `ty`, e.g. the enum of an `AtomicEnum`.
+fn find_item<'a>(ty: &Type, items: &'a [AstPieces]) -> Option<&'a Item> {
+    let Type::Path(path) = ty else {
+        return None;
+    };
+    let ident = &path.path.segments.last()?.ident;
+    items
+        .iter()
+        .find(|pieces| pieces.ident == *ident && !matches!(pieces.item, Item::Atomic(_)))
+        .map(|pieces| &pieces.item)
+}
+
+fn write_layout_assert(out: &mut String, name: &str, size: usize, align: usize, what: &str) {
+    writeln!(
+        out,
+        "static_assert(sizeof({name}) == {size} && alignof({name}) == {align},\n              \
+         \"{name} must have the layout of the Rust {what}\");"
+    )
+    .unwrap();
+}
+
+fn write_enum(out: &mut String, name: &str, enm: &Enum) -> Result<()> {
+    let repr = match &enm.repr {
+        Some(int) => scalar_type(&int.to_string()).unwrap(),
+        None => "int",
+    };
+
+    writeln!(out, "namespace {name}_impl {{").unwrap();
+    let mut alternatives = Vec::new();
+    for variant in &enm.variants {
+        let alternative = format!("{}_t", variant.ident.unraw());
+        if is_alias(&variant.fields) {
+            let ty = &variant.fields.iter().next().unwrap().ty;
+            writeln!(out, "using {alternative} = {};", cxx_type(ty)?).unwrap();
+        } else if variant.fields.is_empty() {
+            writeln!(out, "struct {alternative} {{}};").unwrap();
+        } else {
+            let fields = variant
+                .fields
+                .iter()
+                .enumerate()
+                .map(|(index, field)| {
+                    Ok((
+                        field_name(index, field.ident.as_ref()),
+                        cxx_type(&field.ty)?,
+                    ))
+                })
+                .collect::<Result<Vec<_>>>()?;
+            write_struct(out, &alternative, &fields);
+        }
+        alternatives.push(alternative);
+    }
+    write!(out, "\nusing base = ::rust::enm::basic_variant<{repr}").unwrap();
+    for alternative in &alternatives {
+        write!(out, ",\n    {alternative}").unwrap();
+    }
+    writeln!(out, ">;\n}} // namespace {name}_impl\n").unwrap();
+
+    writeln!(
+        out,
+        "struct {name} final : public {name}_impl::base {{\n  \
+           using base = {name}_impl::base;\n\n  \
+           {name}() = delete;\n  \
+           {name}(const {name} &) = default;\n  \
+           {name}({name} &&) = default;\n  \
+           {name} &operator=(const {name} &) = default;\n  \
+           {name} &operator=({name} &&) = default;\n  \
+           using base::base;\n  \
+           using base::operator=;\n\n  \
+           using IsRelocatable = std::true_type;\n"
+    )
+    .unwrap();
+    for (variant, alternative) in enm.variants.iter().zip(&alternatives) {
+        writeln!(
+            out,
+            "  using {} = {name}_impl::{alternative};",
+            variant.ident.unraw()
+        )
+        .unwrap();
+    }
+    writeln!(out, "}};").unwrap();
+    Ok(())
+}
+
+/// A tuple or struct variant, with the members of `TUPLE` alternatives.
+fn write_struct(out: &mut String, name: &str, fields: &[(String, String)]) {
+    let join = |separator: &str, f: &dyn Fn(&str, &str) -> String| {
+        fields
+            .iter()
+            .map(|(field, ty)| f(field, ty))
+            .collect::<Vec<_>>()
+            .join(separator)
+    };
+    let tie = |side: &str| {
+        format!(
+            "std::tie({})",
+            join(", ", &|field, _| format!("{side}.{field}"))
+        )
+    };
+    let comparison = |op: &str| {
+        format!(
+            "  template <typename Self = {name}>\n  \
+             friend bool operator{op}(const std::remove_cv_t<Self> &lhs, const {name} &rhs) {{\n"
+        )
+    };
+
+    writeln!(out, "struct {name} {{").unwrap();
+    for (field, ty) in fields {
+        writeln!(out, "  {ty} {field};").unwrap();
+    }
+    writeln!(
+        out,
+        "\n  // Without padding the bytes hash like the fields one by one.\n  \
+         template <typename H>\n  \
+         friend void hash_append(H &hasher, const {name} &value) {{\n    \
+           if constexpr (({}) &&\n                  \
+                         sizeof({name}) == {}) {{\n      \
+             hasher.write(&value, sizeof(value));\n    \
+           }} else {{\n{}    \
+           }}\n  \
+         }}\n",
+        join(" &&\n                   ", &|_, ty| format!(
+            "::rust::enm::is_contiguously_hashable_v<{ty}>"
+        )),
+        join(" + ", &|_, ty| format!("sizeof({ty})")),
+        join("", &|field, _| format!(
+            "      hash_append(hasher, value.{field});\n"
+        )),
+    )
+    .unwrap();
+    writeln!(
+        out,
+        "  // Variants of such compare with memcmp if there is no padding.\n  \
+         using IsTriviallyComparable = std::bool_constant<(\n      {})>;\n",
+        join(" &&\n      ", &|_, ty| format!(
+            "::rust::enm::is_trivially_comparable_v<{ty}>"
+        )),
+    )
+    .unwrap();
+
+    out.push_str("  // Lexicographic, like the derived PartialEq and PartialOrd.\n");
+    out.push_str(&comparison("=="));
+    writeln!(
+        out,
+        "    return {};\n  }}",
+        join(" && ", &|field, _| format!("lhs.{field} == rhs.{field}"))
+    )
+    .unwrap();
+    out.push_str(&comparison("!="));
+    out.push_str("    return !(lhs == rhs);\n  }\n");
+    out.push_str(&comparison("<"));
+    for (field, _) in fields {
+        writeln!(
+            out,
+            "    if (lhs.{field} < rhs.{field}) {{\n      return true;\n    }}\n    \
+             if (rhs.{field} < lhs.{field}) {{\n      return false;\n    }}"
+        )
+        .unwrap();
+    }
+    out.push_str("    return false;\n  }\n");
+    out.push_str(&comparison(">"));
+    out.push_str("    return rhs < lhs;\n  }\n");
+    out.push_str(&comparison("<="));
+    out.push_str("    return !(rhs < lhs);\n  }\n");
+    out.push_str(&comparison(">="));
+    out.push_str("    return !(lhs < rhs);\n  }\n");
+    writeln!(
+        out,
+        "#if CXX_ENUMEXT_THREE_WAY\n  \
+         template <typename Self = {name}>\n  \
+         friend auto operator<=>(const std::remove_cv_t<Self> &lhs,\n                          \
+         const {name} &rhs)\n      \
+             -> decltype({lhs} <=> {rhs}) {{\n    \
+           return {lhs} <=> {rhs};\n  \
+         }}\n\
+         #endif\n\
+         }};",
+        lhs = tie("lhs"),
+        rhs = tie("rhs"),
+    )
+    .unwrap();
+}
+
+/// The `struct` of `CXX_DEFINE_OPTIONAL`, `CXX_DEFINE_EXPECTED` and
+/// `CXX_DEFINE_NULLABLE`.
+fn write_wrapper(out: &mut String, name: &str, base: &str, alternatives: [&str; 2]) {
+    writeln!(
+        out,
+        "struct {name} final : public {base} {{\n  \
+           using base = {base};\n  \
+           using base::base;\n  \
+           using base::operator=;\n\n  \
+           using base::{};\n  \
+           using base::{};\n\n  \
+           using IsRelocatable = std::true_type;\n\
+         }};",
+        alternatives[0], alternatives[1]
+    )
+    .unwrap();
+}
+
+/// A single unnamed field, defined as `using Name_t = T;` like `TYPE`.
+fn is_alias(fields: &Fields) -> bool {
+    matches!(fields, Fields::Unnamed(unnamed) if unnamed.unnamed.len() == 1)
+}
+
+/// `_0`, `_1`... for tuple variants like `TUPLE`.
+fn field_name(index: usize, ident: Option<&syn::Ident>) -> String {
+    match ident {
+        Some(ident) => ident.unraw().to_string(),
+        None => format!("_{index}"),
+    }
+}
+
+/// Standard library types which may not be standard layout, `offsetof` is
+/// only asserted for structs without them.
+fn is_smart_ptr(ty: &Type) -> bool {
+    let Type::Path(path) = ty else {
+        return false;
+    };
+    path.path.segments.last().is_some_and(|segment| {
+        ["UniquePtr", "SharedPtr", "WeakPtr"]
+            .iter()
+            .any(|name| segment.ident == name)
+    })
+}
+
+fn scalar_type(name: &str) -> Option<&'static str> {
+    Some(match name {
+        "bool" => "bool",
+        "u8" => "uint8_t",
+        "u16" => "uint16_t",
+        "u32" => "uint32_t",
+        "u64" => "uint64_t",
+        "usize" => "size_t",
+        "i8" => "int8_t",
+        "i16" => "int16_t",
+        "i32" => "int32_t",
+        "i64" => "int64_t",
+        "isize" => "::rust::isize",
+        "f32" => "float",
+        "f64" => "double",
+        _ => return None,
+    })
+}
+
+/// The C++ spelling of a field type, following cxx. Other types are spelled
+/// with their last path segment and must be declared before the header is
+/// included, like the types of the bridge.
+fn cxx_type(ty: &Type) -> Result<String> {
+    let unsupported =
+        || Error::new_spanned(ty, format!("unsupported type `{}`", ty.to_token_stream()));
+    Ok(match ty {
+        Type::Paren(paren) => cxx_type(&paren.elem)?,
+        Type::Reference(reference) => {
+            let constness = match reference.mutability {
+                Some(_) => "",
+                None => "const ",
+            };
+            match reference.elem.as_ref() {
+                Type::Path(path) if path.qself.is_none() && path.path.is_ident("str") => {
+                    "::rust::Str".to_owned()
+                }
+                Type::Slice(slice) => {
+                    format!("::rust::Slice<{constness}{}>", cxx_type(&slice.elem)?)
+                }
+                elem => format!("std::reference_wrapper<{}>", cxx_type(elem)?),
+            }
+        }
+        Type::Ptr(ptr) => {
+            let constness = match ptr.mutability {
+                Some(_) => "",
+                None => "const ",
+            };
+            format!("{constness}{} *", cxx_type(&ptr.elem)?)
+        }
+        Type::Array(array) => format!(
+            "std::array<{}, {}>",
+            cxx_type(&array.elem)?,
+            array.len.to_token_stream()
+        ),
+        Type::Path(path) if path.qself.is_none() => {
+            let segment = path.path.segments.last().ok_or_else(unsupported)?;
+            let mut arguments = Vec::new();
+            match &segment.arguments {
+                PathArguments::None => {}
+                PathArguments::AngleBracketed(generic) => {
+                    for argument in &generic.args {
+                        match argument {
+                            GenericArgument::Type(ty) => arguments.push(cxx_type(ty)?),
+                            GenericArgument::Lifetime(_) => {}
+                            _ => return Err(unsupported()),
+                        }
+                    }
+                }
+                PathArguments::Parenthesized(_) => return Err(unsupported()),
+            }
+            let name = segment.ident.unraw().to_string();
+            if let (Some(scalar), true) = (scalar_type(&name), arguments.is_empty()) {
+                return Ok(scalar.to_owned());
+            }
+            let nonzero = name
+                .strip_prefix("NonZero")
+                .and_then(|int| scalar_type(&int.to_lowercase()))
+                .filter(|int| int.contains("int") || int.contains("size"));
+            match (name.as_str(), arguments.as_slice()) {
+                (_, []) if nonzero.is_some() => {
+                    format!("::rust::enm::nonzero<{}>", nonzero.unwrap())
+                }
+                ("String", []) => "::rust::String".to_owned(),
+                ("CxxString", []) => "std::string".to_owned(),
+                ("Vec", [element]) => format!("::rust::Vec<{element}>"),
+                ("Box", [inner]) => format!("::rust::Box<{inner}>"),
+                ("UniquePtr", [inner]) => format!("std::unique_ptr<{inner}>"),
+                ("SharedPtr", [inner]) => format!("std::shared_ptr<{inner}>"),
+                ("WeakPtr", [inner]) => format!("std::weak_ptr<{inner}>"),
+                ("CxxVector", [element]) => format!("std::vector<{element}>"),
+                (_, []) => name,
+                _ => return Err(unsupported()),
+            }
+        }
+        _ => return Err(unsupported()),
+    })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::generate;
+    use crate::layout::Target;
+
+    #[test]
+    fn fieldless_enums_are_rejected() {
+        for variants in ["North, South", "North {}, South()"] {
+            let source = format!("#[extern_type]\n#[repr(u8)]\nenum Direction {{ {variants} }}");
+            let err = generate(&source, "fieldless.rs", Some(Target::ALL[0])).unwrap_err();
+            assert!(err.to_string().contains("without fields"), "{err}");
+        }
+        // one field is enough for the tagged union layout
+        let source = "#[extern_type]\n#[repr(u8)]\nenum Direction { North, South(u8) }";
+        assert!(generate(source, "fields.rs", Some(Target::ALL[0])).is_ok());
+    }
+
+    #[test]
+    fn atomic_enums() {
+        let source = "#[extern_type(atomic)]\n#[repr(u8)]\nenum State { Idle, Done }";
+        let err = generate(source, "fieldless.rs", Some(Target::ALL[0])).unwrap_err();
+        assert!(err.to_string().contains("without fields"), "{err}");
+
+        // `AtomicEnum` stores the 6 bytes of the enum in an `AtomicU64`
+        let source = "#[extern_type(atomic)]\n#[repr(u8)]\nenum State { Idle, Done(u16, u16) }\n\
+                      #[extern_type]\ntype AtomicState = cxx_enumext::AtomicEnum<State>;";
+        let header = generate(source, "atomic.rs", Some(Target::ALL[0])).unwrap();
+        assert!(
+            header.contains("static_assert(sizeof(AtomicState) == 8 && alignof(AtomicState) == 8,"),
+            "{header}"
+        );
+    }
+}
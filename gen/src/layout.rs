@@ -0,0 +1 @@
+../../macro/src/layout.rs
\ No newline at end of file
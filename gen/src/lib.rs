@@ -0,0 +1,106 @@
+//! Generates the C++ definitions of the `#[cxx_enumext::extern_type]` items of
+//! a crate from its build script, instead of declaring them with
+//! `CXX_DEFINE_VARIANT` and friends.
+//!
+//! ```no_run
+//! // build.rs
+//! fn main() {
+//!     let enumext_include = cxx_enumext_build::headers(["src/types.rs"]).generate();
+//!
+//!     cxx_build::bridges(["src/lib.rs"])
+//!         .include(enumext_include)
+//!         .std("c++17")
+//!         .compile("my-crate");
+//! }
+//! ```
+//!
+//! Each file gets a header named like the cxx ones, `my-crate/src/types.rs.h`
+//! becomes `my-crate/src/types.rs.enumext.h`. The header holds plain struct
+//! definitions and `static_assert`s on their layout, the proc macro asserts
+//! the same layout on the Rust side.
+
+mod header;
+#[allow(dead_code)]
+mod layout;
+#[allow(dead_code)]
+mod syntax;
+
+use std::env;
+use std::fs;
+use std::path::{Path, PathBuf};
+
+use crate::layout::Target;
+
+/// The source files to generate headers for, relative to the crate root.
+pub fn headers<P: AsRef<Path>>(rust_source_files: impl IntoIterator<Item = P>) -> Headers {
+    Headers {
+        files: rust_source_files
+            .into_iter()
+            .map(|file| file.as_ref().to_owned())
+            .collect(),
+        include_prefix: env::var("CARGO_PKG_NAME").unwrap_or_default(),
+    }
+}
+
+pub struct Headers {
+    files: Vec<PathBuf>,
+    include_prefix: String,
+}
+
+impl Headers {
+    /// The directory the headers are put in, like `cxx_build::CFG.include_prefix`.
+    /// Defaults to the name of the crate.
+    pub fn include_prefix(&mut self, include_prefix: impl Into<String>) -> &mut Self {
+        self.include_prefix = include_prefix.into();
+        self
+    }
+
+    /// Writes the headers to `$OUT_DIR/cxx-enumext/include/<prefix>/<file>.enumext.h`
+    /// and returns `$OUT_DIR/cxx-enumext/include`, to be added to the include
+    /// path.
+    ///
+    /// # Panics
+    ///
+    /// If a file can't be read or parsed, or uses a type that has no C++
+    /// spelling. Build scripts report panics as build errors.
+    pub fn generate(&self) -> PathBuf {
+        let out_dir = env::var_os("OUT_DIR").expect("`OUT_DIR` not set, call from a build script");
+        let include_dir = Path::new(&out_dir).join("cxx-enumext").join("include");
+        let target = build_target();
+
+        for file in &self.files {
+            println!("cargo:rerun-if-changed={}", file.display());
+
+            let source = fs::read_to_string(file)
+                .unwrap_or_else(|err| panic!("failed to read {}: {err}", file.display()));
+            let header = header::generate(&source, &file.to_string_lossy(), target)
+                .unwrap_or_else(|err| panic!("{}: {err}", file.display()));
+
+            let mut name = file.as_os_str().to_owned();
+            name.push(".enumext.h");
+            let path = include_dir.join(&self.include_prefix).join(name);
+            fs::create_dir_all(path.parent().unwrap()).unwrap();
+            // keep the timestamp when nothing changed, to not rebuild the C++
+            if fs::read_to_string(&path).ok().as_deref() != Some(header.as_str()) {
+                fs::write(&path, header)
+                    .unwrap_or_else(|err| panic!("failed to write {}: {err}", path.display()));
+            }
+        }
+
+        include_dir
+    }
+}
+
+/// The target being built for, `None` if the layout model doesn't cover it.
+fn build_target() -> Option<Target> {
+    if env::var("CARGO_CFG_TARGET_ARCH").ok()? == "x86" {
+        return None;
+    }
+    let pointer_width: usize = env::var("CARGO_CFG_TARGET_POINTER_WIDTH")
+        .ok()?
+        .parse()
+        .ok()?;
+    Target::ALL
+        .into_iter()
+        .find(|target| target.pointer_width * 8 == pointer_width)
+}
@@ -0,0 +1 @@
+../../macro/src/syntax.rs
\ No newline at end of file
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) Rachel Powers.
+ *
+ * This source code is licensed under both the MIT license found in the
+ * LICENSE-MIT file in the root directory of this source tree and the Apache
+ * License, Version 2.0 found in the LICENSE-APACHE file in the root directory
+ * of this source tree.
+ */
+
+// cxx_enumext/include/rust/cxx_enumext.cppm
+
+// The C++20 module interface of the library, `import rust.cxx_enumext;`
+// instead of including "rust/cxx_enumext.h". Experimental: it isn't built or
+// imported by the tests, and GCC 12 doesn't export the using-declarations
+// below to importers. A module can't export macros: the headers defining the
+// enums (the generated ones or the ones using "rust/cxx_enumext_macros.h")
+// still include the headers, and the configuration macros (e.g.
+// CXX_ENUMEXT_BAD_ACCESS_POLICY) apply when the module is built.
+
+module;
+
+#include "rust/cxx_enumext.h"
+
+export module rust.cxx_enumext;
+
+export namespace rust::enm {
+
+// rust/cxx_enumext_core.h
+using rust::enm::bad_rust_variant_access;
+using rust::enm::bad_rust_variant_index;
+using rust::enm::basic_variant;
+using rust::enm::basic_variant_base;
+using rust::enm::emplace_into;
+using rust::enm::get;
+using rust::enm::get_if;
+using rust::enm::get_unchecked;
+using rust::enm::holds_alternative;
+using rust::enm::is_contiguously_hashable;
+using rust::enm::is_contiguously_hashable_v;
+using rust::enm::is_trivially_comparable;
+using rust::enm::is_trivially_comparable_v;
+using rust::enm::monostate;
+using rust::enm::nonzero;
+using rust::enm::variant;
+using rust::enm::variant_alternative;
+using rust::enm::variant_alternative_t;
+using rust::enm::variant_base;
+using rust::enm::visit;
+
+// rust/cxx_enumext_compare.h
+using rust::enm::operator==;
+using rust::enm::operator!=;
+using rust::enm::operator<;
+using rust::enm::operator<=;
+using rust::enm::operator>;
+using rust::enm::operator>=;
+#if CXX_ENUMEXT_THREE_WAY
+using rust::enm::operator<=>;
+#endif
+
+// rust/cxx_enumext_optional.h
+using rust::enm::bad_rust_optional_access;
+using rust::enm::make_optional;
+using rust::enm::niche_traits;
+using rust::enm::nullable;
+using rust::enm::optional;
+
+// rust/cxx_enumext_expected.h
+using rust::enm::bad_rust_expected_access;
+using rust::enm::expected;
+
+// rust/cxx_enumext_ranges.h
+using rust::enm::alternative_batch;
+using rust::enm::alternative_mask;
+using rust::enm::count_alternatives;
+using rust::enm::find_alternative;
+using rust::enm::has_valid_tags;
+using rust::enm::soa_vector;
+using rust::enm::span;
+using rust::enm::visit_grouped;
+using rust::enm::visit_grouped_batches;
+
+// rust/cxx_enumext_hash.h
+using rust::enm::hash;
+using rust::enm::hash_append;
+using rust::enm::hash_value;
+using rust::enm::hasher;
+
+// rust/cxx_enumext_atomic.h
+using rust::enm::atomic_variant;
+
+} // namespace rust::enm
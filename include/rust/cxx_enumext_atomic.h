@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) Rachel Powers.
+ *
+ * This source code is licensed under both the MIT license found in the
+ * LICENSE-MIT file in the root directory of this source tree and the Apache
+ * License, Version 2.0 found in the LICENSE-APACHE file in the root directory
+ * of this source tree.
+ */
+
+// cxx_enumext/include/rust/cxx_enumext_atomic.h
+
+// `atomic_variant`, a lock-free atomic holding a small trivially copyable
+// enum, which has the layout of `cxx_enumext::AtomicEnum` in Rust so threads
+// of both languages can share it.
+
+#ifndef RUST_CXX_ENUMEXT_ATOMIC_H
+#define RUST_CXX_ENUMEXT_ATOMIC_H
+
+#include "cxx_enumext_core.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+// =================================================
+//
+// Atomic variants shared with Rust
+//
+// =================================================
+
+namespace rust {
+namespace enm {
+
+namespace detail {
+
+/// @brief The smallest unsigned integer with at least `Size` bytes, the same
+/// one `cxx_enumext::AtomicEnum` picks in Rust.
+template <std::size_t Size>
+using atomic_storage_t = std::conditional_t<
+    Size <= 1, std::uint8_t,
+    std::conditional_t<
+        Size <= 2, std::uint16_t,
+        std::conditional_t<Size <= 4, std::uint32_t, std::uint64_t>>>;
+
+/// @brief Converts variants to the integers `atomic_variant` stores and back.
+///
+/// The integer holds the bytes of the tag and of the active alternative,
+/// every other byte is zero. Equal values therefore have equal integers, no
+/// matter what the padding and the bytes of the inactive alternatives held,
+/// and compare-exchange compares exactly the tag and the active alternative.
+/// Rust writes the same integers.
+template <typename V,
+          typename Base = std::remove_const_t<variant_base_of_t<V>>>
+struct atomic_bits;
+
+template <typename V, typename Tag, typename... Ts>
+struct atomic_bits<V, basic_variant_base<Tag, Ts...>> {
+  using type = atomic_storage_t<sizeof(V)>;
+
+  constexpr static std::size_t value_align = std::max({alignof(Ts)...});
+
+  /// @brief The offset of the alternative, just like in the Rust enum.
+  constexpr static std::size_t value_offset =
+      (sizeof(Tag) + value_align - 1) / value_align * value_align;
+
+  /// @brief The bytes of each alternative, none for the empty ones which
+  /// have no bytes in Rust.
+  constexpr static std::size_t value_sizes[] = {
+      std::is_empty_v<Ts> ? 0 : sizeof(Ts)...};
+
+  static type to_bits(const V &value) noexcept {
+    const auto *bytes = reinterpret_cast<const unsigned char *>(&value);
+    unsigned char clean[sizeof(type)] = {};
+    std::memcpy(clean, bytes, sizeof(Tag));
+    std::memcpy(clean + value_offset, bytes + value_offset,
+                value_sizes[value.index()]);
+    type bits;
+    std::memcpy(&bits, clean, sizeof(bits));
+    return bits;
+  }
+
+  static V from_bits(type bits) noexcept {
+    // The generated enums have no default constructor, the union leaves the
+    // value uninitialized until the bytes are copied in.
+    union holder {
+      holder() noexcept {}
+      V value;
+    } result;
+    std::memcpy(static_cast<void *>(&result.value), &bits, sizeof(V));
+    return result.value;
+  }
+};
+
+} // namespace detail
+
+/// @brief Holds a variant which is loaded, stored and compared-exchanged
+/// atomically, without a lock: the tag and the active alternative are packed
+/// into one of `std::uint8_t` to `std::uint64_t`, so `V` must be trivially
+/// copyable and at most 8 bytes, e.g. a tag followed by an `int32_t`.
+///
+/// It has the layout of `cxx_enumext::AtomicEnum<V>` in Rust. Rust hands out
+/// shared references to it, which arrive as `const atomic_variant &`: like
+/// `std::atomic_ref` the operations are `const`.
+///
+/// `compare_exchange_*` compare the bytes of the tag and of the active
+/// alternative, which is equality unless the alternatives hold floats (`0.0`
+/// and `-0.0` differ, equal NaNs compare equal) or padding. The alternatives
+/// of an enum with `#[cxx_enumext::extern_type(atomic)]` have no padding.
+template <typename V> class atomic_variant {
+  using bits = detail::atomic_bits<V>;
+  using storage_type = typename bits::type;
+
+  static_assert(std::is_trivially_copyable_v<V>,
+                "atomic_variant needs a trivially copyable variant");
+  static_assert(sizeof(V) <= sizeof(std::uint64_t),
+                "atomic_variant needs a variant of at most 8 bytes");
+  static_assert(sizeof(std::atomic<storage_type>) == sizeof(storage_type),
+                "atomic_variant must have the layout of its Rust counterpart");
+
+public:
+  using value_type = V;
+
+  /// @brief Rust moves the `AtomicEnum` around while it isn't shared.
+  using IsRelocatable = std::true_type;
+
+  constexpr static bool is_always_lock_free =
+      std::atomic<storage_type>::is_always_lock_free;
+
+  atomic_variant(const V &value) noexcept : m_Bits(bits::to_bits(value)) {}
+
+  atomic_variant(const atomic_variant &) = delete;
+  atomic_variant &operator=(const atomic_variant &) = delete;
+
+  bool is_lock_free() const noexcept { return m_Bits.is_lock_free(); }
+
+  V load(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+    return bits::from_bits(m_Bits.load(order));
+  }
+
+  void store(const V &value,
+             std::memory_order order = std::memory_order_seq_cst) const
+      noexcept {
+    m_Bits.store(bits::to_bits(value), order);
+  }
+
+  V exchange(const V &value,
+             std::memory_order order = std::memory_order_seq_cst) const
+      noexcept {
+    return bits::from_bits(m_Bits.exchange(bits::to_bits(value), order));
+  }
+
+  /// @brief Replaces the value by `desired` if it equals `expected` (see
+  /// above), otherwise loads it into `expected`.
+  bool compare_exchange_strong(V &expected, const V &desired,
+                               std::memory_order success,
+                               std::memory_order failure) const noexcept {
+    return compare_exchange(expected, desired,
+                            [&](storage_type &current, storage_type next) {
+                              return m_Bits.compare_exchange_strong(
+                                  current, next, success, failure);
+                            });
+  }
+
+  bool compare_exchange_strong(
+      V &expected, const V &desired,
+      std::memory_order order = std::memory_order_seq_cst) const noexcept {
+    return compare_exchange(expected, desired,
+                            [&](storage_type &current, storage_type next) {
+                              return m_Bits.compare_exchange_strong(
+                                  current, next, order);
+                            });
+  }
+
+  /// @brief Like `compare_exchange_strong`, but may fail spuriously, which is
+  /// faster in a loop on some platforms.
+  bool compare_exchange_weak(V &expected, const V &desired,
+                             std::memory_order success,
+                             std::memory_order failure) const noexcept {
+    return compare_exchange(expected, desired,
+                            [&](storage_type &current, storage_type next) {
+                              return m_Bits.compare_exchange_weak(
+                                  current, next, success, failure);
+                            });
+  }
+
+  bool compare_exchange_weak(
+      V &expected, const V &desired,
+      std::memory_order order = std::memory_order_seq_cst) const noexcept {
+    return compare_exchange(expected, desired,
+                            [&](storage_type &current, storage_type next) {
+                              return m_Bits.compare_exchange_weak(
+                                  current, next, order);
+                            });
+  }
+
+  /// @brief Replaces the value by the `V` which `visitor` returns for its
+  /// active alternative (as by `visit`) and returns the value it replaced.
+  ///
+  /// If another thread changes the value in between, `visitor` is called
+  /// again with the new one: it may run several times and should not have
+  /// side effects.
+  template <typename Visitor>
+  V update(Visitor &&visitor,
+           std::memory_order order = std::memory_order_seq_cst) const {
+    storage_type current = m_Bits.load(std::memory_order_relaxed);
+    for (;;) {
+      const V value = bits::from_bits(current);
+      const V next = visit(visitor, value);
+      if (m_Bits.compare_exchange_weak(current, bits::to_bits(next), order,
+                                       std::memory_order_relaxed)) {
+        return value;
+      }
+    }
+  }
+
+private:
+  template <typename Exchange>
+  bool compare_exchange(V &expected, const V &desired,
+                        Exchange exchange) const noexcept {
+    storage_type current = bits::to_bits(expected);
+    if (exchange(current, bits::to_bits(desired))) {
+      return true;
+    }
+    expected = bits::from_bits(current);
+    return false;
+  }
+
+  mutable std::atomic<storage_type> m_Bits;
+};
+
+} // namespace enm
+} // namespace rust
+
+#endif
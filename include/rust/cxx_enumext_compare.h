@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) Rachel Powers.
+ *
+ * This source code is licensed under both the MIT license found in the
+ * LICENSE-MIT file in the root directory of this source tree and the Apache
+ * License, Version 2.0 found in the LICENSE-APACHE file in the root directory
+ * of this source tree.
+ */
+
+// cxx_enumext/include/rust/cxx_enumext_compare.h
+
+// `==`, `<` and friends (and `<=>` in C++20) of the variants, comparing like
+// the derived `PartialEq` and `PartialOrd` of the Rust enums.
+
+#ifndef RUST_CXX_ENUMEXT_COMPARE_H
+#define RUST_CXX_ENUMEXT_COMPARE_H
+
+#include "cxx_enumext_core.h"
+
+#include <cstring>
+#include <functional>
+
+// =================================================
+//
+// Comparisons
+//
+// =================================================
+
+namespace rust {
+namespace enm {
+
+namespace detail {
+
+#if CXX_ENUMEXT_THREE_WAY
+template <typename T>
+concept synth_three_way_comparable =
+    std::is_empty_v<T> || std::three_way_comparable<T> ||
+    requires(const T &value) {
+      { value < value } -> std::convertible_to<bool>;
+    };
+
+/// @brief `<=>` of the alternatives, derived from `<` for types without one.
+/// Empty alternatives are always equal.
+template <typename T>
+constexpr auto synth_three_way(const T &lhs, const T &rhs) {
+  if constexpr (std::is_empty_v<T>) {
+    return std::strong_ordering::equal;
+  } else if constexpr (std::three_way_comparable<T>) {
+    return lhs <=> rhs;
+  } else {
+    return lhs < rhs   ? std::weak_ordering::less
+           : rhs < lhs ? std::weak_ordering::greater
+                       : std::weak_ordering::equivalent;
+  }
+}
+
+template <typename... Ts>
+using synth_ordering_t =
+    std::common_comparison_category_t<decltype(synth_three_way(
+        std::declval<const Ts &>(), std::declval<const Ts &>()))...>;
+#endif
+
+/// @brief Compares variants like the derived `PartialEq` and `PartialOrd` of
+/// the Rust enum: by the index of the alternative first and by the
+/// alternatives if the indices are equal. Empty alternatives (`UNIT`,
+/// `monostate`) are equal.
+template <typename Tag, typename... Ts> struct variant_comparison {
+  using variant = basic_variant_base<Tag, Ts...>;
+
+  /// @brief Equal values of such variants have equal bytes in the active
+  /// alternative, so `==` is a single `memcmp` without dispatching.
+  constexpr static bool trivial =
+      ((std::is_empty_v<Ts> || is_trivially_comparable_v<Ts>) && ...);
+
+  /// @brief The bytes compared by `memcmp`, none for empty alternatives.
+  constexpr static std::size_t value_sizes[] = {
+      (std::is_empty_v<Ts> ? 0 : sizeof(Ts))...};
+
+  constexpr static std::size_t buffer_size = max_size_v<Ts...>;
+
+#if (defined(__BYTE_ORDER__) &&                                                \
+     __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) ||                             \
+    defined(_MSC_VER)
+  /// @brief Small buffers are compared as one word instead, masked to the
+  /// first `value_sizes[index]` bytes.
+  constexpr static bool word_sized = buffer_size <= sizeof(std::uint64_t);
+#else
+  constexpr static bool word_sized = false;
+#endif
+
+  constexpr static std::uint64_t low_bytes(std::size_t size) noexcept {
+    return size >= sizeof(std::uint64_t)
+               ? ~std::uint64_t{0}
+               : (std::uint64_t{1} << (8 * size)) - 1;
+  }
+
+  constexpr static std::uint64_t value_masks[] = {
+      low_bytes(std::is_empty_v<Ts> ? 0 : sizeof(Ts))...};
+
+  static bool equal(const variant &lhs, const variant &rhs) {
+    if (lhs.m_Index != rhs.m_Index) {
+      return false;
+    }
+    if constexpr (trivial) {
+      const std::size_t index = lhs.index();
+      if (index >= sizeof...(Ts)) {
+        bad_access<bad_rust_variant_index>("invalid variant index", index);
+      }
+      if constexpr (word_sized) {
+        std::uint64_t lhs_word = 0;
+        std::uint64_t rhs_word = 0;
+        std::memcpy(&lhs_word, lhs.m_Buff, buffer_size);
+        std::memcpy(&rhs_word, rhs.m_Buff, buffer_size);
+        return ((lhs_word ^ rhs_word) & value_masks[index]) == 0;
+      } else {
+        return std::memcmp(lhs.m_Buff, rhs.m_Buff, value_sizes[index]) == 0;
+      }
+    } else {
+      return relation(lhs, rhs, std::equal_to<>{});
+    }
+  }
+
+  /// @brief Applies `op` to the indices if they differ and to the
+  /// alternatives otherwise, dispatching on the index once.
+  template <typename Op>
+  static bool relation(const variant &lhs, const variant &rhs, Op op) {
+    if (lhs.m_Index != rhs.m_Index) {
+      return op(lhs.index(), rhs.index());
+    }
+    return visitor_type<Ts...>::visit(
+        [&rhs, &op](const auto &value) -> bool {
+          using type = std::decay_t<decltype(value)>;
+          if constexpr (std::is_empty_v<type>) {
+            return op(0, 0);
+          } else {
+            return op(value, *reinterpret_cast<const type *>(rhs.m_Buff));
+          }
+        },
+        lhs.m_Index, lhs.m_Buff);
+  }
+
+#if CXX_ENUMEXT_THREE_WAY
+  /// @brief `Ordering` is only formed by `<=>`, so `==` works for
+  /// alternatives without `<`.
+  template <typename Ordering>
+  static Ordering compare(const variant &lhs, const variant &rhs) {
+    if (lhs.m_Index != rhs.m_Index) {
+      return lhs.index() <=> rhs.index();
+    }
+    return visitor_type<Ts...>::visit(
+        [&rhs](const auto &value) -> Ordering {
+          using type = std::decay_t<decltype(value)>;
+          return synth_three_way(value,
+                                 *reinterpret_cast<const type *>(rhs.m_Buff));
+        },
+        lhs.m_Index, lhs.m_Buff);
+  }
+#endif
+};
+
+} // namespace detail
+
+/// @brief Compares like the derived `PartialEq` of the Rust enum. Variants
+/// of trivially comparable alternatives only are compared with one `memcmp`
+/// of the active alternative.
+template <typename Tag, typename... Ts>
+bool operator==(const basic_variant_base<Tag, Ts...> &lhs,
+                const basic_variant_base<Tag, Ts...> &rhs) {
+  return detail::variant_comparison<Tag, Ts...>::equal(lhs, rhs);
+}
+
+template <typename Tag, typename... Ts>
+bool operator!=(const basic_variant_base<Tag, Ts...> &lhs,
+                const basic_variant_base<Tag, Ts...> &rhs) {
+  return !detail::variant_comparison<Tag, Ts...>::equal(lhs, rhs);
+}
+
+/// @brief Orders like the derived `PartialOrd` of the Rust enum: by the index
+/// of the alternative, then by the alternatives.
+template <typename Tag, typename... Ts>
+bool operator<(const basic_variant_base<Tag, Ts...> &lhs,
+               const basic_variant_base<Tag, Ts...> &rhs) {
+  return detail::variant_comparison<Tag, Ts...>::relation(lhs, rhs,
+                                                          std::less<>{});
+}
+
+template <typename Tag, typename... Ts>
+bool operator>(const basic_variant_base<Tag, Ts...> &lhs,
+               const basic_variant_base<Tag, Ts...> &rhs) {
+  return detail::variant_comparison<Tag, Ts...>::relation(lhs, rhs,
+                                                          std::greater<>{});
+}
+
+template <typename Tag, typename... Ts>
+bool operator<=(const basic_variant_base<Tag, Ts...> &lhs,
+                const basic_variant_base<Tag, Ts...> &rhs) {
+  return detail::variant_comparison<Tag, Ts...>::relation(
+      lhs, rhs, std::less_equal<>{});
+}
+
+template <typename Tag, typename... Ts>
+bool operator>=(const basic_variant_base<Tag, Ts...> &lhs,
+                const basic_variant_base<Tag, Ts...> &rhs) {
+  return detail::variant_comparison<Tag, Ts...>::relation(
+      lhs, rhs, std::greater_equal<>{});
+}
+
+#if CXX_ENUMEXT_THREE_WAY
+/// @brief Three-way comparison in the same order. Alternatives without `<=>`
+/// are compared with `<`, giving a `std::weak_ordering`.
+template <typename Tag, typename... Ts>
+  requires(detail::synth_three_way_comparable<Ts> && ...)
+detail::synth_ordering_t<Ts...>
+operator<=>(const basic_variant_base<Tag, Ts...> &lhs,
+            const basic_variant_base<Tag, Ts...> &rhs) {
+  return detail::variant_comparison<Tag, Ts...>::template compare<
+      detail::synth_ordering_t<Ts...>>(lhs, rhs);
+}
+#endif
+
+} // namespace enm
+} // namespace rust
+
+#endif
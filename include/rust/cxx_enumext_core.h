@@ -0,0 +1,1783 @@
+/*
+ * Copyright (c) Rachel Powers.
+ *
+ * This source code is licensed under both the MIT license found in the
+ * LICENSE-MIT file in the root directory of this source tree and the Apache
+ * License, Version 2.0 found in the LICENSE-APACHE file in the root directory
+ * of this source tree.
+ */
+
+// cxx_enumext/include/rust/cxx_enumext_core.h
+
+
+// This file incorporates work submitted as a pull request
+// to the cxx github repository (https://github.com/dtolnay/cxx/pull/1328)
+// and is covered by the following copyright and permission notice:
+//
+//  Copyright 2024 Dima Dorezyuk
+//
+//  Licensed under either of Apache License [1], Version 2.0 or MIT license [2]
+//  at your option.
+//
+//  [1] https://github.com/dtolnay/cxx/blob/master/LICENSE-APACHE
+//  [2] https://github.com/dtolnay/cxx/blob/master/LICENSE-MIT
+//
+
+// The variant with the layout of a Rust enum and what its definitions need:
+// storage, `index`, `get`, `get_if`, `visit`, `monostate` and `nonzero`. The
+// generated headers only include this one and the headers of the types they
+// use. Comparisons, `optional`, `nullable`, `expected`, the containers and
+// the hashing are in headers of their own, "rust/cxx_enumext.h" includes all
+// of them.
+
+#ifndef RUST_CXX_ENUMEXT_CORE_H
+#define RUST_CXX_ENUMEXT_CORE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint> // IWYU pragma: keep
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+// If you're using enums and variants on windows, you need to pass also
+// `/Zc:__cplusplus` as a compiler to make __cplusplus work correctly. If users
+// ever report that they have a too old compiler to `/Zc:__cplusplus` we may
+// fallback to the `_MSVC_LANG` define.
+//
+// Sources:
+// https://devblogs.microsoft.com/cppblog/msvc-now-correctly-reports-__cplusplus/
+// https://learn.microsoft.com/en-us/cpp/build/reference/zc-cplusplus?view=msvc-170
+#include <variant>
+
+// `operator<=>` is provided if both the compiler and the standard library
+// support it.
+#if defined(__cpp_impl_three_way_comparison) && defined(__has_include)
+#if __has_include(<compare>)
+#include <compare>
+#endif
+#endif
+
+#if defined(__cpp_impl_three_way_comparison) &&                                \
+    defined(__cpp_lib_three_way_comparison) && defined(__cpp_concepts)
+#define CXX_ENUMEXT_THREE_WAY 1
+#else
+#define CXX_ENUMEXT_THREE_WAY 0
+#endif
+
+// Variants of trivially copyable alternatives can be read in constant
+// expressions (e.g. `constexpr` tables of enums) if the standard library
+// tells constant evaluation apart, i.e. from C++20 on.
+#if defined(__cpp_lib_is_constant_evaluated)
+#define CXX_ENUMEXT_CONSTEXPR_VARIANT 1
+#else
+#define CXX_ENUMEXT_CONSTEXPR_VARIANT 0
+#endif
+
+// Selects what happens on a bad access (e.g. `get` with the wrong index,
+// `value()` of an empty optional or visiting a variant with a corrupted
+// index):
+//
+// - CXX_ENUMEXT_BAD_ACCESS_THROW: throws the documented exception (default if
+//   exceptions are enabled).
+// - CXX_ENUMEXT_BAD_ACCESS_ABORT: calls std::abort (default if exceptions are
+//   disabled, e.g. with `-fno-exceptions`).
+// - CXX_ENUMEXT_BAD_ACCESS_HOOK: calls the user provided
+//   `[[noreturn]] void rust::enm::bad_access_hook(const char *) noexcept`.
+// - CXX_ENUMEXT_BAD_ACCESS_UNREACHABLE: treats a bad access as undefined
+//   behavior, so the checks are removed by the optimizer.
+//
+// Define CXX_ENUMEXT_BAD_ACCESS_POLICY to one of the values before including
+// this header to override the default.
+#define CXX_ENUMEXT_BAD_ACCESS_THROW 0
+#define CXX_ENUMEXT_BAD_ACCESS_ABORT 1
+#define CXX_ENUMEXT_BAD_ACCESS_HOOK 2
+#define CXX_ENUMEXT_BAD_ACCESS_UNREACHABLE 3
+
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define CXX_ENUMEXT_EXCEPTIONS 1
+#else
+#define CXX_ENUMEXT_EXCEPTIONS 0
+#endif
+
+#ifndef CXX_ENUMEXT_BAD_ACCESS_POLICY
+#if CXX_ENUMEXT_EXCEPTIONS
+#define CXX_ENUMEXT_BAD_ACCESS_POLICY CXX_ENUMEXT_BAD_ACCESS_THROW
+#else
+#define CXX_ENUMEXT_BAD_ACCESS_POLICY CXX_ENUMEXT_BAD_ACCESS_ABORT
+#endif
+#endif
+
+#if CXX_ENUMEXT_BAD_ACCESS_POLICY == CXX_ENUMEXT_BAD_ACCESS_THROW &&          \
+    !CXX_ENUMEXT_EXCEPTIONS
+#error "CXX_ENUMEXT_BAD_ACCESS_THROW requires exceptions"
+#endif
+
+// Marks the function reporting a bad access as cold and keeps it out of line,
+// so the checked accessors only contain a compare and a call and the
+// compiler lays out the failure away from the hot code. An unreachable bad
+// access stays inline for the optimizer to remove.
+#if CXX_ENUMEXT_BAD_ACCESS_POLICY == CXX_ENUMEXT_BAD_ACCESS_UNREACHABLE
+#define CXX_ENUMEXT_COLD
+#elif defined(__GNUC__) || defined(__clang__)
+#define CXX_ENUMEXT_COLD [[gnu::cold, gnu::noinline]]
+#elif defined(_MSC_VER)
+#define CXX_ENUMEXT_COLD __declspec(noinline)
+#else
+#define CXX_ENUMEXT_COLD
+#endif
+
+namespace rust {
+namespace enm {
+
+#if CXX_ENUMEXT_BAD_ACCESS_POLICY == CXX_ENUMEXT_BAD_ACCESS_HOOK
+/// @brief Called on a bad access if CXX_ENUMEXT_BAD_ACCESS_POLICY is
+/// CXX_ENUMEXT_BAD_ACCESS_HOOK. Must be defined by the user and must not
+/// return.
+[[noreturn]] void bad_access_hook(const char *what) noexcept;
+#endif
+
+namespace detail {
+
+/// @brief Reports a bad access according to CXX_ENUMEXT_BAD_ACCESS_POLICY.
+/// `Exception` is constructed from `args` if the policy throws. Every failing
+/// check of the accessors ends up here.
+///
+/// `Policy` only names the instantiations after the policy: translation
+/// units built with different policies (e.g. with and without exceptions)
+/// then don't define the same out of line function differently, which the
+/// linker would silently merge.
+template <typename Exception, int Policy = CXX_ENUMEXT_BAD_ACCESS_POLICY,
+          typename... Args>
+[[noreturn]] CXX_ENUMEXT_COLD void
+bad_access([[maybe_unused]] const char *what, [[maybe_unused]] Args &&...args) {
+#if CXX_ENUMEXT_BAD_ACCESS_POLICY == CXX_ENUMEXT_BAD_ACCESS_THROW
+  throw Exception(std::forward<Args>(args)...);
+#elif CXX_ENUMEXT_BAD_ACCESS_POLICY == CXX_ENUMEXT_BAD_ACCESS_ABORT
+  std::abort();
+#elif CXX_ENUMEXT_BAD_ACCESS_POLICY == CXX_ENUMEXT_BAD_ACCESS_HOOK
+  bad_access_hook(what);
+#elif defined(_MSC_VER) && !defined(__clang__)
+  __assume(false);
+#else
+  __builtin_unreachable();
+#endif
+}
+
+/// @brief Copies `text` without its terminator to `out` and returns the end.
+inline char *write_text(char *out, const char *text) noexcept {
+  while (*text != '\0') {
+    *out++ = *text++;
+  }
+  return out;
+}
+
+/// @brief Writes `value` in decimal to `out` and returns the end.
+inline char *write_decimal(char *out, std::size_t value) noexcept {
+  char digits[std::numeric_limits<std::size_t>::digits10 + 1];
+  std::size_t count = 0;
+  do {
+    digits[count++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+  while (count != 0) {
+    *out++ = digits[--count];
+  }
+  return out;
+}
+
+} // namespace detail
+
+/// @brief Thrown by `get` if the variant holds another alternative than the
+/// requested one. Constructing it doesn't allocate, the message is formatted
+/// into the exception when `what()` is called.
+struct bad_rust_variant_access : std::bad_variant_access {
+  bad_rust_variant_access(std::size_t requested, std::size_t active) noexcept
+      : m_Requested(requested), m_Active(active) {}
+
+  /// @brief The index of the alternative `get` asked for
+  std::size_t requested_index() const noexcept { return m_Requested; }
+
+  /// @brief The index of the alternative the variant holds
+  std::size_t active_index() const noexcept { return m_Active; }
+
+  const char *what() const noexcept override {
+    char *end = detail::write_text(m_What, "bad variant access: requested ");
+    end = detail::write_decimal(end, m_Requested);
+    end = detail::write_text(end, ", active ");
+    end = detail::write_decimal(end, m_Active);
+    *end = '\0';
+    return m_What;
+  }
+
+private:
+  std::size_t m_Requested;
+  std::size_t m_Active;
+  // Fits the text and two 20 digit indices.
+  mutable char m_What[80];
+};
+
+/// @brief Thrown if the index stored in a variant doesn't name any of its
+/// alternatives, e.g. if its bytes didn't come from a variant of that type.
+/// Like `bad_rust_variant_access`, it doesn't allocate.
+struct bad_rust_variant_index : std::bad_variant_access {
+  explicit bad_rust_variant_index(std::size_t index) noexcept
+      : m_Index(index) {}
+
+  /// @brief The invalid index
+  std::size_t index() const noexcept { return m_Index; }
+
+  const char *what() const noexcept override {
+    char *end = detail::write_text(m_What, "invalid variant index ");
+    end = detail::write_decimal(end, m_Index);
+    *end = '\0';
+    return m_What;
+  }
+
+private:
+  std::size_t m_Index;
+  // Fits the text and a 20 digit index.
+  mutable char m_What[48];
+};
+
+// Adjusted from std::variant_alternative. Standard selects always the most
+// specialized template specialization. See
+// https://timsong-cpp.github.io/cppwp/n4140/temp.class.spec.match and
+// https://timsong-cpp.github.io/cppwp/n4140/temp.class.order.
+template <std::size_t I, typename... Ts> struct variant_alternative;
+
+// Specialization for gracefully handling invalid indices.
+template <std::size_t I> struct variant_alternative<I> {};
+
+template <std::size_t I, typename First, typename... Remainder>
+struct variant_alternative<I, First, Remainder...>
+    : variant_alternative<I - 1, Remainder...> {};
+
+template <typename First, typename... Remainder>
+struct variant_alternative<0, First, Remainder...> {
+  using type = First;
+};
+
+template <std::size_t I, typename... Ts>
+using variant_alternative_t = typename variant_alternative<I, Ts...>::type;
+
+template <bool... Values> constexpr size_t compile_time_count() noexcept {
+  return 0 + (static_cast<std::size_t>(Values) + ...);
+}
+
+template <bool... Values>
+struct count
+    : std::integral_constant<std::size_t, compile_time_count<Values...>()> {};
+
+template <bool... Values>
+struct exactly_once : std::conditional_t<count<Values...>::value == 1,
+                                         std::true_type, std::false_type> {};
+
+template <std::size_t I, bool... Values> struct index_from_booleans;
+
+template <std::size_t I> struct index_from_booleans<I> {};
+
+template <std::size_t I, bool First, bool... Remainder>
+struct index_from_booleans<I, First, Remainder...>
+    : index_from_booleans<I + 1, Remainder...> {};
+
+template <std::size_t I, bool... Remainder>
+struct index_from_booleans<I, true, Remainder...>
+    : std::integral_constant<std::size_t, I> {};
+
+template <typename Type, typename... Ts>
+struct index_from_type
+    : index_from_booleans<0, std::is_same_v<std::decay_t<Type>, Ts>...> {
+  static_assert(exactly_once<std::is_same_v<std::decay_t<Type>, Ts>...>::value,
+                "Index must be unique");
+};
+
+/// @brief Adds `const` to `T` if `From` is const qualified.
+template <typename From, typename T>
+using copy_const_t = std::conditional_t<std::is_const_v<From>, const T, T>;
+
+namespace detail {
+
+/// @brief The size of the largest of `Ts`, `std::max` without pulling in
+/// `<algorithm>`.
+template <typename... Ts>
+constexpr std::size_t max_size_v = [] {
+  std::size_t size = 0;
+  ((size = sizeof(Ts) > size ? sizeof(Ts) : size), ...);
+  return size;
+}();
+
+/// @brief `std::addressof` without pulling in `<memory>`. The standard
+/// libraries implement it with the same builtin.
+template <typename T> constexpr T *address_of(T &value) noexcept {
+  return __builtin_addressof(value);
+}
+
+/// @brief True if `T` is an aggregate which can be initialized from `Args`
+/// with braces, like the `TUPLE` and `STRUCT` alternatives.
+template <typename Void, typename T, typename... Args>
+struct is_aggregate_initializable : std::false_type {};
+
+template <typename T, typename... Args>
+struct is_aggregate_initializable<
+    std::void_t<decltype(T{std::declval<Args>()...})>, T, Args...>
+    : std::is_aggregate<T> {};
+
+/// @brief True if `T` can be created from `Args`, with parentheses or, as
+/// C++20 allows for aggregates, with braces.
+template <typename T, typename... Args>
+constexpr bool is_initializable_v =
+    std::is_constructible_v<T, Args...> ||
+    is_aggregate_initializable<void, T, Args...>::value;
+
+template <typename T, typename... Args>
+constexpr bool is_nothrow_initializable() noexcept {
+  if constexpr (std::is_constructible_v<T, Args...>) {
+    return std::is_nothrow_constructible_v<T, Args...>;
+  } else if constexpr (is_aggregate_initializable<void, T, Args...>::value) {
+    return noexcept(T{std::declval<Args>()...});
+  } else {
+    return false;
+  }
+}
+
+template <typename T, typename... Args>
+constexpr bool is_nothrow_initializable_v =
+    is_nothrow_initializable<T, Args...>();
+
+/// @brief Creates `T` from `args`, see `is_initializable_v`. The result is a
+/// prvalue: `new (storage) T(initialize<T>(args...))` constructs `T` right
+/// in `storage`, without a temporary.
+template <typename T, typename... Args>
+constexpr T
+initialize(Args &&...args) noexcept(is_nothrow_initializable_v<T, Args...>) {
+  if constexpr (std::is_constructible_v<T, Args...>) {
+    return T(std::forward<Args>(args)...);
+  } else {
+    return T{std::forward<Args>(args)...};
+  }
+}
+
+} // namespace detail
+
+template <typename... Ts> struct visitor_type;
+
+template <typename... Vs> struct multi_visitor_type;
+
+/// @brief True if `visit(Visitor, Variant)` can not throw.
+template <typename Visitor, typename Variant, typename... Ts>
+constexpr bool is_nothrow_visit_v = std::conjunction_v<
+    std::is_nothrow_invocable<Visitor, copy_const_t<Variant, Ts> &>...>;
+
+template <typename Tag, typename... Ts> struct basic_variant_base;
+
+/// @brief The variant with the tag of a `#[repr(C)]` Rust enum.
+template <typename... Ts> using variant_base = basic_variant_base<int, Ts...>;
+
+template <std::size_t I, typename Tag, typename... Ts>
+constexpr decltype(auto) get(basic_variant_base<Tag, Ts...> &);
+
+template <std::size_t I, typename Tag, typename... Ts>
+constexpr decltype(auto) get(const basic_variant_base<Tag, Ts...> &);
+
+template <std::size_t I, typename Tag, typename... Ts>
+constexpr variant_alternative_t<I, Ts...> &
+get_unchecked(basic_variant_base<Tag, Ts...> &) noexcept;
+
+template <std::size_t I, typename Tag, typename... Ts>
+constexpr const variant_alternative_t<I, Ts...> &
+get_unchecked(const basic_variant_base<Tag, Ts...> &) noexcept;
+
+template <std::size_t I, typename Tag, typename... Ts>
+constexpr std::add_pointer_t<variant_alternative_t<I, Ts...>>
+get_if(basic_variant_base<Tag, Ts...> *variant);
+
+template <std::size_t I, typename Tag, typename... Ts>
+constexpr std::add_pointer_t<const variant_alternative_t<I, Ts...>>
+get_if(const basic_variant_base<Tag, Ts...> *variant);
+
+template <typename Visitor, typename Tag, typename... Ts>
+constexpr decltype(auto) visit(Visitor &&visitor,
+                               basic_variant_base<Tag, Ts...> &) noexcept(
+    is_nothrow_visit_v<Visitor, basic_variant_base<Tag, Ts...>, Ts...>);
+
+template <typename Visitor, typename Tag, typename... Ts>
+constexpr decltype(auto)
+visit(Visitor &&visitor, const basic_variant_base<Tag, Ts...> &) noexcept(
+    is_nothrow_visit_v<Visitor, const basic_variant_base<Tag, Ts...>, Ts...>);
+
+namespace detail {
+
+template <typename Tag, typename... Ts> struct variant_comparison;
+
+/// @brief The alternatives as nested unions. Constructing one of its members
+/// in the constructor's initializer list is the only way to create an
+/// alternative in a constant expression, and reading the member the only way
+/// to access it there.
+template <typename... Ts> union alternative_union {};
+
+template <typename T, typename... Ts> union alternative_union<T, Ts...> {
+  template <typename... Args>
+  constexpr explicit alternative_union(std::in_place_index_t<0>,
+                                       Args &&...args)
+      : m_Head(initialize<T>(std::forward<Args>(args)...)) {}
+
+  template <std::size_t I, typename... Args,
+            typename = std::enable_if_t<(I > 0)>>
+  constexpr explicit alternative_union(std::in_place_index_t<I>,
+                                       Args &&...args)
+      : m_Tail(std::in_place_index<I - 1>, std::forward<Args>(args)...) {}
+
+  T m_Head;
+  alternative_union<Ts...> m_Tail;
+};
+
+/// @brief Returns the `I`-th member of an `alternative_union`.
+template <std::size_t I, typename Union>
+constexpr auto &union_member(Union &alternatives) noexcept {
+  if constexpr (I == 0) {
+    return alternatives.m_Head;
+  } else {
+    return union_member<I - 1>(alternatives.m_Tail);
+  }
+}
+
+/// @brief Stands in for the `alternative_union` of alternatives that aren't
+/// trivially copyable (e.g. `rust::String`), which can't live in a union
+/// without the union taking over their special members. They are constructed
+/// into the bytes and can't be used in constant expressions.
+template <typename... Ts> struct alternative_bytes {
+  template <std::size_t I, typename... Args>
+  explicit alternative_bytes(std::in_place_index_t<I>, Args &&...args) {
+    using type = variant_alternative_t<I, Ts...>;
+    new (static_cast<void *>(m_Bytes))
+        type(initialize<type>(std::forward<Args>(args)...));
+  }
+
+  alignas(Ts...) std::byte m_Bytes[max_size_v<Ts...>];
+};
+
+/// @brief True if a `T` can be moved by copying its bytes and forgetting the
+/// original, like Rust moves values: trivially movable types, and types
+/// declaring `using IsRelocatable = std::true_type;` like the cxx types
+/// (`rust::String`, `rust::Box`, `rust::Vec`...) and the enums themselves.
+/// Types keeping pointers into themselves, e.g. a `std::string` holding a
+/// short string, are not.
+template <typename T, typename = void>
+struct is_trivially_relocatable
+    : std::bool_constant<std::is_trivially_move_constructible_v<T> &&
+                         std::is_trivially_destructible_v<T>> {};
+
+template <typename T>
+struct is_trivially_relocatable<T, std::void_t<typename T::IsRelocatable>>
+    : std::bool_constant<T::IsRelocatable::value> {};
+
+template <typename... Ts>
+constexpr bool is_trivial_variant_v = std::conjunction_v<
+    std::is_trivially_copy_constructible<Ts>...,
+    std::is_trivially_move_constructible<Ts>...,
+    std::is_trivially_copy_assignable<Ts>...,
+    std::is_trivially_move_assignable<Ts>...,
+    std::is_trivially_destructible<Ts>...>;
+
+template <typename... Ts>
+using alternatives_t =
+    std::conditional_t<is_trivial_variant_v<Ts...>, alternative_union<Ts...>,
+                       alternative_bytes<Ts...>>;
+
+/// @brief Holds the tag and the storage of a `variant_base`.
+template <typename Tag, typename... Ts> struct variant_storage {
+  static_assert(std::is_integral_v<Tag> && !std::is_same_v<Tag, bool>,
+                "The tag must be an integer type");
+  static_assert(sizeof...(Ts) - 1 <=
+                    static_cast<std::size_t>(std::numeric_limits<Tag>::max()),
+                "The tag type is too small for the number of alternatives");
+
+  /// @brief The alternative is only created by the layers above, which copy
+  /// or move it into `m_Buff`.
+  variant_storage() noexcept {}
+
+  /// @brief Creates the `I`-th alternative from `args`.
+  template <std::size_t I, typename... Args>
+  constexpr explicit variant_storage(std::in_place_index_t<I> index,
+                                     Args &&...args)
+      : m_Index(static_cast<Tag>(I)),
+        m_Alternatives(index, std::forward<Args>(args)...) {}
+
+protected:
+  /// @brief True if the alternatives live in an `alternative_union`, so the
+  /// variant can be used in constant expressions.
+  constexpr static bool has_alternative_union =
+      std::is_same_v<alternatives_t<Ts...>, alternative_union<Ts...>>;
+
+  /// @brief The size of every alternative, indexed by `m_Index`. Used to
+  /// relocate only the bytes of the active alternative.
+  constexpr static std::size_t alternative_sizes[] = {sizeof(Ts)...};
+
+  /// @brief True if every alternative can be relocated by its bytes.
+  constexpr static bool all_trivially_relocatable =
+      std::conjunction_v<is_trivially_relocatable<Ts>...>;
+
+  /// @brief The bytes of the active alternative, all of them if the tag is
+  /// out of range (e.g. bytes from Rust which don't hold a valid enum).
+  std::size_t active_size() const noexcept {
+    const auto index = static_cast<std::size_t>(m_Index);
+    return index < sizeof...(Ts) ? alternative_sizes[index] : sizeof(m_Buff);
+  }
+
+  void destroy() {
+    visitor_type<Ts...>::visit(
+        [](const auto &value) {
+          using type = std::decay_t<decltype(value)>;
+          value.~type();
+        },
+        m_Index, m_Buff);
+  }
+
+  // The discriminant of the Rust enum. `#[repr(C)]` enums use the C enum
+  // type, which is not fixed but should be int - which we will verify
+  // statically. See
+  // https://timsong-cpp.github.io/cppwp/n4659/dcl.enum#7
+  // `#[repr(C, u8)]` and friends use the given integer type.
+  Tag m_Index;
+
+  // std::aligned_storage is deprecated and may be replaced with the construct
+  // below. See
+  // https://www.open-std.org/jtc1/sc22/wg21/docs/papers/2021/p1413r3.pdf
+  //
+  // The bytes overlay the alternatives, which have the same size and
+  // alignment. At runtime the alternatives are accessed through the bytes,
+  // in constant expressions through the union.
+  union {
+    alignas(Ts...) std::byte m_Buff[max_size_v<Ts...>];
+    alternatives_t<Ts...> m_Alternatives;
+  };
+};
+
+/// @brief Destroys the active alternative. The destructor is only
+/// user-provided if one of the alternatives is not trivially destructible,
+/// so the variant stays trivially destructible otherwise.
+template <bool Trivial, typename Tag, typename... Ts>
+struct variant_destructor : variant_storage<Tag, Ts...> {
+  using variant_storage<Tag, Ts...>::variant_storage;
+
+  ~variant_destructor() { this->destroy(); }
+};
+
+template <typename Tag, typename... Ts>
+struct variant_destructor<true, Tag, Ts...> : variant_storage<Tag, Ts...> {
+  using variant_storage<Tag, Ts...>::variant_storage;
+};
+
+template <typename Tag, typename... Ts>
+using variant_destructor_t =
+    variant_destructor<std::conjunction_v<std::is_trivially_destructible<Ts>...>,
+                       Tag, Ts...>;
+
+/// @brief Copies the active alternative. If all alternatives are trivially
+/// copyable the copy operations are defaulted and the variant is trivially
+/// copyable itself - which allows to memcpy arrays of it.
+template <bool Trivial, typename Tag, typename... Ts>
+struct variant_copy : variant_destructor_t<Tag, Ts...> {
+  constexpr static bool all_copy_constructible_v =
+      std::conjunction_v<std::is_copy_constructible<Ts>...>;
+
+  using variant_destructor_t<Tag, Ts...>::variant_destructor_t;
+
+  variant_copy() = default;
+
+  variant_copy(const variant_copy &other) {
+    static_assert(
+        all_copy_constructible_v,
+        "Copy constructor requires that all types are copy constructable");
+
+    this->m_Index = other.m_Index;
+    visitor_type<Ts...>::visit(
+        [this](const auto &value) {
+          using type = std::decay_t<decltype(value)>;
+          new (static_cast<void *>(this->m_Buff)) type(value);
+        },
+        other.m_Index, other.m_Buff);
+  }
+
+  variant_copy &operator=(const variant_copy &other) {
+    static_assert(
+        all_copy_constructible_v,
+        "Copy assignment requires that all types are copy constructable");
+
+    if (this == &other) {
+      return *this;
+    }
+    if (this->m_Index == other.m_Index) {
+      visitor_type<Ts...>::visit(
+          [&other](auto &value) {
+            using type = std::decay_t<decltype(value)>;
+            value = *reinterpret_cast<const type *>(other.m_Buff);
+          },
+          this->m_Index, this->m_Buff);
+    } else {
+      visitor_type<Ts...>::visit(
+          [this](const auto &value) {
+            using type = std::decay_t<decltype(value)>;
+            static_cast<basic_variant_base<Tag, Ts...> &>(*this)
+                .template emplace<type>(value);
+          },
+          other.m_Index, other.m_Buff);
+    }
+    return *this;
+  }
+
+  // Moves are handled by `variant_move`.
+  variant_copy(variant_copy &&) = default;
+  variant_copy &operator=(variant_copy &&) = default;
+};
+
+template <typename Tag, typename... Ts>
+struct variant_copy<true, Tag, Ts...> : variant_destructor_t<Tag, Ts...> {
+  using variant_destructor_t<Tag, Ts...>::variant_destructor_t;
+};
+
+template <typename... Ts>
+constexpr bool is_trivially_copyable_variant_v = std::conjunction_v<
+    std::is_trivially_copy_constructible<Ts>...,
+    std::is_trivially_copy_assignable<Ts>...,
+    std::is_trivially_destructible<Ts>...>;
+
+template <typename Tag, typename... Ts>
+using variant_copy_t =
+    variant_copy<is_trivially_copyable_variant_v<Ts...>, Tag, Ts...>;
+
+/// @brief Moves the active alternative. Defaulted if all alternatives are
+/// trivially movable, otherwise the active alternative is move constructed
+/// (or assigned) from the other variant, leaving it in a moved-from state.
+template <bool Trivial, typename Tag, typename... Ts>
+struct variant_move : variant_copy_t<Tag, Ts...> {
+  constexpr static bool all_move_constructible_v =
+      std::conjunction_v<std::is_move_constructible<Ts>...>;
+
+  constexpr static bool all_nothrow_move_constructible_v =
+      std::conjunction_v<std::is_nothrow_move_constructible<Ts>...>;
+
+  constexpr static bool all_nothrow_move_assignable_v =
+      std::conjunction_v<std::is_nothrow_move_assignable<Ts>...>;
+
+  using variant_copy_t<Tag, Ts...>::variant_copy_t;
+
+  variant_move() = default;
+  variant_move(const variant_move &) = default;
+
+  variant_move(variant_move &&other) noexcept(
+      all_nothrow_move_constructible_v) {
+    static_assert(
+        all_move_constructible_v,
+        "Move constructor requires that all types are move constructable");
+
+    this->m_Index = other.m_Index;
+    visitor_type<Ts...>::visit(
+        [this](auto &value) {
+          using type = std::decay_t<decltype(value)>;
+          new (static_cast<void *>(this->m_Buff)) type(std::move(value));
+        },
+        other.m_Index, other.m_Buff);
+  }
+
+  variant_move &operator=(const variant_move &) = default;
+
+  variant_move &operator=(variant_move &&other) noexcept(
+      all_nothrow_move_constructible_v &&all_nothrow_move_assignable_v) {
+    static_assert(
+        all_move_constructible_v,
+        "Move assignment requires that all types are move constructable");
+
+    // Like std::variant: the same alternative is move assigned in place,
+    // another one is emplaced. A self-move leaves the variant as it is.
+    if (this == &other) {
+      return *this;
+    }
+    if (this->m_Index == other.m_Index) {
+      visitor_type<Ts...>::visit(
+          [&other](auto &value) {
+            using type = std::decay_t<decltype(value)>;
+            value = std::move(*reinterpret_cast<type *>(other.m_Buff));
+          },
+          this->m_Index, this->m_Buff);
+    } else {
+      visitor_type<Ts...>::visit(
+          [this](auto &value) {
+            using type = std::decay_t<decltype(value)>;
+            static_cast<basic_variant_base<Tag, Ts...> &>(*this)
+                .template emplace<type>(std::move(value));
+          },
+          other.m_Index, other.m_Buff);
+    }
+    return *this;
+  }
+};
+
+template <typename Tag, typename... Ts>
+struct variant_move<true, Tag, Ts...> : variant_copy_t<Tag, Ts...> {
+  using variant_copy_t<Tag, Ts...>::variant_copy_t;
+};
+
+template <typename... Ts>
+constexpr bool is_trivially_movable_variant_v = std::conjunction_v<
+    std::is_trivially_move_constructible<Ts>...,
+    std::is_trivially_move_assignable<Ts>...,
+    std::is_trivially_destructible<Ts>...>;
+
+template <typename Tag, typename... Ts>
+using variant_move_t =
+    variant_move<is_trivially_movable_variant_v<Ts...>, Tag, Ts...>;
+
+} // namespace detail
+
+/// @brief A std::variant like tagged union with the same memory layout as a
+/// Rust Enum.
+///
+/// The memory layout of the Rust enum is defined under
+/// https://doc.rust-lang.org/reference/type-layout.html#reprc-enums-with-fields
+///
+/// The variant is trivially copyable and trivially destructible if all its
+/// alternatives are.
+template <typename Tag, typename... Ts>
+struct basic_variant_base : detail::variant_move_t<Tag, Ts...> {
+  static_assert(sizeof...(Ts) > 0,
+                "variant_base must hold at least one alternative");
+
+  /// @brief Delete the default constructor since we cannot be in an
+  /// uninitialized state (if the first alternative throws). Corresponds to
+  /// the (1) constructor in std::variant.
+  basic_variant_base() = delete;
+
+  constexpr static bool all_copy_constructible_v =
+      std::conjunction_v<std::is_copy_constructible<Ts>...>;
+
+  /// @brief Copy constructor. Statically fails if not every type in Ts is
+  /// copy constructable. Corresponds to (2) constructor of std::variant.
+  basic_variant_base(const basic_variant_base &other) = default;
+
+  /// @brief Move constructor. Statically fails if not every type in Ts is
+  /// move constructable. Corresponds to (3) constructor of std::variant.
+  basic_variant_base(basic_variant_base &&other) = default;
+
+  template <typename T>
+  constexpr static bool is_unique_v =
+      exactly_once<std::is_same_v<Ts, std::decay_t<T>>...>::value;
+
+  template <typename T>
+  constexpr static std::size_t index_from_type_v =
+      index_from_type<T, Ts...>::value;
+
+  /// @brief Converting constructor. Corresponds to (4) constructor of
+  /// std::variant. The conjunction only asks `is_constructible` for
+  /// alternatives: asking it for the variant itself, e.g. while copying from
+  /// a non-const lvalue, would recurse into this constructor.
+  template <typename T, typename D = std::decay_t<T>,
+            typename = std::enable_if_t<std::conjunction_v<
+                std::bool_constant<is_unique_v<T>>,
+                std::is_constructible<D, T>>>>
+  constexpr basic_variant_base(T &&other) noexcept(
+      std::is_nothrow_constructible_v<D, T>)
+      : detail::variant_move_t<Tag, Ts...>(
+            std::in_place_index<index_from_type_v<D>>, std::forward<T>(other)) {
+  }
+
+  /// @brief Participates in the resolution only if we can construct T from
+  /// Args and if T is unique in Ts. Corresponds to (5) constructor of
+  /// std::variant. Aggregates, like `TUPLE` and `STRUCT` alternatives, are
+  /// initialized from their fields as in C++20.
+  template <typename T, typename... Args,
+            typename = std::enable_if_t<is_unique_v<T>>,
+            typename = std::enable_if_t<detail::is_initializable_v<T, Args...>>>
+  constexpr explicit basic_variant_base(
+      [[maybe_unused]] std::in_place_type_t<T> type,
+      Args &&...args) noexcept(detail::is_nothrow_initializable_v<T, Args...>)
+      : basic_variant_base{std::in_place_index<index_from_type_v<T>>,
+                     std::forward<Args>(args)...} {}
+
+  template <std::size_t I>
+  using type_from_index_t = variant_alternative_t<I, Ts...>;
+
+  /// @brief Participates in the resolution only if the index is within range
+  /// and if the type can be constructor from Args. Corresponds to (7) of
+  /// std::variant.
+  template <std::size_t I, typename... Args, typename T = type_from_index_t<I>,
+            typename = std::enable_if_t<detail::is_initializable_v<T, Args...>>>
+  constexpr explicit basic_variant_base(
+      std::in_place_index_t<I> index,
+      Args &&...args) noexcept(detail::is_nothrow_initializable_v<T, Args...>)
+      : detail::variant_move_t<Tag, Ts...>(index, std::forward<Args>(args)...) {
+  }
+
+  template <typename... Rs>
+  constexpr static bool all_same_v =
+      std::conjunction_v<std::is_same<Rs, Ts>...>;
+
+  /// @brief Converts the std::variant to our variant. Participates only in
+  /// the resolution if all types in Ts are copy constructable.
+  template <typename... Rs, typename = std::enable_if_t<
+                                all_same_v<Rs...> && all_copy_constructible_v>>
+  basic_variant_base(const std::variant<Rs...> &other) {
+    m_Index = static_cast<Tag>(other.index());
+    std::visit(
+        [this](const auto &value) {
+          using type = std::decay_t<decltype(value)>;
+          new (static_cast<void *>(m_Buff)) type(value);
+        },
+        other);
+  }
+
+  constexpr static bool all_move_constructible_v =
+      std::conjunction_v<std::is_move_constructible<Ts>...>;
+
+  /// @brief Converts the std::variant to our variant. Participates only in
+  /// the resolution if all types in Ts are move constructable.
+  template <typename... Rs, typename = std::enable_if_t<
+                                all_same_v<Rs...> && all_move_constructible_v>>
+  basic_variant_base(std::variant<Rs...> &&other) {
+    m_Index = static_cast<Tag>(other.index());
+    std::visit(
+        [this](auto &&value) {
+          using type = std::decay_t<decltype(value)>;
+          new (static_cast<void *>(m_Buff)) type(std::move(value));
+        },
+        other);
+  }
+
+  ~basic_variant_base() = default;
+
+  /// @brief Copy assignment. Statically fails if not every type in Ts is copy
+  /// constructable. Corresponds to (1) assignment of std::variant.
+  basic_variant_base &operator=(const basic_variant_base &other) = default;
+
+  /// @brief Move assignment. Statically fails if not every type in Ts is move
+  /// constructable. Corresponds to (2) assignment of std::variant.
+  basic_variant_base &operator=(basic_variant_base &&other) = default;
+
+  /// @brief Converting assignment. Corresponds to (3) assignment of
+  /// std::variant.
+  template <typename T, typename = std::enable_if_t<
+                            is_unique_v<T> && std::is_constructible_v<T &&, T>>>
+  basic_variant_base &operator=(T &&other) {
+    constexpr auto index = index_from_type_v<T>;
+
+    if (m_Index == index) {
+      if constexpr (std::is_nothrow_assignable_v<T, T &&>) {
+        get<index>(*this) = std::forward<T>(other);
+        return *this;
+      }
+    }
+    this->emplace<std::decay_t<T>>(std::forward<T>(other));
+    return *this;
+  }
+
+  /// @brief Converting assignment from std::variant. Participates only in the
+  /// resolution if all types in Ts are copy constructable.
+  template <typename... Rs, typename = std::enable_if_t<
+                                all_same_v<Rs...> && all_copy_constructible_v>>
+  basic_variant_base &operator=(const std::variant<Rs...> &other) {
+    // TODO this is not really clean since we fail if std::variant has
+    // duplicated types.
+    std::visit(
+        [this](const auto &value) {
+          using type = decltype(value);
+          emplace<std::decay_t<type>>(value);
+        },
+        other);
+    return *this;
+  }
+
+  /// @brief Converting assignment from std::variant. Participates only in the
+  /// resolution if all types in Ts are move constructable.
+  template <typename... Rs, typename = std::enable_if_t<
+                                all_same_v<Rs...> && all_move_constructible_v>>
+  basic_variant_base &operator=(std::variant<Rs...> &&other) {
+    // TODO this is not really clean since we fail if std::variant has
+    // duplicated types.
+    std::visit(
+        [this](auto &&value) {
+          using type = decltype(value);
+          emplace<std::decay_t<type>>(std::move(value));
+        },
+        other);
+    return *this;
+  }
+
+  /// @brief Emplace function. Participates in the resolution only if T is
+  /// unique in Ts and if T can be constructed from Args. Offers strong
+  /// exception guarantee. Corresponds to the (1) emplace function of
+  /// std::variant.
+  template <typename T, typename... Args,
+            typename = std::enable_if_t<is_unique_v<T>>,
+            typename = std::enable_if_t<detail::is_initializable_v<T, Args...>>>
+  T &emplace(Args &&...args) {
+    constexpr std::size_t index = index_from_type_v<T>;
+    return this->emplace<index>(std::forward<Args>(args)...);
+  }
+
+  /// @brief Emplace function. Participates in the resolution only if T can be
+  /// constructed from Args. Offers strong exception guarantee. Corresponds to
+  /// the (2) emplace function of std::variant.
+  ///
+  /// The std::variant can have no valid state if the type throws during the
+  /// construction. This is represented by the `valueless_by_exception` flag.
+  /// The same approach is also used in absl::variant [2].
+  /// In our case we can't accept valueless enums since we can't represent
+  /// this in Rust. We must therefore provide a strong exception guarantee for
+  /// all operations using `emplace`. Two famous implementations of never
+  /// valueless variants are Boost/variant [3] and Boost/variant2 [4].
+  /// Boost/variant2 uses two memory buffers - which would be not compatible
+  /// with Rust Enum's memory layout. The Boost/variant backs up the old
+  /// object and calls its d'tor before constructing the new object; It then
+  /// copies the old data back to the buffer if the construction fails - which
+  /// might contain garbage (since) the d'tor was already called.
+  ///
+  ///
+  /// We take a similar approach to Boost/variant. Assuming that constructing
+  /// or moving the new type can throw, we backup the old data, try to
+  /// construct the new object in the final buffer, swap the buffers, such
+  /// that the old object is back in its original place, destroy it and move
+  /// the new object from the old buffer back to the final place.
+  ///
+  /// If every alternative is trivially relocatable (see
+  /// `detail::is_trivially_relocatable`, which holds for the types coming
+  /// from Rust) the old alternative is instead relocated into a backup of its
+  /// exact size, relocated back if the construction fails and destroyed in
+  /// the backup otherwise, which spares copying the new object.
+  ///
+  /// Sources
+  ///
+  /// [1]
+  /// https://en.cppreference.com/w/cpp/utility/variant/valueless_by_exception
+  /// [2]
+  /// https://github.com/abseil/abseil-cpp/blob/master/absl/types/variant.h
+  /// [3]
+  /// https://www.boost.org/doc/libs/1_84_0/libs/variant2/doc/html/variant2.html
+  /// [4]
+  /// https://www.boost.org/doc/libs/1_84_0/doc/html/variant/design.html#variant.design.never-empty
+  template <std::size_t I, typename... Args, typename T = type_from_index_t<I>,
+            typename = std::enable_if_t<detail::is_initializable_v<T, Args...>>>
+  T &emplace(Args &&...args) {
+    if constexpr (detail::is_nothrow_initializable_v<T, Args...>) {
+      destroy();
+      new (static_cast<void *>(m_Buff))
+          T(detail::initialize<T>(std::forward<Args>(args)...));
+    } else if constexpr (std::is_nothrow_move_constructible_v<T>) {
+      // This operation may throw, but we know that the move does not.
+      T tmp(detail::initialize<T>(std::forward<Args>(args)...));
+
+      // The operations below are safe.
+      destroy();
+      new (static_cast<void *>(m_Buff)) T(std::move(tmp));
+    } else if constexpr (all_trivially_relocatable) {
+      visitor_type<Ts...>::visit(
+          [&]([[maybe_unused]] auto &current) {
+            using old_type = std::decay_t<decltype(current)>;
+
+            // Relocate the old alternative into the backup.
+            alignas(old_type) std::byte backup[sizeof(old_type)];
+            std::memcpy(backup, m_Buff, sizeof(old_type));
+
+#if CXX_ENUMEXT_EXCEPTIONS
+            try {
+              // Try to construct the new object
+              new (static_cast<void *>(m_Buff))
+                  T(detail::initialize<T>(std::forward<Args>(args)...));
+            } catch (...) {
+              // Relocate the old alternative back.
+              std::memcpy(m_Buff, backup, sizeof(old_type));
+              throw;
+            }
+#else
+            new (static_cast<void *>(m_Buff))
+                T(detail::initialize<T>(std::forward<Args>(args)...));
+#endif
+            reinterpret_cast<old_type *>(backup)->~old_type();
+          },
+          m_Index, m_Buff);
+    } else {
+      // Backup the old data.
+      alignas(Ts...) std::byte old_buff[sizeof(m_Buff)];
+      std::memcpy(old_buff, m_Buff, sizeof(m_Buff));
+
+#if CXX_ENUMEXT_EXCEPTIONS
+      try {
+        // Try to construct the new object
+        new (static_cast<void *>(m_Buff))
+            T(detail::initialize<T>(std::forward<Args>(args)...));
+      } catch (...) {
+        // Restore the old buffer
+        std::memcpy(m_Buff, old_buff, sizeof(m_Buff));
+        throw;
+      }
+#else
+      new (static_cast<void *>(m_Buff))
+          T(detail::initialize<T>(std::forward<Args>(args)...));
+#endif
+      // Fetch the old buffer and destroy the old alternative in place.
+      std::swap_ranges(m_Buff, m_Buff + sizeof(m_Buff), old_buff);
+
+      destroy();
+      std::memcpy(m_Buff, old_buff, sizeof(m_Buff));
+    }
+
+    m_Index = static_cast<Tag>(I);
+    return get<I>(*this);
+  }
+
+  constexpr std::size_t index() const noexcept { return m_Index; }
+
+  /// @brief Swaps the two variants. If every alternative is trivially
+  /// relocatable the bytes of the active alternatives are swapped, only the
+  /// larger of the two alternatives is touched. Otherwise the alternatives
+  /// are swapped, or moved through a temporary if they differ.
+  void swap(basic_variant_base &other) noexcept(
+      all_trivially_relocatable ||
+      (std::conjunction_v<std::is_nothrow_move_constructible<Ts>...> &&
+       std::conjunction_v<std::is_nothrow_swappable<Ts>...>)) {
+    if constexpr (all_trivially_relocatable) {
+      const std::size_t size = active_size() > other.active_size()
+                                   ? active_size()
+                                   : other.active_size();
+      for (std::size_t i = 0; i < size; ++i) {
+        std::swap(m_Buff[i], other.m_Buff[i]);
+      }
+      std::swap(m_Index, other.m_Index);
+    } else if (m_Index == other.m_Index) {
+      visitor_type<Ts...>::visit(
+          [&other](auto &value) {
+            using std::swap;
+            using type = std::decay_t<decltype(value)>;
+            swap(value, *reinterpret_cast<type *>(other.m_Buff));
+          },
+          m_Index, m_Buff);
+    } else {
+      basic_variant_base tmp(std::move(other));
+      other = std::move(*this);
+      *this = std::move(tmp);
+    }
+  }
+
+  using bad_rust_variant_access = ::rust::enm::bad_rust_variant_access;
+
+protected:
+  template <std::size_t I> constexpr void throw_if_invalid() const {
+    static_assert(I < (sizeof...(Ts)), "Invalid index");
+
+    if (m_Index != I)
+      detail::bad_access<bad_rust_variant_access>("bad variant access", I,
+                                                  index());
+  }
+
+  template <std::size_t I> constexpr bool is_valid() const {
+    static_assert(I < (sizeof...(Ts)), "Invalid index");
+    return m_Index == I;
+  }
+
+  using detail::variant_move_t<Tag, Ts...>::alternative_sizes;
+  using detail::variant_move_t<Tag, Ts...>::all_trivially_relocatable;
+  using detail::variant_move_t<Tag, Ts...>::active_size;
+  using detail::variant_move_t<Tag, Ts...>::has_alternative_union;
+  using detail::variant_move_t<Tag, Ts...>::destroy;
+  using detail::variant_move_t<Tag, Ts...>::m_Index;
+  using detail::variant_move_t<Tag, Ts...>::m_Buff;
+  using detail::variant_move_t<Tag, Ts...>::m_Alternatives;
+
+private:
+  // The friend zone
+  template <std::size_t I, typename OtherTag, typename... Rs>
+  friend constexpr decltype(auto)
+  get(basic_variant_base<OtherTag, Rs...> &variant);
+
+  template <std::size_t I, typename OtherTag, typename... Rs>
+  friend constexpr decltype(auto)
+  get(const basic_variant_base<OtherTag, Rs...> &variant);
+
+  template <std::size_t I, typename OtherTag, typename... Rs>
+  friend constexpr variant_alternative_t<I, Rs...> &
+  get_unchecked(basic_variant_base<OtherTag, Rs...> &variant) noexcept;
+
+  template <std::size_t I, typename OtherTag, typename... Rs>
+  friend constexpr const variant_alternative_t<I, Rs...> &
+  get_unchecked(const basic_variant_base<OtherTag, Rs...> &variant) noexcept;
+
+  template <std::size_t I, typename OtherTag, typename... Rs>
+  friend constexpr std::add_pointer_t<variant_alternative_t<I, Rs...>>
+  get_if(basic_variant_base<OtherTag, Rs...> *variant);
+
+  template <std::size_t I, typename OtherTag, typename... Rs>
+  friend constexpr std::add_pointer_t<const variant_alternative_t<I, Rs...>>
+  get_if(const basic_variant_base<OtherTag, Rs...> *variant);
+
+  template <typename... Rs> friend struct visitor_type;
+
+  template <typename... Vs> friend struct multi_visitor_type;
+
+  template <typename OtherTag, typename... Rs>
+  friend struct detail::variant_comparison;
+};
+
+namespace detail {
+
+/// @brief Invokes the visitor with the alternative `T` stored in `data`.
+///
+/// Called directly when `visitor_type` dispatches inline, otherwise one
+/// instantiation per alternative makes up its dispatch table. The return
+/// value is converted to `Result` (the result of visiting the first
+/// alternative), matching `std::visit` semantics.
+template <typename Result, typename T, typename Visitor, typename Data>
+constexpr Result visit_alternative(Visitor &&visitor, Data *data) noexcept(
+    std::is_nothrow_invocable_v<Visitor, T &>) {
+  if constexpr (std::is_void_v<Result>) {
+    std::forward<Visitor>(visitor)(*reinterpret_cast<T *>(data));
+  } else {
+    return std::forward<Visitor>(visitor)(*reinterpret_cast<T *>(data));
+  }
+}
+
+/// @brief Compile-time table holding one `visit_alternative` instantiation
+/// per alternative, indexed by the variant's `m_Index`.
+template <typename Result, typename Visitor, typename Data, bool Nothrow,
+          typename... Ts>
+struct visit_table {
+  using function_type = Result (*)(Visitor &&, Data *) noexcept(Nothrow);
+
+  constexpr static function_type value[] = {
+      &visit_alternative<Result, Ts, Visitor, Data>...};
+};
+
+} // namespace detail
+
+template <typename First, typename... Remainder>
+struct visitor_type<First, Remainder...> {
+  /// @brief True if visiting the buffer `Data` (`std::byte` or
+  /// `const std::byte`) with `Visitor` can not throw.
+  template <typename Visitor, typename Data>
+  constexpr static bool is_nothrow_v = std::conjunction_v<
+      std::is_nothrow_invocable<Visitor, copy_const_t<Data, First> &>,
+      std::is_nothrow_invocable<Visitor, copy_const_t<Data, Remainder> &>...>;
+
+  template <typename Visitor, typename Variant>
+  constexpr static decltype(auto)
+  visit(Visitor &&visitor, Variant &&variant) noexcept(
+      is_nothrow_v<Visitor,
+                   copy_const_t<std::remove_reference_t<Variant>, std::byte>>) {
+#if CXX_ENUMEXT_CONSTEXPR_VARIANT
+    if constexpr (std::remove_reference_t<Variant>::has_alternative_union) {
+      if (std::is_constant_evaluated()) {
+        using data = copy_const_t<std::remove_reference_t<Variant>, std::byte>;
+        return visit_constant<
+            0, std::invoke_result_t<Visitor, copy_const_t<data, First> &>>(
+            std::forward<Visitor>(visitor), variant);
+      }
+    }
+#endif
+    return visit(std::forward<Visitor>(visitor), variant.m_Index,
+                 variant.m_Buff);
+  }
+
+  /// @brief The visit method which will pick the right type depending on the
+  /// `index` value.
+  ///
+  /// Up to `max_inline_dispatch` alternatives are dispatched through a
+  /// switch, which the optimizer can inline into the caller like
+  /// `std::visit` does. Larger variants go through a table of function
+  /// pointers, so every alternative costs one indirect call.
+  template <typename Visitor>
+  constexpr static decltype(auto)
+  visit(Visitor &&visitor, std::size_t index,
+        std::byte *data) noexcept(is_nothrow_v<Visitor, std::byte>) {
+    return dispatch(std::forward<Visitor>(visitor), index, data);
+  }
+
+  template <typename Visitor>
+  constexpr static decltype(auto)
+  visit(Visitor &&visitor, std::size_t index,
+        const std::byte *data) noexcept(is_nothrow_v<Visitor,
+                                                     const std::byte>) {
+    return dispatch(std::forward<Visitor>(visitor), index, data);
+  }
+
+  /// @brief The largest number of alternatives visited without the table.
+  constexpr static std::size_t max_inline_dispatch = 16;
+
+private:
+  template <typename Visitor, typename Data>
+  constexpr static decltype(auto) dispatch(Visitor &&visitor, std::size_t index,
+                                           Data *data) {
+    using result = std::invoke_result_t<Visitor, copy_const_t<Data, First> &>;
+
+    if constexpr (1 + sizeof...(Remainder) <= max_inline_dispatch) {
+      return dispatch_inline<result>(std::forward<Visitor>(visitor), index,
+                                     data);
+    } else {
+      using table = detail::visit_table<
+          result, Visitor, Data, is_nothrow_v<Visitor, Data>,
+          copy_const_t<Data, First>, copy_const_t<Data, Remainder>...>;
+
+      if (index >= 1 + sizeof...(Remainder)) {
+        detail::bad_access<bad_rust_variant_index>("invalid variant index",
+                                                   index);
+      }
+      return table::value[index](std::forward<Visitor>(visitor), data);
+    }
+  }
+
+  /// @brief Visits through a switch over `index`, which the optimizer can
+  /// inline. The cases past the last alternative are discarded.
+  template <typename Result, typename Visitor, typename Data>
+  constexpr static Result dispatch_inline(Visitor &&visitor, std::size_t index,
+                                          Data *data) {
+    switch (index) {
+#define CXX_ENUMEXT_DISPATCH_CASE(I)                                           \
+  case I:                                                                      \
+    if constexpr (I < 1 + sizeof...(Remainder)) {                              \
+      return visit_index<I, Result>(std::forward<Visitor>(visitor), data);     \
+    }                                                                          \
+    break;
+      CXX_ENUMEXT_DISPATCH_CASE(0)
+      CXX_ENUMEXT_DISPATCH_CASE(1)
+      CXX_ENUMEXT_DISPATCH_CASE(2)
+      CXX_ENUMEXT_DISPATCH_CASE(3)
+      CXX_ENUMEXT_DISPATCH_CASE(4)
+      CXX_ENUMEXT_DISPATCH_CASE(5)
+      CXX_ENUMEXT_DISPATCH_CASE(6)
+      CXX_ENUMEXT_DISPATCH_CASE(7)
+      CXX_ENUMEXT_DISPATCH_CASE(8)
+      CXX_ENUMEXT_DISPATCH_CASE(9)
+      CXX_ENUMEXT_DISPATCH_CASE(10)
+      CXX_ENUMEXT_DISPATCH_CASE(11)
+      CXX_ENUMEXT_DISPATCH_CASE(12)
+      CXX_ENUMEXT_DISPATCH_CASE(13)
+      CXX_ENUMEXT_DISPATCH_CASE(14)
+      CXX_ENUMEXT_DISPATCH_CASE(15)
+#undef CXX_ENUMEXT_DISPATCH_CASE
+    }
+    detail::bad_access<bad_rust_variant_index>("invalid variant index", index);
+  }
+
+  template <std::size_t I, typename Result, typename Visitor, typename Data>
+  constexpr static Result visit_index(Visitor &&visitor, Data *data) {
+    using type =
+        copy_const_t<Data, variant_alternative_t<I, First, Remainder...>>;
+    return detail::visit_alternative<Result, type, Visitor, Data>(
+        std::forward<Visitor>(visitor), data);
+  }
+
+  /// @brief Visits by comparing the index with every alternative's, since
+  /// the table's function pointers can't be called in constant expressions.
+  template <std::size_t I, typename Result, typename Visitor, typename Variant>
+  constexpr static Result visit_constant(Visitor &&visitor, Variant &variant) {
+    if (variant.index() != I) {
+      if constexpr (I < sizeof...(Remainder)) {
+        return visit_constant<I + 1, Result>(std::forward<Visitor>(visitor),
+                                             variant);
+      } else {
+        detail::bad_access<bad_rust_variant_index>("invalid variant index",
+                                                   variant.index());
+      }
+    }
+    return static_cast<Result>(
+        std::forward<Visitor>(visitor)(get_unchecked<I>(variant)));
+  }
+};
+
+/// @brief Applies the visitor to the variant. Corresponds to the (3)
+/// std::visit definition.
+template <typename Visitor, typename Tag, typename... Ts>
+constexpr decltype(auto)
+visit(Visitor &&visitor, basic_variant_base<Tag, Ts...> &variant) noexcept(
+    is_nothrow_visit_v<Visitor, basic_variant_base<Tag, Ts...>, Ts...>) {
+  return visitor_type<Ts...>::visit(std::forward<Visitor>(visitor), variant);
+}
+
+/// @brief Applies the visitor to the variant. Corresponds to the (4)
+/// std::visit definition.
+template <typename Visitor, typename Tag, typename... Ts>
+constexpr decltype(auto)
+visit(Visitor &&visitor,
+      const basic_variant_base<Tag, Ts...> &variant) noexcept(
+    is_nothrow_visit_v<Visitor, const basic_variant_base<Tag, Ts...>, Ts...>) {
+  return visitor_type<Ts...>::visit(std::forward<Visitor>(visitor), variant);
+}
+
+namespace detail {
+
+/// @brief Maps a type derived from `variant_base` (e.g. `variant`, `optional`)
+/// to its cv-qualified `variant_base`. Fails substitution for other types.
+template <typename Tag, typename... Ts>
+constexpr basic_variant_base<Tag, Ts...> &
+as_variant_base(basic_variant_base<Tag, Ts...> &variant) noexcept {
+  return variant;
+}
+
+template <typename Tag, typename... Ts>
+constexpr const basic_variant_base<Tag, Ts...> &
+as_variant_base(const basic_variant_base<Tag, Ts...> &variant) noexcept {
+  return variant;
+}
+
+template <typename V>
+using variant_base_of_t = std::remove_reference_t<decltype(as_variant_base(
+    std::declval<std::remove_reference_t<V> &>()))>;
+
+template <typename V, typename = void>
+struct is_variant_base_of : std::false_type {};
+
+template <typename V>
+struct is_variant_base_of<V, std::void_t<variant_base_of_t<V>>>
+    : std::true_type {};
+
+template <typename V> struct variant_base_traits;
+
+/// @brief Number of alternatives and cv-qualified alternative types of a
+/// (possibly const) `variant_base`.
+template <typename Tag, typename... Ts>
+struct variant_base_traits<basic_variant_base<Tag, Ts...>> {
+  constexpr static std::size_t size = sizeof...(Ts);
+
+  template <std::size_t I> using alternative = variant_alternative_t<I, Ts...>;
+};
+
+template <typename Tag, typename... Ts>
+struct variant_base_traits<const basic_variant_base<Tag, Ts...>> {
+  constexpr static std::size_t size = sizeof...(Ts);
+
+  template <std::size_t I>
+  using alternative = const variant_alternative_t<I, Ts...>;
+};
+
+/// @brief Returns the index of the alternative the `K`-th variant holds for
+/// the entry `flat` of a row-major cartesian dispatch table.
+template <std::size_t... Sizes>
+constexpr std::size_t unflatten_index(std::size_t flat, std::size_t k) {
+  constexpr std::size_t sizes[] = {Sizes...};
+  std::size_t stride = 1;
+  for (std::size_t i = sizeof...(Sizes); i-- > k + 1;) {
+    stride *= sizes[i];
+  }
+  return flat / stride % sizes[k];
+}
+
+/// @brief Table holding a `visit` entry for every combination of
+/// alternatives of the cv-qualified `variant_base` types `Vs`.
+///
+/// The table is laid out in row-major order (the last variant's index varies
+/// fastest).
+template <typename Visitor, typename Ks, typename... Vs>
+struct multi_visit_table;
+
+template <typename Visitor, std::size_t... Ks, typename... Vs>
+struct multi_visit_table<Visitor, std::index_sequence<Ks...>, Vs...> {
+  constexpr static std::size_t size = (variant_base_traits<Vs>::size * ...);
+
+  template <std::size_t Flat, std::size_t K, typename V>
+  using alternative_type = typename variant_base_traits<V>::template alternative<
+      unflatten_index<variant_base_traits<Vs>::size...>(Flat, K)>;
+
+  template <std::size_t Flat>
+  constexpr static bool is_nothrow_entry_v =
+      std::is_nothrow_invocable_v<Visitor, alternative_type<Flat, Ks, Vs> &...>;
+
+  template <std::size_t... Flats>
+  constexpr static bool is_nothrow(std::index_sequence<Flats...>) {
+    return (is_nothrow_entry_v<Flats> && ...);
+  }
+
+  constexpr static bool nothrow = is_nothrow(std::make_index_sequence<size>{});
+
+  using result_type =
+      std::invoke_result_t<Visitor, alternative_type<0, Ks, Vs> &...>;
+
+  using function_type = result_type (*)(Visitor &&,
+                                        copy_const_t<Vs, std::byte> *...) noexcept(nothrow);
+
+  template <std::size_t Flat>
+  constexpr static result_type
+  invoke(Visitor &&visitor, copy_const_t<Vs, std::byte> *...data) noexcept(
+      nothrow) {
+    if constexpr (std::is_void_v<result_type>) {
+      std::forward<Visitor>(visitor)(
+          *reinterpret_cast<alternative_type<Flat, Ks, Vs> *>(data)...);
+    } else {
+      return std::forward<Visitor>(visitor)(
+          *reinterpret_cast<alternative_type<Flat, Ks, Vs> *>(data)...);
+    }
+  }
+
+  template <std::size_t... Flats>
+  constexpr static std::array<function_type, size>
+  make_table(std::index_sequence<Flats...>) {
+    return {{&invoke<Flats>...}};
+  }
+
+  constexpr static std::array<function_type, size> value =
+      make_table(std::make_index_sequence<size>{});
+};
+
+} // namespace detail
+
+/// @brief Visits several variants through a single flattened dispatch table,
+/// so a visit costs one index computation and one indirect call no matter how
+/// many variants are involved.
+///
+/// `Vs` are the cv-qualified `variant_base` types.
+template <typename... Vs> struct multi_visitor_type {
+  template <typename Visitor>
+  using table_type =
+      detail::multi_visit_table<Visitor, std::index_sequence_for<Vs...>, Vs...>;
+
+  /// @brief True if `Visitor` can be invoked with every combination of
+  /// alternatives without throwing.
+  template <typename Visitor>
+  constexpr static bool is_nothrow_v = table_type<Visitor>::nothrow;
+
+  template <typename Visitor>
+  constexpr static decltype(auto)
+  visit(Visitor &&visitor, Vs &...variants) noexcept(is_nothrow_v<Visitor>) {
+    return table_type<Visitor>::value[flat_index(variants...)](
+        std::forward<Visitor>(visitor), variants.m_Buff...);
+  }
+
+private:
+  /// @brief Maps the indices of all variants to the table entry.
+  constexpr static std::size_t flat_index(Vs &...variants) {
+    std::size_t flat = 0;
+    ((flat = flat * detail::variant_base_traits<Vs>::size +
+             checked_index(variants)),
+     ...);
+    return flat;
+  }
+
+  template <typename Variant>
+  constexpr static std::size_t checked_index(Variant &variant) {
+    const auto index = static_cast<std::size_t>(variant.m_Index);
+    if (index >= detail::variant_base_traits<Variant>::size) {
+      detail::bad_access<bad_rust_variant_index>("invalid variant index",
+                                                 index);
+    }
+    return index;
+  }
+};
+
+/// @brief Applies the visitor to several variants at once. Corresponds to
+/// the (3) std::visit definition with more than one variant.
+///
+/// The visitor is invoked with (const) lvalue references to the held
+/// alternatives, mirroring the single variant overloads.
+template <typename Visitor, typename First, typename Second,
+          typename... Remainder,
+          typename = std::enable_if_t<std::conjunction_v<
+              detail::is_variant_base_of<First>,
+              detail::is_variant_base_of<Second>,
+              detail::is_variant_base_of<Remainder>...>>>
+constexpr decltype(auto)
+visit(Visitor &&visitor, First &&first, Second &&second,
+      Remainder &&...remainder) noexcept(multi_visitor_type<
+                                         detail::variant_base_of_t<First>,
+                                         detail::variant_base_of_t<Second>,
+                                         detail::variant_base_of_t<
+                                             Remainder>...>::
+                                             template is_nothrow_v<Visitor>) {
+  return multi_visitor_type<detail::variant_base_of_t<First>,
+                            detail::variant_base_of_t<Second>,
+                            detail::variant_base_of_t<Remainder>...>::
+      visit(std::forward<Visitor>(visitor), detail::as_variant_base(first),
+            detail::as_variant_base(second),
+            detail::as_variant_base(remainder)...);
+}
+
+template <std::size_t I, typename Tag, typename... Ts>
+constexpr decltype(auto) get(basic_variant_base<Tag, Ts...> &variant) {
+  variant.template throw_if_invalid<I>();
+  return get_unchecked<I>(variant);
+}
+
+template <std::size_t I, typename Tag, typename... Ts>
+constexpr decltype(auto) get(const basic_variant_base<Tag, Ts...> &variant) {
+  variant.template throw_if_invalid<I>();
+  return get_unchecked<I>(variant);
+}
+
+template <typename T, typename Tag, typename... Ts,
+          typename = std::enable_if_t<
+              exactly_once<std::is_same_v<Ts, std::decay_t<T>>...>::value>>
+constexpr const T &get(const basic_variant_base<Tag, Ts...> &variant) {
+  constexpr auto index = index_from_type<T, Ts...>::value;
+  return get<index>(variant);
+}
+
+template <typename T, typename Tag, typename... Ts,
+          typename = std::enable_if_t<
+              exactly_once<std::is_same_v<Ts, std::decay_t<T>>...>::value>>
+constexpr T &get(basic_variant_base<Tag, Ts...> &variant) {
+  constexpr auto index = index_from_type<T, Ts...>::value;
+  return get<index>(variant);
+}
+
+/// @brief Returns the alternative at index I without checking that the variant
+/// holds it. The behavior is undefined if it doesn't.
+///
+/// In constant expressions the alternative is read from the union, the other
+/// accessors all end up here.
+template <std::size_t I, typename Tag, typename... Ts>
+constexpr variant_alternative_t<I, Ts...> &
+get_unchecked(basic_variant_base<Tag, Ts...> &variant) noexcept {
+#if CXX_ENUMEXT_CONSTEXPR_VARIANT
+  if constexpr (basic_variant_base<Tag, Ts...>::has_alternative_union) {
+    if (std::is_constant_evaluated()) {
+      return detail::union_member<I>(variant.m_Alternatives);
+    }
+  }
+#endif
+  return *reinterpret_cast<variant_alternative_t<I, Ts...> *>(variant.m_Buff);
+}
+
+template <std::size_t I, typename Tag, typename... Ts>
+constexpr const variant_alternative_t<I, Ts...> &
+get_unchecked(const basic_variant_base<Tag, Ts...> &variant) noexcept {
+#if CXX_ENUMEXT_CONSTEXPR_VARIANT
+  if constexpr (basic_variant_base<Tag, Ts...>::has_alternative_union) {
+    if (std::is_constant_evaluated()) {
+      return detail::union_member<I>(variant.m_Alternatives);
+    }
+  }
+#endif
+  return *reinterpret_cast<const variant_alternative_t<I, Ts...> *>(
+      variant.m_Buff);
+}
+
+template <typename T, typename Tag, typename... Ts,
+          typename = std::enable_if_t<
+              exactly_once<std::is_same_v<Ts, std::decay_t<T>>...>::value>>
+constexpr const T &
+get_unchecked(const basic_variant_base<Tag, Ts...> &variant) noexcept {
+  return get_unchecked<index_from_type<T, Ts...>::value>(variant);
+}
+
+template <typename T, typename Tag, typename... Ts,
+          typename = std::enable_if_t<
+              exactly_once<std::is_same_v<Ts, std::decay_t<T>>...>::value>>
+constexpr T &get_unchecked(basic_variant_base<Tag, Ts...> &variant) noexcept {
+  return get_unchecked<index_from_type<T, Ts...>::value>(variant);
+}
+
+template <std::size_t I, typename Tag, typename... Ts>
+constexpr std::add_pointer_t<variant_alternative_t<I, Ts...>>
+get_if(basic_variant_base<Tag, Ts...> *variant) {
+  if (!variant->template is_valid<I>())
+    return nullptr;
+  return detail::address_of(get_unchecked<I>(*variant));
+}
+
+template <std::size_t I, typename Tag, typename... Ts>
+constexpr std::add_pointer_t<const variant_alternative_t<I, Ts...>>
+get_if(const basic_variant_base<Tag, Ts...> *variant) {
+  if (!variant->template is_valid<I>())
+    return nullptr;
+  return detail::address_of(get_unchecked<I>(*variant));
+}
+
+template <typename T, typename Tag, typename... Ts,
+          typename = std::enable_if_t<
+              exactly_once<std::is_same_v<Ts, std::decay_t<T>>...>::value>>
+constexpr std::add_pointer_t<const T>
+get_if(const basic_variant_base<Tag, Ts...> *variant) {
+  constexpr auto index = index_from_type<T, Ts...>::value;
+  return get_if<index>(variant);
+}
+
+template <typename T, typename Tag, typename... Ts,
+          typename = std::enable_if_t<
+              exactly_once<std::is_same_v<Ts, std::decay_t<T>>...>::value>>
+constexpr std::add_pointer_t<T>
+get_if(basic_variant_base<Tag, Ts...> *variant) {
+  constexpr auto index = index_from_type<T, Ts...>::value;
+  return get_if<index>(variant);
+}
+
+template <std::size_t I, typename Tag, typename... Ts>
+constexpr bool
+holds_alternative(const basic_variant_base<Tag, Ts...> &variant) {
+  return variant.index() == I;
+}
+
+template <typename T, typename Tag, typename... Ts,
+          typename = std::enable_if_t<
+              exactly_once<std::is_same_v<Ts, std::decay_t<T>>...>::value>>
+constexpr bool
+holds_alternative(const basic_variant_base<Tag, Ts...> &variant) {
+  return variant.index() == index_from_type<T, Ts...>::value;
+}
+
+template <bool> struct copy_control;
+
+template <> struct copy_control<true> {
+  copy_control() = default;
+  copy_control(const copy_control &other) = default;
+  copy_control(copy_control &&other) = default;
+  copy_control &operator=(const copy_control &) = default;
+  copy_control &operator=(copy_control &&) = default;
+};
+
+template <> struct copy_control<false> {
+  copy_control() = default;
+  copy_control(const copy_control &other) = delete;
+  copy_control(copy_control &&other) = default;
+  copy_control &operator=(const copy_control &) = delete;
+  copy_control &operator=(copy_control &&) = default;
+};
+
+template <typename... Ts>
+using allow_copy =
+    copy_control<std::conjunction_v<std::is_copy_constructible<Ts>...>>;
+
+template <bool> struct move_control;
+
+template <> struct move_control<true> {
+  move_control() = default;
+  move_control(const move_control &other) = default;
+  move_control(move_control &&other) = default;
+  move_control &operator=(const move_control &) = default;
+  move_control &operator=(move_control &&) = default;
+};
+
+template <> struct move_control<false> {
+  move_control() = default;
+  move_control(const move_control &other) = default;
+  move_control(move_control &&other) = delete;
+  move_control &operator=(const move_control &) = default;
+  move_control &operator=(move_control &&) = delete;
+};
+
+template <typename... Ts>
+using allow_move =
+    move_control<std::conjunction_v<std::is_move_constructible<Ts>...>>;
+
+/// @brief A variant with the tag type `Tag`, matching a Rust enum declared
+/// with `#[repr(C, Tag)]`.
+template <typename Tag, typename... Ts>
+struct basic_variant : public basic_variant_base<Tag, Ts...>,
+                       private allow_copy<Ts...>,
+                       private allow_move<Ts...> {
+  using base = basic_variant_base<Tag, Ts...>;
+
+  basic_variant() = delete;
+  basic_variant(const basic_variant &) = default;
+  basic_variant(basic_variant &&) = default;
+
+  using base::base;
+
+  basic_variant &operator=(const basic_variant &) = default;
+  basic_variant &operator=(basic_variant &&) = default;
+
+  using base::operator=;
+};
+
+/// @brief The variant of a `#[repr(C)]` Rust enum.
+template <typename... Ts> using variant = basic_variant<int, Ts...>;
+
+/// An empty type used for unit variants from Rust.
+struct monostate {};
+
+/// @brief Constructs the alternative `T` of `V` from `args` right in the
+/// uninitialized storage `out` and returns the new value. Meant for storage
+/// owned by Rust, e.g. a `MaybeUninit<V>` or the spare capacity of a `Vec<V>`
+/// passed as `*mut V` (see `cxx_enumext::Emplace`), which then holds the
+/// value without it being built on the C++ stack and copied over.
+///
+/// `V` is any enum, optional or expected, `TUPLE` and `STRUCT` alternatives
+/// are initialized from their fields. `out` must not hold a value, it would
+/// be overwritten without being destroyed. If the construction throws `out`
+/// stays uninitialized.
+template <typename T, typename V, typename... Args>
+V &emplace_into(V *out, Args &&...args) noexcept(
+    std::is_nothrow_constructible_v<V, std::in_place_type_t<T>, Args...>) {
+  return *::new (static_cast<void *>(out))
+      V(std::in_place_type<T>, std::forward<Args>(args)...);
+}
+
+/// @brief Like `emplace_into` but picks the alternative by its index, e.g.
+/// if several alternatives have the same type.
+template <std::size_t I, typename V, typename... Args>
+V &emplace_into(V *out, Args &&...args) noexcept(
+    std::is_nothrow_constructible_v<V, std::in_place_index_t<I>, Args...>) {
+  return *::new (static_cast<void *>(out))
+      V(std::in_place_index<I>, std::forward<Args>(args)...);
+}
+
+/// @brief True if two values of `T` are equal exactly if their bytes are:
+/// integers, `bool`, enums, `nonzero` and `TUPLE` alternatives of such
+/// without padding. Further types opt in with a member
+/// `using IsTriviallyComparable = std::true_type;`.
+template <typename T, typename = void>
+struct is_trivially_comparable
+    : std::bool_constant<std::is_integral_v<T> || std::is_enum_v<T>> {};
+
+template <typename T>
+struct is_trivially_comparable<T,
+                               std::void_t<typename T::IsTriviallyComparable>>
+    : std::bool_constant<T::IsTriviallyComparable::value &&
+                         std::has_unique_object_representations_v<T>> {};
+
+template <typename T>
+constexpr bool is_trivially_comparable_v = is_trivially_comparable<T>::value;
+
+/// @brief Mirrors Rust's `NonZero` integers (e.g. `NonZeroU32`). Holding
+/// zero is undefined behavior.
+template <typename T> struct nonzero {
+  static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>,
+                "nonzero requires an integer type");
+
+  constexpr explicit nonzero(T value) noexcept : m_Value(value) {}
+
+  constexpr T get() const noexcept { return m_Value; }
+
+  friend constexpr bool operator==(nonzero lhs, nonzero rhs) noexcept {
+    return lhs.m_Value == rhs.m_Value;
+  }
+  friend constexpr bool operator!=(nonzero lhs, nonzero rhs) noexcept {
+    return lhs.m_Value != rhs.m_Value;
+  }
+  friend constexpr bool operator<(nonzero lhs, nonzero rhs) noexcept {
+    return lhs.m_Value < rhs.m_Value;
+  }
+  friend constexpr bool operator>(nonzero lhs, nonzero rhs) noexcept {
+    return lhs.m_Value > rhs.m_Value;
+  }
+  friend constexpr bool operator<=(nonzero lhs, nonzero rhs) noexcept {
+    return lhs.m_Value <= rhs.m_Value;
+  }
+  friend constexpr bool operator>=(nonzero lhs, nonzero rhs) noexcept {
+    return lhs.m_Value >= rhs.m_Value;
+  }
+
+private:
+  T m_Value;
+};
+
+template <typename T>
+struct is_trivially_comparable<nonzero<T>> : std::true_type {};
+
+/// @brief True if hashing the bytes of `T` at once hashes the same as its
+/// Rust counterpart: integers, `bool`, enums and `nonzero`. `TUPLE`
+/// alternatives of such without padding do the same in their
+/// `hash_append`.
+template <typename T>
+struct is_contiguously_hashable
+    : std::bool_constant<std::is_integral_v<T> || std::is_enum_v<T>> {};
+
+template <typename T>
+struct is_contiguously_hashable<nonzero<T>> : std::true_type {};
+
+template <typename T>
+constexpr bool is_contiguously_hashable_v = is_contiguously_hashable<T>::value;
+
+} // namespace enm
+} // namespace rust
+
+#endif
@@ -0,0 +1,488 @@
+/*
+ * Copyright (c) Rachel Powers.
+ *
+ * This source code is licensed under both the MIT license found in the
+ * LICENSE-MIT file in the root directory of this source tree and the Apache
+ * License, Version 2.0 found in the LICENSE-APACHE file in the root directory
+ * of this source tree.
+ */
+
+// cxx_enumext/include/rust/cxx_enumext_expected.h
+
+
+// This file incorporates work submitted as a pull request
+// to the cxx github repository (https://github.com/dtolnay/cxx/pull/1328)
+// and is covered by the following copyright and permission notice:
+//
+//  Copyright 2024 Dima Dorezyuk
+//
+//  Licensed under either of Apache License [1], Version 2.0 or MIT license [2]
+//  at your option.
+//
+//  [1] https://github.com/dtolnay/cxx/blob/master/LICENSE-APACHE
+//  [2] https://github.com/dtolnay/cxx/blob/master/LICENSE-MIT
+//
+
+// The binding of Rust's `Result<T, E>`: `expected`, a `std::expected` like
+// tagged union.
+
+#ifndef RUST_CXX_ENUMEXT_EXPECTED_H
+#define RUST_CXX_ENUMEXT_EXPECTED_H
+
+#include "cxx_enumext_core.h"
+
+#include <exception>
+#include <functional>
+
+// =================================================
+//
+// std::expected like binding for Rust Result<T, E>
+//
+// =================================================
+
+namespace rust {
+namespace enm {
+
+template <typename T, typename E> struct expected;
+
+namespace detail {
+template <typename T> struct is_rust_expected_impl : std::false_type {};
+template <typename T, typename E>
+struct is_rust_expected_impl<expected<T, E>> : std::true_type {};
+template <typename T>
+using is_rust_expected = is_rust_expected_impl<std::decay_t<T>>;
+} // namespace detail
+
+template <typename E> struct bad_rust_expected_access;
+
+/// @brief The base of every bad_rust_expected_access, to catch them whatever
+/// their unexpected value. Doesn't allocate.
+template <> struct bad_rust_expected_access<void> : std::exception {
+  const char *what() const noexcept override {
+    return "Expected is the unexpected value";
+  }
+};
+
+/// @brief Thrown by `value()` of an expected holding an unexpected value. The
+/// value is copied into the exception, or moved if `value()` was called on an
+/// rvalue, and can be moved out again with `std::move(e).error()`.
+template <typename E>
+struct bad_rust_expected_access : bad_rust_expected_access<void> {
+  explicit bad_rust_expected_access(const E &error) : m_Error(error) {}
+  explicit bad_rust_expected_access(E &&error) noexcept(
+      std::is_nothrow_move_constructible_v<E>)
+      : m_Error(std::move(error)) {}
+
+  E &error() & noexcept { return m_Error; }
+  const E &error() const & noexcept { return m_Error; }
+  E &&error() && noexcept { return std::move(m_Error); }
+  const E &&error() const && noexcept { return std::move(m_Error); }
+
+private:
+  E m_Error;
+};
+
+template <typename T, typename E> struct expected : public variant<T, E> {
+  using base = variant<T, E>;
+
+  expected() = delete;
+
+  expected(const expected &) = default;
+  expected(expected &&) = default;
+
+  expected &operator=(const expected &) = default;
+  expected &operator=(expected &&) = default;
+
+  using base::base;
+  using base::operator=;
+
+  using Ok = T;
+  using Err = E;
+
+  constexpr explicit operator bool() { return this->m_Index == 0; }
+  constexpr bool has_value() const noexcept { return this->m_Index == 0; }
+
+  /// @brief returns the expected value
+  ///
+  /// @throws bad_rust_expected_access<E> with a copy of the unexpected value
+  constexpr T &value() & {
+    if (has_value()) {
+      return get_unchecked<0>(*this);
+    } else {
+      detail::bad_access<bad_rust_expected_access<E>>(
+          "Expected is the unexpected value", error());
+    }
+  }
+
+  /// @brief returns the expected value
+  ///
+  /// @throws bad_rust_expected_access<E> with a copy of the unexpected value
+  constexpr const T &value() const & {
+    if (has_value()) {
+      return get_unchecked<0>(*this);
+    } else {
+      detail::bad_access<bad_rust_expected_access<E>>(
+          "Expected is the unexpected value", error());
+    }
+  }
+
+  /// @brief returns the expected value, moved out of `*this`
+  ///
+  /// @throws bad_rust_expected_access<E> with the unexpected value moved into
+  /// it
+  constexpr T &&value() && {
+    if (!has_value()) {
+      detail::bad_access<bad_rust_expected_access<E>>(
+          "Expected is the unexpected value", std::move(error()));
+    }
+    return std::move(**this);
+  }
+
+  /// @brief returns the unexpected value
+  ///
+  /// if has_value() is `true`, the behavior is undefined
+  constexpr E &error() & { return get_unchecked<1>(*this); }
+
+  /// @brief returns the unexpected value
+  ///
+  /// if has_value() is `true`, the behavior is undefined
+  constexpr const E &error() const & {
+    return get_unchecked<1>(*this);
+  }
+
+  /// @brief returns the unexpected value as an rvalue
+  ///
+  /// if has_value() is `true`, the behavior is undefined
+  constexpr E &&error() && {
+    return std::move(get_unchecked<1>(*this));
+  }
+
+  /// @brief Accesses the contained value without checking that it exists.
+  /// The behavior is undefined if it doesn't.
+  constexpr const T *operator->() const noexcept {
+    return detail::address_of(get_unchecked<0>(*this));
+  }
+  constexpr T *operator->() noexcept {
+    return detail::address_of(get_unchecked<0>(*this));
+  }
+  constexpr const T &operator*() const & noexcept {
+    return get_unchecked<0>(*this);
+  }
+  constexpr T &operator*() & noexcept {
+    return get_unchecked<0>(*this);
+  }
+  constexpr T &&operator*() && noexcept {
+    return std::move(get_unchecked<0>(*this));
+  }
+
+  /// @brief Returns the expected value if it exists, otherwise returns
+  /// `default_value`
+  template <class U = std::remove_cv_t<T>>
+  constexpr T value_or(U &&default_value) const & {
+    return has_value() ? get_unchecked<0>(*this)
+                       : static_cast<T>(std::forward<U>(default_value));
+  }
+
+  /// @brief Like the `const &` overload but moves the expected value out
+  template <class U = std::remove_cv_t<T>>
+  constexpr T value_or(U &&default_value) && {
+    return has_value() ? std::move(**this)
+                       : static_cast<T>(std::forward<U>(default_value));
+  }
+
+  /// @brief Returns the unexpected value if it exists, otherwise returns
+  /// `default_value`
+  template <class G = E> constexpr E error_or(G &&default_value) const & {
+    return has_value() ? std::forward<G>(default_value) : error();
+  }
+
+  /// @brief Like the `const &` overload but moves the unexpected value out
+  template <class G = E> constexpr E error_or(G &&default_value) && {
+    return has_value() ? static_cast<E>(std::forward<G>(default_value))
+                       : std::move(error());
+  }
+
+  template <class F> constexpr auto and_then(F &&f) & {
+    using result = std::invoke_result_t<F, T &>;
+    static_assert(detail::is_rust_expected<result>::value,
+                  "F must return a rust::variant::expected");
+    return (has_value()) ? std::invoke(std::forward<F>(f), value())
+                         : result(error());
+  }
+
+  template <class F> constexpr auto and_then(F &&f) const & {
+    using result = std::invoke_result_t<F, const T &>;
+    static_assert(detail::is_rust_expected<result>::value,
+                  "F must return a rust::variant::expected");
+    return (has_value()) ? std::invoke(std::forward<F>(f), value())
+                         : result(error());
+  }
+
+  /// @brief Passes the expected value to `f` as an rvalue, or moves the
+  /// unexpected value into the result
+  template <class F> constexpr auto and_then(F &&f) && {
+    using result = std::invoke_result_t<F, T &&>;
+    static_assert(detail::is_rust_expected<result>::value,
+                  "F must return a rust::variant::expected");
+    return (has_value()) ? std::invoke(std::forward<F>(f), std::move(**this))
+                         : result(std::in_place_index<1>, std::move(error()));
+  }
+
+  template <class F> constexpr auto transform(F &&f) & {
+    using result = expected<std::remove_cv_t<std::invoke_result_t<F, T &>>, E>;
+    return has_value() ? std::invoke(std::forward<F>(f), value())
+                       : result(error());
+  }
+
+  template <class F> constexpr auto transform(F &&f) const & {
+    using result =
+        expected<std::remove_cv_t<std::invoke_result_t<F, const T &>>, E>;
+    return has_value() ? std::invoke(std::forward<F>(f), value())
+                       : result(error());
+  }
+
+  /// @brief Passes the expected value to `f` as an rvalue, or moves the
+  /// unexpected value into the result
+  template <class F> constexpr auto transform(F &&f) && {
+    using result = expected<std::remove_cv_t<std::invoke_result_t<F, T &&>>, E>;
+    return has_value()
+               ? result(std::in_place_index<0>,
+                        std::invoke(std::forward<F>(f), std::move(**this)))
+               : result(std::in_place_index<1>, std::move(error()));
+  }
+
+  /// @brief Returns a copy of the expected value if it exists, otherwise the
+  /// result of `f` on the unexpected value
+  template <class F> constexpr auto or_else(F &&f) & {
+    using result = std::invoke_result_t<F, E &>;
+    static_assert(detail::is_rust_expected<result>::value,
+                  "F must return a rust::variant::expected");
+    return has_value() ? result(std::in_place_index<0>, **this)
+                       : std::invoke(std::forward<F>(f), error());
+  }
+
+  template <class F> constexpr auto or_else(F &&f) const & {
+    using result = std::invoke_result_t<F, const E &>;
+    static_assert(detail::is_rust_expected<result>::value,
+                  "F must return a rust::variant::expected");
+    return has_value() ? result(std::in_place_index<0>, **this)
+                       : std::invoke(std::forward<F>(f), error());
+  }
+
+  /// @brief Moves the expected value into the result, or passes the
+  /// unexpected value to `f` as an rvalue
+  template <class F> constexpr auto or_else(F &&f) && {
+    using result = std::invoke_result_t<F, E &&>;
+    static_assert(detail::is_rust_expected<result>::value,
+                  "F must return a rust::variant::expected");
+    return has_value() ? result(std::in_place_index<0>, std::move(**this))
+                       : std::invoke(std::forward<F>(f), std::move(error()));
+  }
+
+  /// @brief Returns an expected holding a copy of the expected value, or the
+  /// result of `f` on the unexpected value
+  template <class F> constexpr auto transform_error(F &&f) & {
+    using result = expected<T, std::remove_cv_t<std::invoke_result_t<F, E &>>>;
+    return has_value() ? result(std::in_place_index<0>, **this)
+                       : result(std::in_place_index<1>,
+                                std::invoke(std::forward<F>(f), error()));
+  }
+
+  template <class F> constexpr auto transform_error(F &&f) const & {
+    using result =
+        expected<T, std::remove_cv_t<std::invoke_result_t<F, const E &>>>;
+    return has_value() ? result(std::in_place_index<0>, **this)
+                       : result(std::in_place_index<1>,
+                                std::invoke(std::forward<F>(f), error()));
+  }
+
+  /// @brief Moves the expected value into the result, or passes the
+  /// unexpected value to `f` as an rvalue
+  template <class F> constexpr auto transform_error(F &&f) && {
+    using result = expected<T, std::remove_cv_t<std::invoke_result_t<F, E &&>>>;
+    return has_value()
+               ? result(std::in_place_index<0>, std::move(**this))
+               : result(std::in_place_index<1>,
+                        std::invoke(std::forward<F>(f), std::move(error())));
+  }
+
+  using IsRelocatable = ::std::true_type;
+};
+
+template <typename E> struct expected<void, E> : public variant<monostate, E> {
+  using base = variant<monostate, E>;
+
+  expected() : base(monostate{}) {};
+  expected(const expected &) = default;
+  expected(expected &&) = default;
+
+  expected &operator=(const expected &) = default;
+  expected &operator=(expected &&) = default;
+
+  using base::base;
+  using base::operator=;
+
+  using Ok = monostate;
+  using Err = E;
+
+  constexpr explicit operator bool() { return this->m_Index == 0; }
+  constexpr bool has_value() const noexcept { return this->m_Index == 0; }
+
+  /// @brief returns the expected value
+  ///
+  /// @throws bad_rust_expected_access<E> with a copy of the unexpected value
+  constexpr void value() & {
+    if (has_value()) {
+      return;
+    } else {
+      detail::bad_access<bad_rust_expected_access<E>>(
+          "Expected is the unexpected value", error());
+    }
+  }
+
+  /// @brief Checks that there is no unexpected value
+  ///
+  /// @throws bad_rust_expected_access<E> with the unexpected value moved into
+  /// it
+  constexpr void value() && {
+    if (!has_value()) {
+      detail::bad_access<bad_rust_expected_access<E>>(
+          "Expected is the unexpected value", std::move(error()));
+    }
+  }
+
+  /// @brief returns the unexpected value
+  ///
+  /// if has_value() is `true`, the behavior is undefined
+  constexpr E &error() & { return get_unchecked<1>(*this); }
+
+  /// @brief returns the unexpected value
+  ///
+  /// if has_value() is `true`, the behavior is undefined
+  constexpr const E &error() const & {
+    return get_unchecked<1>(*this);
+  }
+
+  /// @brief returns the unexpected value as an rvalue
+  ///
+  /// if has_value() is `true`, the behavior is undefined
+  constexpr E &&error() && {
+    return std::move(get_unchecked<1>(*this));
+  }
+
+  constexpr void operator*() const noexcept {}
+
+  /// @brief Returns the unexpected value if it exists, otherwise returns
+  /// `default_value`
+  template <class G = E> constexpr E error_or(G &&default_value) const & {
+    return has_value() ? std::forward<G>(default_value) : error();
+  }
+
+  /// @brief Like the `const &` overload but moves the unexpected value out
+  template <class G = E> constexpr E error_or(G &&default_value) && {
+    return has_value() ? static_cast<E>(std::forward<G>(default_value))
+                       : std::move(error());
+  }
+
+  template <class F> constexpr auto and_then(F &&f) & {
+    using result = std::invoke_result_t<F>;
+    static_assert(detail::is_rust_expected<result>::value,
+                  "F must return a rust::variant::expected");
+    return (has_value()) ? std::invoke(std::forward<F>(f)) : result(error());
+  }
+
+  template <class F> constexpr auto and_then(F &&f) const & {
+    using result = std::invoke_result_t<F>;
+    static_assert(detail::is_rust_expected<result>::value,
+                  "F must return a rust::variant::expected");
+    return (has_value()) ? std::invoke(std::forward<F>(f)) : result(error());
+  }
+
+  /// @brief Moves the unexpected value into the result if there is one
+  template <class F> constexpr auto and_then(F &&f) && {
+    using result = std::invoke_result_t<F>;
+    static_assert(detail::is_rust_expected<result>::value,
+                  "F must return a rust::variant::expected");
+    return (has_value())
+               ? std::invoke(std::forward<F>(f))
+               : result(std::in_place_index<1>, std::move(error()));
+  }
+
+  template <class F> constexpr auto transform(F &&f) & {
+    using result = expected<std::remove_cv_t<std::invoke_result_t<F>>, E>;
+    return has_value() ? std::invoke(std::forward<F>(f)) : result(error());
+  }
+
+  template <class F> constexpr auto transform(F &&f) const & {
+    using result = expected<std::remove_cv_t<std::invoke_result_t<F>>, E>;
+    return has_value() ? std::invoke(std::forward<F>(f)) : result(error());
+  }
+
+  /// @brief Moves the unexpected value into the result if there is one
+  template <class F> constexpr auto transform(F &&f) && {
+    using result = expected<std::remove_cv_t<std::invoke_result_t<F>>, E>;
+    return has_value()
+               ? result(std::in_place_index<0>, std::invoke(std::forward<F>(f)))
+               : result(std::in_place_index<1>, std::move(error()));
+  }
+
+  /// @brief Returns an empty expected if there is no unexpected value,
+  /// otherwise the result of `f` on it
+  template <class F> constexpr auto or_else(F &&f) & {
+    using result = std::invoke_result_t<F, E &>;
+    static_assert(detail::is_rust_expected<result>::value,
+                  "F must return a rust::variant::expected");
+    return has_value() ? result() : std::invoke(std::forward<F>(f), error());
+  }
+
+  template <class F> constexpr auto or_else(F &&f) const & {
+    using result = std::invoke_result_t<F, const E &>;
+    static_assert(detail::is_rust_expected<result>::value,
+                  "F must return a rust::variant::expected");
+    return has_value() ? result() : std::invoke(std::forward<F>(f), error());
+  }
+
+  /// @brief Passes the unexpected value to `f` as an rvalue
+  template <class F> constexpr auto or_else(F &&f) && {
+    using result = std::invoke_result_t<F, E &&>;
+    static_assert(detail::is_rust_expected<result>::value,
+                  "F must return a rust::variant::expected");
+    return has_value() ? result()
+                       : std::invoke(std::forward<F>(f), std::move(error()));
+  }
+
+  /// @brief Returns an empty expected if there is no unexpected value,
+  /// otherwise one holding the result of `f` on it
+  template <class F> constexpr auto transform_error(F &&f) & {
+    using result =
+        expected<void, std::remove_cv_t<std::invoke_result_t<F, E &>>>;
+    return has_value() ? result()
+                       : result(std::in_place_index<1>,
+                                std::invoke(std::forward<F>(f), error()));
+  }
+
+  template <class F> constexpr auto transform_error(F &&f) const & {
+    using result =
+        expected<void, std::remove_cv_t<std::invoke_result_t<F, const E &>>>;
+    return has_value() ? result()
+                       : result(std::in_place_index<1>,
+                                std::invoke(std::forward<F>(f), error()));
+  }
+
+  /// @brief Passes the unexpected value to `f` as an rvalue
+  template <class F> constexpr auto transform_error(F &&f) && {
+    using result =
+        expected<void, std::remove_cv_t<std::invoke_result_t<F, E &&>>>;
+    return has_value()
+               ? result()
+               : result(std::in_place_index<1>,
+                        std::invoke(std::forward<F>(f), std::move(error())));
+  }
+
+  using IsRelocatable = ::std::true_type;
+};
+
+} // namespace enm
+} // namespace rust
+
+#endif
@@ -0,0 +1,524 @@
+/*
+ * Copyright (c) Rachel Powers.
+ *
+ * This source code is licensed under both the MIT license found in the
+ * LICENSE-MIT file in the root directory of this source tree and the Apache
+ * License, Version 2.0 found in the LICENSE-APACHE file in the root directory
+ * of this source tree.
+ */
+
+// cxx_enumext/include/rust/cxx_enumext_flat.h
+
+// A flat file format for sequences of variants whose alternatives are all
+// trivially copyable. The elements are stored exactly as they are laid out
+// in memory, so a reader maps the file and uses the elements in place.
+//
+// Layout (all integers in the byte order of the writer):
+//
+//   flat_header                  64 bytes
+//   flat_alternative[n]          8 bytes per alternative
+//   zero padding                 up to `data_offset`, a multiple of 64
+//   elements[count]              `element_size` bytes each
+//   zero padding                 up to `index_offset`, a multiple of 8
+//   flat_run[run_count]          the optional run-length index of the tags
+
+#ifndef RUST_CXX_ENUMEXT_FLAT_H
+#define RUST_CXX_ENUMEXT_FLAT_H
+
+#include "cxx_enumext_core.h"
+#include "cxx_enumext_ranges.h"
+
+#include <cstdio>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CXX_ENUMEXT_HAS_MMAP 1
+#else
+#define CXX_ENUMEXT_HAS_MMAP 0
+#endif
+
+namespace rust {
+namespace enm {
+
+constexpr std::uint16_t flat_format_version = 1;
+
+/// @brief The first bytes of every flat file.
+struct flat_header {
+  char magic[8];
+  /// @brief `0x01020304` in the byte order of the writer.
+  std::uint32_t byte_order;
+  std::uint16_t version;
+  std::uint16_t header_size;
+  std::uint16_t tag_size;
+  std::uint16_t alternative_count;
+  std::uint32_t alignment;
+  std::uint64_t element_size;
+  std::uint64_t count;
+  std::uint64_t data_offset;
+  /// @brief Zero if the file has no run index.
+  std::uint64_t index_offset;
+  std::uint64_t run_count;
+};
+
+static_assert(sizeof(flat_header) == 64, "The header has a fixed size");
+
+/// @brief The size and alignment of an alternative, following the header.
+struct flat_alternative {
+  std::uint32_t size;
+  std::uint32_t alignment;
+};
+
+/// @brief `size` consecutive elements starting at `start` holding the
+/// alternative `index`.
+struct flat_run {
+  std::uint64_t start;
+  std::uint64_t size;
+  std::uint64_t index;
+};
+
+enum class flat_error : std::uint8_t {
+  none,
+  /// @brief The file could not be opened or mapped.
+  io,
+  /// @brief The file ends before the header, the elements or the index.
+  truncated,
+  /// @brief The file is not a flat file.
+  magic,
+  /// @brief The file was written by an unknown version of the format.
+  version,
+  /// @brief The file was written on a machine of the other byte order.
+  byte_order,
+  /// @brief The tag, the alternatives or the elements have different sizes
+  /// or alignments than the variant read.
+  layout,
+  /// @brief The elements are not aligned for the variant in memory.
+  misaligned,
+  /// @brief The runs do not cover the elements in order.
+  index,
+};
+
+inline const char *to_string(flat_error error) noexcept {
+  switch (error) {
+  case flat_error::none:
+    return "no error";
+  case flat_error::io:
+    return "the file could not be read";
+  case flat_error::truncated:
+    return "the file is truncated";
+  case flat_error::magic:
+    return "not a flat file";
+  case flat_error::version:
+    return "unsupported format version";
+  case flat_error::byte_order:
+    return "written with a different byte order";
+  case flat_error::layout:
+    return "the layout of the variant does not match";
+  case flat_error::misaligned:
+    return "the elements are misaligned";
+  case flat_error::index:
+    return "the run index is corrupted";
+  }
+  return "unknown error";
+}
+
+namespace detail {
+
+constexpr char flat_magic[8] = {'C', 'X', 'X', 'E', 'N', 'U', 'M', 'F'};
+constexpr std::uint32_t flat_byte_order = 0x01020304;
+
+constexpr std::uint64_t round_up(std::uint64_t value,
+                                 std::uint64_t alignment) noexcept {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+/// @brief The layout recorded for `Variant` and checked when reading.
+template <typename Variant,
+          typename Base = std::remove_const_t<variant_base_of_t<Variant>>>
+struct flat_layout;
+
+template <typename Variant, typename Tag, typename... Ts>
+struct flat_layout<Variant, basic_variant_base<Tag, Ts...>> {
+  constexpr static bool serializable =
+      std::is_trivially_copyable_v<Variant> &&
+      (std::is_trivially_copyable_v<Ts> && ...);
+
+  constexpr static std::size_t count = sizeof...(Ts);
+
+  constexpr static flat_alternative alternatives[] = {
+      {static_cast<std::uint32_t>(sizeof(Ts)),
+       static_cast<std::uint32_t>(alignof(Ts))}...};
+
+  /// @brief The bytes copied for each alternative. Empty alternatives (Rust
+  /// unit variants) have no value, their padding byte is left zero.
+  constexpr static std::size_t value_sizes[] = {
+      (std::is_empty_v<Ts> ? 0 : sizeof(Ts))...};
+
+  /// @brief The offset of the alternative, just like in the Rust enum.
+  constexpr static std::size_t value_offset =
+      round_up(sizeof(Tag), std::max({alignof(Ts)...}));
+
+  constexpr static std::uint64_t data_offset =
+      round_up(sizeof(flat_header) + sizeof(alternatives), 64);
+
+  /// @brief Copies the element, zeroing the bytes after the active
+  /// alternative so the file does not depend on stale memory.
+  static void copy_clean(std::byte *out, const Variant &value) {
+    const std::size_t index = value.index();
+    if (index >= count) {
+      bad_access<bad_rust_variant_index>("invalid variant index", index);
+    }
+    const auto *bytes = reinterpret_cast<const std::byte *>(&value);
+    std::memset(out, 0, sizeof(Variant));
+    std::memcpy(out, bytes, sizeof(Tag));
+    std::memcpy(out + value_offset, bytes + value_offset,
+                value_sizes[index]);
+  }
+
+  static flat_header header(std::uint64_t size, std::uint64_t run_count) {
+    flat_header header{};
+    std::memcpy(header.magic, flat_magic, sizeof(flat_magic));
+    header.byte_order = flat_byte_order;
+    header.version = flat_format_version;
+    header.header_size = sizeof(flat_header);
+    header.tag_size = sizeof(Tag);
+    header.alternative_count = static_cast<std::uint16_t>(count);
+    header.alignment = alignof(Variant);
+    header.element_size = sizeof(Variant);
+    header.count = size;
+    header.data_offset = data_offset;
+    header.index_offset =
+        run_count == 0 ? 0 : round_up(data_offset + size * sizeof(Variant), 8);
+    header.run_count = run_count;
+    return header;
+  }
+
+  static flat_error check(const std::byte *data, std::size_t size) {
+    if (size < sizeof(flat_header)) {
+      return flat_error::truncated;
+    }
+    flat_header header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, flat_magic, sizeof(flat_magic)) != 0) {
+      return flat_error::magic;
+    }
+    if (header.byte_order != flat_byte_order) {
+      return header.byte_order == 0x04030201 ? flat_error::byte_order
+                                              : flat_error::magic;
+    }
+    if (header.version != flat_format_version) {
+      return flat_error::version;
+    }
+    if (header.header_size != sizeof(flat_header) ||
+        header.tag_size != sizeof(Tag) || header.alternative_count != count ||
+        header.alignment != alignof(Variant) ||
+        header.element_size != sizeof(Variant)) {
+      return flat_error::layout;
+    }
+    if (size < sizeof(flat_header) + sizeof(alternatives)) {
+      return flat_error::truncated;
+    }
+    if (std::memcmp(data + sizeof(flat_header), alternatives,
+                    sizeof(alternatives)) != 0) {
+      return flat_error::layout;
+    }
+    if (header.data_offset % alignof(Variant) != 0 ||
+        header.data_offset < sizeof(flat_header) + sizeof(alternatives)) {
+      return flat_error::layout;
+    }
+    if (header.data_offset > size ||
+        header.count > (size - header.data_offset) / sizeof(Variant)) {
+      return flat_error::truncated;
+    }
+    if (reinterpret_cast<std::uintptr_t>(data + header.data_offset) %
+            alignof(Variant) !=
+        0) {
+      return flat_error::misaligned;
+    }
+    if (header.index_offset == 0) {
+      return header.run_count == 0 ? flat_error::none : flat_error::index;
+    }
+    const std::uint64_t data_end =
+        header.data_offset + header.count * sizeof(Variant);
+    if (header.index_offset % alignof(flat_run) != 0 ||
+        header.index_offset < data_end) {
+      return flat_error::index;
+    }
+    if (header.index_offset > size ||
+        header.run_count >
+            (size - header.index_offset) / sizeof(flat_run)) {
+      return flat_error::truncated;
+    }
+    return check_runs(
+        reinterpret_cast<const flat_run *>(data + header.index_offset),
+        header.run_count, header.count);
+  }
+
+  /// @brief The runs have to be non-empty, follow each other without gaps
+  /// and cover all elements. The tags themselves are not read.
+  static flat_error check_runs(const flat_run *runs, std::uint64_t run_count,
+                               std::uint64_t size) {
+    std::uint64_t next = 0;
+    for (std::uint64_t i = 0; i < run_count; ++i) {
+      if (runs[i].start != next || runs[i].size == 0 ||
+          runs[i].size > size - next || runs[i].index >= count) {
+        return flat_error::index;
+      }
+      next += runs[i].size;
+    }
+    return next == size ? flat_error::none : flat_error::index;
+  }
+};
+
+} // namespace detail
+
+/// @brief True if `Variant` can be written to and read from flat files: all
+/// alternatives are trivially copyable.
+template <typename Variant>
+constexpr bool is_flat_serializable_v =
+    detail::flat_layout<Variant>::serializable;
+
+/// @brief Computes the runs of consecutive elements holding the same
+/// alternative.
+template <typename Values>
+std::vector<flat_run> tag_runs(const Values &values) {
+  std::vector<flat_run> runs;
+  const auto *data = std::data(values);
+  const std::size_t size = std::size(values);
+  for (std::size_t i = 0; i < size; ++i) {
+    const std::uint64_t index = data[i].index();
+    if (runs.empty() || runs.back().index != index) {
+      runs.push_back(flat_run{i, 0, index});
+    }
+    ++runs.back().size;
+  }
+  return runs;
+}
+
+/// @brief Writes `values` as a flat file by calling `sink(const void *data,
+/// std::size_t size)` with consecutive pieces of it. Writes the run index
+/// of the tags if `run_index` is set.
+template <typename Values, typename Sink>
+void write_flat(const Values &values, Sink &&sink, bool run_index = false) {
+  using element = detail::range_element_t<Values>;
+  using layout = detail::flat_layout<element>;
+  static_assert(layout::serializable,
+                "Only variants of trivially copyable alternatives are flat");
+
+  const auto *data = std::data(values);
+  const std::size_t size = std::size(values);
+  const std::vector<flat_run> runs =
+      run_index ? tag_runs(values) : std::vector<flat_run>{};
+  const flat_header header = layout::header(size, runs.size());
+
+  const std::byte zeros[64] = {};
+  sink(static_cast<const void *>(&header), sizeof(header));
+  sink(static_cast<const void *>(layout::alternatives),
+       sizeof(layout::alternatives));
+  sink(static_cast<const void *>(zeros),
+       static_cast<std::size_t>(header.data_offset - sizeof(header) -
+                                sizeof(layout::alternatives)));
+
+  // Copies the elements in chunks, cleaning the bytes of every element.
+  constexpr std::size_t chunk =
+      std::max<std::size_t>(1, 65536 / sizeof(element));
+  std::vector<std::byte> buffer(std::min(size, chunk) * sizeof(element));
+  for (std::size_t first = 0; first < size; first += chunk) {
+    const std::size_t count = std::min(chunk, size - first);
+    for (std::size_t i = 0; i < count; ++i) {
+      layout::copy_clean(buffer.data() + i * sizeof(element), data[first + i]);
+    }
+    sink(static_cast<const void *>(buffer.data()), count * sizeof(element));
+  }
+
+  if (!runs.empty()) {
+    const std::uint64_t data_end = header.data_offset + size * sizeof(element);
+    sink(static_cast<const void *>(zeros),
+         static_cast<std::size_t>(header.index_offset - data_end));
+    sink(static_cast<const void *>(runs.data()),
+         runs.size() * sizeof(flat_run));
+  }
+}
+
+/// @brief Writes `values` as a flat file into a byte buffer.
+template <typename Values>
+std::vector<std::byte> to_flat(const Values &values, bool run_index = false) {
+  std::vector<std::byte> bytes;
+  write_flat(
+      values,
+      [&bytes](const void *data, std::size_t size) {
+        const auto *begin = static_cast<const std::byte *>(data);
+        bytes.insert(bytes.end(), begin, begin + size);
+      },
+      run_index);
+  return bytes;
+}
+
+/// @brief Writes `values` as a flat file to `path`. Returns false if the
+/// file could not be written.
+template <typename Values>
+bool write_flat_file(const char *path, const Values &values,
+                     bool run_index = false) {
+  std::FILE *file = std::fopen(path, "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  bool ok = true;
+  write_flat(
+      values,
+      [file, &ok](const void *data, std::size_t size) {
+        ok = ok && std::fwrite(data, 1, size, file) == size;
+      },
+      run_index);
+  return std::fclose(file) == 0 && ok;
+}
+
+/// @brief The elements of a flat file in memory, used in place. The layout
+/// is checked on construction and the view is empty if it does not match.
+///
+/// The tags of the elements are not checked, call `has_valid_tags` on
+/// `values()` before trusting files from elsewhere.
+template <typename Variant> class flat_view {
+public:
+  static_assert(is_flat_serializable_v<Variant>,
+                "Only variants of trivially copyable alternatives are flat");
+
+  flat_view() noexcept = default;
+
+  /// @brief `data` has to stay alive as long as the view and has to be
+  /// aligned for `Variant` at the start of the elements, e.g. by being
+  /// aligned to 64 bytes.
+  flat_view(const void *data, std::size_t size) noexcept {
+    const auto *bytes = static_cast<const std::byte *>(data);
+    m_Error = detail::flat_layout<Variant>::check(bytes, size);
+    if (m_Error != flat_error::none) {
+      return;
+    }
+    std::memcpy(&m_Header, bytes, sizeof(m_Header));
+    m_Values = span<const Variant>(
+        reinterpret_cast<const Variant *>(bytes + m_Header.data_offset),
+        static_cast<std::size_t>(m_Header.count));
+    if (m_Header.run_count != 0) {
+      m_Runs = span<const flat_run>(
+          reinterpret_cast<const flat_run *>(bytes + m_Header.index_offset),
+          static_cast<std::size_t>(m_Header.run_count));
+    }
+  }
+
+  explicit operator bool() const noexcept {
+    return m_Error == flat_error::none;
+  }
+  flat_error error() const noexcept { return m_Error; }
+
+  const flat_header &header() const noexcept { return m_Header; }
+  span<const Variant> values() const noexcept { return m_Values; }
+
+  /// @brief The run index, empty if the file has none.
+  span<const flat_run> runs() const noexcept { return m_Runs; }
+  bool has_runs() const noexcept { return !m_Runs.empty(); }
+
+  /// @brief The run containing the element at `position`. Requires the run
+  /// index and a position within the elements.
+  const flat_run &run_at(std::size_t position) const noexcept {
+    const flat_run *run = std::upper_bound(
+        m_Runs.begin(), m_Runs.end(), position,
+        [](std::size_t value, const flat_run &run) {
+          return value < run.start;
+        });
+    return *(run - 1);
+  }
+
+private:
+  flat_error m_Error = flat_error::truncated;
+  flat_header m_Header{};
+  span<const Variant> m_Values;
+  span<const flat_run> m_Runs;
+};
+
+#if CXX_ENUMEXT_HAS_MMAP
+/// @brief Maps a flat file read-only into memory and views its elements
+/// without copying them.
+template <typename Variant> class flat_file {
+public:
+  explicit flat_file(const char *path) noexcept {
+    const int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+      m_Error = flat_error::io;
+      return;
+    }
+    struct stat status;
+    if (::fstat(fd, &status) != 0) {
+      ::close(fd);
+      m_Error = flat_error::io;
+      return;
+    }
+    m_Size = static_cast<std::size_t>(status.st_size);
+    if (m_Size == 0) {
+      ::close(fd);
+      m_Error = flat_error::truncated;
+      return;
+    }
+    void *data = ::mmap(nullptr, m_Size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+      m_Error = flat_error::io;
+      return;
+    }
+    m_Data = data;
+    m_View = flat_view<Variant>(m_Data, m_Size);
+    m_Error = m_View.error();
+  }
+
+  flat_file(const flat_file &) = delete;
+  flat_file &operator=(const flat_file &) = delete;
+
+  flat_file(flat_file &&other) noexcept
+      : m_Data(std::exchange(other.m_Data, nullptr)),
+        m_Size(std::exchange(other.m_Size, 0)), m_View(other.m_View),
+        m_Error(std::exchange(other.m_Error, flat_error::io)) {
+    other.m_View = flat_view<Variant>();
+  }
+
+  flat_file &operator=(flat_file &&other) noexcept {
+    if (this != &other) {
+      unmap();
+      m_Data = std::exchange(other.m_Data, nullptr);
+      m_Size = std::exchange(other.m_Size, 0);
+      m_View = std::exchange(other.m_View, flat_view<Variant>());
+      m_Error = std::exchange(other.m_Error, flat_error::io);
+    }
+    return *this;
+  }
+
+  ~flat_file() { unmap(); }
+
+  explicit operator bool() const noexcept {
+    return m_Error == flat_error::none;
+  }
+  flat_error error() const noexcept { return m_Error; }
+
+  const flat_view<Variant> &view() const noexcept { return m_View; }
+  span<const Variant> values() const noexcept { return m_View.values(); }
+  span<const flat_run> runs() const noexcept { return m_View.runs(); }
+
+private:
+  void unmap() noexcept {
+    if (m_Data != nullptr) {
+      ::munmap(m_Data, m_Size);
+      m_Data = nullptr;
+    }
+  }
+
+  void *m_Data = nullptr;
+  std::size_t m_Size = 0;
+  flat_view<Variant> m_View;
+  flat_error m_Error = flat_error::io;
+};
+#endif
+
+} // namespace enm
+} // namespace rust
+
+#endif
@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) Rachel Powers.
+ *
+ * This source code is licensed under both the MIT license found in the
+ * LICENSE-MIT file in the root directory of this source tree and the Apache
+ * License, Version 2.0 found in the LICENSE-APACHE file in the root directory
+ * of this source tree.
+ */
+
+// cxx_enumext/include/rust/cxx_enumext_hash.h
+
+// Hashes the enums like `cxx_enumext::CxxHasher` does in Rust, and the hash
+// function objects for `std::unordered_map` and friends.
+
+#ifndef RUST_CXX_ENUMEXT_HASH_H
+#define RUST_CXX_ENUMEXT_HASH_H
+
+#include "cxx_enumext_core.h"
+
+#include "cxx_enumext_expected.h"
+#include "cxx_enumext_optional.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
+
+// =================================================
+//
+// Hashing shared with Rust
+//
+// =================================================
+
+namespace rust {
+namespace enm {
+
+/// @brief The hash function of `cxx_enumext::CxxHasher` in Rust.
+///
+/// The hash only depends on the concatenation of the written bytes, not on
+/// how they are split into `write` calls. Writing the bytes of a struct
+/// without padding at once therefore hashes the same as writing its fields
+/// one by one, like Rust's `Hash` implementations do.
+class hasher {
+public:
+  void write(const void *data, std::size_t size) noexcept {
+    const auto *bytes = static_cast<const unsigned char *>(data);
+    m_Length += size;
+    if (m_TailSize != 0) {
+      const std::size_t count = std::min(size, sizeof(m_Tail) - m_TailSize);
+      std::memcpy(m_Tail + m_TailSize, bytes, count);
+      m_TailSize += count;
+      bytes += count;
+      size -= count;
+      if (m_TailSize < sizeof(m_Tail)) {
+        return;
+      }
+      m_State = mix(m_State, load(m_Tail));
+      m_TailSize = 0;
+    }
+    for (; size >= sizeof(std::uint64_t); size -= sizeof(std::uint64_t)) {
+      m_State = mix(m_State, load(bytes));
+      bytes += sizeof(std::uint64_t);
+    }
+    std::memcpy(m_Tail, bytes, size);
+    m_TailSize = size;
+  }
+
+  std::uint64_t finish() const noexcept {
+    std::uint64_t state = m_State;
+    if (m_TailSize != 0) {
+      unsigned char tail[sizeof(m_Tail)] = {};
+      std::memcpy(tail, m_Tail, m_TailSize);
+      state = mix(state, load(tail));
+    }
+    state = mix(state, m_Length);
+    // The finalizer of MurmurHash3.
+    state ^= state >> 33;
+    state *= 0xff51afd7ed558ccdULL;
+    state ^= state >> 33;
+    state *= 0xc4ceb9fe1a85ec53ULL;
+    state ^= state >> 33;
+    return state;
+  }
+
+private:
+  static std::uint64_t load(const unsigned char *bytes) noexcept {
+    std::uint64_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+    return word;
+  }
+
+  static std::uint64_t mix(std::uint64_t state, std::uint64_t word) noexcept {
+    return (((state << 23) | (state >> 41)) ^ word) * 0x9e3779b97f4a7c15ULL;
+  }
+
+  std::uint64_t m_State = 0x243f6a8885a308d3ULL;
+  std::uint64_t m_Length = 0;
+  unsigned char m_Tail[sizeof(std::uint64_t)] = {};
+  std::size_t m_TailSize = 0;
+};
+
+namespace detail {
+
+template <typename T, typename = void>
+struct is_hashable_range : std::false_type {};
+
+template <typename T>
+struct is_hashable_range<
+    T, std::void_t<decltype(std::data(std::declval<const T &>())),
+                   decltype(std::size(std::declval<const T &>()))>>
+    : std::true_type {};
+
+} // namespace detail
+
+namespace detail {
+
+template <typename T>
+constexpr bool is_generically_hashable_v =
+    is_contiguously_hashable_v<T> || std::is_empty_v<T> ||
+    is_hashable_range<T>::value;
+
+} // namespace detail
+
+/// @brief Feeds `value` to the hasher like its Rust counterpart's `Hash`
+/// implementation does:
+///
+/// - integers, `bool` and enums: their bytes.
+/// - empty types (`UNIT` alternatives, `monostate`): nothing.
+/// - strings (`rust::String`, `rust::Str`, `std::string`, ...): the bytes and
+///   `0xff`.
+/// - other ranges (`rust::Vec`, `rust::Slice`, `std::vector`, ...): the size
+///   as `std::size_t` and the elements.
+///
+/// Further types (e.g. `STRUCT` alternatives or shared structs) are supported
+/// by an overload `hash_append(H &, const T &)` found by argument dependent
+/// lookup, which has to match the `Hash` implementation in Rust.
+template <typename H, typename T>
+std::enable_if_t<detail::is_generically_hashable_v<T>>
+hash_append(H &hasher, const T &value) {
+  if constexpr (is_contiguously_hashable_v<T>) {
+    hasher.write(&value, sizeof(T));
+  } else if constexpr (std::is_empty_v<T>) {
+    // Zero sized types are not hashed in Rust either.
+  } else {
+    using element = std::remove_const_t<
+        std::remove_pointer_t<decltype(std::data(value))>>;
+    if constexpr (std::is_same_v<element, char>) {
+      hasher.write(std::data(value), std::size(value));
+      const unsigned char terminator = 0xff;
+      hasher.write(&terminator, sizeof(terminator));
+    } else {
+      const std::size_t size = std::size(value);
+      hasher.write(&size, sizeof(size));
+      if constexpr (is_contiguously_hashable_v<element>) {
+        hasher.write(std::data(value), size * sizeof(element));
+      } else {
+        for (const auto &element_value : value) {
+          hash_append(hasher, element_value);
+        }
+      }
+    }
+  }
+}
+
+/// @brief References (`&T`) and boxes hash the value they point to.
+template <typename H, typename T>
+void hash_append(H &hasher, const std::reference_wrapper<T> &value) {
+  hash_append(hasher, value.get());
+}
+
+template <typename H, typename T>
+void hash_append(H &hasher, const ::rust::Box<T> &value) {
+  hash_append(hasher, *value);
+}
+
+/// @brief The index of the alternative as a `std::uint64_t` followed by the
+/// alternative.
+template <typename H, typename Tag, typename... Ts>
+void hash_append(H &hasher, const basic_variant_base<Tag, Ts...> &value) {
+  const std::uint64_t index = value.index();
+  hasher.write(&index, sizeof(index));
+  visit(
+      [&hasher](const auto &alternative) { hash_append(hasher, alternative); },
+      value);
+}
+
+/// @brief Hashes like `Option<T>`: `None` is the index 0, `Some` the index 1
+/// followed by the value.
+template <typename H, typename T>
+void hash_append(H &hasher, const nullable<T> &value) {
+  const std::uint64_t index = value.has_value() ? 1 : 0;
+  hasher.write(&index, sizeof(index));
+  if (value.has_value()) {
+    hash_append(hasher, *value);
+  }
+}
+
+/// @brief The hash of `value`, equal to `cxx_enumext::hash(&value)` in Rust
+/// if the Rust type implements `Hash` as generated by
+/// `#[cxx_enumext::extern_type(hash)]`.
+template <typename T> std::uint64_t hash_value(const T &value) {
+  hasher state;
+  hash_append(state, value);
+  return state.finish();
+}
+
+/// @brief A hash function object for `std::unordered_map` and friends, e.g.
+/// `std::unordered_set<RustEnum, rust::enm::hash<>>`.
+template <typename T = void> struct hash {
+  std::size_t operator()(const T &value) const {
+    return static_cast<std::size_t>(hash_value(value));
+  }
+};
+
+template <> struct hash<void> {
+  using is_transparent = void;
+
+  template <typename T> std::size_t operator()(const T &value) const {
+    return static_cast<std::size_t>(hash_value(value));
+  }
+};
+
+} // namespace enm
+} // namespace rust
+
+namespace std {
+
+template <typename Tag, typename... Ts>
+struct hash<::rust::enm::basic_variant<Tag, Ts...>>
+    : ::rust::enm::hash<::rust::enm::basic_variant<Tag, Ts...>> {};
+
+template <typename T>
+struct hash<::rust::enm::optional<T>>
+    : ::rust::enm::hash<::rust::enm::optional<T>> {};
+
+template <typename T, typename E>
+struct hash<::rust::enm::expected<T, E>>
+    : ::rust::enm::hash<::rust::enm::expected<T, E>> {};
+
+template <typename T>
+struct hash<::rust::enm::nullable<T>>
+    : ::rust::enm::hash<::rust::enm::nullable<T>> {};
+
+} // namespace std
+
+#endif
@@ -11,290 +11,191 @@
 
 #pragma once
 
+#include "cxx_enumext_core.h"
+
+#include <tuple>
+
 #define CXX_CAT(a, ...) CXX_PRIMITIVE_CAT(a, __VA_ARGS__)
 #define CXX_PRIMITIVE_CAT(a, ...) a##__VA_ARGS__
 
-#define CXX_CALL(X, Y) X Y
-
 #define CXX_EAT(...)
-#define CXX_EMPTY()
-#define CXX_DEFER(id) id CXX_EMPTY()
-#define CXX_OBSTRUCT(...) __VA_ARGS__ CXX_DEFER(CXX_EMPTY)()
 #define CXX_EXPAND(...) __VA_ARGS__
 
-#define CXX_EVAL(...) CXX_EVAL1(CXX_EVAL1(CXX_EVAL1(__VA_ARGS__)))
-#define CXX_EVAL1(...) CXX_EVAL2(CXX_EVAL2(CXX_EVAL2(__VA_ARGS__)))
-#define CXX_EVAL2(...) CXX_EVAL3(CXX_EVAL3(CXX_EVAL3(__VA_ARGS__)))
-#define CXX_EVAL3(...) CXX_EVAL4(CXX_EVAL4(CXX_EVAL4(__VA_ARGS__)))
-#define CXX_EVAL4(...) __VA_ARGS__
-
-#define CXX_GET_ARG_22(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, \
-                       a14, a15, a17, a18, a19, a20, a21, a22, n, ...)         \
-  n
-#define CXX_GET_ARG_N(n, ...)                                                  \
-  CXX_CALL(CXX_TOKENPASTE(CXX_GET_ARG_, n), (__VA_ARGS__))
-#define CXX_COUNT_ARGS(...)                                                    \
-  CXX_EXPAND(CXX_GET_ARG_22("ignored", __VA_ARGS__, 20, 19, 18, 17, 16, 15,    \
-                            14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0))
-
-// Concatenates `prefix` to the number of variadic arguments supplied (e.g.
-// `prefix_1`, `prefix_2`, etc.)
-#define CXX_DISPATCH_VARIADIC_IMPL(prefix, unused, a0, a1, a2, a3, a4, a5, a6, \
-                                   a7, a8, a9, a10, a11, a12, a13, a14, a15,   \
-                                   a16, a17, a18, a19, a20, ...)               \
-  prefix##a20
-#define CXX_DISPATCH_VARIADIC(prefix, ...)                                     \
-  CXX_DEFER(CXX_DISPATCH_VARIADIC_IMPL)(prefix, __VA_ARGS__, 21, 20, 19, 18,   \
-                                        17, 16, 15, 14, 13, 12, 11, 10, 9, 8,  \
-                                        7, 6, 5, 4, 3, 2, 1)
-
-#define CXX_LIST_WRAP_WITH_0(macro, arg, ...)
-#define CXX_LIST_WRAP_WITH_1(macro, arg, var, ...) macro(var, arg)
-#define CXX_LIST_WRAP_WITH_2(macro, arg, var, ...)                             \
-  macro(var, arg), CXX_DEFER(CXX_LIST_WRAP_WITH_1)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_WRAP_WITH_3(macro, arg, var, ...)                             \
-  macro(var, arg), CXX_DEFER(CXX_LIST_WRAP_WITH_2)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_WRAP_WITH_4(macro, arg, var, ...)                             \
-  macro(var, arg), CXX_DEFER(CXX_LIST_WRAP_WITH_3)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_WRAP_WITH_5(macro, arg, var, ...)                             \
-  macro(var, arg), CXX_DEFER(CXX_LIST_WRAP_WITH_4)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_WRAP_WITH_6(macro, arg, var, ...)                             \
-  macro(var, arg), CXX_DEFER(CXX_LIST_WRAP_WITH_5)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_WRAP_WITH_7(macro, arg, var, ...)                             \
-  macro(var, arg), CXX_DEFER(CXX_LIST_WRAP_WITH_6)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_WRAP_WITH_8(macro, arg, var, ...)                             \
-  macro(var, arg), CXX_DEFER(CXX_LIST_WRAP_WITH_7)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_WRAP_WITH_9(macro, arg, var, ...)                             \
-  macro(var, arg), CXX_DEFER(CXX_LIST_WRAP_WITH_8)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_WRAP_WITH_10(macro, arg, var, ...)                            \
-  macro(var, arg), CXX_DEFER(CXX_LIST_WRAP_WITH_9)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_WRAP_WITH_11(macro, arg, var, ...)                            \
-  macro(var, arg), CXX_DEFER(CXX_LIST_WRAP_WITH_10)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_WRAP_WITH_12(macro, arg, var, ...)                            \
-  macro(var, arg), CXX_DEFER(CXX_LIST_WRAP_WITH_11)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_WRAP_WITH_13(macro, arg, var, ...)                            \
-  macro(var, arg), CXX_DEFER(CXX_LIST_WRAP_WITH_12)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_WRAP_WITH_14(macro, arg, var, ...)                            \
-  macro(var, arg), CXX_DEFER(CXX_LIST_WRAP_WITH_13)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_WRAP_WITH_15(macro, arg, var, ...)                            \
-  macro(var, arg), CXX_DEFER(CXX_LIST_WRAP_WITH_14)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_WRAP_WITH(macro, arg, ...)                                    \
-  CXX_DISPATCH_VARIADIC(CXX_LIST_WRAP_WITH_, __VA_ARGS__)(macro, arg,          \
-                                                          __VA_ARGS__)
-
-#define CXX_LIST_APPLY_0(macro)
-#define CXX_LIST_APPLY_1(macro, var) macro(var)
-#define CXX_LIST_APPLY_2(macro, var, ...)                                      \
-  macro(var) CXX_DEFER(CXX_LIST_APPLY_1)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_3(macro, var, ...)                                      \
-  macro(var) CXX_DEFER(CXX_LIST_APPLY_2)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_4(macro, var, ...)                                      \
-  macro(var) CXX_DEFER(CXX_LIST_APPLY_3)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_5(macro, var, ...)                                      \
-  macro(var) CXX_DEFER(CXX_LIST_APPLY_4)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_6(macro, var, ...)                                      \
-  macro(var) CXX_DEFER(CXX_LIST_APPLY_5)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_7(macro, var, ...)                                      \
-  macro(var) CXX_DEFER(CXX_LIST_APPLY_6)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_8(macro, var, ...)                                      \
-  macro(var) CXX_DEFER(CXX_LIST_APPLY_7)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_9(macro, var, ...)                                      \
-  macro(var) CXX_DEFER(CXX_LIST_APPLY_8)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_10(macro, var, ...)                                     \
-  macro(var) CXX_DEFER(CXX_LIST_APPLY_9)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_11(macro, var, ...)                                     \
-  macro(var) CXX_DEFER(CXX_LIST_APPLY_10)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_12(macro, var, ...)                                     \
-  macro(var) CXX_DEFER(CXX_LIST_APPLY_11)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_13(macro, var, ...)                                     \
-  macro(var) CXX_DEFER(CXX_LIST_APPLY_12)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_14(macro, var, ...)                                     \
-  macro(var) CXX_DEFER(CXX_LIST_APPLY_13)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_15(macro, var, ...)                                     \
-  macro(var) CXX_DEFER(CXX_LIST_APPLY_14)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY(macro, ...)                                             \
-  CXX_DISPATCH_VARIADIC(CXX_LIST_APPLY_, __VA_ARGS__)(macro, __VA_ARGS__)
-
-#define CXX_LIST_APPLY_WITH_0(macro, arg)
-#define CXX_LIST_APPLY_WITH_1(macro, arg, var) macro(var, arg)
-#define CXX_LIST_APPLY_WITH_2(macro, arg, var, ...)                            \
-  macro(var, arg) CXX_DEFER(CXX_LIST_APPLY_WITH_1)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_APPLY_WITH_3(macro, arg, var, ...)                            \
-  macro(var, arg) CXX_DEFER(CXX_LIST_APPLY_WITH_2)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_APPLY_WITH_4(macro, arg, var, ...)                            \
-  macro(var, arg) CXX_DEFER(CXX_LIST_APPLY_WITH_3)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_APPLY_WITH_5(macro, arg, var, ...)                            \
-  macro(var, arg) CXX_DEFER(CXX_LIST_APPLY_WITH_4)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_APPLY_WITH_6(macro, arg, var, ...)                            \
-  macro(var, arg) CXX_DEFER(CXX_LIST_APPLY_WITH_5)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_APPLY_WITH_7(macro, arg, var, ...)                            \
-  macro(var, arg) CXX_DEFER(CXX_LIST_APPLY_WITH_6)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_APPLY_WITH_8(macro, arg, var, ...)                            \
-  macro(var, arg) CXX_DEFER(CXX_LIST_APPLY_WITH_7)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_APPLY_WITH_9(macro, arg, var, ...)                            \
-  macro(var, arg) CXX_DEFER(CXX_LIST_APPLY_WITH_8)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_APPLY_WITH_10(macro, arg, var, ...)                           \
-  macro(var, arg) CXX_DEFER(CXX_LIST_APPLY_WITH_9)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_APPLY_WITH_11(macro, arg, var, ...)                           \
-  macro(var, arg) CXX_DEFER(CXX_LIST_APPLY_WITH_10)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_APPLY_WITH_12(macro, arg, var, ...)                           \
-  macro(var, arg) CXX_DEFER(CXX_LIST_APPLY_WITH_11)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_APPLY_WITH_13(macro, arg, var, ...)                           \
-  macro(var, arg) CXX_DEFER(CXX_LIST_APPLY_WITH_12)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_APPLY_WITH_14(macro, arg, var, ...)                           \
-  macro(var, arg) CXX_DEFER(CXX_LIST_APPLY_WITH_13)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_APPLY_WITH_15(macro, arg, var, ...)                           \
-  macro(var, arg) CXX_DEFER(CXX_LIST_APPLY_WITH_14)(macro, arg, __VA_ARGS__)
-#define CXX_LIST_APPLY_WITH(macro, arg, ...)                                   \
-  CXX_DISPATCH_VARIADIC(CXX_LIST_APPLY_WITH_, __VA_ARGS__)(macro, arg,         \
-                                                           __VA_ARGS__)
-
-#define CXX_LIST_APPLY_INDEX_0(macro, var, ...)
-#define CXX_LIST_APPLY_INDEX_1(macro, var, ...) macro(var, 0)
-#define CXX_LIST_APPLY_INDEX_2(macro, var, ...)                                \
-  macro(var, 1) CXX_DEFER(CXX_LIST_APPLY_INDEX_1)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_INDEX_3(macro, var, ...)                                \
-  macro(var, 2) CXX_DEFER(CXX_LIST_APPLY_INDEX_2)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_INDEX_4(macro, var, ...)                                \
-  macro(var, 3) CXX_DEFER(CXX_LIST_APPLY_INDEX_3)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_INDEX_5(macro, var, ...)                                \
-  macro(var, 4) CXX_DEFER(CXX_LIST_APPLY_INDEX_4)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_INDEX_6(macro, var, ...)                                \
-  macro(var, 5) CXX_DEFER(CXX_LIST_APPLY_INDEX_5)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_INDEX_7(macro, var, ...)                                \
-  macro(var, 6) CXX_DEFER(CXX_LIST_APPLY_INDEX_6)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_INDEX_8(macro, var, ...)                                \
-  macro(var, 7) CXX_DEFER(CXX_LIST_APPLY_INDEX_7)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_INDEX_9(macro, var, ...)                                \
-  macro(var, 8) CXX_DEFER(CXX_LIST_APPLY_INDEX_8)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_INDEX_10(macro, var, ...)                               \
-  macro(var, 9) CXX_DEFER(CXX_LIST_APPLY_INDEX_9)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_INDEX_11(macro, var, ...)                               \
-  macro(var, 10) CXX_DEFER(CXX_LIST_APPLY_INDEX_10)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_INDEX_12(macro, var, ...)                               \
-  macro(var, 11) CXX_DEFER(CXX_LIST_APPLY_INDEX_11)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_INDEX_13(macro, var, ...)                               \
-  macro(var, 12) CXX_DEFER(CXX_LIST_APPLY_INDEX_12)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_INDEX_14(macro, var, ...)                               \
-  macro(var, 13) CXX_DEFER(CXX_LIST_APPLY_INDEX_13)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_INDEX_15(macro, var, ...)                               \
-  macro(var, 14) CXX_DEFER(CXX_LIST_APPLY_INDEX_14)(macro, __VA_ARGS__)
-#define CXX_LIST_APPLY_INDEX(macro, ...)                                       \
-  CXX_DISPATCH_VARIADIC(CXX_LIST_APPLY_INDEX_, __VA_ARGS__)(macro, __VA_ARGS__)
-
-#define CXX_LIST_APPLY_INDEX_REV_0(macro, var, ...)
-#define CXX_LIST_APPLY_INDEX_REV_1(macro, var, ...) macro(var, 0)
-#define CXX_LIST_APPLY_INDEX_REV_2(macro, var, ...)                            \
-  CXX_DEFER(CXX_LIST_APPLY_INDEX_REV_1)(macro, __VA_ARGS__) macro(var, 1)
-#define CXX_LIST_APPLY_INDEX_REV_3(macro, var, ...)                            \
-  CXX_DEFER(CXX_LIST_APPLY_INDEX_REV_2)(macro, __VA_ARGS__) macro(var, 2)
-#define CXX_LIST_APPLY_INDEX_REV_4(macro, var, ...)                            \
-  CXX_DEFER(CXX_LIST_APPLY_INDEX_REV_3)(macro, __VA_ARGS__) macro(var, 3)
-#define CXX_LIST_APPLY_INDEX_REV_5(macro, var, ...)                            \
-  CXX_DEFER(CXX_LIST_APPLY_INDEX_REV_4)(macro, __VA_ARGS__) macro(var, 4)
-#define CXX_LIST_APPLY_INDEX_REV_6(macro, var, ...)                            \
-  CXX_DEFER(CXX_LIST_APPLY_INDEX_REV_5)(macro, __VA_ARGS__) macro(var, 5)
-#define CXX_LIST_APPLY_INDEX_REV_7(macro, var, ...)                            \
-  CXX_DEFER(CXX_LIST_APPLY_INDEX_REV_6)(macro, __VA_ARGS__) macro(var, 6)
-#define CXX_LIST_APPLY_INDEX_REV_8(macro, var, ...)                            \
-  CXX_DEFER(CXX_LIST_APPLY_INDEX_REV_7)(macro, __VA_ARGS__) macro(var, 7)
-#define CXX_LIST_APPLY_INDEX_REV_9(macro, var, ...)                            \
-  CXX_DEFER(CXX_LIST_APPLY_INDEX_REV_8)(macro, __VA_ARGS__) macro(var, 8)
-#define CXX_LIST_APPLY_INDEX_REV_10(macro, var, ...)                           \
-  CXX_DEFER(CXX_LIST_APPLY_INDEX_REV_9)(macro, __VA_ARGS__) macro(var, 9)
-#define CXX_LIST_APPLY_INDEX_REV_11(macro, var, ...)                           \
-  CXX_DEFER(CXX_LIST_APPLY_INDEX_REV_10)(macro, __VA_ARGS__) macro(var, 10)
-#define CXX_LIST_APPLY_INDEX_REV_12(macro, var, ...)                           \
-  CXX_DEFER(CXX_LIST_APPLY_INDEX_REV_11)(macro, __VA_ARGS__) macro(var, 11)
-#define CXX_LIST_APPLY_INDEX_REV_13(macro, var, ...)                           \
-  CXX_DEFER(CXX_LIST_APPLY_INDEX_REV_12)(macro, __VA_ARGS__) macro(var, 12)
-#define CXX_LIST_APPLY_INDEX_REV_14(macro, var, ...)                           \
-  CXX_DEFER(CXX_LIST_APPLY_INDEX_REV_13)(macro, __VA_ARGS__) macro(var, 13)
-#define CXX_LIST_APPLY_INDEX_REV_15(macro, var, ...)                           \
-  CXX_DEFER(CXX_LIST_APPLY_INDEX_REV_14)(macro, __VA_ARGS__) macro(var, 14)
-#define CXX_LIST_APPLY_INDEX_REV(macro, ...)                                   \
-  CXX_DISPATCH_VARIADIC(CXX_LIST_APPLY_INDEX_REV_, __VA_ARGS__)(macro,         \
-                                                                __VA_ARGS__)
+// `CXX_IS_EMPTY(x)` is 1 if `x` has no tokens and 0 otherwise. `x` must not
+// start with a parenthesis, which neither alternatives nor field types do.
+#define CXX_EMPTY_PROBE(...) ~, 1
+#define CXX_SECOND(a, b, ...) b
+#define CXX_IS_EMPTY_IMPL(...) CXX_EXPAND(CXX_SECOND(__VA_ARGS__))
+#define CXX_IS_EMPTY(x) CXX_IS_EMPTY_IMPL(CXX_EMPTY_PROBE x(), 0, ~)
 
-#define CXX_APPLY(macro, ...) macro(__VA_ARGS__)
+// `CXX_IF(x)(body)` is `body` if `x` isn't empty and nothing otherwise.
+#define CXX_IF(x) CXX_CAT(CXX_IF_, CXX_IS_EMPTY(x))
+#define CXX_IF_0(...) __VA_ARGS__
+#define CXX_IF_1(...)
 
-#define CXX_VARIANT_TYPE_FROM_DEF(name, type, impl) type
-#define CXX_VARIANT_NAME_FROM_DEF(name, type, impl) name
-#define CXX_VARIANT_IMPL_FROM_DEF(name, type, impl) impl
+// `CXX_FOR_EACH_VARIANT(m, a, x0, x1, ...)` is `m(x0, a, 0) m(x1, a, 1) ...`,
+// for up to 256 alternatives. `CXX_FOR_EACH_FIELD` is the same for up to 64
+// tuple fields, it can be used inside of `m`.
+//
+// Each level of the ladders at the end of the file handles eight elements and
+// expands the next level directly, so every element is expanded once and the
+// rest of the list is only passed on once per eight elements. The iteration
+// stops at the first empty element, the padding appended here, which also
+// makes a trailing comma harmless.
+#define CXX_FOR_EACH_VARIANT(m, a, ...)                                        \
+  CXX_VARIANTS_0(m, a, __VA_ARGS__, , , , , , , , , )
+#define CXX_FOR_EACH_FIELD(m, a, ...)                                          \
+  CXX_FIELDS_0(m, a, __VA_ARGS__, , , , , , , , , )
 
-#define CXX_VARIANT_COLLECT_TYPE(def, variant)                                 \
-  variant##_impl::CXX_DEFER(CXX_VARIANT_TYPE_FROM_DEF)(                        \
-      CXX_EXPAND(CXX_VARIANT_##def))
+// The name of an alternative, without expanding its definition.
+#define CXX_VARIANT_NAME_TYPE(name, type) name
+#define CXX_VARIANT_NAME_TUPLE(name, ...) name
+#define CXX_VARIANT_NAME_UNIT(name) name
+#define CXX_VARIANT_NAME_STRUCT(name, ...) name
 
-#define CXX_VARIANT_COLLECT_IMPL(def)                                          \
-  CXX_DEFER(CXX_VARIANT_IMPL_FROM_DEF)                                         \
-  CXX_DEFER(CXX_EXPAND)((CXX_VARIANT_##def))
-
-#define CXX_VARIANT_USING(def, variant)                                        \
-  using CXX_DEFER(CXX_VARIANT_NAME_FROM_DEF)(CXX_EXPAND(CXX_VARIANT_##def)) =  \
-      variant##_impl::CXX_DEFER(CXX_VARIANT_TYPE_FROM_DEF)(                    \
-          CXX_EXPAND(CXX_VARIANT_##def));
+#define CXX_VARIANT_IMPL(def, variant, index) CXX_VARIANT_##def
+#define CXX_VARIANT_ALTERNATIVE(def, variant, index)                           \
+  , CXX_CAT(CXX_VARIANT_NAME_##def, _t)
+#define CXX_VARIANT_USING(def, variant, index)                                 \
+  using CXX_VARIANT_NAME_##def =                                               \
+      variant##_impl::CXX_CAT(CXX_VARIANT_NAME_##def, _t);
 
 ///=====================
 /// Variant Type macros
 /// ====================
 
 /// Type (single element tuple)
-#define CXX_VARIANT_TYPE(name, type) name, name##_t, using name##_t = type;
+#define CXX_VARIANT_TYPE(name, type) using name##_t = type;
 
-/// N element Tuple (supports up to 15 fields)
-#define CXX_DEFINE_TUPLE_FIELD(type, index) type _##index;
+/// N element Tuple (supports up to 64 fields)
+#define CXX_DEFINE_TUPLE_FIELD(type, name, index) type _##index;
+#define CXX_HASH_TUPLE_FIELD(type, name, index)                                \
+  hash_append(hasher, value._##index);
+#define CXX_TUPLE_FIELD_CONTIGUOUS(type, name, index)                          \
+  &&::rust::enm::is_contiguously_hashable_v<type>
+#define CXX_TUPLE_FIELD_SIZE(type, name, index) +sizeof(type)
+#define CXX_TUPLE_FIELD_TRIVIAL(type, name, index)                             \
+  &&::rust::enm::is_trivially_comparable_v<type>
+#define CXX_TUPLE_FIELD_EQUAL(type, name, index) &&lhs._##index == rhs._##index
+#define CXX_TUPLE_FIELD_LESS(type, name, index)                                \
+  if (lhs._##index < rhs._##index) {                                           \
+    return true;                                                               \
+  }                                                                            \
+  if (rhs._##index < lhs._##index) {                                           \
+    return false;                                                              \
+  }
+#if CXX_ENUMEXT_THREE_WAY
+#define CXX_TUPLE_FIELD_TIE(type, side, index) , std::tie(side._##index)
+#define CXX_TUPLE_TIE(side, ...)                                               \
+  std::tuple_cat(std::tuple<>()                                                \
+                     CXX_FOR_EACH_FIELD(CXX_TUPLE_FIELD_TIE, side, __VA_ARGS__))
+#define CXX_TUPLE_THREE_WAY(name, ...)                                         \
+  template <typename Self = name##_t>                                          \
+  friend auto operator<=>(const std::remove_cv_t<Self> &lhs,                   \
+                          const name##_t &rhs)                                 \
+      -> decltype(CXX_TUPLE_TIE(lhs, __VA_ARGS__) <=>                          \
+                  CXX_TUPLE_TIE(rhs, __VA_ARGS__)) {                           \
+    return CXX_TUPLE_TIE(lhs, __VA_ARGS__) <=>                                 \
+           CXX_TUPLE_TIE(rhs, __VA_ARGS__);                                    \
+  }
+#else
+#define CXX_TUPLE_THREE_WAY(name, ...)
+#endif
+// The comparisons are templates so that fields without them only fail when
+// they are used. `Self` is never deduced, it only makes the body dependent.
+#define CXX_TUPLE_COMPARISON(name, op)                                         \
+  template <typename Self = name##_t>                                          \
+  friend bool operator op(const std::remove_cv_t<Self> &lhs,                   \
+                          const name##_t &rhs)
 #define CXX_VARIANT_TUPLE(name, ...)                                           \
-  name, name##_t, struct name##_t {                                            \
-    CXX_DEFER(CXX_LIST_APPLY_INDEX_REV)                                        \
-    (CXX_DEFINE_TUPLE_FIELD, __VA_ARGS__)                                      \
+  struct name##_t {                                                            \
+    CXX_FOR_EACH_FIELD(CXX_DEFINE_TUPLE_FIELD, name, __VA_ARGS__)              \
+                                                                               \
+    /* Without padding the bytes hash like the fields one by one. */           \
+    template <typename H>                                                      \
+    friend void hash_append(H &hasher, const name##_t &value) {                \
+      if constexpr ((true CXX_FOR_EACH_FIELD(CXX_TUPLE_FIELD_CONTIGUOUS, name, \
+                                             __VA_ARGS__)) &&                  \
+                    sizeof(name##_t) ==                                        \
+                        (0 CXX_FOR_EACH_FIELD(CXX_TUPLE_FIELD_SIZE, name,      \
+                                              __VA_ARGS__))) {                 \
+        hasher.write(&value, sizeof(value));                                   \
+      } else {                                                                 \
+        CXX_FOR_EACH_FIELD(CXX_HASH_TUPLE_FIELD, name, __VA_ARGS__)            \
+      }                                                                        \
+    }                                                                          \
+                                                                               \
+    /* Variants of such compare with memcmp if there is no padding. */         \
+    using IsTriviallyComparable = std::bool_constant<(                         \
+        true CXX_FOR_EACH_FIELD(CXX_TUPLE_FIELD_TRIVIAL, name, __VA_ARGS__))>; \
+                                                                               \
+    /* Lexicographic, like the derived PartialEq and PartialOrd. */            \
+    CXX_TUPLE_COMPARISON(name, ==) {                                           \
+      return true CXX_FOR_EACH_FIELD(CXX_TUPLE_FIELD_EQUAL, name,              \
+                                     __VA_ARGS__);                             \
+    }                                                                          \
+    CXX_TUPLE_COMPARISON(name, !=) {                                           \
+      return !(lhs == rhs);                                                    \
+    }                                                                          \
+    CXX_TUPLE_COMPARISON(name, <) {                                            \
+      CXX_FOR_EACH_FIELD(CXX_TUPLE_FIELD_LESS, name, __VA_ARGS__)              \
+      return false;                                                            \
+    }                                                                          \
+    CXX_TUPLE_COMPARISON(name, >) {                                            \
+      return rhs < lhs;                                                        \
+    }                                                                          \
+    CXX_TUPLE_COMPARISON(name, <=) {                                           \
+      return !(rhs < lhs);                                                     \
+    }                                                                          \
+    CXX_TUPLE_COMPARISON(name, >=) {                                           \
+      return !(lhs < rhs);                                                     \
+    }                                                                          \
+    CXX_TUPLE_THREE_WAY(name, __VA_ARGS__)                                     \
   };
 
-#define CXX_VARIANT_UNIT(name)                                                 \
-  name, name##_t, struct name##_t {};
+#define CXX_VARIANT_UNIT(name) struct name##_t {};
 
 #define CXX_VARIANT_STRUCT(name, ...)                                          \
-  name, name##_t, struct name##_t {                                            \
+  struct name##_t {                                                            \
     __VA_ARGS__                                                                \
   };
 
-#define CXX_IMPL_NAMESPACE(...)                                                \
-  CXX_LIST_APPLY(CXX_VARIANT_COLLECT_IMPL, __VA_ARGS__)
-
-#define CXX_VARIANT_TYPE_PACK(name, ...)                                       \
-  CXX_LIST_WRAP_WITH(CXX_VARIANT_COLLECT_TYPE, name, __VA_ARGS__)
-
-#define CXX_VARIANT_USING_STATMENTS(name, ...)                                 \
-  CXX_LIST_APPLY_WITH(CXX_VARIANT_USING, name, __VA_ARGS__)
-
 ///=====================
 /// Variant Define macro
 /// ====================
 
-#define CXX_DEFINE_VARIANT(name, variants, ...)                                \
+/// `repr` is the integer type of the discriminant. It must match the
+/// `#[repr(C, u8)]` (or u16, u32...) attribute of the Rust enum.
+#define CXX_DEFINE_VARIANT_REPR(name, repr, variants, ...)                     \
   namespace name##_impl {                                                      \
-    CXX_EVAL(CXX_CALL(CXX_IMPL_NAMESPACE, variants))                           \
+    CXX_FOR_EACH_VARIANT(CXX_VARIANT_IMPL, name, CXX_EXPAND variants)          \
+                                                                               \
+    using base = ::rust::enm::basic_variant<repr CXX_FOR_EACH_VARIANT(         \
+        CXX_VARIANT_ALTERNATIVE, name, CXX_EXPAND variants)>;                  \
   }                                                                            \
-  struct name final                                                            \
-      : public ::rust::enm::variant<CXX_EVAL(CXX_CALL(                     \
-            CXX_VARIANT_TYPE_PACK, (name, CXX_DEFER(CXX_EXPAND) variants)))> { \
-    using base = ::rust::enm::variant<CXX_EVAL(CXX_CALL(                   \
-        CXX_VARIANT_TYPE_PACK, (name, CXX_DEFER(CXX_EXPAND) variants)))>;      \
+  struct name final : public name##_impl::base {                               \
+    using base = name##_impl::base;                                            \
                                                                                \
     name() = delete;                                                           \
     name(const name &) = default;                                              \
-    name(name &&) = delete;                                                    \
+    name(name &&) = default;                                                   \
+    name &operator=(const name &) = default;                                   \
+    name &operator=(name &&) = default;                                        \
     using base::base;                                                          \
     using base::operator=;                                                     \
                                                                                \
     using IsRelocatable = std::true_type;                                      \
                                                                                \
-    CXX_EVAL(CXX_DEFER(CXX_VARIANT_USING_STATMENTS)(name,                      \
-                                                    CXX_DEFER(CXX_EXPAND)      \
-                                                        variants))             \
+    CXX_FOR_EACH_VARIANT(CXX_VARIANT_USING, name, CXX_EXPAND variants)         \
     __VA_ARGS__                                                                \
   };
 
+/// The variant of a `#[repr(C)]` enum, whose discriminant is an int.
+#define CXX_DEFINE_VARIANT(name, variants, ...)                                \
+  CXX_DEFINE_VARIANT_REPR(name, int, variants, __VA_ARGS__)
+
+/// The macros below need "rust/cxx_enumext_optional.h", respectively
+/// "rust/cxx_enumext_expected.h".
 #define CXX_DEFINE_OPTIONAL(name, type, ...)                                   \
   struct name final : public ::rust::enm::optional<type> {                 \
     using base = ::rust::enm::optional<type>;                              \
@@ -309,6 +210,20 @@
     __VA_ARGS__                                                                \
   };
 
+#define CXX_DEFINE_NULLABLE(name, type, ...)                                   \
+  struct name final : public ::rust::enm::nullable<type> {                     \
+    using base = ::rust::enm::nullable<type>;                                  \
+    using base::base;                                                          \
+    using base::operator=;                                                     \
+                                                                               \
+    using base::Some;                                                          \
+    using base::None;                                                          \
+                                                                               \
+    using IsRelocatable = std::true_type;                                      \
+                                                                               \
+    __VA_ARGS__                                                                \
+  };
+
 #define CXX_DEFINE_EXPECTED(name, expected_t, unexpected_t, ...)               \
   struct name final                                                            \
       : public ::rust::enm::expected<expected_t, unexpected_t> {           \
@@ -323,3 +238,255 @@
                                                                                \
     __VA_ARGS__                                                                \
   };
+
+///=====================
+/// Iteration ladders (generated)
+/// ====================
+
+#define CXX_VARIANTS_0(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)              \
+  CXX_IF(x0)(m(x0, a, 0)) CXX_IF(x1)(m(x1, a, 1))                              \
+  CXX_IF(x2)(m(x2, a, 2)) CXX_IF(x3)(m(x3, a, 3))                              \
+  CXX_IF(x4)(m(x4, a, 4)) CXX_IF(x5)(m(x5, a, 5))                              \
+  CXX_IF(x6)(m(x6, a, 6)) CXX_IF(x7)(m(x7, a, 7))                              \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(1))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_1(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)              \
+  CXX_IF(x0)(m(x0, a, 8)) CXX_IF(x1)(m(x1, a, 9))                              \
+  CXX_IF(x2)(m(x2, a, 10)) CXX_IF(x3)(m(x3, a, 11))                            \
+  CXX_IF(x4)(m(x4, a, 12)) CXX_IF(x5)(m(x5, a, 13))                            \
+  CXX_IF(x6)(m(x6, a, 14)) CXX_IF(x7)(m(x7, a, 15))                            \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(2))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_2(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)              \
+  CXX_IF(x0)(m(x0, a, 16)) CXX_IF(x1)(m(x1, a, 17))                            \
+  CXX_IF(x2)(m(x2, a, 18)) CXX_IF(x3)(m(x3, a, 19))                            \
+  CXX_IF(x4)(m(x4, a, 20)) CXX_IF(x5)(m(x5, a, 21))                            \
+  CXX_IF(x6)(m(x6, a, 22)) CXX_IF(x7)(m(x7, a, 23))                            \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(3))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_3(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)              \
+  CXX_IF(x0)(m(x0, a, 24)) CXX_IF(x1)(m(x1, a, 25))                            \
+  CXX_IF(x2)(m(x2, a, 26)) CXX_IF(x3)(m(x3, a, 27))                            \
+  CXX_IF(x4)(m(x4, a, 28)) CXX_IF(x5)(m(x5, a, 29))                            \
+  CXX_IF(x6)(m(x6, a, 30)) CXX_IF(x7)(m(x7, a, 31))                            \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(4))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_4(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)              \
+  CXX_IF(x0)(m(x0, a, 32)) CXX_IF(x1)(m(x1, a, 33))                            \
+  CXX_IF(x2)(m(x2, a, 34)) CXX_IF(x3)(m(x3, a, 35))                            \
+  CXX_IF(x4)(m(x4, a, 36)) CXX_IF(x5)(m(x5, a, 37))                            \
+  CXX_IF(x6)(m(x6, a, 38)) CXX_IF(x7)(m(x7, a, 39))                            \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(5))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_5(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)              \
+  CXX_IF(x0)(m(x0, a, 40)) CXX_IF(x1)(m(x1, a, 41))                            \
+  CXX_IF(x2)(m(x2, a, 42)) CXX_IF(x3)(m(x3, a, 43))                            \
+  CXX_IF(x4)(m(x4, a, 44)) CXX_IF(x5)(m(x5, a, 45))                            \
+  CXX_IF(x6)(m(x6, a, 46)) CXX_IF(x7)(m(x7, a, 47))                            \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(6))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_6(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)              \
+  CXX_IF(x0)(m(x0, a, 48)) CXX_IF(x1)(m(x1, a, 49))                            \
+  CXX_IF(x2)(m(x2, a, 50)) CXX_IF(x3)(m(x3, a, 51))                            \
+  CXX_IF(x4)(m(x4, a, 52)) CXX_IF(x5)(m(x5, a, 53))                            \
+  CXX_IF(x6)(m(x6, a, 54)) CXX_IF(x7)(m(x7, a, 55))                            \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(7))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_7(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)              \
+  CXX_IF(x0)(m(x0, a, 56)) CXX_IF(x1)(m(x1, a, 57))                            \
+  CXX_IF(x2)(m(x2, a, 58)) CXX_IF(x3)(m(x3, a, 59))                            \
+  CXX_IF(x4)(m(x4, a, 60)) CXX_IF(x5)(m(x5, a, 61))                            \
+  CXX_IF(x6)(m(x6, a, 62)) CXX_IF(x7)(m(x7, a, 63))                            \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(8))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_8(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)              \
+  CXX_IF(x0)(m(x0, a, 64)) CXX_IF(x1)(m(x1, a, 65))                            \
+  CXX_IF(x2)(m(x2, a, 66)) CXX_IF(x3)(m(x3, a, 67))                            \
+  CXX_IF(x4)(m(x4, a, 68)) CXX_IF(x5)(m(x5, a, 69))                            \
+  CXX_IF(x6)(m(x6, a, 70)) CXX_IF(x7)(m(x7, a, 71))                            \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(9))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_9(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)              \
+  CXX_IF(x0)(m(x0, a, 72)) CXX_IF(x1)(m(x1, a, 73))                            \
+  CXX_IF(x2)(m(x2, a, 74)) CXX_IF(x3)(m(x3, a, 75))                            \
+  CXX_IF(x4)(m(x4, a, 76)) CXX_IF(x5)(m(x5, a, 77))                            \
+  CXX_IF(x6)(m(x6, a, 78)) CXX_IF(x7)(m(x7, a, 79))                            \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(10))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_10(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)             \
+  CXX_IF(x0)(m(x0, a, 80)) CXX_IF(x1)(m(x1, a, 81))                            \
+  CXX_IF(x2)(m(x2, a, 82)) CXX_IF(x3)(m(x3, a, 83))                            \
+  CXX_IF(x4)(m(x4, a, 84)) CXX_IF(x5)(m(x5, a, 85))                            \
+  CXX_IF(x6)(m(x6, a, 86)) CXX_IF(x7)(m(x7, a, 87))                            \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(11))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_11(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)             \
+  CXX_IF(x0)(m(x0, a, 88)) CXX_IF(x1)(m(x1, a, 89))                            \
+  CXX_IF(x2)(m(x2, a, 90)) CXX_IF(x3)(m(x3, a, 91))                            \
+  CXX_IF(x4)(m(x4, a, 92)) CXX_IF(x5)(m(x5, a, 93))                            \
+  CXX_IF(x6)(m(x6, a, 94)) CXX_IF(x7)(m(x7, a, 95))                            \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(12))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_12(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)             \
+  CXX_IF(x0)(m(x0, a, 96)) CXX_IF(x1)(m(x1, a, 97))                            \
+  CXX_IF(x2)(m(x2, a, 98)) CXX_IF(x3)(m(x3, a, 99))                            \
+  CXX_IF(x4)(m(x4, a, 100)) CXX_IF(x5)(m(x5, a, 101))                          \
+  CXX_IF(x6)(m(x6, a, 102)) CXX_IF(x7)(m(x7, a, 103))                          \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(13))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_13(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)             \
+  CXX_IF(x0)(m(x0, a, 104)) CXX_IF(x1)(m(x1, a, 105))                          \
+  CXX_IF(x2)(m(x2, a, 106)) CXX_IF(x3)(m(x3, a, 107))                          \
+  CXX_IF(x4)(m(x4, a, 108)) CXX_IF(x5)(m(x5, a, 109))                          \
+  CXX_IF(x6)(m(x6, a, 110)) CXX_IF(x7)(m(x7, a, 111))                          \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(14))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_14(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)             \
+  CXX_IF(x0)(m(x0, a, 112)) CXX_IF(x1)(m(x1, a, 113))                          \
+  CXX_IF(x2)(m(x2, a, 114)) CXX_IF(x3)(m(x3, a, 115))                          \
+  CXX_IF(x4)(m(x4, a, 116)) CXX_IF(x5)(m(x5, a, 117))                          \
+  CXX_IF(x6)(m(x6, a, 118)) CXX_IF(x7)(m(x7, a, 119))                          \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(15))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_15(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)             \
+  CXX_IF(x0)(m(x0, a, 120)) CXX_IF(x1)(m(x1, a, 121))                          \
+  CXX_IF(x2)(m(x2, a, 122)) CXX_IF(x3)(m(x3, a, 123))                          \
+  CXX_IF(x4)(m(x4, a, 124)) CXX_IF(x5)(m(x5, a, 125))                          \
+  CXX_IF(x6)(m(x6, a, 126)) CXX_IF(x7)(m(x7, a, 127))                          \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(16))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_16(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)             \
+  CXX_IF(x0)(m(x0, a, 128)) CXX_IF(x1)(m(x1, a, 129))                          \
+  CXX_IF(x2)(m(x2, a, 130)) CXX_IF(x3)(m(x3, a, 131))                          \
+  CXX_IF(x4)(m(x4, a, 132)) CXX_IF(x5)(m(x5, a, 133))                          \
+  CXX_IF(x6)(m(x6, a, 134)) CXX_IF(x7)(m(x7, a, 135))                          \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(17))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_17(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)             \
+  CXX_IF(x0)(m(x0, a, 136)) CXX_IF(x1)(m(x1, a, 137))                          \
+  CXX_IF(x2)(m(x2, a, 138)) CXX_IF(x3)(m(x3, a, 139))                          \
+  CXX_IF(x4)(m(x4, a, 140)) CXX_IF(x5)(m(x5, a, 141))                          \
+  CXX_IF(x6)(m(x6, a, 142)) CXX_IF(x7)(m(x7, a, 143))                          \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(18))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_18(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)             \
+  CXX_IF(x0)(m(x0, a, 144)) CXX_IF(x1)(m(x1, a, 145))                          \
+  CXX_IF(x2)(m(x2, a, 146)) CXX_IF(x3)(m(x3, a, 147))                          \
+  CXX_IF(x4)(m(x4, a, 148)) CXX_IF(x5)(m(x5, a, 149))                          \
+  CXX_IF(x6)(m(x6, a, 150)) CXX_IF(x7)(m(x7, a, 151))                          \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(19))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_19(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)             \
+  CXX_IF(x0)(m(x0, a, 152)) CXX_IF(x1)(m(x1, a, 153))                          \
+  CXX_IF(x2)(m(x2, a, 154)) CXX_IF(x3)(m(x3, a, 155))                          \
+  CXX_IF(x4)(m(x4, a, 156)) CXX_IF(x5)(m(x5, a, 157))                          \
+  CXX_IF(x6)(m(x6, a, 158)) CXX_IF(x7)(m(x7, a, 159))                          \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(20))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_20(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)             \
+  CXX_IF(x0)(m(x0, a, 160)) CXX_IF(x1)(m(x1, a, 161))                          \
+  CXX_IF(x2)(m(x2, a, 162)) CXX_IF(x3)(m(x3, a, 163))                          \
+  CXX_IF(x4)(m(x4, a, 164)) CXX_IF(x5)(m(x5, a, 165))                          \
+  CXX_IF(x6)(m(x6, a, 166)) CXX_IF(x7)(m(x7, a, 167))                          \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(21))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_21(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)             \
+  CXX_IF(x0)(m(x0, a, 168)) CXX_IF(x1)(m(x1, a, 169))                          \
+  CXX_IF(x2)(m(x2, a, 170)) CXX_IF(x3)(m(x3, a, 171))                          \
+  CXX_IF(x4)(m(x4, a, 172)) CXX_IF(x5)(m(x5, a, 173))                          \
+  CXX_IF(x6)(m(x6, a, 174)) CXX_IF(x7)(m(x7, a, 175))                          \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(22))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_22(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)             \
+  CXX_IF(x0)(m(x0, a, 176)) CXX_IF(x1)(m(x1, a, 177))                          \
+  CXX_IF(x2)(m(x2, a, 178)) CXX_IF(x3)(m(x3, a, 179))                          \
+  CXX_IF(x4)(m(x4, a, 180)) CXX_IF(x5)(m(x5, a, 181))                          \
+  CXX_IF(x6)(m(x6, a, 182)) CXX_IF(x7)(m(x7, a, 183))                          \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(23))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_23(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)             \
+  CXX_IF(x0)(m(x0, a, 184)) CXX_IF(x1)(m(x1, a, 185))                          \
+  CXX_IF(x2)(m(x2, a, 186)) CXX_IF(x3)(m(x3, a, 187))                          \
+  CXX_IF(x4)(m(x4, a, 188)) CXX_IF(x5)(m(x5, a, 189))                          \
+  CXX_IF(x6)(m(x6, a, 190)) CXX_IF(x7)(m(x7, a, 191))                          \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(24))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_24(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)             \
+  CXX_IF(x0)(m(x0, a, 192)) CXX_IF(x1)(m(x1, a, 193))                          \
+  CXX_IF(x2)(m(x2, a, 194)) CXX_IF(x3)(m(x3, a, 195))                          \
+  CXX_IF(x4)(m(x4, a, 196)) CXX_IF(x5)(m(x5, a, 197))                          \
+  CXX_IF(x6)(m(x6, a, 198)) CXX_IF(x7)(m(x7, a, 199))                          \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(25))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_25(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)             \
+  CXX_IF(x0)(m(x0, a, 200)) CXX_IF(x1)(m(x1, a, 201))                          \
+  CXX_IF(x2)(m(x2, a, 202)) CXX_IF(x3)(m(x3, a, 203))                          \
+  CXX_IF(x4)(m(x4, a, 204)) CXX_IF(x5)(m(x5, a, 205))                          \
+  CXX_IF(x6)(m(x6, a, 206)) CXX_IF(x7)(m(x7, a, 207))                          \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(26))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_26(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)             \
+  CXX_IF(x0)(m(x0, a, 208)) CXX_IF(x1)(m(x1, a, 209))                          \
+  CXX_IF(x2)(m(x2, a, 210)) CXX_IF(x3)(m(x3, a, 211))                          \
+  CXX_IF(x4)(m(x4, a, 212)) CXX_IF(x5)(m(x5, a, 213))                          \
+  CXX_IF(x6)(m(x6, a, 214)) CXX_IF(x7)(m(x7, a, 215))                          \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(27))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_27(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)             \
+  CXX_IF(x0)(m(x0, a, 216)) CXX_IF(x1)(m(x1, a, 217))                          \
+  CXX_IF(x2)(m(x2, a, 218)) CXX_IF(x3)(m(x3, a, 219))                          \
+  CXX_IF(x4)(m(x4, a, 220)) CXX_IF(x5)(m(x5, a, 221))                          \
+  CXX_IF(x6)(m(x6, a, 222)) CXX_IF(x7)(m(x7, a, 223))                          \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(28))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_28(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)             \
+  CXX_IF(x0)(m(x0, a, 224)) CXX_IF(x1)(m(x1, a, 225))                          \
+  CXX_IF(x2)(m(x2, a, 226)) CXX_IF(x3)(m(x3, a, 227))                          \
+  CXX_IF(x4)(m(x4, a, 228)) CXX_IF(x5)(m(x5, a, 229))                          \
+  CXX_IF(x6)(m(x6, a, 230)) CXX_IF(x7)(m(x7, a, 231))                          \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(29))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_29(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)             \
+  CXX_IF(x0)(m(x0, a, 232)) CXX_IF(x1)(m(x1, a, 233))                          \
+  CXX_IF(x2)(m(x2, a, 234)) CXX_IF(x3)(m(x3, a, 235))                          \
+  CXX_IF(x4)(m(x4, a, 236)) CXX_IF(x5)(m(x5, a, 237))                          \
+  CXX_IF(x6)(m(x6, a, 238)) CXX_IF(x7)(m(x7, a, 239))                          \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(30))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_30(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)             \
+  CXX_IF(x0)(m(x0, a, 240)) CXX_IF(x1)(m(x1, a, 241))                          \
+  CXX_IF(x2)(m(x2, a, 242)) CXX_IF(x3)(m(x3, a, 243))                          \
+  CXX_IF(x4)(m(x4, a, 244)) CXX_IF(x5)(m(x5, a, 245))                          \
+  CXX_IF(x6)(m(x6, a, 246)) CXX_IF(x7)(m(x7, a, 247))                          \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(31))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_31(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)             \
+  CXX_IF(x0)(m(x0, a, 248)) CXX_IF(x1)(m(x1, a, 249))                          \
+  CXX_IF(x2)(m(x2, a, 250)) CXX_IF(x3)(m(x3, a, 251))                          \
+  CXX_IF(x4)(m(x4, a, 252)) CXX_IF(x5)(m(x5, a, 253))                          \
+  CXX_IF(x6)(m(x6, a, 254)) CXX_IF(x7)(m(x7, a, 255))                          \
+  CXX_CAT(CXX_VARIANTS_, CXX_IF(x7)(32))(m, a, __VA_ARGS__)
+#define CXX_VARIANTS_32(m, a, x, ...)                                          \
+  CXX_IF(x)(static_assert(false, "Variants have at most 256 alternatives");)
+#define CXX_VARIANTS_(...)
+
+#define CXX_FIELDS_0(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)                \
+  CXX_IF(x0)(m(x0, a, 0)) CXX_IF(x1)(m(x1, a, 1))                              \
+  CXX_IF(x2)(m(x2, a, 2)) CXX_IF(x3)(m(x3, a, 3))                              \
+  CXX_IF(x4)(m(x4, a, 4)) CXX_IF(x5)(m(x5, a, 5))                              \
+  CXX_IF(x6)(m(x6, a, 6)) CXX_IF(x7)(m(x7, a, 7))                              \
+  CXX_CAT(CXX_FIELDS_, CXX_IF(x7)(1))(m, a, __VA_ARGS__)
+#define CXX_FIELDS_1(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)                \
+  CXX_IF(x0)(m(x0, a, 8)) CXX_IF(x1)(m(x1, a, 9))                              \
+  CXX_IF(x2)(m(x2, a, 10)) CXX_IF(x3)(m(x3, a, 11))                            \
+  CXX_IF(x4)(m(x4, a, 12)) CXX_IF(x5)(m(x5, a, 13))                            \
+  CXX_IF(x6)(m(x6, a, 14)) CXX_IF(x7)(m(x7, a, 15))                            \
+  CXX_CAT(CXX_FIELDS_, CXX_IF(x7)(2))(m, a, __VA_ARGS__)
+#define CXX_FIELDS_2(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)                \
+  CXX_IF(x0)(m(x0, a, 16)) CXX_IF(x1)(m(x1, a, 17))                            \
+  CXX_IF(x2)(m(x2, a, 18)) CXX_IF(x3)(m(x3, a, 19))                            \
+  CXX_IF(x4)(m(x4, a, 20)) CXX_IF(x5)(m(x5, a, 21))                            \
+  CXX_IF(x6)(m(x6, a, 22)) CXX_IF(x7)(m(x7, a, 23))                            \
+  CXX_CAT(CXX_FIELDS_, CXX_IF(x7)(3))(m, a, __VA_ARGS__)
+#define CXX_FIELDS_3(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)                \
+  CXX_IF(x0)(m(x0, a, 24)) CXX_IF(x1)(m(x1, a, 25))                            \
+  CXX_IF(x2)(m(x2, a, 26)) CXX_IF(x3)(m(x3, a, 27))                            \
+  CXX_IF(x4)(m(x4, a, 28)) CXX_IF(x5)(m(x5, a, 29))                            \
+  CXX_IF(x6)(m(x6, a, 30)) CXX_IF(x7)(m(x7, a, 31))                            \
+  CXX_CAT(CXX_FIELDS_, CXX_IF(x7)(4))(m, a, __VA_ARGS__)
+#define CXX_FIELDS_4(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)                \
+  CXX_IF(x0)(m(x0, a, 32)) CXX_IF(x1)(m(x1, a, 33))                            \
+  CXX_IF(x2)(m(x2, a, 34)) CXX_IF(x3)(m(x3, a, 35))                            \
+  CXX_IF(x4)(m(x4, a, 36)) CXX_IF(x5)(m(x5, a, 37))                            \
+  CXX_IF(x6)(m(x6, a, 38)) CXX_IF(x7)(m(x7, a, 39))                            \
+  CXX_CAT(CXX_FIELDS_, CXX_IF(x7)(5))(m, a, __VA_ARGS__)
+#define CXX_FIELDS_5(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)                \
+  CXX_IF(x0)(m(x0, a, 40)) CXX_IF(x1)(m(x1, a, 41))                            \
+  CXX_IF(x2)(m(x2, a, 42)) CXX_IF(x3)(m(x3, a, 43))                            \
+  CXX_IF(x4)(m(x4, a, 44)) CXX_IF(x5)(m(x5, a, 45))                            \
+  CXX_IF(x6)(m(x6, a, 46)) CXX_IF(x7)(m(x7, a, 47))                            \
+  CXX_CAT(CXX_FIELDS_, CXX_IF(x7)(6))(m, a, __VA_ARGS__)
+#define CXX_FIELDS_6(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)                \
+  CXX_IF(x0)(m(x0, a, 48)) CXX_IF(x1)(m(x1, a, 49))                            \
+  CXX_IF(x2)(m(x2, a, 50)) CXX_IF(x3)(m(x3, a, 51))                            \
+  CXX_IF(x4)(m(x4, a, 52)) CXX_IF(x5)(m(x5, a, 53))                            \
+  CXX_IF(x6)(m(x6, a, 54)) CXX_IF(x7)(m(x7, a, 55))                            \
+  CXX_CAT(CXX_FIELDS_, CXX_IF(x7)(7))(m, a, __VA_ARGS__)
+#define CXX_FIELDS_7(m, a, x0, x1, x2, x3, x4, x5, x6, x7, ...)                \
+  CXX_IF(x0)(m(x0, a, 56)) CXX_IF(x1)(m(x1, a, 57))                            \
+  CXX_IF(x2)(m(x2, a, 58)) CXX_IF(x3)(m(x3, a, 59))                            \
+  CXX_IF(x4)(m(x4, a, 60)) CXX_IF(x5)(m(x5, a, 61))                            \
+  CXX_IF(x6)(m(x6, a, 62)) CXX_IF(x7)(m(x7, a, 63))                            \
+  CXX_CAT(CXX_FIELDS_, CXX_IF(x7)(8))(m, a, __VA_ARGS__)
+#define CXX_FIELDS_8(m, a, x, ...)                                             \
+  CXX_IF(x)(static_assert(false, "Tuples have at most 64 fields");)
+#define CXX_FIELDS_(...)
@@ -0,0 +1,658 @@
+/*
+ * Copyright (c) Rachel Powers.
+ *
+ * This source code is licensed under both the MIT license found in the
+ * LICENSE-MIT file in the root directory of this source tree and the Apache
+ * License, Version 2.0 found in the LICENSE-APACHE file in the root directory
+ * of this source tree.
+ */
+
+// cxx_enumext/include/rust/cxx_enumext_optional.h
+
+
+// This file incorporates work submitted as a pull request
+// to the cxx github repository (https://github.com/dtolnay/cxx/pull/1328)
+// and is covered by the following copyright and permission notice:
+//
+//  Copyright 2024 Dima Dorezyuk
+//
+//  Licensed under either of Apache License [1], Version 2.0 or MIT license [2]
+//  at your option.
+//
+//  [1] https://github.com/dtolnay/cxx/blob/master/LICENSE-APACHE
+//  [2] https://github.com/dtolnay/cxx/blob/master/LICENSE-MIT
+//
+
+// The bindings of Rust's `Option<T>`: `optional`, a `std::optional` like
+// tagged union, and `nullable`, which has the size of `T` for the types
+// where Rust encodes `None` in a niche of `T`.
+
+#ifndef RUST_CXX_ENUMEXT_OPTIONAL_H
+#define RUST_CXX_ENUMEXT_OPTIONAL_H
+
+#include "cxx_enumext_core.h"
+
+#include <cstring>
+#include <functional>
+#include <optional>
+
+// =================================================
+//
+// std::optional like binding for Rust Option<T>
+//
+// =================================================
+
+namespace rust {
+namespace enm {
+
+template <typename T> struct optional;
+
+namespace detail {
+template <class T> struct is_std_optional_impl : std::false_type {};
+template <class T>
+struct is_std_optional_impl<std::optional<T>> : std::true_type {};
+template <class T>
+using is_std_optional = is_std_optional_impl<std::decay_t<T>>;
+
+template <class T> struct is_rust_optional_impl : std::false_type {};
+template <class T>
+struct is_rust_optional_impl<optional<T>> : std::true_type {};
+template <class T>
+using is_rust_optional = is_rust_optional_impl<std::decay_t<T>>;
+} // namespace detail
+
+/// @brief Thrown by `value()` of an empty optional. Doesn't allocate.
+struct bad_rust_optional_access : std::bad_optional_access {
+  const char *what() const noexcept override {
+    return "Optional has no value";
+  }
+};
+
+template <typename T> struct optional : public variant<monostate, T> {
+  using base = variant<monostate, T>;
+
+  optional() : base(monostate{}) {};
+  optional(std::nullopt_t) : base(monostate{}) {};
+  optional(const optional &) = default;
+  optional(optional &&) = default;
+
+  optional &operator=(const optional &) = default;
+  optional &operator=(optional &&) = default;
+
+  using base::base;
+  using base::operator=;
+
+  using Some = T;
+  using None = monostate;
+
+  constexpr explicit operator bool() { return this->m_Index == 1; }
+  constexpr bool has_value() const noexcept { return this->m_Index == 1; }
+  constexpr bool is_some() const noexcept { return this->m_Index == 1; }
+  constexpr bool is_none() const noexcept { return this->m_Index == 0; }
+
+  /// @brief returns the contined value
+  ///
+  /// if `*this` contains a value returns a refrence. Otherwise throws
+  /// bad_rust_optional_access
+  /// @throws bad_rust_optional_access
+  constexpr T &value() & {
+    if (has_value()) {
+      return get_unchecked<1>(*this);
+    } else {
+      detail::bad_access<bad_rust_optional_access>("Optional has no value");
+    }
+  }
+
+  /// @brief returns the contined value
+  ///
+  /// if `*this` contains a value returns a refrence. Otherwise throws
+  /// bad_rust_optional_access
+  /// @throws bad_rust_optional_access
+  constexpr const T &value() const & {
+    if (has_value()) {
+      return get_unchecked<1>(*this);
+    } else {
+      detail::bad_access<bad_rust_optional_access>("Optional has no value");
+    }
+  }
+
+  /// @brief resets the optional to an empty state
+  ///
+  /// if `has_value()` is true first calls the deconstructor
+  constexpr void reset() noexcept {
+    if (has_value()) {
+      this->destroy();
+      *this = monostate{};
+    }
+  }
+
+  /// @brief Accesses the contained value without checking that it exists.
+  /// The behavior is undefined if it doesn't.
+  constexpr const T *operator->() const noexcept {
+    return detail::address_of(get_unchecked<1>(*this));
+  }
+  constexpr T *operator->() noexcept {
+    return detail::address_of(get_unchecked<1>(*this));
+  }
+  constexpr const T &operator*() const & noexcept {
+    return get_unchecked<1>(*this);
+  }
+  constexpr T &operator*() & noexcept {
+    return get_unchecked<1>(*this);
+  }
+  constexpr T &&operator*() && noexcept {
+    return std::move(get_unchecked<1>(*this));
+  }
+
+  /// @brief returns the contined value, moved out of `*this`
+  ///
+  /// @throws bad_rust_optional_access
+  constexpr T &&value() && {
+    if (!has_value()) {
+      detail::bad_access<bad_rust_optional_access>("Optional has no value");
+    }
+    return std::move(**this);
+  }
+
+  template <class U = std::remove_cv_t<T>>
+  constexpr T value_or(U &&default_value) const & {
+    return has_value() ? get_unchecked<1>(*this)
+                       : static_cast<T>(std::forward<U>(default_value));
+  }
+
+  /// @brief Like the `const &` overload but moves the contained value out
+  template <class U = std::remove_cv_t<T>>
+  constexpr T value_or(U &&default_value) && {
+    return has_value() ? std::move(**this)
+                       : static_cast<T>(std::forward<U>(default_value));
+  }
+
+  template <class F> constexpr auto and_then(F &&f) & {
+    using result = std::invoke_result_t<F, T &>;
+    static_assert(detail::is_std_optional<result>::value ||
+                      detail::is_rust_optional<result>::value,
+                  "F must return an std::optional or rust::variant::optional");
+    return (has_value()) ? std::invoke(std::forward<F>(f), value()) : result{};
+  }
+
+  template <class F> constexpr auto and_then(F &&f) const & {
+    using result = std::invoke_result_t<F, const T &>;
+    static_assert(detail::is_std_optional<result>::value ||
+                      detail::is_rust_optional<result>::value,
+                  "F must return an std::optional or rust::variant::optional");
+    return (has_value()) ? std::invoke(std::forward<F>(f), value()) : result{};
+  }
+
+  /// @brief Passes the contained value to `f` as an rvalue
+  template <class F> constexpr auto and_then(F &&f) && {
+    using result = std::invoke_result_t<F, T &&>;
+    static_assert(detail::is_std_optional<result>::value ||
+                      detail::is_rust_optional<result>::value,
+                  "F must return an std::optional or rust::variant::optional");
+    return (has_value()) ? std::invoke(std::forward<F>(f), std::move(**this))
+                         : result{};
+  }
+
+  /// @brief Returns an optional holding the result of `f` on the contained
+  /// value, or an empty optional
+  template <class F> constexpr auto transform(F &&f) & {
+    using result = optional<std::remove_cv_t<std::invoke_result_t<F, T &>>>;
+    return has_value() ? result(std::in_place_index<1>,
+                                std::invoke(std::forward<F>(f), **this))
+                       : result();
+  }
+
+  template <class F> constexpr auto transform(F &&f) const & {
+    using result =
+        optional<std::remove_cv_t<std::invoke_result_t<F, const T &>>>;
+    return has_value() ? result(std::in_place_index<1>,
+                                std::invoke(std::forward<F>(f), **this))
+                       : result();
+  }
+
+  /// @brief Passes the contained value to `f` as an rvalue
+  template <class F> constexpr auto transform(F &&f) && {
+    using result = optional<std::remove_cv_t<std::invoke_result_t<F, T &&>>>;
+    return has_value()
+               ? result(std::in_place_index<1>,
+                        std::invoke(std::forward<F>(f), std::move(**this)))
+               : result();
+  }
+
+  /// @brief Returns a copy of `*this` if it has a value, otherwise the result
+  /// of `f()`
+  template <class F> constexpr optional or_else(F &&f) const & {
+    static_assert(
+        std::is_same_v<std::decay_t<std::invoke_result_t<F>>, optional>,
+        "F must return a rust::variant::optional of the same type");
+    return has_value() ? *this : std::invoke(std::forward<F>(f));
+  }
+
+  /// @brief Like the `const &` overload but moves `*this`
+  template <class F> constexpr optional or_else(F &&f) && {
+    static_assert(
+        std::is_same_v<std::decay_t<std::invoke_result_t<F>>, optional>,
+        "F must return a rust::variant::optional of the same type");
+    return has_value() ? std::move(*this) : std::invoke(std::forward<F>(f));
+  }
+
+  using IsRelocatable = ::std::true_type;
+};
+
+/// Compares two optional objects
+template <class T, class U>
+inline constexpr bool operator==(const optional<T> &lhs,
+                                 const optional<U> &rhs) {
+  return lhs.has_value() == rhs.has_value() &&
+         (!lhs.has_value() || *lhs == *rhs);
+}
+template <class T, class U>
+inline constexpr bool operator!=(const optional<T> &lhs,
+                                 const optional<U> &rhs) {
+  return lhs.has_value() != rhs.has_value() ||
+         (lhs.has_value() && *lhs != *rhs);
+}
+template <class T, class U>
+inline constexpr bool operator<(const optional<T> &lhs,
+                                const optional<U> &rhs) {
+  return rhs.has_value() && (!lhs.has_value() || *lhs < *rhs);
+}
+template <class T, class U>
+inline constexpr bool operator>(const optional<T> &lhs,
+                                const optional<U> &rhs) {
+  return lhs.has_value() && (!rhs.has_value() || *lhs > *rhs);
+}
+template <class T, class U>
+inline constexpr bool operator<=(const optional<T> &lhs,
+                                 const optional<U> &rhs) {
+  return !lhs.has_value() || (rhs.has_value() && *lhs <= *rhs);
+}
+template <class T, class U>
+inline constexpr bool operator>=(const optional<T> &lhs,
+                                 const optional<U> &rhs) {
+  return !rhs.has_value() || (lhs.has_value() && *lhs >= *rhs);
+}
+
+/// Compares an optional to a `nullopt`
+template <class T>
+inline constexpr bool operator==(const optional<T> &lhs,
+                                 std::nullopt_t) noexcept {
+  return !lhs.has_value();
+}
+template <class T>
+inline constexpr bool operator==(std::nullopt_t,
+                                 const optional<T> &rhs) noexcept {
+  return !rhs.has_value();
+}
+template <class T>
+inline constexpr bool operator!=(const optional<T> &lhs,
+                                 std::nullopt_t) noexcept {
+  return lhs.has_value();
+}
+template <class T>
+inline constexpr bool operator!=(std::nullopt_t,
+                                 const optional<T> &rhs) noexcept {
+  return rhs.has_value();
+}
+template <class T>
+inline constexpr bool operator<(const optional<T> &, std::nullopt_t) noexcept {
+  return false;
+}
+template <class T>
+inline constexpr bool operator<(std::nullopt_t,
+                                const optional<T> &rhs) noexcept {
+  return rhs.has_value();
+}
+template <class T>
+inline constexpr bool operator<=(const optional<T> &lhs,
+                                 std::nullopt_t) noexcept {
+  return !lhs.has_value();
+}
+template <class T>
+inline constexpr bool operator<=(std::nullopt_t, const optional<T> &) noexcept {
+  return true;
+}
+template <class T>
+inline constexpr bool operator>(const optional<T> &lhs,
+                                std::nullopt_t) noexcept {
+  return lhs.has_value();
+}
+template <class T>
+inline constexpr bool operator>(std::nullopt_t, const optional<T> &) noexcept {
+  return false;
+}
+template <class T>
+inline constexpr bool operator>=(const optional<T> &, std::nullopt_t) noexcept {
+  return true;
+}
+template <class T>
+inline constexpr bool operator>=(std::nullopt_t,
+                                 const optional<T> &rhs) noexcept {
+  return !rhs.has_value();
+}
+
+/// Compares the optional with a value.
+template <class T, class U>
+inline constexpr bool operator==(const optional<T> &lhs, const U &rhs) {
+  return lhs.has_value() ? *lhs == rhs : false;
+}
+template <class T, class U>
+inline constexpr bool operator==(const U &lhs, const optional<T> &rhs) {
+  return rhs.has_value() ? lhs == *rhs : false;
+}
+template <class T, class U>
+inline constexpr bool operator!=(const optional<T> &lhs, const U &rhs) {
+  return lhs.has_value() ? *lhs != rhs : true;
+}
+template <class T, class U>
+inline constexpr bool operator!=(const U &lhs, const optional<T> &rhs) {
+  return rhs.has_value() ? lhs != *rhs : true;
+}
+template <class T, class U>
+inline constexpr bool operator<(const optional<T> &lhs, const U &rhs) {
+  return lhs.has_value() ? *lhs < rhs : true;
+}
+template <class T, class U>
+inline constexpr bool operator<(const U &lhs, const optional<T> &rhs) {
+  return rhs.has_value() ? lhs < *rhs : false;
+}
+template <class T, class U>
+inline constexpr bool operator<=(const optional<T> &lhs, const U &rhs) {
+  return lhs.has_value() ? *lhs <= rhs : true;
+}
+template <class T, class U>
+inline constexpr bool operator<=(const U &lhs, const optional<T> &rhs) {
+  return rhs.has_value() ? lhs <= *rhs : false;
+}
+template <class T, class U>
+inline constexpr bool operator>(const optional<T> &lhs, const U &rhs) {
+  return lhs.has_value() ? *lhs > rhs : false;
+}
+template <class T, class U>
+inline constexpr bool operator>(const U &lhs, const optional<T> &rhs) {
+  return rhs.has_value() ? lhs > *rhs : true;
+}
+template <class T, class U>
+inline constexpr bool operator>=(const optional<T> &lhs, const U &rhs) {
+  return lhs.has_value() ? *lhs >= rhs : false;
+}
+template <class T, class U>
+inline constexpr bool operator>=(const U &lhs, const optional<T> &rhs) {
+  return rhs.has_value() ? lhs >= *rhs : true;
+}
+
+template <class T>
+constexpr optional<std::decay_t<T>> make_optional(T &&value) {
+  return optional<std::decay_t<T>>(std::forward<T>(value));
+}
+
+} // namespace enm
+} // namespace rust
+
+// =================================================
+//
+// Niche optimized binding for Rust Option<T>
+//
+// =================================================
+
+namespace rust {
+inline namespace cxxbridge1 {
+template <typename T> class Box;
+} // namespace cxxbridge1
+
+namespace enm {
+
+/// @brief Describes how Rust encodes `None` in the bytes of `T` for the types
+/// where `Option<T>` has the same size as `T` (the "niche" optimization).
+///
+/// Rust documents this for `Box<T>`, `&T` and the `NonZero` integers, with
+/// `None` as all zero bytes. For `bool` it is only what rustc does today, so
+/// the Rust side of every `nullable` asserts the size, and for `bool` the
+/// value of `None`, at compile time.
+///
+/// Specializations provide `is_none(const std::byte *)` and
+/// `set_none(std::byte *)` working on `sizeof(T)` bytes.
+template <typename T> struct niche_traits;
+
+namespace detail {
+
+/// @brief Niche of types which can never be all zero bytes, e.g. non-null
+/// pointers.
+template <typename T> struct zero_niche {
+  static bool is_none(const std::byte *data) noexcept {
+    constexpr std::byte zero[sizeof(T)] = {};
+    return std::memcmp(data, zero, sizeof(T)) == 0;
+  }
+
+  static void set_none(std::byte *data) noexcept {
+    std::memset(data, 0, sizeof(T));
+  }
+};
+
+} // namespace detail
+
+template <typename T>
+struct niche_traits<::rust::Box<T>> : detail::zero_niche<::rust::Box<T>> {};
+
+template <typename T>
+struct niche_traits<std::reference_wrapper<T>>
+    : detail::zero_niche<std::reference_wrapper<T>> {};
+
+template <typename T>
+struct niche_traits<nonzero<T>> : detail::zero_niche<nonzero<T>> {};
+
+/// @brief rustc stores `None` of `Option<bool>` as 2. This is not a
+/// documented guarantee.
+template <> struct niche_traits<bool> {
+  static bool is_none(const std::byte *data) noexcept {
+    return *data == std::byte{2};
+  }
+
+  static void set_none(std::byte *data) noexcept { *data = std::byte{2}; }
+};
+
+namespace detail {
+
+/// @brief Storage of a `nullable`. Trivially copyable types are copied
+/// bitwise, everything else is copied through `T` and moved by relocating
+/// the bytes and marking the source as `None`.
+template <typename T, bool Trivial = std::is_trivially_copyable_v<T>>
+struct nullable_storage {
+  nullable_storage() noexcept { niche_traits<T>::set_none(m_Buff); }
+
+  nullable_storage(const nullable_storage &other) : nullable_storage() {
+    if (!niche_traits<T>::is_none(other.m_Buff)) {
+      new (static_cast<void *>(m_Buff))
+          T(*reinterpret_cast<const T *>(other.m_Buff));
+    }
+  }
+
+  nullable_storage(nullable_storage &&other) noexcept {
+    std::memcpy(m_Buff, other.m_Buff, sizeof(T));
+    niche_traits<T>::set_none(other.m_Buff);
+  }
+
+  nullable_storage &operator=(const nullable_storage &other) {
+    if (this != &other) {
+      reset();
+      if (!niche_traits<T>::is_none(other.m_Buff)) {
+        new (static_cast<void *>(m_Buff))
+            T(*reinterpret_cast<const T *>(other.m_Buff));
+      }
+    }
+    return *this;
+  }
+
+  nullable_storage &operator=(nullable_storage &&other) noexcept {
+    if (this != &other) {
+      reset();
+      std::memcpy(m_Buff, other.m_Buff, sizeof(T));
+      niche_traits<T>::set_none(other.m_Buff);
+    }
+    return *this;
+  }
+
+  ~nullable_storage() { reset(); }
+
+  void reset() noexcept {
+    if (!niche_traits<T>::is_none(m_Buff)) {
+      reinterpret_cast<T *>(m_Buff)->~T();
+      niche_traits<T>::set_none(m_Buff);
+    }
+  }
+
+  alignas(T) std::byte m_Buff[sizeof(T)];
+};
+
+template <typename T> struct nullable_storage<T, true> {
+  nullable_storage() noexcept { niche_traits<T>::set_none(m_Buff); }
+
+  void reset() noexcept { niche_traits<T>::set_none(m_Buff); }
+
+  alignas(T) std::byte m_Buff[sizeof(T)];
+};
+
+} // namespace detail
+
+/// @brief A std::optional like binding for Rust's `Option<T>` where `T` has a
+/// niche (`Box<T>`, `&T`, `NonZero` integers and `bool`).
+///
+/// Unlike `optional<T>` there is no separate tag: `None` is encoded in the
+/// bytes of `T` as described by `niche_traits<T>`, so `nullable<T>` has the
+/// same size as `T`.
+template <typename T>
+struct nullable : private detail::nullable_storage<T>, private allow_copy<T> {
+  using traits = niche_traits<T>;
+
+  nullable() noexcept = default;
+  nullable(std::nullopt_t) noexcept {}
+  nullable(const nullable &) = default;
+  nullable(nullable &&) = default;
+
+  template <typename U = T,
+            typename = std::enable_if_t<
+                std::is_constructible_v<T, U &&> &&
+                !std::is_same_v<std::decay_t<U>, nullable> &&
+                !std::is_same_v<std::decay_t<U>, std::nullopt_t> &&
+                !std::is_same_v<std::decay_t<U>, std::in_place_t>>>
+  nullable(U &&value) noexcept(std::is_nothrow_constructible_v<T, U &&>) {
+    construct(std::forward<U>(value));
+  }
+
+  template <typename... Args,
+            typename = std::enable_if_t<std::is_constructible_v<T, Args...>>>
+  explicit nullable(std::in_place_t, Args &&...args) noexcept(
+      std::is_nothrow_constructible_v<T, Args...>) {
+    construct(std::forward<Args>(args)...);
+  }
+
+  nullable &operator=(const nullable &) = default;
+  nullable &operator=(nullable &&) = default;
+
+  nullable &operator=(std::nullopt_t) noexcept {
+    reset();
+    return *this;
+  }
+
+  template <typename U = T,
+            typename = std::enable_if_t<
+                std::is_constructible_v<T, U &&> &&
+                std::is_assignable_v<T &, U &&> &&
+                !std::is_same_v<std::decay_t<U>, nullable> &&
+                !std::is_same_v<std::decay_t<U>, std::nullopt_t>>>
+  nullable &operator=(U &&value) {
+    if (has_value()) {
+      **this = std::forward<U>(value);
+    } else {
+      emplace(std::forward<U>(value));
+    }
+    return *this;
+  }
+
+  using Some = T;
+  using None = monostate;
+
+  constexpr explicit operator bool() const noexcept { return has_value(); }
+  constexpr bool has_value() const noexcept {
+    return !traits::is_none(this->m_Buff);
+  }
+  constexpr bool is_some() const noexcept { return has_value(); }
+  constexpr bool is_none() const noexcept { return !has_value(); }
+
+  /// @brief returns the contined value
+  ///
+  /// if `*this` contains a value returns a refrence. Otherwise throws
+  /// bad_rust_optional_access
+  /// @throws bad_rust_optional_access
+  T &value() & {
+    if (!has_value()) {
+      detail::bad_access<bad_rust_optional_access>("Optional has no value");
+    }
+    return **this;
+  }
+
+  /// @brief returns the contined value
+  ///
+  /// if `*this` contains a value returns a refrence. Otherwise throws
+  /// bad_rust_optional_access
+  /// @throws bad_rust_optional_access
+  const T &value() const & {
+    if (!has_value()) {
+      detail::bad_access<bad_rust_optional_access>("Optional has no value");
+    }
+    return **this;
+  }
+
+  /// @brief Accesses the contained value without checking that it exists.
+  /// The behavior is undefined if it doesn't.
+  const T *operator->() const noexcept {
+    return reinterpret_cast<const T *>(this->m_Buff);
+  }
+  T *operator->() noexcept { return reinterpret_cast<T *>(this->m_Buff); }
+  const T &operator*() const & noexcept {
+    return *reinterpret_cast<const T *>(this->m_Buff);
+  }
+  T &operator*() & noexcept { return *reinterpret_cast<T *>(this->m_Buff); }
+
+  template <class U = std::remove_cv_t<T>>
+  T value_or(U &&default_value) const & {
+    return has_value() ? **this
+                       : static_cast<T>(std::forward<U>(default_value));
+  }
+
+  /// @brief resets the nullable to `None`, destroying the contained value
+  void reset() noexcept { detail::nullable_storage<T>::reset(); }
+
+  /// @brief Destroys the contained value (if any) and constructs a new one
+  /// from `args`. The nullable is `None` if the construction throws.
+  template <typename... Args,
+            typename = std::enable_if_t<std::is_constructible_v<T, Args...>>>
+  T &emplace(Args &&...args) {
+    reset();
+    construct(std::forward<Args>(args)...);
+    return **this;
+  }
+
+  using IsRelocatable = ::std::true_type;
+
+private:
+  /// @brief Constructs the value over `None`. `T` may have written over the
+  /// niche before throwing, so the bytes are set back to `None`.
+  template <typename... Args> void construct(Args &&...args) {
+#if CXX_ENUMEXT_EXCEPTIONS
+    try {
+      new (static_cast<void *>(this->m_Buff)) T(std::forward<Args>(args)...);
+    } catch (...) {
+      traits::set_none(this->m_Buff);
+      throw;
+    }
+#else
+    new (static_cast<void *>(this->m_Buff)) T(std::forward<Args>(args)...);
+#endif
+  }
+};
+
+} // namespace enm
+} // namespace rust
+
+#endif
@@ -0,0 +1,923 @@
+/*
+ * Copyright (c) Rachel Powers.
+ *
+ * This source code is licensed under both the MIT license found in the
+ * LICENSE-MIT file in the root directory of this source tree and the Apache
+ * License, Version 2.0 found in the LICENSE-APACHE file in the root directory
+ * of this source tree.
+ */
+
+// cxx_enumext/include/rust/cxx_enumext_ranges.h
+
+// Works on many enums at once: `soa_vector`, which stores them as a struct
+// of arrays, and the tag scanning and grouped visitation kernels over
+// contiguous ranges of them.
+
+#ifndef RUST_CXX_ENUMEXT_RANGES_H
+#define RUST_CXX_ENUMEXT_RANGES_H
+
+#include "cxx_enumext_core.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+// Selects the instruction set of the tag scanning kernels (e.g.
+// `count_alternatives`):
+//
+// - CXX_ENUMEXT_SIMD_NONE: portable scalar loops.
+// - CXX_ENUMEXT_SIMD_SSE4: SSE4.1, four tags per step.
+// - CXX_ENUMEXT_SIMD_AVX2: AVX2 gathers, eight tags per step.
+//
+// The default is the best one enabled for the target (e.g. with `-mavx2`).
+// Define CXX_ENUMEXT_SIMD to one of the values before including this header
+// to override it.
+#define CXX_ENUMEXT_SIMD_NONE 0
+#define CXX_ENUMEXT_SIMD_SSE4 1
+#define CXX_ENUMEXT_SIMD_AVX2 2
+
+#ifndef CXX_ENUMEXT_SIMD
+#if defined(__AVX2__)
+#define CXX_ENUMEXT_SIMD CXX_ENUMEXT_SIMD_AVX2
+#elif defined(__SSE4_1__)
+#define CXX_ENUMEXT_SIMD CXX_ENUMEXT_SIMD_SSE4
+#else
+#define CXX_ENUMEXT_SIMD CXX_ENUMEXT_SIMD_NONE
+#endif
+#endif
+
+#if CXX_ENUMEXT_SIMD == CXX_ENUMEXT_SIMD_AVX2
+#include <immintrin.h>
+#define CXX_ENUMEXT_SIMD_NAMESPACE simd_avx2
+#elif CXX_ENUMEXT_SIMD == CXX_ENUMEXT_SIMD_SSE4
+#include <smmintrin.h>
+#define CXX_ENUMEXT_SIMD_NAMESPACE simd_sse4
+#else
+#define CXX_ENUMEXT_SIMD_NAMESPACE simd_none
+#endif
+
+// The kernels of every instruction set live in an inline namespace of their
+// own, so translation units built for different ones (e.g. one file built
+// with `-mavx2` behind a CPU check) can be linked into one program.
+
+// =================================================
+//
+// Struct of arrays container for Rust enums
+//
+// =================================================
+
+namespace rust {
+namespace enm {
+
+/// @brief A view over contiguous elements, the subset of C++20's `std::span`
+/// used by `soa_vector`.
+template <typename T> class span {
+public:
+  constexpr span() noexcept = default;
+  constexpr span(T *data, std::size_t size) noexcept
+      : m_Data(data), m_Size(size) {}
+
+  constexpr T *data() const noexcept { return m_Data; }
+  constexpr std::size_t size() const noexcept { return m_Size; }
+  constexpr bool empty() const noexcept { return m_Size == 0; }
+
+  constexpr T *begin() const noexcept { return m_Data; }
+  constexpr T *end() const noexcept { return m_Data + m_Size; }
+
+  constexpr T &operator[](std::size_t index) const noexcept {
+    return m_Data[index];
+  }
+
+private:
+  T *m_Data = nullptr;
+  std::size_t m_Size = 0;
+};
+
+namespace detail {
+
+template <typename Result, typename Function, std::size_t I>
+constexpr Result invoke_with_index(Function &&function) {
+  if constexpr (std::is_void_v<Result>) {
+    std::forward<Function>(function)(std::integral_constant<std::size_t, I>{});
+  } else {
+    return std::forward<Function>(function)(
+        std::integral_constant<std::size_t, I>{});
+  }
+}
+
+/// @brief Table of `invoke_with_index` instantiations, turning a runtime
+/// index into a `std::integral_constant` with one indirect call.
+template <typename Result, typename Function, typename Is> struct index_table;
+
+template <typename Result, typename Function, std::size_t... Is>
+struct index_table<Result, Function, std::index_sequence<Is...>> {
+  constexpr static Result (*value[])(Function &&) = {
+      &invoke_with_index<Result, Function, Is>...};
+};
+
+/// @brief Calls `function` with `std::integral_constant<std::size_t, index>`.
+/// The result is the one for index 0.
+template <std::size_t N, typename Function>
+constexpr decltype(auto) with_index(std::size_t index, Function &&function) {
+  using result = std::invoke_result_t<Function,
+                                      std::integral_constant<std::size_t, 0>>;
+  return index_table<result, Function, std::make_index_sequence<N>>::value
+      [index](std::forward<Function>(function));
+}
+
+/// @brief `std::vector<bool>` is not contiguous, so `soa_vector` stores bools
+/// in this minimal vector of real `bool` objects instead.
+class bool_vector {
+public:
+  bool_vector() = default;
+  bool_vector(const bool_vector &other) { *this = other; }
+  bool_vector(bool_vector &&other) noexcept { *this = std::move(other); }
+
+  bool_vector &operator=(const bool_vector &other) {
+    if (this != &other) {
+      bool_vector copy;
+      copy.reserve(other.m_Size);
+      std::copy_n(other.data(), other.m_Size, copy.data());
+      copy.m_Size = other.m_Size;
+      *this = std::move(copy);
+    }
+    return *this;
+  }
+
+  bool_vector &operator=(bool_vector &&other) noexcept {
+    m_Data = std::move(other.m_Data);
+    m_Size = std::exchange(other.m_Size, 0);
+    m_Capacity = std::exchange(other.m_Capacity, 0);
+    return *this;
+  }
+
+  bool *data() noexcept { return m_Data.get(); }
+  const bool *data() const noexcept { return m_Data.get(); }
+  std::size_t size() const noexcept { return m_Size; }
+  void clear() noexcept { m_Size = 0; }
+
+  void reserve(std::size_t capacity) {
+    if (capacity > m_Capacity) {
+      std::unique_ptr<bool[]> data(new bool[capacity]);
+      std::copy_n(m_Data.get(), m_Size, data.get());
+      m_Data = std::move(data);
+      m_Capacity = capacity;
+    }
+  }
+
+  template <typename... Args> bool &emplace_back(Args &&...args) {
+    const bool value = bool(std::forward<Args>(args)...);
+    if (m_Size == m_Capacity) {
+      reserve(std::max<std::size_t>(2 * m_Capacity, 8));
+    }
+    return m_Data[m_Size++] = value;
+  }
+
+private:
+  std::unique_ptr<bool[]> m_Data;
+  std::size_t m_Size = 0;
+  std::size_t m_Capacity = 0;
+};
+
+template <typename T>
+using soa_column_t =
+    std::conditional_t<std::is_same_v<T, bool>, bool_vector, std::vector<T>>;
+
+} // namespace detail
+
+template <typename Variant, typename Base = std::remove_const_t<
+                               detail::variant_base_of_t<Variant>>>
+class soa_vector;
+
+/// @brief A vector of `Variant` stored as a struct of arrays.
+///
+/// The tags (the variants' `index()`) are stored in a dense array and the
+/// alternatives in one column per alternative, so scanning the tags does not
+/// touch the payloads and every alternative can be processed as a contiguous
+/// array. A second array maps every element to its row in its column.
+///
+/// `Variant` is a variant, optional or expected - or a type declared with the
+/// `CXX_DEFINE_*` macros.
+template <typename Variant, typename Tag, typename... Ts>
+class soa_vector<Variant, basic_variant_base<Tag, Ts...>> {
+public:
+  using value_type = Variant;
+  using tag_type = Tag;
+
+  template <std::size_t I>
+  using alternative_t = variant_alternative_t<I, Ts...>;
+
+  soa_vector() = default;
+
+  /// @brief Copies the variants in [first, last).
+  template <typename InputIt> soa_vector(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+      push_back(*first);
+    }
+  }
+
+  std::size_t size() const noexcept { return m_Tags.size(); }
+  bool empty() const noexcept { return m_Tags.empty(); }
+
+  void reserve(std::size_t capacity) {
+    m_Tags.reserve(capacity);
+    m_Rows.reserve(capacity);
+  }
+
+  void clear() noexcept {
+    m_Tags.clear();
+    m_Rows.clear();
+    std::apply([](auto &...columns) { (columns.clear(), ...); }, m_Columns);
+  }
+
+  void push_back(const Variant &value) {
+    detail::with_index<sizeof...(Ts)>(value.index(), [&](auto index) {
+      emplace_back<index>(get_unchecked<index>(value));
+    });
+  }
+
+  void push_back(Variant &&value) {
+    detail::with_index<sizeof...(Ts)>(value.index(), [&](auto index) {
+      emplace_back<index>(std::move(get_unchecked<index>(value)));
+    });
+  }
+
+  /// @brief Appends an element holding the alternative `I` constructed from
+  /// `args`. Offers strong exception guarantee.
+  template <std::size_t I, typename... Args>
+  alternative_t<I> &emplace_back(Args &&...args) {
+    static_assert(I < sizeof...(Ts), "Invalid index");
+
+    if (m_Tags.size() == m_Tags.capacity()) {
+      reserve(std::max<std::size_t>(2 * m_Tags.size(), 8));
+    }
+    auto &column = std::get<I>(m_Columns);
+    column.emplace_back(std::forward<Args>(args)...);
+
+    // Can't throw after the reserve above.
+    m_Tags.push_back(static_cast<Tag>(I));
+    m_Rows.push_back(column.size() - 1);
+    return column_data<I>()[column.size() - 1];
+  }
+
+  /// @brief The index of every element's alternative.
+  span<const Tag> tags() const noexcept {
+    return {m_Tags.data(), m_Tags.size()};
+  }
+
+  /// @brief The `I`-th alternative of all elements holding it, in order.
+  template <std::size_t I> span<alternative_t<I>> column() noexcept {
+    return {column_data<I>(), count<I>()};
+  }
+
+  template <std::size_t I>
+  span<const alternative_t<I>> column() const noexcept {
+    return {column_data<I>(), count<I>()};
+  }
+
+  template <typename T,
+            typename = std::enable_if_t<
+                exactly_once<std::is_same_v<Ts, std::decay_t<T>>...>::value>>
+  span<T> column() noexcept {
+    return column<index_from_type<T, Ts...>::value>();
+  }
+
+  template <typename T,
+            typename = std::enable_if_t<
+                exactly_once<std::is_same_v<Ts, std::decay_t<T>>...>::value>>
+  span<const T> column() const noexcept {
+    return column<index_from_type<T, Ts...>::value>();
+  }
+
+  /// @brief The number of elements holding the alternative `I`.
+  template <std::size_t I> std::size_t count() const noexcept {
+    return std::get<I>(m_Columns).size();
+  }
+
+  /// @brief Applies the visitor to the alternative of the element at
+  /// `position`.
+  template <typename Visitor>
+  decltype(auto) visit(Visitor &&visitor, std::size_t position) {
+    return detail::with_index<sizeof...(Ts)>(
+        m_Tags[position], [&](auto index) -> decltype(auto) {
+          return std::forward<Visitor>(visitor)(
+              column_data<index>()[m_Rows[position]]);
+        });
+  }
+
+  template <typename Visitor>
+  decltype(auto) visit(Visitor &&visitor, std::size_t position) const {
+    return detail::with_index<sizeof...(Ts)>(
+        m_Tags[position], [&](auto index) -> decltype(auto) {
+          return std::forward<Visitor>(visitor)(
+              column_data<index>()[m_Rows[position]]);
+        });
+  }
+
+  /// @brief Copies the element at `position` back into a `Variant`.
+  Variant to_variant(std::size_t position) const {
+    return detail::with_index<sizeof...(Ts)>(
+        m_Tags[position], [&](auto index) {
+          return Variant(std::in_place_index<index>,
+                         column_data<index>()[m_Rows[position]]);
+        });
+  }
+
+  /// @brief Copies all elements, in order, to `out`.
+  template <typename OutputIt> OutputIt copy_to(OutputIt out) const {
+    for (std::size_t i = 0; i < size(); ++i) {
+      *out++ = to_variant(i);
+    }
+    return out;
+  }
+
+  std::vector<Variant> to_vector() const {
+    std::vector<Variant> result;
+    result.reserve(size());
+    copy_to(std::back_inserter(result));
+    return result;
+  }
+
+private:
+  template <std::size_t I> alternative_t<I> *column_data() noexcept {
+    return std::get<I>(m_Columns).data();
+  }
+
+  template <std::size_t I>
+  const alternative_t<I> *column_data() const noexcept {
+    return std::get<I>(m_Columns).data();
+  }
+
+  std::vector<Tag> m_Tags;
+  std::vector<std::size_t> m_Rows;
+  std::tuple<detail::soa_column_t<Ts>...> m_Columns;
+};
+
+} // namespace enm
+} // namespace rust
+
+// =================================================
+//
+// Tag scanning kernels
+//
+// =================================================
+
+namespace rust {
+namespace enm {
+namespace detail {
+inline namespace CXX_ENUMEXT_SIMD_NAMESPACE {
+
+inline int countr_zero(std::uint32_t bits) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int count = 0;
+  for (; (bits & 1) == 0; bits >>= 1) {
+    ++count;
+  }
+  return count;
+#else
+  return __builtin_ctz(bits);
+#endif
+}
+
+#if CXX_ENUMEXT_SIMD == CXX_ENUMEXT_SIMD_AVX2
+/// @brief Loads the tags of eight consecutive elements. Strides of 4, 8 and
+/// 16 bytes use plain loads and shuffles, all others a gather.
+struct simd_tags {
+  using block = __m256i;
+  constexpr static std::size_t lanes = 8;
+  // Counting compares every block against every alternative, which is
+  // slower than the scalar loop beyond this.
+  constexpr static std::size_t max_counted = 4;
+
+  template <std::size_t Stride>
+  static block load(const void *data, std::uint32_t mask) noexcept {
+    const auto *blocks = static_cast<const block *>(data);
+    block tags;
+    if constexpr (Stride == 4) {
+      tags = _mm256_loadu_si256(blocks);
+    } else if constexpr (Stride == 8) {
+      // Tags in the even 32 bit lanes.
+      const __m256 low = _mm256_castsi256_ps(_mm256_loadu_si256(blocks));
+      const __m256 high = _mm256_castsi256_ps(_mm256_loadu_si256(blocks + 1));
+      tags = _mm256_permute4x64_epi64(
+          _mm256_castps_si256(
+              _mm256_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0))),
+          _MM_SHUFFLE(3, 1, 2, 0));
+    } else if constexpr (Stride == 16) {
+      // Tags in the lanes 0 and 4, ordered 0 2 4 6 1 3 5 7 after unpacking.
+      const block ab = _mm256_unpacklo_epi32(_mm256_loadu_si256(blocks),
+                                             _mm256_loadu_si256(blocks + 1));
+      const block cd = _mm256_unpacklo_epi32(_mm256_loadu_si256(blocks + 2),
+                                             _mm256_loadu_si256(blocks + 3));
+      tags = _mm256_permutevar8x32_epi32(
+          _mm256_unpacklo_epi64(ab, cd),
+          _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+    } else {
+      constexpr int stride = static_cast<int>(Stride);
+      const block offsets =
+          _mm256_setr_epi32(0, stride, 2 * stride, 3 * stride, 4 * stride,
+                            5 * stride, 6 * stride, 7 * stride);
+      tags = _mm256_i32gather_epi32(static_cast<const int *>(data), offsets,
+                                    1);
+    }
+    return _mm256_and_si256(tags, splat(mask));
+  }
+
+  static block splat(std::uint32_t value) noexcept {
+    return _mm256_set1_epi32(static_cast<int>(value));
+  }
+
+  /// @brief One bit per lane, set if the lanes are equal.
+  static std::uint32_t equal(block lhs, block rhs) noexcept {
+    return static_cast<std::uint32_t>(_mm256_movemask_ps(
+        _mm256_castsi256_ps(_mm256_cmpeq_epi32(lhs, rhs))));
+  }
+
+  /// @brief Increments the lanes of `counts` where `lhs` equals `rhs`.
+  static block count_equal(block counts, block lhs, block rhs) noexcept {
+    return _mm256_sub_epi32(counts, _mm256_cmpeq_epi32(lhs, rhs));
+  }
+
+  static std::size_t sum(block counts) noexcept {
+    return sum(_mm256_castsi256_si128(counts)) +
+           sum(_mm256_extracti128_si256(counts, 1));
+  }
+
+  static std::size_t sum(__m128i counts) noexcept {
+    std::uint32_t values[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(values), counts);
+    return std::size_t{values[0]} + values[1] + values[2] + values[3];
+  }
+
+  /// @brief One bit per lane, set if the unsigned `lhs` is at most `rhs`.
+  static std::uint32_t less_equal(block lhs, block rhs) noexcept {
+    return equal(_mm256_min_epu32(lhs, rhs), lhs);
+  }
+};
+#elif CXX_ENUMEXT_SIMD == CXX_ENUMEXT_SIMD_SSE4
+/// @brief Loads the tags of four consecutive elements. Strides of 4, 8 and
+/// 16 bytes use plain loads and shuffles, all others scalar loads.
+struct simd_tags {
+  using block = __m128i;
+  constexpr static std::size_t lanes = 4;
+  constexpr static std::size_t max_counted = 3;
+
+  template <std::size_t Stride>
+  static block load(const void *data, std::uint32_t mask) noexcept {
+    const auto *blocks = static_cast<const block *>(data);
+    block tags;
+    if constexpr (Stride == 4) {
+      tags = _mm_loadu_si128(blocks);
+    } else if constexpr (Stride == 8) {
+      tags = _mm_castps_si128(
+          _mm_shuffle_ps(_mm_castsi128_ps(_mm_loadu_si128(blocks)),
+                         _mm_castsi128_ps(_mm_loadu_si128(blocks + 1)),
+                         _MM_SHUFFLE(2, 0, 2, 0)));
+    } else if constexpr (Stride == 16) {
+      tags = _mm_unpacklo_epi64(
+          _mm_unpacklo_epi32(_mm_loadu_si128(blocks),
+                             _mm_loadu_si128(blocks + 1)),
+          _mm_unpacklo_epi32(_mm_loadu_si128(blocks + 2),
+                             _mm_loadu_si128(blocks + 3)));
+    } else {
+      const auto *bytes = static_cast<const unsigned char *>(data);
+      int values[lanes];
+      for (std::size_t i = 0; i < lanes; ++i) {
+        std::memcpy(&values[i], bytes + i * Stride, sizeof(int));
+      }
+      tags = _mm_setr_epi32(values[0], values[1], values[2], values[3]);
+    }
+    return _mm_and_si128(tags, splat(mask));
+  }
+
+  static block splat(std::uint32_t value) noexcept {
+    return _mm_set1_epi32(static_cast<int>(value));
+  }
+
+  static std::uint32_t equal(block lhs, block rhs) noexcept {
+    return static_cast<std::uint32_t>(
+        _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(lhs, rhs))));
+  }
+
+  static block count_equal(block counts, block lhs, block rhs) noexcept {
+    return _mm_sub_epi32(counts, _mm_cmpeq_epi32(lhs, rhs));
+  }
+
+  static std::size_t sum(block counts) noexcept {
+    std::uint32_t values[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(values), counts);
+    return std::size_t{values[0]} + values[1] + values[2] + values[3];
+  }
+
+  static std::uint32_t less_equal(block lhs, block rhs) noexcept {
+    return equal(_mm_min_epu32(lhs, rhs), lhs);
+  }
+};
+#endif
+
+/// @brief The kernels behind `count_alternatives` and friends.
+///
+/// `m_Index` is the first member of `variant_storage`, just like the tag of
+/// the Rust enum, so the tag of the `i`-th element is at byte
+/// `i * sizeof(Variant)`. The vectorized loops load 32 bits at every element
+/// and mask the tag out of them, which requires a tag of at most 32 bits and
+/// elements of at least 32 bits. Everything else and the remainder of the
+/// vectorized loops is handled by the scalar loops.
+template <typename Variant,
+          typename Base = std::remove_const_t<variant_base_of_t<Variant>>>
+struct tag_scanner;
+
+template <typename Variant, typename Tag, typename... Ts>
+struct tag_scanner<Variant, basic_variant_base<Tag, Ts...>> {
+  constexpr static std::size_t size = sizeof...(Ts);
+
+#if CXX_ENUMEXT_SIMD != CXX_ENUMEXT_SIMD_NONE
+  constexpr static bool vectorized =
+      sizeof(Tag) <= sizeof(std::uint32_t) &&
+      sizeof(Variant) >= sizeof(std::uint32_t) &&
+      sizeof(Variant) <= (std::size_t{1} << 27);
+
+  constexpr static std::uint32_t tag_mask =
+      sizeof(Tag) == sizeof(std::uint32_t)
+          ? ~std::uint32_t{0}
+          : (std::uint32_t{1} << (8 * sizeof(Tag))) - 1;
+
+  constexpr static std::uint32_t all_lanes =
+      (std::uint32_t{1} << simd_tags::lanes) - 1;
+
+  static typename simd_tags::block load(const Variant *data) noexcept {
+    return simd_tags::template load<sizeof(Variant)>(data, tag_mask);
+  }
+#else
+  constexpr static bool vectorized = false;
+#endif
+
+  static std::array<std::size_t, size> count(const Variant *data,
+                                             std::size_t n) noexcept {
+    std::array<std::size_t, size> counts{};
+    std::size_t i = 0;
+#if CXX_ENUMEXT_SIMD != CXX_ENUMEXT_SIMD_NONE
+    // Comparing against every alternative only pays off for a few of them.
+    if constexpr (vectorized && size <= simd_tags::max_counted) {
+      // Flush the 32 bit lane counters before they can overflow.
+      constexpr std::size_t chunk =
+          simd_tags::lanes * std::numeric_limits<std::uint32_t>::max();
+      while (i + simd_tags::lanes <= n) {
+        const std::size_t end = i + std::min(n - i, chunk);
+        typename simd_tags::block lanes[size];
+        for (auto &lane : lanes) {
+          lane = simd_tags::splat(0);
+        }
+        for (; i + simd_tags::lanes <= end; i += simd_tags::lanes) {
+          const auto tags = load(data + i);
+          for (std::size_t k = 0; k < size; ++k) {
+            lanes[k] = simd_tags::count_equal(
+                lanes[k], tags,
+                simd_tags::splat(static_cast<std::uint32_t>(k)));
+          }
+        }
+        for (std::size_t k = 0; k < size; ++k) {
+          counts[k] += simd_tags::sum(lanes[k]);
+        }
+      }
+    }
+#endif
+    for (const Variant *it = data + i, *end = data + n; it != end; ++it) {
+      const std::size_t index = it->index();
+      if (index < size) {
+        ++counts[index];
+      }
+    }
+    return counts;
+  }
+
+  template <std::size_t I>
+  static std::size_t find(const Variant *data, std::size_t n) noexcept {
+    std::size_t i = 0;
+#if CXX_ENUMEXT_SIMD != CXX_ENUMEXT_SIMD_NONE
+    if constexpr (vectorized) {
+      const auto needle = simd_tags::splat(static_cast<std::uint32_t>(I));
+      for (; i + simd_tags::lanes <= n; i += simd_tags::lanes) {
+        const std::uint32_t found = simd_tags::equal(load(data + i), needle);
+        if (found != 0) {
+          return i + static_cast<std::size_t>(countr_zero(found));
+        }
+      }
+    }
+#endif
+    return static_cast<std::size_t>(
+        std::find_if(data + i, data + n,
+                     [](const Variant &value) { return value.index() == I; }) -
+        data);
+  }
+
+  template <std::size_t... Is>
+  static void mask(const Variant *data, std::size_t n,
+                   std::uint64_t *words) noexcept {
+    std::size_t i = 0;
+#if CXX_ENUMEXT_SIMD != CXX_ENUMEXT_SIMD_NONE
+    if constexpr (vectorized) {
+      // `lanes` divides 64, so a block never straddles two words.
+      for (; i + simd_tags::lanes <= n; i += simd_tags::lanes) {
+        const auto tags = load(data + i);
+        const std::uint32_t found =
+            (0u | ... |
+             simd_tags::equal(
+                 tags, simd_tags::splat(static_cast<std::uint32_t>(Is))));
+        words[i / 64] |= std::uint64_t{found} << (i % 64);
+      }
+    }
+#endif
+    for (; i < n; ++i) {
+      const std::size_t index = data[i].index();
+      if (((index == Is) || ...)) {
+        words[i / 64] |= std::uint64_t{1} << (i % 64);
+      }
+    }
+  }
+
+  static bool valid(const Variant *data, std::size_t n) noexcept {
+    std::size_t i = 0;
+#if CXX_ENUMEXT_SIMD != CXX_ENUMEXT_SIMD_NONE
+    if constexpr (vectorized) {
+      // Negative tags are masked to values above the largest index.
+      const auto last =
+          simd_tags::splat(static_cast<std::uint32_t>(size - 1));
+      for (; i + simd_tags::lanes <= n; i += simd_tags::lanes) {
+        if (simd_tags::less_equal(load(data + i), last) != all_lanes) {
+          return false;
+        }
+      }
+    }
+#endif
+    // Negative tags convert to large indices.
+    return std::all_of(data + i, data + n, [](const Variant &value) {
+      return value.index() < size;
+    });
+  }
+};
+
+/// @brief The element type of a contiguous range of variants, e.g.
+/// `rust::Slice<const T>`, `std::span<const T>` or `std::vector<T>`.
+template <typename Values>
+using range_element_t = std::remove_const_t<std::remove_pointer_t<decltype(
+    std::data(std::declval<const Values &>()))>>;
+
+template <typename Values>
+using tag_scanner_t = tag_scanner<range_element_t<Values>>;
+
+} // namespace CXX_ENUMEXT_SIMD_NAMESPACE
+} // namespace detail
+
+inline namespace CXX_ENUMEXT_SIMD_NAMESPACE {
+
+/// @brief Counts the elements holding every alternative. Elements with an
+/// invalid tag are not counted.
+template <typename Values>
+std::array<std::size_t, detail::tag_scanner_t<Values>::size>
+count_alternatives(const Values &values) noexcept {
+  return detail::tag_scanner_t<Values>::count(std::data(values),
+                                               std::size(values));
+}
+
+/// @brief Returns the position of the first element holding the alternative
+/// `I`, or the size of `values` if there is none.
+template <std::size_t I, typename Values>
+std::size_t find_alternative(const Values &values) noexcept {
+  static_assert(I < detail::tag_scanner_t<Values>::size,
+                "Index out of bounds");
+  return detail::tag_scanner_t<Values>::template find<I>(std::data(values),
+                                                         std::size(values));
+}
+
+/// @brief Returns a bitmask with the bit `i % 64` of the word `i / 64` set if
+/// the `i`-th element holds one of the alternatives `Is...`.
+template <std::size_t... Is, typename Values>
+std::vector<std::uint64_t> alternative_mask(const Values &values) {
+  static_assert(((Is < detail::tag_scanner_t<Values>::size) && ...),
+                "Index out of bounds");
+  const std::size_t size = std::size(values);
+  std::vector<std::uint64_t> words((size + 63) / 64);
+  detail::tag_scanner_t<Values>::template mask<Is...>(std::data(values), size,
+                                                      words.data());
+  return words;
+}
+
+/// @brief Checks that every element holds a valid alternative. Use it before
+/// trusting enums read from untrusted memory, `visit` and friends assume
+/// valid tags.
+template <typename Values> bool has_valid_tags(const Values &values) noexcept {
+  return detail::tag_scanner_t<Values>::valid(std::data(values),
+                                              std::size(values));
+}
+
+} // namespace CXX_ENUMEXT_SIMD_NAMESPACE
+} // namespace enm
+} // namespace rust
+
+// =================================================
+//
+// Grouped visitation
+//
+// =================================================
+
+namespace rust {
+namespace enm {
+
+/// @brief The elements of a range of `Variant`s holding the alternative `I`,
+/// in ascending position. Passed to the visitor of `visit_grouped_batches`.
+template <typename Variant, std::size_t I> class alternative_batch {
+public:
+  /// @brief The alternative, const if `Variant` is const.
+  using element_type = typename detail::variant_base_traits<
+      detail::variant_base_of_t<Variant>>::template alternative<I>;
+
+  constexpr static std::size_t index = I;
+
+  class iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::remove_const_t<element_type>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = element_type *;
+    using reference = element_type &;
+
+    iterator() noexcept = default;
+    iterator(Variant *data, const std::size_t *position) noexcept
+        : m_Data(data), m_Position(position) {}
+
+    element_type &operator*() const noexcept {
+      return get_unchecked<I>(m_Data[*m_Position]);
+    }
+    element_type *operator->() const noexcept { return &**this; }
+
+    iterator &operator++() noexcept {
+      ++m_Position;
+      return *this;
+    }
+
+    iterator operator++(int) noexcept {
+      iterator result = *this;
+      ++m_Position;
+      return result;
+    }
+
+    friend bool operator==(const iterator &lhs, const iterator &rhs) noexcept {
+      return lhs.m_Position == rhs.m_Position;
+    }
+
+    friend bool operator!=(const iterator &lhs, const iterator &rhs) noexcept {
+      return lhs.m_Position != rhs.m_Position;
+    }
+
+  private:
+    Variant *m_Data = nullptr;
+    const std::size_t *m_Position = nullptr;
+  };
+
+  alternative_batch(Variant *data, span<const std::size_t> positions) noexcept
+      : m_Data(data), m_Positions(positions) {}
+
+  std::size_t size() const noexcept { return m_Positions.size(); }
+  bool empty() const noexcept { return m_Positions.empty(); }
+
+  element_type &operator[](std::size_t n) const noexcept {
+    return get_unchecked<I>(m_Data[m_Positions[n]]);
+  }
+
+  /// @brief The position of the `n`-th element in the visited range.
+  std::size_t position(std::size_t n) const noexcept {
+    return m_Positions[n];
+  }
+
+  span<const std::size_t> positions() const noexcept { return m_Positions; }
+
+  iterator begin() const noexcept {
+    return iterator(m_Data, m_Positions.begin());
+  }
+  iterator end() const noexcept { return iterator(m_Data, m_Positions.end()); }
+
+private:
+  Variant *m_Data;
+  span<const std::size_t> m_Positions;
+};
+
+namespace detail {
+inline namespace CXX_ENUMEXT_SIMD_NAMESPACE {
+
+/// @brief Buckets the positions of a range of variants by alternative and
+/// visits one alternative after the other.
+template <typename Variant,
+          typename Base = std::remove_const_t<variant_base_of_t<Variant>>>
+struct grouped_visitor;
+
+template <typename Variant, typename Tag, typename... Ts>
+struct grouped_visitor<Variant, basic_variant_base<Tag, Ts...>> {
+  constexpr static std::size_t size = sizeof...(Ts);
+
+  /// @brief A counting sort of the positions by alternative. It is stable,
+  /// so every group is in ascending position. The group `I` is
+  /// [`offsets[I]`, `offsets[I + 1]`).
+  static std::vector<std::size_t>
+  group(const Variant *data, std::size_t n,
+        std::array<std::size_t, size + 1> &offsets) {
+    const auto counts =
+        tag_scanner<std::remove_const_t<Variant>>::count(data, n);
+    offsets[0] = 0;
+    for (std::size_t k = 0; k < size; ++k) {
+      offsets[k + 1] = offsets[k] + counts[k];
+    }
+    // Invalid tags are not counted. Check them before visiting anything.
+    if (offsets[size] != n) {
+      std::size_t invalid = 0;
+      while (data[invalid].index() < size) {
+        ++invalid;
+      }
+      detail::bad_access<bad_rust_variant_index>("invalid variant index",
+                                                 data[invalid].index());
+    }
+
+    std::vector<std::size_t> positions(n);
+    std::array<std::size_t, size + 1> cursors = offsets;
+    for (std::size_t i = 0; i < n; ++i) {
+      positions[cursors[data[i].index()]++] = i;
+    }
+    return positions;
+  }
+
+  template <bool Batches, typename Visitor, std::size_t... Is>
+  static void visit(Variant *data, std::size_t n, Visitor &visitor,
+                    std::index_sequence<Is...>) {
+    std::array<std::size_t, size + 1> offsets;
+    const std::vector<std::size_t> positions = group(data, n, offsets);
+    (visit_group<Batches, Is>(data, positions.data() + offsets[Is],
+                              positions.data() + offsets[Is + 1], visitor),
+     ...);
+  }
+
+  template <bool Batches, std::size_t I, typename Visitor>
+  static void visit_group(Variant *data, const std::size_t *first,
+                          const std::size_t *last, Visitor &visitor) {
+    if constexpr (Batches) {
+      if (first != last) {
+        visitor(alternative_batch<Variant, I>(
+            data, span<const std::size_t>(
+                      first, static_cast<std::size_t>(last - first))));
+      }
+    } else {
+      // One homogeneous loop per alternative, no dispatch per element.
+      for (; first != last; ++first) {
+        visitor(get_unchecked<I>(data[*first]));
+      }
+    }
+  }
+};
+
+template <typename Values>
+using grouped_visitor_t = grouped_visitor<
+    std::remove_pointer_t<decltype(std::data(std::declval<Values &>()))>>;
+
+} // namespace CXX_ENUMEXT_SIMD_NAMESPACE
+} // namespace detail
+
+inline namespace CXX_ENUMEXT_SIMD_NAMESPACE {
+
+/// @brief Visits every element of a contiguous range of variants (e.g.
+/// `rust::Slice<T>`, `std::vector<T>`), grouped by alternative: first all
+/// elements holding the alternative 0 in ascending position, then all
+/// holding the alternative 1 and so on.
+///
+/// Unlike calling `visit` in a loop every overload of `visitor` runs in a
+/// tight loop of its own, which pays off for long ranges of randomly mixed
+/// alternatives. Ranges dominated by one alternative are predicted well by
+/// a plain `visit` loop, which is cheaper there. The grouping takes two
+/// passes over the tags and one `std::size_t` per element. Reports a bad
+/// access without visiting anything if an element holds an invalid
+/// alternative.
+template <typename Values, typename Visitor>
+void visit_grouped(Values &&values, Visitor &&visitor) {
+  using grouped = detail::grouped_visitor_t<Values>;
+  grouped::template visit<false>(std::data(values), std::size(values),
+                                 visitor,
+                                 std::make_index_sequence<grouped::size>{});
+}
+
+/// @brief Like `visit_grouped`, but calls `visitor` once per alternative
+/// held by any element with an `alternative_batch` of all of them.
+template <typename Values, typename Visitor>
+void visit_grouped_batches(Values &&values, Visitor &&visitor) {
+  using grouped = detail::grouped_visitor_t<Values>;
+  grouped::template visit<true>(std::data(values), std::size(values),
+                                visitor,
+                                std::make_index_sequence<grouped::size>{});
+}
+
+} // namespace CXX_ENUMEXT_SIMD_NAMESPACE
+} // namespace enm
+} // namespace rust
+
+#endif
@@ -0,0 +1,211 @@
+//! The layout Rust gives an `#[extern_type]` item, asserted on both sides of
+//! the bridge.
+//!
+//! This module is shared with `cxx-enumext-build`. It only knows the types
+//! whose layout is fixed by Rust and cxx (primitives, pointers, `String`,
+//! `Vec<T>`...), anything else makes the layout unknown and the assertions
+//! are skipped.
+
+use syn::{Expr, Fields, GenericArgument, Lit, PathArguments, Type};
+
+use crate::syntax::{Enum, Item};
+
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub struct Layout {
+    pub size: usize,
+    pub align: usize,
+}
+
+impl Layout {
+    /// `()` and the fields of a unit variant
+    pub const UNIT: Layout = Layout { size: 0, align: 1 };
+
+    const fn scalar(size: usize) -> Self {
+        Layout { size, align: size }
+    }
+
+    const fn pointers(target: Target, count: usize) -> Self {
+        Layout {
+            size: target.pointer_width * count,
+            align: target.pointer_width,
+        }
+    }
+}
+
+/// The properties of the target the layouts depend on.
+///
+/// 32 bit x86 is left out: `u64` and `f64` are only 4 byte aligned there on
+/// some platforms.
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub struct Target {
+    /// `size_of::<usize>()`
+    pub pointer_width: usize,
+}
+
+impl Target {
+    pub const ALL: [Target; 2] = [Target { pointer_width: 8 }, Target { pointer_width: 4 }];
+}
+
+fn round_up(offset: usize, align: usize) -> usize {
+    offset.div_ceil(align) * align
+}
+
+/// The layout of a `#[repr(C)]` struct with the given fields, and the offset
+/// of each field.
+pub fn struct_layout<'a>(
+    fields: impl IntoIterator<Item = &'a Type>,
+    target: Target,
+) -> Option<(Layout, Vec<usize>)> {
+    let mut offsets = Vec::new();
+    let mut end = 0;
+    let mut align = 1;
+    for ty in fields {
+        let field = type_layout(ty, target)?;
+        let offset = round_up(end, field.align);
+        offsets.push(offset);
+        end = offset + field.size;
+        align = align.max(field.align);
+    }
+    let size = round_up(end, align);
+    Some((Layout { size, align }, offsets))
+}
+
+/// The layout of the fields of an enum variant, which Rust lays out like a
+/// `#[repr(C)]` struct.
+pub fn fields_layout(fields: &Fields, target: Target) -> Option<(Layout, Vec<usize>)> {
+    struct_layout(fields.iter().map(|field| &field.ty), target)
+}
+
+/// The layout of the bridged type.
+pub fn item_layout(item: &Item, target: Target) -> Option<Layout> {
+    match item {
+        Item::Enum(enm) => enum_layout(enm, target),
+        Item::Optional(optional) => tagged_union_layout(
+            None,
+            [Some(Layout::UNIT), type_layout(&optional.inner, target)],
+        ),
+        Item::Expected(expected) => tagged_union_layout(
+            None,
+            [
+                type_layout(&expected.expected, target),
+                type_layout(&expected.unexpected, target),
+            ],
+        ),
+        // the niche keeps the layout of the inner type
+        Item::Nullable(nullable) => type_layout(&nullable.inner, target),
+        // the enum asserts its own layout
+        Item::Atomic(_) => None,
+    }
+}
+
+fn enum_layout(enm: &Enum, target: Target) -> Option<Layout> {
+    let tag = enm.repr.as_ref().map(ToString::to_string);
+    tagged_union_layout(
+        tag.as_deref(),
+        enm.variants
+            .iter()
+            .map(|variant| fields_layout(&variant.fields, target).map(|(layout, _)| layout)),
+    )
+}
+
+fn tag_layout(repr: Option<&str>) -> Layout {
+    match repr {
+        Some("u8" | "i8") => Layout::scalar(1),
+        Some("u16" | "i16") => Layout::scalar(2),
+        Some("u64" | "i64") => Layout::scalar(8),
+        // `c_int` or a 32 bit integer
+        _ => Layout::scalar(4),
+    }
+}
+
+/// `#[repr(C)] struct { tag: repr, payload: union { variants } }`, which is
+/// how Rust lays out a `#[repr(C)]` enum with fields.
+fn tagged_union_layout(
+    repr: Option<&str>,
+    variants: impl IntoIterator<Item = Option<Layout>>,
+) -> Option<Layout> {
+    let tag = tag_layout(repr);
+    let mut payload = Layout::UNIT;
+    for variant in variants {
+        let variant = variant?;
+        payload.size = payload.size.max(variant.size);
+        payload.align = payload.align.max(variant.align);
+    }
+    payload.size = round_up(payload.size, payload.align);
+
+    let offset = round_up(tag.size, payload.align);
+    let align = tag.align.max(payload.align);
+    Some(Layout {
+        size: round_up(offset + payload.size, align),
+        align,
+    })
+}
+
+/// The layout of a field type, if Rust and cxx fix it.
+pub fn type_layout(ty: &Type, target: Target) -> Option<Layout> {
+    match ty {
+        Type::Reference(reference) => Some(if is_unsized(&reference.elem) {
+            Layout::pointers(target, 2)
+        } else {
+            Layout::pointers(target, 1)
+        }),
+        Type::Ptr(ptr) if !is_unsized(&ptr.elem) => Some(Layout::pointers(target, 1)),
+        Type::Array(array) => {
+            let element = type_layout(&array.elem, target)?;
+            let Expr::Lit(len) = &array.len else {
+                return None;
+            };
+            let Lit::Int(len) = &len.lit else {
+                return None;
+            };
+            let len: usize = len.base10_parse().ok()?;
+            Some(Layout {
+                size: element.size * len,
+                align: element.align,
+            })
+        }
+        Type::Tuple(tuple) if tuple.elems.is_empty() => Some(Layout::UNIT),
+        Type::Paren(paren) => type_layout(&paren.elem, target),
+        Type::Path(path) if path.qself.is_none() => {
+            let segment = path.path.segments.last()?;
+            let argument = match &segment.arguments {
+                PathArguments::None => None,
+                PathArguments::AngleBracketed(arguments) if arguments.args.len() == 1 => {
+                    match &arguments.args[0] {
+                        GenericArgument::Type(argument) => Some(argument),
+                        _ => return None,
+                    }
+                }
+                _ => return None,
+            };
+            match (segment.ident.to_string().as_str(), argument) {
+                ("bool" | "u8" | "i8" | "NonZeroU8" | "NonZeroI8", None) => Some(Layout::scalar(1)),
+                ("u16" | "i16" | "NonZeroU16" | "NonZeroI16", None) => Some(Layout::scalar(2)),
+                ("u32" | "i32" | "f32" | "NonZeroU32" | "NonZeroI32", None) => {
+                    Some(Layout::scalar(4))
+                }
+                ("u64" | "i64" | "f64" | "NonZeroU64" | "NonZeroI64", None) => {
+                    Some(Layout::scalar(8))
+                }
+                ("usize" | "isize" | "NonZeroUsize" | "NonZeroIsize", None) => {
+                    Some(Layout::pointers(target, 1))
+                }
+                ("String", None) | ("Vec", Some(_)) => Some(Layout::pointers(target, 3)),
+                ("Box", Some(inner)) if is_unsized(inner) => Some(Layout::pointers(target, 2)),
+                ("Box" | "UniquePtr", Some(_)) => Some(Layout::pointers(target, 1)),
+                ("SharedPtr" | "WeakPtr", Some(_)) => Some(Layout::pointers(target, 2)),
+                _ => None,
+            }
+        }
+        _ => None,
+    }
+}
+
+/// `str`, `[T]` and `dyn Trait`, which are behind fat pointers.
+fn is_unsized(ty: &Type) -> bool {
+    match ty {
+        Type::Slice(_) | Type::TraitObject(_) => true,
+        Type::Path(path) => path.qself.is_none() && path.path.is_ident("str"),
+        _ => false,
+    }
+}
@@ -1,60 +1,20 @@
+mod layout;
+mod syntax;
+
 use std::collections::HashSet;
-use std::fmt::Display;
 
 use proc_macro::TokenStream;
 use proc_macro2::Span;
 use quote::{quote, quote_spanned, ToTokens};
-use syn::ext::IdentExt;
-use syn::{
-    parse::{Parse, ParseStream, Parser},
-    spanned::Spanned,
-};
-use syn::{
-    Attribute, Fields, GenericArgument, GenericParam, Generics, Ident, Item as RustItem, ItemEnum,
-    ItemType, Lit, LitStr, Path, PathArguments, Token, Type, Variant, Visibility,
-};
-
-use syn::{Error as SynError, Result as SynResult};
-
-struct Errors {
-    errors: Vec<SynError>,
-}
-
-impl Errors {
-    pub fn new() -> Self {
-        Errors { errors: Vec::new() }
-    }
-
-    #[allow(dead_code)]
-    pub fn error(&mut self, sp: impl ToTokens, msg: impl Display) {
-        self.errors.push(SynError::new_spanned(sp, msg));
-    }
-
-    pub fn push(&mut self, error: SynError) {
-        self.errors.push(error);
-    }
-
-    pub fn propagate(&mut self) -> SynResult<()> {
-        let mut iter = self.errors.drain(..);
-        let Some(mut all_errors) = iter.next() else {
-            return Ok(());
-        };
-        for err in iter {
-            all_errors.combine(err);
-        }
-        Err(all_errors)
-    }
-}
+use syn::spanned::Spanned;
+use syn::{Fields, Ident, Item as RustItem, Lifetime, Lit, LitStr, Path};
 
-impl Default for Errors {
-    fn default() -> Self {
-        Self::new()
-    }
-}
+use crate::layout::{item_layout, struct_layout, type_layout, Target};
+use crate::syntax::{AstPieces, Atomic, Enum, Expected, ExternType, Item, Nullable, Optional};
 
 #[proc_macro_attribute]
 pub fn extern_type(attribute: TokenStream, input: TokenStream) -> TokenStream {
-    match AstPieces::from_token_streams(attribute, input) {
+    match syn::parse::<RustItem>(input).and_then(|item| AstPieces::parse(attribute.into(), item)) {
         Err(error) => error.into_compile_error().into(),
         Ok(pieces) => expand(pieces).into(),
     }
@@ -68,17 +28,10 @@ fn expand(pieces: AstPieces) -> proc_macro2::TokenStream {
         &format!(
             "{}{}",
             pieces
-                .namespace
-                .clone()
-                .unwrap_or_default()
-                .0
+                .cxx_namespace()
                 .iter()
                 .fold(String::new(), |acc, piece| acc + piece + "::"),
-            pieces
-                .cxx_name
-                .clone()
-                .unwrap_or_else(|| ForeignName(ident.to_string()))
-                .0
+            pieces.cxx_ident()
         ),
         ident.span(),
     ));
@@ -87,6 +40,8 @@ fn expand(pieces: AstPieces) -> proc_macro2::TokenStream {
         Item::Enum(enm) => expand_enum(&pieces, enm),
         Item::Optional(optional) => expand_optional(&pieces, optional),
         Item::Expected(expected) => expand_expected(&pieces, expected),
+        Item::Nullable(nullable) => expand_nullable(&pieces, nullable),
+        Item::Atomic(atomic) => expand_atomic(&pieces, atomic),
     });
 
     let cfg = &pieces.cfg;
@@ -103,9 +58,21 @@ fn expand(pieces: AstPieces) -> proc_macro2::TokenStream {
             type Kind = ::cxx::kind::Trivial;
         }
 
+        #cfg
+        #[automatically_derived]
+        impl #generics ::cxx_enumext::Emplace for #ident #generics {}
+
     });
 
+    if pieces.hash {
+        output.extend(expand_hash(&pieces));
+    }
+    if pieces.atomic {
+        output.extend(expand_atomic_repr(&pieces).unwrap_or_else(syn::Error::into_compile_error));
+    }
+
     output.extend(expand_asserts(&pieces));
+    output.extend(expand_layout(&pieces));
 
     output
 }
@@ -116,6 +83,10 @@ fn expand_enum(pieces: &AstPieces, enm: &Enum) -> proc_macro2::TokenStream {
     let attrs = pieces.attrs.iter();
     let generics = &pieces.generics;
     let cfg = &pieces.cfg;
+    let repr = match &enm.repr {
+        Some(int) => quote! { #[repr(C, #int)] },
+        None => quote! { #[repr(C)] },
+    };
     let variants = enm.variants.iter().map(|variant| {
         let attrs = variant.attrs.iter();
         let ident = &variant.ident;
@@ -137,7 +108,7 @@ fn expand_enum(pieces: &AstPieces, enm: &Enum) -> proc_macro2::TokenStream {
     quote! {
         #cfg
         #(#attrs)*
-        #[repr(C)]
+        #repr
         #vis enum #ident #generics {
             #(#variants,)*
         }
@@ -182,6 +153,39 @@ fn expand_optional(pieces: &AstPieces, optional: &Optional) -> proc_macro2::Toke
                 }
             }
         }
+
+        #cfg
+        #[automatically_derived]
+        impl #generics ::cxx_enumext::StdEnum for #ident #generics {
+            type Std = ::std::option::Option<#inner>;
+        }
+
+        #cfg
+        #[allow(dead_code)]
+        impl #generics #ident #generics {
+            /// Borrows the value as an `Option`, without moving it.
+            #[inline]
+            #vis fn as_option(&self) -> ::std::option::Option<&#inner> {
+                match self {
+                    #ident::None => ::std::option::Option::None,
+                    #ident::Some(value) => ::std::option::Option::Some(value),
+                }
+            }
+
+            /// Like `Option::as_mut`.
+            #[inline]
+            #vis fn as_mut(&mut self) -> ::std::option::Option<&mut #inner> {
+                match self {
+                    #ident::None => ::std::option::Option::None,
+                    #ident::Some(value) => ::std::option::Option::Some(value),
+                }
+            }
+
+            #[inline]
+            #vis fn into_option(self) -> ::std::option::Option<#inner> {
+                self.into()
+            }
+        }
     }
 }
 
@@ -224,6 +228,415 @@ fn expand_expected(pieces: &AstPieces, expected: &Expected) -> proc_macro2::Toke
                 }
             }
         }
+
+        #cfg
+        #[automatically_derived]
+        impl #generics ::cxx_enumext::StdEnum for #ident #generics {
+            type Std = ::std::result::Result<#expected_t, #unexpected_t>;
+        }
+
+        #cfg
+        #[allow(dead_code)]
+        impl #generics #ident #generics {
+            /// Borrows the value or the error as a `Result`, without moving
+            /// them.
+            #[inline]
+            #vis fn as_result(&self) -> ::std::result::Result<&#expected_t, &#unexpected_t> {
+                match self {
+                    #ident::Ok(value) => ::std::result::Result::Ok(value),
+                    #ident::Err(error) => ::std::result::Result::Err(error),
+                }
+            }
+
+            /// Like `Result::as_mut`.
+            #[inline]
+            #vis fn as_mut(
+                &mut self,
+            ) -> ::std::result::Result<&mut #expected_t, &mut #unexpected_t> {
+                match self {
+                    #ident::Ok(value) => ::std::result::Result::Ok(value),
+                    #ident::Err(error) => ::std::result::Result::Err(error),
+                }
+            }
+
+            #[inline]
+            #vis fn into_result(self) -> ::std::result::Result<#expected_t, #unexpected_t> {
+                self.into()
+            }
+        }
+    }
+}
+
+fn expand_nullable(pieces: &AstPieces, nullable: &Nullable) -> proc_macro2::TokenStream {
+    let ident = &pieces.ident;
+    let vis = &pieces.vis;
+    let attrs = pieces.attrs.iter();
+    let generics = &pieces.generics;
+    let inner = &nullable.inner;
+    let cfg = &pieces.cfg;
+
+    // Only lifetimes are allowed, and the layout does not depend on them.
+    let ty = if pieces.generics.params.is_empty() {
+        quote!(#ident)
+    } else {
+        let statics = pieces.generics.params.iter().map(|_| quote!('static));
+        quote!(#ident<#(#statics),*>)
+    };
+    let std = quote!(<#ty as ::cxx_enumext::StdEnum>::Std);
+    let reason = format!(
+        "Option<{}> is not the size of its value, which rust::enm::nullable needs",
+        inner.to_token_stream()
+    );
+    let bool_none = matches!(inner, syn::Type::Path(ty) if ty.path.is_ident("bool")).then(|| {
+        quote! {
+            #cfg
+            #[doc(hidden)]
+            const _: () = assert!(
+                ::cxx_enumext::private::none_bool_byte() == 2,
+                "rust::enm::niche_traits<bool> expects None to be stored as 2"
+            );
+        }
+    });
+
+    quote! {
+        #cfg
+        #(#attrs)*
+        #[repr(transparent)]
+        #vis struct #ident #generics(pub ::std::option::Option<#inner>);
+
+        #cfg
+        #[automatically_derived]
+        impl #generics ::std::convert::From<#ident #generics> for ::std::option::Option<#inner> {
+            fn from(value: #ident #generics) -> Self {
+                value.0
+            }
+        }
+
+        #cfg
+        #[automatically_derived]
+        impl #generics ::std::convert::From<::std::option::Option<#inner>> for #ident #generics {
+            fn from(value: ::std::option::Option<#inner>) -> Self {
+                #ident(value)
+            }
+        }
+
+        #cfg
+        #[automatically_derived]
+        impl #generics ::std::ops::Deref for #ident #generics {
+            type Target = ::std::option::Option<#inner>;
+
+            fn deref(&self) -> &Self::Target {
+                &self.0
+            }
+        }
+
+        #cfg
+        #[automatically_derived]
+        impl #generics ::std::ops::DerefMut for #ident #generics {
+            fn deref_mut(&mut self) -> &mut Self::Target {
+                &mut self.0
+            }
+        }
+
+        #cfg
+        #[automatically_derived]
+        impl #generics ::cxx_enumext::StdEnum for #ident #generics {
+            type Std = ::std::option::Option<#inner>;
+        }
+
+        // `#[repr(transparent)]` around the `Option`.
+        #cfg
+        #[automatically_derived]
+        unsafe impl #generics ::cxx_enumext::TransparentStdEnum for #ident #generics {}
+
+        #cfg
+        #[allow(dead_code)]
+        impl #generics #ident #generics {
+            /// Borrows the value as an `Option`, like the optionals with a
+            /// tag. `Option::as_ref` and `as_mut` work through `Deref`.
+            #[inline]
+            #vis fn as_option(&self) -> ::std::option::Option<&#inner> {
+                self.0.as_ref()
+            }
+
+            #[inline]
+            #vis fn into_option(self) -> ::std::option::Option<#inner> {
+                self.0
+            }
+        }
+
+        #cfg
+        #[doc(hidden)]
+        const _: () = assert!(::cxx_enumext::private::is_niche_option::<#std>(), #reason);
+        #bool_none
+    }
+}
+
+fn expand_atomic(pieces: &AstPieces, atomic: &Atomic) -> proc_macro2::TokenStream {
+    let ident = &pieces.ident;
+    let vis = &pieces.vis;
+    let attrs = pieces.attrs.iter();
+    let generics = &pieces.generics;
+    let inner = &atomic.inner;
+    let cfg = &pieces.cfg;
+
+    quote! {
+        #cfg
+        #(#attrs)*
+        #[repr(transparent)]
+        #vis struct #ident #generics(pub ::cxx_enumext::AtomicEnum<#inner>);
+
+        #cfg
+        #[automatically_derived]
+        impl #generics ::std::convert::From<#inner> for #ident #generics {
+            fn from(value: #inner) -> Self {
+                #ident(::cxx_enumext::AtomicEnum::new(value))
+            }
+        }
+
+        #cfg
+        #[automatically_derived]
+        impl #generics ::std::ops::Deref for #ident #generics {
+            type Target = ::cxx_enumext::AtomicEnum<#inner>;
+
+            fn deref(&self) -> &Self::Target {
+                &self.0
+            }
+        }
+
+        #cfg
+        #[automatically_derived]
+        impl #generics ::std::ops::DerefMut for #ident #generics {
+            fn deref_mut(&mut self) -> &mut Self::Target {
+                &mut self.0
+            }
+        }
+
+        #cfg
+        #[allow(dead_code)]
+        impl #generics #ident #generics {
+            #[inline]
+            #vis fn new(value: #inner) -> Self {
+                #ident(::cxx_enumext::AtomicEnum::new(value))
+            }
+        }
+    }
+}
+
+/// Copies the discriminant and the fields of the active variant to the bytes
+/// `AtomicEnum` stores, at their offsets in the enum, which is what
+/// `rust::enm::atomic_variant` does in C++.
+///
+/// The bytes of the padding are uninitialized and can't be copied, nor be
+/// compared by a compare-exchange. The fields must be types whose layout
+/// `layout` knows (which have no padding), without padding between or after
+/// them.
+fn expand_atomic_repr(pieces: &AstPieces) -> syn::Result<proc_macro2::TokenStream> {
+    let ident = &pieces.ident;
+    let generics = &pieces.generics;
+    let cfg = &pieces.cfg;
+    let ty = static_type(pieces);
+    let c_int = quote! { ::std::os::raw::c_int };
+    let field = |index: usize| Ident::new(&format!("__field{index}"), Span::call_site());
+
+    let variants: Vec<(proc_macro2::TokenStream, Vec<&syn::Type>)> = match &pieces.item {
+        Item::Enum(enm) => enm
+            .variants
+            .iter()
+            .map(|variant| {
+                let name = &variant.ident;
+                let types = variant.fields.iter().map(|field| &field.ty).collect();
+                let pattern = match &variant.fields {
+                    Fields::Named(named) => {
+                        let names = named.named.iter().map(|field| &field.ident);
+                        let fields = (0..named.named.len()).map(field);
+                        quote! { Self::#name { #(#names: #fields),* } }
+                    }
+                    Fields::Unnamed(unnamed) => {
+                        let fields = (0..unnamed.unnamed.len()).map(field);
+                        quote! { Self::#name ( #(#fields),* ) }
+                    }
+                    Fields::Unit => quote! { Self::#name },
+                };
+                (pattern, types)
+            })
+            .collect(),
+        Item::Optional(optional) => vec![
+            (quote! { Self::None }, Vec::new()),
+            (quote! { Self::Some(__field0) }, vec![&optional.inner]),
+        ],
+        Item::Expected(expected) => vec![
+            (quote! { Self::Ok(__field0) }, vec![&expected.expected]),
+            (quote! { Self::Err(__field0) }, vec![&expected.unexpected]),
+        ],
+        Item::Nullable(_) | Item::Atomic(_) => unreachable!("atomic is rejected when parsing"),
+    };
+    let tag = match &pieces.item {
+        Item::Enum(Enum {
+            repr: Some(int), ..
+        }) => quote! { #int },
+        _ => c_int,
+    };
+
+    for (_, types) in &variants {
+        for ty in types {
+            if type_layout(ty, Target::ALL[0]).is_none() {
+                return Err(syn::Error::new_spanned(
+                    ty,
+                    "atomic enums can only hold integers, floats, bool, NonZero integers, \
+                     references, pointers and arrays of them",
+                ));
+            }
+        }
+        for target in Target::ALL {
+            let (layout, offsets) = struct_layout(types.iter().copied(), target).unwrap();
+            let mut end = 0;
+            for (ty, offset) in types.iter().zip(offsets) {
+                if offset != end {
+                    return Err(syn::Error::new_spanned(
+                        ty,
+                        "padding before this field, which atomic enums can't compare, \
+                         reorder or widen the fields",
+                    ));
+                }
+                end += type_layout(ty, target).unwrap().size;
+            }
+            if layout.size != end {
+                return Err(syn::Error::new_spanned(
+                    types.last().unwrap(),
+                    "padding after this field, which atomic enums can't compare, \
+                     reorder or widen the fields",
+                ));
+            }
+        }
+    }
+
+    // Without a byte in any variant Rust stores only the tag, while the C++
+    // variant keeps a byte for the alternative and picks a larger atomic.
+    if variants.iter().all(|(_, types)| {
+        let (layout, _) = struct_layout(types.iter().copied(), Target::ALL[0]).unwrap();
+        layout.size == 0
+    }) {
+        return Err(syn::Error::new_spanned(
+            ident,
+            "atomic enums need a variant with a field that isn't zero sized",
+        ));
+    }
+
+    let arms = variants.iter().map(|(pattern, types)| {
+        let fields = (0..types.len()).map(field);
+        quote! {
+            #pattern => {
+                #(::cxx_enumext::atomic::write_field(__value, #fields, __bytes);)*
+            }
+        }
+    });
+    let reason = format!("{ident} is larger than the 8 bytes an AtomicEnum can hold");
+
+    Ok(quote! {
+        #cfg
+        #[automatically_derived]
+        unsafe impl #generics ::cxx_enumext::AtomicRepr for #ident #generics {
+            type Storage = <::cxx_enumext::atomic::Size<{ ::core::mem::size_of::<#ty>() }>
+                as ::cxx_enumext::atomic::SelectStorage>::Storage;
+
+            #[inline]
+            fn write_bytes(&self, __bytes: &mut [u8; 8]) {
+                let __value = (self as *const Self).cast::<u8>();
+                // SAFETY: The fields have no padding and lie within the
+                // enum, which is at most 8 bytes.
+                unsafe {
+                    ::cxx_enumext::atomic::write_tag::<#tag>(__value, __bytes);
+                    match self {
+                        #(#arms)*
+                    }
+                }
+            }
+        }
+
+        #cfg
+        #[doc(hidden)]
+        const _: () = assert!(::core::mem::size_of::<#ty>() <= 8, #reason);
+    })
+}
+
+/// Hashes the index of the variant as `u64` followed by the fields, which is
+/// what `rust::enm::hash_append` does for variants in C++.
+fn expand_hash(pieces: &AstPieces) -> proc_macro2::TokenStream {
+    let ident = &pieces.ident;
+    let generics = &pieces.generics;
+    let cfg = &pieces.cfg;
+
+    let arm = |index: u64, pattern: proc_macro2::TokenStream, fields: Vec<Ident>| {
+        quote! {
+            #pattern => {
+                ::std::hash::Hasher::write_u64(__state, #index);
+                #(::std::hash::Hash::hash(#fields, __state);)*
+            }
+        }
+    };
+    let field = |index: usize| Ident::new(&format!("__field{index}"), Span::call_site());
+
+    let (value, arms) = match &pieces.item {
+        Item::Enum(enm) => {
+            let arms = enm.variants.iter().enumerate().map(|(index, variant)| {
+                let name = &variant.ident;
+                match &variant.fields {
+                    Fields::Named(named) => {
+                        let names: Vec<_> = named
+                            .named
+                            .iter()
+                            .map(|field| field.ident.clone().unwrap())
+                            .collect();
+                        arm(index as u64, quote! { Self::#name { #(#names),* } }, names)
+                    }
+                    Fields::Unnamed(unnamed) => {
+                        let names: Vec<_> = (0..unnamed.unnamed.len()).map(field).collect();
+                        arm(index as u64, quote! { Self::#name ( #(#names),* ) }, names)
+                    }
+                    Fields::Unit => arm(index as u64, quote! { Self::#name }, Vec::new()),
+                }
+            });
+            (quote! { self }, arms.collect::<Vec<_>>())
+        }
+        Item::Optional(_) => (
+            quote! { self },
+            vec![
+                arm(0, quote! { Self::None }, Vec::new()),
+                arm(1, quote! { Self::Some(__field0) }, vec![field(0)]),
+            ],
+        ),
+        Item::Expected(_) => (
+            quote! { self },
+            vec![
+                arm(0, quote! { Self::Ok(__field0) }, vec![field(0)]),
+                arm(1, quote! { Self::Err(__field0) }, vec![field(0)]),
+            ],
+        ),
+        Item::Atomic(_) => unreachable!("hash is rejected for atomics when parsing"),
+        Item::Nullable(_) => (
+            quote! { &self.0 },
+            vec![
+                arm(0, quote! { ::std::option::Option::None }, Vec::new()),
+                arm(
+                    1,
+                    quote! { ::std::option::Option::Some(__field0) },
+                    vec![field(0)],
+                ),
+            ],
+        ),
+    };
+
+    quote! {
+        #cfg
+        #[automatically_derived]
+        impl #generics ::std::hash::Hash for #ident #generics {
+            fn hash<__H: ::std::hash::Hasher>(&self, __state: &mut __H) {
+                match #value {
+                    #(#arms)*
+                }
+            }
+        }
     }
 }
 
@@ -305,7 +718,7 @@ fn expand_asserts(pieces: &AstPieces) -> proc_macro2::TokenStream {
             seen_vec.insert(path.clone());
             let span = path.span();
             let reason = format!("{} is not exposed inside a Vec in a cxx bridge. Use a Vec as a function parameter/return value or shared struct member", path.to_token_stream());
-            let assert = quote_spanned!(span=> assert!(cxx_enumext::private::IsCxxImplBox::<#path>::IS_CXX_IMPL_VEC, #reason));
+            let assert = quote_spanned!(span=> assert!(cxx_enumext::private::IsCxxImplVec::<#path>::IS_CXX_IMPL_VEC, #reason));
             verify_box.extend(quote! {
                 const _: () = #assert;
             });
@@ -331,484 +744,52 @@ fn expand_asserts(pieces: &AstPieces) -> proc_macro2::TokenStream {
     }
 }
 
-struct Enum {
-    variants: Vec<Variant>,
-}
-
-struct Optional {
-    inner: Type,
-}
-
-struct Expected {
-    expected: Type,
-    unexpected: Type,
-}
-
-enum Item {
-    Enum(Enum),
-    Optional(Optional),
-    Expected(Expected),
-}
-
-enum ExternType {
-    Trivial(Path),
-    Opaque(Path),
-    #[allow(dead_code)]
-    Unspecified(Path),
-}
-
-struct AstPieces {
-    /// the item to bridge
-    item: Item,
-    ident: Ident,
-    namespace: Option<Namespace>,
-    cxx_name: Option<ForeignName>,
-    vis: Visibility,
-    generics: Generics,
-    attrs: Vec<Attribute>,
-    cfg: Option<Attribute>,
-    /// type name to confirm impl cxx::private::ImplBox
-    box_types: Vec<Path>,
-    /// type name to confirm impl cxx::private::ImplVec
-    vec_types: Vec<Path>,
-    /// type name and kind of cxx::ExternType to confirm
-    extern_types: Vec<ExternType>,
-}
-
-mod kw {
-    syn::custom_keyword!(namespace);
-    syn::custom_keyword!(cxx_name);
-}
-
-#[derive(Default, Clone)]
-struct Namespace(pub Vec<String>);
-
-#[derive(Default, Clone)]
-struct ForeignName(pub String);
-
-impl ForeignName {
-    pub fn parse(text: &str, span: Span) -> SynResult<Self> {
-        match Ident::parse_any.parse_str(text) {
-            Ok(ident) => {
-                let text = ident.to_string();
-                Ok(ForeignName(text))
-            }
-            Err(err) => Err(SynError::new(span, err)),
-        }
-    }
-}
+/// Asserts the size and alignment computed by `layout`, which the header
+/// generated by `cxx-enumext-build` asserts on the C++ side, so both sides
+/// agree with each other. The offsets of fields inside of variants can't be
+/// checked on stable Rust, the C++ side checks them against the same model.
+fn expand_layout(pieces: &AstPieces) -> proc_macro2::TokenStream {
+    let ident = &pieces.ident;
+    let cfg = &pieces.cfg;
+    let ty = static_type(pieces);
 
-impl Parse for Namespace {
-    fn parse(input: ParseStream) -> SynResult<Self> {
-        if input.is_empty() {
-            return Ok(Namespace(vec![]));
-        }
-        let path = input.call(Path::parse_mod_style)?;
-        Ok(Namespace(
-            path.segments
-                .iter()
-                .map(|segment| segment.ident.to_string())
-                .collect(),
-        ))
+    let mut output = proc_macro2::TokenStream::new();
+    for target in Target::ALL {
+        let Some(layout) = item_layout(&pieces.item, target) else {
+            continue;
+        };
+        let width = (target.pointer_width * 8).to_string();
+        let size = layout.size;
+        let align = layout.align;
+        let reason = format!(
+            "{ident} doesn't have the size ({size}) and alignment ({align}) asserted by the \
+             generated C++ header"
+        );
+        output.extend(quote! {
+            #cfg
+            #[cfg(all(target_pointer_width = #width, not(target_arch = "x86")))]
+            #[doc(hidden)]
+            const _: () = assert!(
+                ::core::mem::size_of::<#ty>() == #size && ::core::mem::align_of::<#ty>() == #align,
+                #reason
+            );
+        });
     }
+    output
 }
 
-fn parse_bridge_params(input: ParseStream) -> SynResult<(Option<Namespace>, Option<ForeignName>)> {
-    if input.is_empty() {
-        Ok((None, None))
+/// The bridged type with `'static` lifetimes: only lifetimes are allowed,
+/// they don't change the layout.
+fn static_type(pieces: &AstPieces) -> proc_macro2::TokenStream {
+    let ident = &pieces.ident;
+    if pieces.generics.params.is_empty() {
+        quote! { #ident }
     } else {
-        let mut ns = None;
-        let mut cxx_name = None;
-        loop {
-            if input.peek(kw::namespace) {
-                let ns_tok = input.parse::<kw::namespace>()?;
-                if ns.is_some() {
-                    return Err(SynError::new_spanned(ns_tok, "duplicate namespace param"));
-                }
-                input.parse::<Token![=]>()?;
-                ns = Some(input.parse::<Namespace>()?);
-            } else if input.peek(kw::cxx_name) {
-                let name_tok = input.parse::<kw::cxx_name>()?;
-                if cxx_name.is_some() {
-                    return Err(SynError::new_spanned(name_tok, "duplicate cxx_name param"));
-                }
-                input.parse::<Token![=]>()?;
-                cxx_name = Some(ForeignName::parse(
-                    &input.parse::<LitStr>()?.value(),
-                    name_tok.span,
-                )?);
-            }
-
-            if (input.parse::<Option<Token![,]>>()?).is_none() {
-                break;
-            }
-        }
-        Ok((ns, cxx_name))
-    }
-}
-
-impl AstPieces {
-    // Parses the macro arguments and returns the pieces, returning a `syn::Error` on error.
-    fn from_token_streams(attribute: TokenStream, item: TokenStream) -> SynResult<AstPieces> {
-        let (namespace, cxx_name) = parse_bridge_params.parse(attribute)?;
-
-        match syn::parse::<RustItem>(item)? {
-            RustItem::Type(ty) => parse_type_decl(ty, namespace, cxx_name),
-            RustItem::Enum(enm) => parse_enum(enm, namespace, cxx_name),
-            other => Err(SynError::new_spanned(
-                other,
-                "unsupported item for ExternType generation",
-            )),
-        }
-    }
-}
-
-fn parse_enum(
-    enm: ItemEnum,
-    namespace: Option<Namespace>,
-    cxx_name: Option<ForeignName>,
-) -> SynResult<AstPieces> {
-    let cx = &mut Errors::new();
-
-    let mut box_types = Vec::new();
-    let mut vec_types = Vec::new();
-    let mut extern_types = Vec::new();
-
-    let mut attrs = enm.attrs;
-    let mut cfg = None;
-    attrs.retain_mut(|attr| {
-        let attr_path = attr.path();
-        if attr_path.is_ident("cfg") {
-            cfg = Some(attr.clone());
-            return false;
-        }
-        if attr_path.is_ident("repr") {
-            cx.push(SynError::new_spanned(attr, "unsupported repr attribute"));
-        }
-        true
-    });
-
-    for variant in &enm.variants {
-        match &variant.fields {
-            Fields::Named(named) => {
-                for field in &named.named {
-                    find_types(
-                        &field.ty,
-                        &mut box_types,
-                        &mut vec_types,
-                        &mut extern_types,
-                        cx,
-                    );
-                }
-            }
-            Fields::Unit => {}
-            Fields::Unnamed(unnamed) => {
-                for field in &unnamed.unnamed {
-                    find_types(
-                        &field.ty,
-                        &mut box_types,
-                        &mut vec_types,
-                        &mut extern_types,
-                        cx,
-                    );
-                }
-            }
-        }
-    }
-    for generic in &enm.generics.params {
-        if !matches!(generic, GenericParam::Lifetime(_)) {
-            cx.push(SynError::new_spanned(
-                generic,
-                "only lifetime generic params supported",
-            ));
-        }
-    }
-    cx.propagate()?;
-    Ok(AstPieces {
-        item: Item::Enum(Enum {
-            variants: enm.variants.into_iter().collect(),
-        }),
-        ident: enm.ident.clone(),
-        cxx_name,
-        namespace,
-        attrs,
-        vis: enm.vis,
-        generics: enm.generics,
-        cfg,
-        box_types,
-        vec_types,
-        extern_types,
-    })
-}
-
-fn parse_type_decl(
-    alias: ItemType,
-    namespace: Option<Namespace>,
-    cxx_name: Option<ForeignName>,
-) -> SynResult<AstPieces> {
-    let cx = &mut Errors::new();
-    let ident = alias.ident;
-    if !alias.generics.params.is_empty() {
-        cx.push(SynError::new_spanned(
-            alias.generics.params.clone(),
-            "Generics are not supported",
-        ));
-    }
-
-    let mut box_types = Vec::new();
-    let mut vec_types = Vec::new();
-    let mut extern_types = Vec::new();
-
-    let mut attrs = alias.attrs;
-    let mut cfg = None;
-    attrs.retain_mut(|attr| {
-        let attr_path = attr.path();
-        if attr_path.is_ident("cfg") {
-            cfg = Some(attr.clone());
-            return false;
-        }
-        if attr_path.is_ident("repr") {
-            cx.push(SynError::new_spanned(attr, "unsupported repr attribute"));
-        }
-        true
-    });
-
-    match alias.ty.as_ref() {
-        Type::Path(ty) => {
-            let path = &ty.path;
-            if ty.qself.is_none() {
-                let segment = {
-                    if path.segments.len() == 1 {
-                        &path.segments[0]
-                    } else if path.segments.len() == 2 && path.segments[0].ident == "cxx_enumext" {
-                        &path.segments[1]
-                    } else {
-                        return Err(SynError::new_spanned(
-                            path,
-                            "unsupported type, did you mean 'Optional' or 'cxx_enumext::Optional'?",
-                        ));
-                    }
-                };
-                let ty_ident = segment.ident.clone();
-                if ty_ident == "Option" {
-                    return Err(SynError::new_spanned(
-                        path,
-                        "unsupported type, did you mean 'Optional'?",
-                    ));
-                } else if ty_ident == "Result" {
-                    return Err(SynError::new_spanned(
-                        path,
-                        "unsupported type, did you mean 'Expected'?",
-                    ));
-                } else if ty_ident == "Optional" {
-                    let inner = match &segment.arguments {
-                        PathArguments::None => {
-                            return Err(SynError::new_spanned(
-                                path,
-                                "Optional needs a contained type",
-                            ));
-                        }
-                        PathArguments::Parenthesized(_) => {
-                            return Err(SynError::new_spanned(
-                                path,
-                                "Optional needs a contained type",
-                            ));
-                        }
-                        PathArguments::AngleBracketed(generic) => {
-                            if generic.args.len() == 1 {
-                                let GenericArgument::Type(inner) = &generic.args[0] else {
-                                    return Err(SynError::new_spanned(
-                                        path,
-                                        "Optional takes only one generic type argument",
-                                    ));
-                                };
-
-                                find_types(
-                                    inner,
-                                    &mut box_types,
-                                    &mut vec_types,
-                                    &mut extern_types,
-                                    cx,
-                                );
-                                inner
-                            } else {
-                                return Err(SynError::new_spanned(
-                                    path,
-                                    "Optional takes only one generic type argument",
-                                ));
-                            }
-                        }
-                    };
-                    cx.propagate()?;
-                    return Ok(AstPieces {
-                        item: Item::Optional(Optional {
-                            inner: inner.clone(),
-                        }),
-                        ident,
-                        namespace,
-                        cxx_name,
-                        attrs,
-                        vis: alias.vis,
-                        generics: alias.generics,
-                        cfg,
-                        box_types,
-                        vec_types,
-                        extern_types,
-                    });
-                } else if ty_ident == "Expected" {
-                    let (expected, unexpected) = match &segment.arguments {
-                        PathArguments::None => {
-                            return Err(SynError::new_spanned(
-                                path,
-                                "Expected needs two contained types",
-                            ));
-                        }
-                        PathArguments::Parenthesized(_) => {
-                            return Err(SynError::new_spanned(
-                                path,
-                                "Expected needs two contained types",
-                            ));
-                        }
-                        PathArguments::AngleBracketed(generic) => {
-                            if generic.args.len() == 2 {
-                                let GenericArgument::Type(expected) = &generic.args[0] else {
-                                    return Err(SynError::new_spanned(
-                                        &generic.args[0],
-                                        "must be a type argument",
-                                    ));
-                                };
-                                let GenericArgument::Type(unexpected) = &generic.args[1] else {
-                                    return Err(SynError::new_spanned(
-                                        &generic.args[0],
-                                        "must be a type argument",
-                                    ));
-                                };
-
-                                find_types(
-                                    expected,
-                                    &mut box_types,
-                                    &mut vec_types,
-                                    &mut extern_types,
-                                    cx,
-                                );
-                                find_types(
-                                    unexpected,
-                                    &mut box_types,
-                                    &mut vec_types,
-                                    &mut extern_types,
-                                    cx,
-                                );
-                                (expected, unexpected)
-                            } else {
-                                return Err(SynError::new_spanned(
-                                    path,
-                                    "Expected takes two generic type argument",
-                                ));
-                            }
-                        }
-                    };
-                    cx.propagate()?;
-                    return Ok(AstPieces {
-                        item: Item::Expected(Expected {
-                            expected: expected.clone(),
-                            unexpected: unexpected.clone(),
-                        }),
-                        ident,
-                        namespace,
-                        cxx_name,
-                        attrs,
-                        vis: alias.vis,
-                        generics: alias.generics,
-                        cfg,
-                        box_types,
-                        vec_types,
-                        extern_types,
-                    });
-                };
-            }
-            Err(SynError::new_spanned(path, "unsupported type"))
-        }
-        other => Err(SynError::new_spanned(other, "unsupported type")),
-    }
-}
-
-fn find_types(
-    ty: &Type,
-    box_types: &mut Vec<Path>,
-    vec_types: &mut Vec<Path>,
-    extern_types: &mut Vec<ExternType>,
-    cx: &mut Errors,
-) {
-    match ty {
-        Type::Reference(_) => {}
-        Type::Ptr(_) => {}
-        Type::Array(_) => {}
-        Type::BareFn(_) => {}
-        Type::Tuple(ty) if ty.elems.is_empty() => {}
-        Type::Path(ty) => {
-            let path = &ty.path;
-
-            // used to detect if type was handeled already
-            let count = extern_types.len() + box_types.len() + vec_types.len();
-
-            if ty.qself.is_none() && path.leading_colon.is_none() && path.segments.len() == 1 {
-                let segment = &path.segments[0];
-                let ident = segment.ident.clone();
-                match &segment.arguments {
-                    PathArguments::None => {}
-                    PathArguments::AngleBracketed(generic) => {
-                        if ident == "Box" && generic.args.len() == 1 {
-                            if let GenericArgument::Type(Type::Path(inner)) = &generic.args[0] {
-                                box_types.push(inner.path.clone());
-                            }
-                        } else if ident == "Vec" && generic.args.len() == 1 {
-                            if let GenericArgument::Type(Type::Path(inner)) = &generic.args[0] {
-                                vec_types.push(inner.path.clone());
-                            }
-                        } else if ["UniquePtr", "SharedPtr", "WeakPtr", "CxxVector"]
-                            .iter()
-                            .any(|name| ident == name)
-                            && generic.args.len() == 1
-                        {
-                            if let GenericArgument::Type(Type::Path(inner)) = &generic.args[0] {
-                                extern_types.push(ExternType::Opaque(inner.path.clone()));
-                            }
-                        }
-                    }
-                    PathArguments::Parenthesized(_) => {}
-                }
-            } else if ty.qself.is_none()
-                && path.leading_colon.is_none()
-                && path.segments.len() == 2
-                && path.segments[0].ident == "cxx"
-            {
-                let segment = &path.segments[1];
-                let ident = segment.ident.clone();
-
-                match &segment.arguments {
-                    PathArguments::None => {}
-                    PathArguments::AngleBracketed(generic) => {
-                        if ["UniquePtr", "SharedPtr", "WeakPtr", "CxxVector"]
-                            .iter()
-                            .any(|name| ident == name)
-                            && generic.args.len() == 1
-                        {
-                            if let GenericArgument::Type(Type::Path(inner)) = &generic.args[0] {
-                                extern_types.push(ExternType::Opaque(inner.path.clone()));
-                            }
-                        }
-                    }
-                    PathArguments::Parenthesized(_) => {}
-                }
-            }
-
-            if (extern_types.len() + box_types.len() + vec_types.len()) == count {
-                // didn't find a special type
-                extern_types.push(ExternType::Trivial(path.clone()));
-            }
-        }
-        other => {
-            cx.push(SynError::new_spanned(other, "unsupported type"));
-        }
+        let lifetimes = pieces
+            .generics
+            .params
+            .iter()
+            .map(|_| Lifetime::new("'static", Span::call_site()));
+        quote! { #ident<#(#lifetimes),*> }
     }
 }
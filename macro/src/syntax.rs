@@ -0,0 +1,812 @@
+//! The parsed form of an `#[extern_type]` item.
+//!
+//! This module is shared with `cxx-enumext-build`, which parses the same items
+//! to generate their C++ definitions.
+
+use std::fmt::Display;
+
+use proc_macro2::Span;
+use quote::ToTokens;
+use syn::ext::IdentExt;
+use syn::parse::{Parse, ParseStream, Parser};
+use syn::{
+    Attribute, Fields, GenericArgument, GenericParam, Generics, Ident, Item as RustItem, ItemEnum,
+    ItemType, LitStr, Path, PathArguments, Token, Type, Variant, Visibility,
+};
+
+use syn::{Error as SynError, Result as SynResult};
+
+pub struct Errors {
+    errors: Vec<SynError>,
+}
+
+impl Errors {
+    pub fn new() -> Self {
+        Errors { errors: Vec::new() }
+    }
+
+    #[allow(dead_code)]
+    pub fn error(&mut self, sp: impl ToTokens, msg: impl Display) {
+        self.errors.push(SynError::new_spanned(sp, msg));
+    }
+
+    pub fn push(&mut self, error: SynError) {
+        self.errors.push(error);
+    }
+
+    pub fn propagate(&mut self) -> SynResult<()> {
+        let mut iter = self.errors.drain(..);
+        let Some(mut all_errors) = iter.next() else {
+            return Ok(());
+        };
+        for err in iter {
+            all_errors.combine(err);
+        }
+        Err(all_errors)
+    }
+}
+
+impl Default for Errors {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+pub struct Enum {
+    pub variants: Vec<Variant>,
+    /// integer type of the discriminant, `c_int` if `None`
+    pub repr: Option<Ident>,
+}
+
+pub struct Optional {
+    pub inner: Type,
+}
+
+pub struct Expected {
+    pub expected: Type,
+    pub unexpected: Type,
+}
+
+/// `Option<T>` where `T` has a niche, bridged without a separate tag
+pub struct Nullable {
+    pub inner: Type,
+}
+
+/// `AtomicEnum<T>` of an enum with `atomic`, bridged as
+/// `rust::enm::atomic_variant`
+pub struct Atomic {
+    pub inner: Type,
+}
+
+pub enum Item {
+    Enum(Enum),
+    Optional(Optional),
+    Expected(Expected),
+    Nullable(Nullable),
+    Atomic(Atomic),
+}
+
+pub enum ExternType {
+    Trivial(Path),
+    #[allow(dead_code)]
+    Opaque(Path),
+    Unspecified(Path),
+}
+
+pub struct AstPieces {
+    /// the item to bridge
+    pub item: Item,
+    pub ident: Ident,
+    pub namespace: Option<Namespace>,
+    pub cxx_name: Option<ForeignName>,
+    pub vis: Visibility,
+    pub generics: Generics,
+    pub attrs: Vec<Attribute>,
+    pub cfg: Option<Attribute>,
+    /// type name to confirm impl cxx::private::ImplBox
+    pub box_types: Vec<Path>,
+    /// type name to confirm impl cxx::private::ImplVec
+    pub vec_types: Vec<Path>,
+    /// type name and kind of cxx::ExternType to confirm
+    pub extern_types: Vec<ExternType>,
+    /// implement `Hash` like `rust::enm::hash_append` in C++
+    pub hash: bool,
+    /// implement `AtomicRepr` so `AtomicEnum` can hold the item
+    pub atomic: bool,
+}
+
+pub mod kw {
+    syn::custom_keyword!(namespace);
+    syn::custom_keyword!(cxx_name);
+    syn::custom_keyword!(hash);
+    syn::custom_keyword!(atomic);
+}
+
+#[derive(Default, Clone)]
+pub struct Namespace(pub Vec<String>);
+
+#[derive(Default, Clone)]
+pub struct ForeignName(pub String);
+
+impl ForeignName {
+    pub fn parse(text: &str, span: Span) -> SynResult<Self> {
+        match Ident::parse_any.parse_str(text) {
+            Ok(ident) => {
+                let text = ident.to_string();
+                Ok(ForeignName(text))
+            }
+            Err(err) => Err(SynError::new(span, err)),
+        }
+    }
+}
+
+impl Parse for Namespace {
+    fn parse(input: ParseStream) -> SynResult<Self> {
+        if input.is_empty() {
+            return Ok(Namespace(vec![]));
+        }
+        let path = input.call(Path::parse_mod_style)?;
+        Ok(Namespace(
+            path.segments
+                .iter()
+                .map(|segment| segment.ident.to_string())
+                .collect(),
+        ))
+    }
+}
+
+#[derive(Default)]
+pub struct BridgeParams {
+    pub namespace: Option<Namespace>,
+    pub cxx_name: Option<ForeignName>,
+    /// implement `Hash` like `rust::enm::hash_append` in C++
+    pub hash: bool,
+    /// implement `AtomicRepr` so `AtomicEnum` can hold the item
+    pub atomic: bool,
+}
+
+pub fn parse_bridge_params(input: ParseStream) -> SynResult<BridgeParams> {
+    if input.is_empty() {
+        Ok(BridgeParams::default())
+    } else {
+        let mut ns = None;
+        let mut cxx_name = None;
+        let mut hash = false;
+        let mut atomic = false;
+        loop {
+            if input.peek(kw::namespace) {
+                let ns_tok = input.parse::<kw::namespace>()?;
+                if ns.is_some() {
+                    return Err(SynError::new_spanned(ns_tok, "duplicate namespace param"));
+                }
+                input.parse::<Token![=]>()?;
+                ns = Some(input.parse::<Namespace>()?);
+            } else if input.peek(kw::cxx_name) {
+                let name_tok = input.parse::<kw::cxx_name>()?;
+                if cxx_name.is_some() {
+                    return Err(SynError::new_spanned(name_tok, "duplicate cxx_name param"));
+                }
+                input.parse::<Token![=]>()?;
+                cxx_name = Some(ForeignName::parse(
+                    &input.parse::<LitStr>()?.value(),
+                    name_tok.span,
+                )?);
+            } else if input.peek(kw::hash) {
+                let hash_tok = input.parse::<kw::hash>()?;
+                if hash {
+                    return Err(SynError::new_spanned(hash_tok, "duplicate hash param"));
+                }
+                hash = true;
+            } else if input.peek(kw::atomic) {
+                let atomic_tok = input.parse::<kw::atomic>()?;
+                if atomic {
+                    return Err(SynError::new_spanned(atomic_tok, "duplicate atomic param"));
+                }
+                atomic = true;
+            }
+
+            if (input.parse::<Option<Token![,]>>()?).is_none() {
+                break;
+            }
+        }
+        Ok(BridgeParams {
+            namespace: ns,
+            cxx_name,
+            hash,
+            atomic,
+        })
+    }
+}
+
+impl AstPieces {
+    // Parses the macro arguments and returns the pieces, returning a `syn::Error` on error.
+    pub fn parse(attribute: proc_macro2::TokenStream, item: RustItem) -> SynResult<AstPieces> {
+        let params = parse_bridge_params.parse2(attribute)?;
+
+        let mut pieces = match item {
+            RustItem::Type(ty) => parse_type_decl(ty, params.namespace, params.cxx_name),
+            RustItem::Enum(enm) => parse_enum(enm, params.namespace, params.cxx_name),
+            other => Err(SynError::new_spanned(
+                other,
+                "unsupported item for ExternType generation",
+            )),
+        }?;
+        pieces.hash = params.hash;
+        pieces.atomic = params.atomic;
+        if pieces.atomic && matches!(pieces.item, Item::Nullable(_) | Item::Atomic(_)) {
+            return Err(SynError::new_spanned(
+                &pieces.ident,
+                "atomic is only supported for enums, optionals and expecteds",
+            ));
+        }
+        if pieces.hash && matches!(pieces.item, Item::Atomic(_)) {
+            return Err(SynError::new_spanned(
+                &pieces.ident,
+                "hash is not supported for atomics",
+            ));
+        }
+        Ok(pieces)
+    }
+
+    /// The name of the C++ type, `cxx_name` or the Rust name.
+    pub fn cxx_ident(&self) -> String {
+        match &self.cxx_name {
+            Some(name) => name.0.clone(),
+            None => self.ident.to_string(),
+        }
+    }
+
+    /// The namespace of the C++ type, empty for the global namespace.
+    pub fn cxx_namespace(&self) -> &[String] {
+        match &self.namespace {
+            Some(namespace) => &namespace.0,
+            None => &[],
+        }
+    }
+}
+
+pub fn parse_enum(
+    enm: ItemEnum,
+    namespace: Option<Namespace>,
+    cxx_name: Option<ForeignName>,
+) -> SynResult<AstPieces> {
+    let cx = &mut Errors::new();
+
+    let mut box_types = Vec::new();
+    let mut vec_types = Vec::new();
+    let mut extern_types = Vec::new();
+
+    let mut attrs = enm.attrs;
+    let mut cfg = None;
+    let mut repr = None;
+    attrs.retain_mut(|attr| {
+        let attr_path = attr.path();
+        if attr_path.is_ident("cfg") {
+            cfg = Some(attr.clone());
+            return false;
+        }
+        if attr_path.is_ident("repr") {
+            match parse_repr(attr) {
+                Ok(int) => repr = int,
+                Err(err) => cx.push(err),
+            }
+            return false;
+        }
+        true
+    });
+
+    for variant in &enm.variants {
+        match &variant.fields {
+            Fields::Named(named) => {
+                for field in &named.named {
+                    find_types(
+                        &field.ty,
+                        &mut box_types,
+                        &mut vec_types,
+                        &mut extern_types,
+                        cx,
+                    );
+                }
+            }
+            Fields::Unit => {}
+            Fields::Unnamed(unnamed) => {
+                for field in &unnamed.unnamed {
+                    find_types(
+                        &field.ty,
+                        &mut box_types,
+                        &mut vec_types,
+                        &mut extern_types,
+                        cx,
+                    );
+                }
+            }
+        }
+    }
+    // Rust lays out an enum without fields as only its discriminant, while
+    // `basic_variant` always has room for an alternative after the tag.
+    if !enm.variants.is_empty() && enm.variants.iter().all(|variant| variant.fields.is_empty()) {
+        cx.push(SynError::new_spanned(
+            &enm.ident,
+            "enums without fields are not supported, bridge them as cxx shared enums",
+        ));
+    }
+    for generic in &enm.generics.params {
+        if !matches!(generic, GenericParam::Lifetime(_)) {
+            cx.push(SynError::new_spanned(
+                generic,
+                "only lifetime generic params supported",
+            ));
+        }
+    }
+    cx.propagate()?;
+    Ok(AstPieces {
+        item: Item::Enum(Enum {
+            variants: enm.variants.into_iter().collect(),
+            repr,
+        }),
+        ident: enm.ident.clone(),
+        cxx_name,
+        namespace,
+        attrs,
+        vis: enm.vis,
+        generics: enm.generics,
+        cfg,
+        box_types,
+        vec_types,
+        extern_types,
+        hash: false,
+        atomic: false,
+    })
+}
+
+/// Parses `#[repr(C)]`, `#[repr(u8)]` or `#[repr(C, u8)]` (and the other
+/// integer types) and returns the integer type of the discriminant.
+///
+/// A primitive representation without `C` is generated as `#[repr(C, u8)]`:
+/// the C++ side can only express the layout of a tag followed by a union.
+pub fn parse_repr(attr: &Attribute) -> SynResult<Option<Ident>> {
+    const INTS: [&str; 8] = ["u8", "u16", "u32", "u64", "i8", "i16", "i32", "i64"];
+
+    let mut int = None;
+    attr.parse_nested_meta(|meta| {
+        if meta.path.is_ident("C") {
+            return Ok(());
+        }
+        if let Some(ident) = INTS.iter().find_map(|name| {
+            meta.path
+                .get_ident()
+                .filter(|ident| *ident == name)
+                .cloned()
+        }) {
+            if int.is_some() {
+                return Err(meta.error("conflicting representation hints"));
+            }
+            int = Some(ident);
+            return Ok(());
+        }
+        Err(meta.error(
+            "unsupported repr attribute, only C and the integer types up to 64 bits are supported",
+        ))
+    })?;
+    Ok(int)
+}
+
+pub fn parse_type_decl(
+    alias: ItemType,
+    namespace: Option<Namespace>,
+    cxx_name: Option<ForeignName>,
+) -> SynResult<AstPieces> {
+    let cx = &mut Errors::new();
+    let ident = alias.ident;
+    let only_lifetimes = alias
+        .generics
+        .params
+        .iter()
+        .all(|generic| matches!(generic, GenericParam::Lifetime(_)));
+
+    let mut box_types = Vec::new();
+    let mut vec_types = Vec::new();
+    let mut extern_types = Vec::new();
+
+    let mut attrs = alias.attrs;
+    let mut cfg = None;
+    attrs.retain_mut(|attr| {
+        let attr_path = attr.path();
+        if attr_path.is_ident("cfg") {
+            cfg = Some(attr.clone());
+            return false;
+        }
+        if attr_path.is_ident("repr") {
+            cx.push(SynError::new_spanned(attr, "unsupported repr attribute"));
+        }
+        true
+    });
+
+    match alias.ty.as_ref() {
+        Type::Path(ty) => {
+            let path = &ty.path;
+            if ty.qself.is_none() {
+                let segment = {
+                    if path.segments.len() == 1 {
+                        &path.segments[0]
+                    } else if path.segments.len() == 2 && path.segments[0].ident == "cxx_enumext" {
+                        &path.segments[1]
+                    } else {
+                        return Err(SynError::new_spanned(
+                            path,
+                            "unsupported type, did you mean 'Optional' or 'cxx_enumext::Optional'?",
+                        ));
+                    }
+                };
+                let ty_ident = segment.ident.clone();
+                if ty_ident != "Option" && !alias.generics.params.is_empty() {
+                    cx.push(SynError::new_spanned(
+                        alias.generics.params.clone(),
+                        "Generics are not supported",
+                    ));
+                }
+                if ty_ident == "Option" {
+                    if !only_lifetimes {
+                        cx.push(SynError::new_spanned(
+                            alias.generics.params.clone(),
+                            "only lifetime generic params supported",
+                        ));
+                    }
+                    let inner = match &segment.arguments {
+                        PathArguments::AngleBracketed(generic) if generic.args.len() == 1 => {
+                            match &generic.args[0] {
+                                GenericArgument::Type(inner) => Some(inner),
+                                _ => None,
+                            }
+                        }
+                        _ => None,
+                    };
+                    let Some(inner) = inner.filter(|inner| has_niche(inner)) else {
+                        return Err(SynError::new_spanned(
+                            path,
+                            "unsupported type, 'Option' is only supported for Box<T>, &T, &mut T, \
+                             bool and NonZero integers, did you mean 'Optional'?",
+                        ));
+                    };
+                    if !is_nonzero(inner) {
+                        find_types(inner, &mut box_types, &mut vec_types, &mut extern_types, cx);
+                    }
+                    cx.propagate()?;
+                    return Ok(AstPieces {
+                        item: Item::Nullable(Nullable {
+                            inner: inner.clone(),
+                        }),
+                        ident,
+                        namespace,
+                        cxx_name,
+                        attrs,
+                        vis: alias.vis,
+                        generics: alias.generics,
+                        cfg,
+                        box_types,
+                        vec_types,
+                        extern_types,
+                        hash: false,
+                        atomic: false,
+                    });
+                } else if ty_ident == "Result" {
+                    return Err(SynError::new_spanned(
+                        path,
+                        "unsupported type, did you mean 'Expected'?",
+                    ));
+                } else if ty_ident == "Optional" {
+                    let inner = match &segment.arguments {
+                        PathArguments::None => {
+                            return Err(SynError::new_spanned(
+                                path,
+                                "Optional needs a contained type",
+                            ));
+                        }
+                        PathArguments::Parenthesized(_) => {
+                            return Err(SynError::new_spanned(
+                                path,
+                                "Optional needs a contained type",
+                            ));
+                        }
+                        PathArguments::AngleBracketed(generic) => {
+                            if generic.args.len() == 1 {
+                                let GenericArgument::Type(inner) = &generic.args[0] else {
+                                    return Err(SynError::new_spanned(
+                                        path,
+                                        "Optional takes only one generic type argument",
+                                    ));
+                                };
+
+                                find_types(
+                                    inner,
+                                    &mut box_types,
+                                    &mut vec_types,
+                                    &mut extern_types,
+                                    cx,
+                                );
+                                inner
+                            } else {
+                                return Err(SynError::new_spanned(
+                                    path,
+                                    "Optional takes only one generic type argument",
+                                ));
+                            }
+                        }
+                    };
+                    cx.propagate()?;
+                    return Ok(AstPieces {
+                        item: Item::Optional(Optional {
+                            inner: inner.clone(),
+                        }),
+                        ident,
+                        namespace,
+                        cxx_name,
+                        attrs,
+                        vis: alias.vis,
+                        generics: alias.generics,
+                        cfg,
+                        box_types,
+                        vec_types,
+                        extern_types,
+                        hash: false,
+                        atomic: false,
+                    });
+                } else if ty_ident == "Expected" {
+                    let (expected, unexpected) = match &segment.arguments {
+                        PathArguments::None => {
+                            return Err(SynError::new_spanned(
+                                path,
+                                "Expected needs two contained types",
+                            ));
+                        }
+                        PathArguments::Parenthesized(_) => {
+                            return Err(SynError::new_spanned(
+                                path,
+                                "Expected needs two contained types",
+                            ));
+                        }
+                        PathArguments::AngleBracketed(generic) => {
+                            if generic.args.len() == 2 {
+                                let GenericArgument::Type(expected) = &generic.args[0] else {
+                                    return Err(SynError::new_spanned(
+                                        &generic.args[0],
+                                        "must be a type argument",
+                                    ));
+                                };
+                                let GenericArgument::Type(unexpected) = &generic.args[1] else {
+                                    return Err(SynError::new_spanned(
+                                        &generic.args[0],
+                                        "must be a type argument",
+                                    ));
+                                };
+
+                                find_types(
+                                    expected,
+                                    &mut box_types,
+                                    &mut vec_types,
+                                    &mut extern_types,
+                                    cx,
+                                );
+                                find_types(
+                                    unexpected,
+                                    &mut box_types,
+                                    &mut vec_types,
+                                    &mut extern_types,
+                                    cx,
+                                );
+                                (expected, unexpected)
+                            } else {
+                                return Err(SynError::new_spanned(
+                                    path,
+                                    "Expected takes two generic type argument",
+                                ));
+                            }
+                        }
+                    };
+                    cx.propagate()?;
+                    return Ok(AstPieces {
+                        item: Item::Expected(Expected {
+                            expected: expected.clone(),
+                            unexpected: unexpected.clone(),
+                        }),
+                        ident,
+                        namespace,
+                        cxx_name,
+                        attrs,
+                        vis: alias.vis,
+                        generics: alias.generics,
+                        cfg,
+                        box_types,
+                        vec_types,
+                        extern_types,
+                        hash: false,
+                        atomic: false,
+                    });
+                } else if ty_ident == "AtomicEnum" {
+                    let inner = match &segment.arguments {
+                        PathArguments::AngleBracketed(generic) if generic.args.len() == 1 => {
+                            match &generic.args[0] {
+                                GenericArgument::Type(inner) => Some(inner),
+                                _ => None,
+                            }
+                        }
+                        _ => None,
+                    };
+                    let Some(inner) = inner else {
+                        return Err(SynError::new_spanned(
+                            path,
+                            "AtomicEnum takes only one generic type argument",
+                        ));
+                    };
+                    find_types(inner, &mut box_types, &mut vec_types, &mut extern_types, cx);
+                    cx.propagate()?;
+                    return Ok(AstPieces {
+                        item: Item::Atomic(Atomic {
+                            inner: inner.clone(),
+                        }),
+                        ident,
+                        namespace,
+                        cxx_name,
+                        attrs,
+                        vis: alias.vis,
+                        generics: alias.generics,
+                        cfg,
+                        box_types,
+                        vec_types,
+                        extern_types,
+                        hash: false,
+                        atomic: false,
+                    });
+                };
+            }
+            Err(SynError::new_spanned(path, "unsupported type"))
+        }
+        other => Err(SynError::new_spanned(other, "unsupported type")),
+    }
+}
+
+/// Types for which `Option<T>` has the size of `T` (with `None` stored in an
+/// invalid value of `T`) and that `rust::enm::nullable` knows how to read.
+/// Rust only documents this for `Box`, references and `NonZero`, so the layout
+/// is asserted when expanding the alias.
+pub fn has_niche(ty: &Type) -> bool {
+    match ty {
+        Type::Reference(_) => true,
+        Type::Path(ty) if ty.qself.is_none() => {
+            let Some(segment) = ty.path.segments.last() else {
+                return false;
+            };
+            if ty.path.segments.len() == 1 && segment.ident == "bool" {
+                return true;
+            }
+            if segment.ident == "Box" {
+                return matches!(
+                    &segment.arguments,
+                    PathArguments::AngleBracketed(generic) if generic.args.len() == 1
+                );
+            }
+            is_nonzero(&Type::Path(ty.clone()))
+        }
+        _ => false,
+    }
+}
+
+pub fn is_nonzero(ty: &Type) -> bool {
+    const NONZERO: [&str; 10] = [
+        "NonZeroU8",
+        "NonZeroU16",
+        "NonZeroU32",
+        "NonZeroU64",
+        "NonZeroUsize",
+        "NonZeroI8",
+        "NonZeroI16",
+        "NonZeroI32",
+        "NonZeroI64",
+        "NonZeroIsize",
+    ];
+    match ty {
+        Type::Path(ty) if ty.qself.is_none() => ty
+            .path
+            .segments
+            .last()
+            .is_some_and(|segment| NONZERO.iter().any(|name| segment.ident == name)),
+        _ => false,
+    }
+}
+
+/// Element types `rust::Vec<T>` supports out of the box.
+pub fn is_builtin_vec_element(path: &Path) -> bool {
+    const BUILTIN: [&str; 14] = [
+        "u8", "u16", "u32", "u64", "usize", "i8", "i16", "i32", "i64", "isize", "f32", "f64",
+        "bool", "String",
+    ];
+    path.get_ident()
+        .is_some_and(|ident| BUILTIN.iter().any(|name| ident == name))
+}
+
+pub fn find_types(
+    ty: &Type,
+    box_types: &mut Vec<Path>,
+    vec_types: &mut Vec<Path>,
+    extern_types: &mut Vec<ExternType>,
+    cx: &mut Errors,
+) {
+    match ty {
+        Type::Reference(_) => {}
+        Type::Ptr(_) => {}
+        Type::Array(_) => {}
+        Type::BareFn(_) => {}
+        Type::Tuple(ty) if ty.elems.is_empty() => {}
+        Type::Path(ty) => {
+            let path = &ty.path;
+
+            // used to detect if type was handeled already
+            let count = extern_types.len() + box_types.len() + vec_types.len();
+
+            if ty.qself.is_none() && path.leading_colon.is_none() && path.segments.len() == 1 {
+                let segment = &path.segments[0];
+                let ident = segment.ident.clone();
+                match &segment.arguments {
+                    PathArguments::None => {}
+                    PathArguments::AngleBracketed(generic) => {
+                        if ident == "Box" && generic.args.len() == 1 {
+                            if let GenericArgument::Type(Type::Path(inner)) = &generic.args[0] {
+                                box_types.push(inner.path.clone());
+                            }
+                        } else if ident == "Vec" && generic.args.len() == 1 {
+                            if let GenericArgument::Type(Type::Path(inner)) = &generic.args[0] {
+                                if is_builtin_vec_element(&inner.path) {
+                                    // cxx implements these without `impl Vec<T>`
+                                    return;
+                                }
+                                vec_types.push(inner.path.clone());
+                            }
+                        } else if ["UniquePtr", "SharedPtr", "WeakPtr", "CxxVector"]
+                            .iter()
+                            .any(|name| ident == name)
+                            && generic.args.len() == 1
+                        {
+                            if let GenericArgument::Type(Type::Path(inner)) = &generic.args[0] {
+                                // trivial and opaque types are both supported
+                                extern_types.push(ExternType::Unspecified(inner.path.clone()));
+                            }
+                        }
+                    }
+                    PathArguments::Parenthesized(_) => {}
+                }
+            } else if ty.qself.is_none()
+                && path.leading_colon.is_none()
+                && path.segments.len() == 2
+                && path.segments[0].ident == "cxx"
+            {
+                let segment = &path.segments[1];
+                let ident = segment.ident.clone();
+
+                match &segment.arguments {
+                    PathArguments::None => {}
+                    PathArguments::AngleBracketed(generic) => {
+                        if ["UniquePtr", "SharedPtr", "WeakPtr", "CxxVector"]
+                            .iter()
+                            .any(|name| ident == name)
+                            && generic.args.len() == 1
+                        {
+                            if let GenericArgument::Type(Type::Path(inner)) = &generic.args[0] {
+                                // trivial and opaque types are both supported
+                                extern_types.push(ExternType::Unspecified(inner.path.clone()));
+                            }
+                        }
+                    }
+                    PathArguments::Parenthesized(_) => {}
+                }
+            }
+
+            if (extern_types.len() + box_types.len() + vec_types.len()) == count {
+                // didn't find a special type
+                extern_types.push(ExternType::Trivial(path.clone()));
+            }
+        }
+        other => {
+            cx.push(SynError::new_spanned(other, "unsupported type"));
+        }
+    }
+}
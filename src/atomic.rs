@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) Rachel Powers.
+ *
+ * This source code is licensed under both the MIT license found in the
+ * LICENSE-MIT file in the root directory of this source tree and the Apache
+ * License, Version 2.0 found in the LICENSE-APACHE file in the root directory
+ * of this source tree.
+ */
+
+//! Small enums shared between Rust and C++ threads without a lock, the
+//! counterpart of C++'s `rust::enm::atomic_variant`
+
+use std::fmt;
+use std::marker::PhantomData;
+use std::mem::size_of;
+use std::ptr;
+use std::sync::atomic::{AtomicU16, AtomicU32, AtomicU64, AtomicU8, Ordering};
+
+/// An enum which `AtomicEnum` can hold: at most 8 bytes, `Copy`, and without
+/// padding between or after the fields of a variant.
+///
+/// Implemented by `#[extern_type(atomic)]`, which checks the fields.
+///
+/// # Safety
+///
+/// `write_bytes` must write the discriminant and the fields of the active
+/// variant at their offsets in `Self` and leave the other bytes alone, so
+/// the bytes read back as the same value.
+pub unsafe trait AtomicRepr: Copy {
+    /// The smallest of `AtomicU8` to `AtomicU64` which holds `Self`, the
+    /// same one C++ picks.
+    #[doc(hidden)]
+    type Storage: AtomicStorage;
+
+    #[doc(hidden)]
+    fn write_bytes(&self, bytes: &mut [u8; 8]);
+}
+
+/// An enum stored as an integer which is loaded, stored and
+/// compared-exchanged atomically, like `AtomicU32` and friends.
+///
+/// It has the layout of `rust::enm::atomic_variant` in C++: bridge it with
+/// `#[extern_type]` on an alias, and threads on both sides operate on the
+/// same memory:
+///
+/// ```ignore
+/// #[cxx_enumext::extern_type]
+/// pub type AtomicJobState = cxx_enumext::AtomicEnum<JobState>;
+/// ```
+///
+/// The integer holds the discriminant and the fields of the active variant,
+/// the other bytes are zero. `compare_exchange` compares these bytes, which
+/// is equality unless the variants hold floats (`0.0` and `-0.0` differ,
+/// equal NaNs compare equal).
+#[repr(transparent)]
+pub struct AtomicEnum<T: AtomicRepr> {
+    storage: T::Storage,
+    _value: PhantomData<T>,
+}
+
+type Bits<T> = <<T as AtomicRepr>::Storage as AtomicStorage>::Bits;
+
+impl<T: AtomicRepr> AtomicEnum<T> {
+    pub fn new(value: T) -> Self {
+        AtomicEnum {
+            storage: T::Storage::new(into_bits(value)),
+            _value: PhantomData,
+        }
+    }
+
+    pub fn into_inner(self) -> T {
+        // SAFETY: The storage only ever holds the bits of a `T`.
+        unsafe { from_bits(self.storage.into_inner()) }
+    }
+
+    pub fn load(&self, order: Ordering) -> T {
+        // SAFETY: The storage only ever holds the bits of a `T`.
+        unsafe { from_bits(self.storage.load(order)) }
+    }
+
+    pub fn store(&self, value: T, order: Ordering) {
+        self.storage.store(into_bits(value), order);
+    }
+
+    pub fn swap(&self, value: T, order: Ordering) -> T {
+        // SAFETY: The storage only ever holds the bits of a `T`.
+        unsafe { from_bits(self.storage.swap(into_bits(value), order)) }
+    }
+
+    /// Stores `new` if the value is `current` (see above). Returns the
+    /// previous value, as `Ok` if it was replaced.
+    pub fn compare_exchange(
+        &self,
+        current: T,
+        new: T,
+        success: Ordering,
+        failure: Ordering,
+    ) -> Result<T, T> {
+        let result =
+            self.storage
+                .compare_exchange(into_bits(current), into_bits(new), success, failure);
+        // SAFETY: The storage only ever holds the bits of a `T`.
+        unsafe { map_result(result) }
+    }
+
+    /// Like `compare_exchange`, but may fail spuriously, which is faster in
+    /// a loop on some platforms.
+    pub fn compare_exchange_weak(
+        &self,
+        current: T,
+        new: T,
+        success: Ordering,
+        failure: Ordering,
+    ) -> Result<T, T> {
+        let result = self.storage.compare_exchange_weak(
+            into_bits(current),
+            into_bits(new),
+            success,
+            failure,
+        );
+        // SAFETY: The storage only ever holds the bits of a `T`.
+        unsafe { map_result(result) }
+    }
+
+    /// Replaces the value by what `f` returns for it, calling `f` again if
+    /// another thread changed the value in between, like
+    /// `AtomicU32::fetch_update`. Returns the previous value, as `Err` if `f`
+    /// returned `None`.
+    pub fn fetch_update(
+        &self,
+        set_order: Ordering,
+        fetch_order: Ordering,
+        mut f: impl FnMut(T) -> Option<T>,
+    ) -> Result<T, T> {
+        let mut previous = self.load(fetch_order);
+        while let Some(next) = f(previous) {
+            match self.compare_exchange_weak(previous, next, set_order, fetch_order) {
+                Ok(previous) => return Ok(previous),
+                Err(current) => previous = current,
+            }
+        }
+        Err(previous)
+    }
+
+    /// Replaces the value by what `f` returns for it and returns the previous
+    /// value, the counterpart of `atomic_variant::update` in C++.
+    pub fn update(&self, order: Ordering, mut f: impl FnMut(T) -> T) -> T {
+        let fetch_order = match order {
+            Ordering::Release => Ordering::Relaxed,
+            Ordering::AcqRel => Ordering::Acquire,
+            order => order,
+        };
+        match self.fetch_update(order, fetch_order, |value| Some(f(value))) {
+            Ok(previous) | Err(previous) => previous,
+        }
+    }
+}
+
+impl<T: AtomicRepr> From<T> for AtomicEnum<T> {
+    fn from(value: T) -> Self {
+        Self::new(value)
+    }
+}
+
+impl<T: AtomicRepr + Default> Default for AtomicEnum<T> {
+    fn default() -> Self {
+        Self::new(T::default())
+    }
+}
+
+impl<T: AtomicRepr + fmt::Debug> fmt::Debug for AtomicEnum<T> {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        fmt::Debug::fmt(&self.load(Ordering::Relaxed), f)
+    }
+}
+
+fn into_bits<T: AtomicRepr>(value: T) -> Bits<T> {
+    let mut bytes = [0; 8];
+    value.write_bytes(&mut bytes);
+    T::Storage::bits_from_bytes(bytes)
+}
+
+/// # Safety
+///
+/// `bits` must come from `into_bits` or `atomic_variant` in C++.
+unsafe fn from_bits<T: AtomicRepr>(bits: Bits<T>) -> T {
+    let bytes = T::Storage::bits_to_bytes(bits);
+    ptr::read_unaligned(bytes.as_ptr().cast::<T>())
+}
+
+/// # Safety
+///
+/// See `from_bits`.
+unsafe fn map_result<T: AtomicRepr>(result: Result<Bits<T>, Bits<T>>) -> Result<T, T> {
+    match result {
+        Ok(bits) => Ok(from_bits(bits)),
+        Err(bits) => Err(from_bits(bits)),
+    }
+}
+
+/// The atomic integers `AtomicEnum` stores the enums in.
+#[doc(hidden)]
+pub trait AtomicStorage {
+    type Bits: Copy;
+
+    fn new(bits: Self::Bits) -> Self;
+    fn into_inner(self) -> Self::Bits;
+    fn load(&self, order: Ordering) -> Self::Bits;
+    fn store(&self, bits: Self::Bits, order: Ordering);
+    fn swap(&self, bits: Self::Bits, order: Ordering) -> Self::Bits;
+    fn compare_exchange(
+        &self,
+        current: Self::Bits,
+        new: Self::Bits,
+        success: Ordering,
+        failure: Ordering,
+    ) -> Result<Self::Bits, Self::Bits>;
+    fn compare_exchange_weak(
+        &self,
+        current: Self::Bits,
+        new: Self::Bits,
+        success: Ordering,
+        failure: Ordering,
+    ) -> Result<Self::Bits, Self::Bits>;
+    /// The integer with the first bytes of `bytes`, like `memcpy` in C++.
+    fn bits_from_bytes(bytes: [u8; 8]) -> Self::Bits;
+    fn bits_to_bytes(bits: Self::Bits) -> [u8; 8];
+}
+
+macro_rules! impl_atomic_storage {
+    ($($atomic:ident($int:ident),)*) => {$(
+        impl AtomicStorage for $atomic {
+            type Bits = $int;
+
+            #[inline]
+            fn new(bits: $int) -> Self {
+                $atomic::new(bits)
+            }
+
+            #[inline]
+            fn into_inner(self) -> $int {
+                $atomic::into_inner(self)
+            }
+
+            #[inline]
+            fn load(&self, order: Ordering) -> $int {
+                $atomic::load(self, order)
+            }
+
+            #[inline]
+            fn store(&self, bits: $int, order: Ordering) {
+                $atomic::store(self, bits, order)
+            }
+
+            #[inline]
+            fn swap(&self, bits: $int, order: Ordering) -> $int {
+                $atomic::swap(self, bits, order)
+            }
+
+            #[inline]
+            fn compare_exchange(
+                &self,
+                current: $int,
+                new: $int,
+                success: Ordering,
+                failure: Ordering,
+            ) -> Result<$int, $int> {
+                $atomic::compare_exchange(self, current, new, success, failure)
+            }
+
+            #[inline]
+            fn compare_exchange_weak(
+                &self,
+                current: $int,
+                new: $int,
+                success: Ordering,
+                failure: Ordering,
+            ) -> Result<$int, $int> {
+                $atomic::compare_exchange_weak(self, current, new, success, failure)
+            }
+
+            #[inline]
+            fn bits_from_bytes(bytes: [u8; 8]) -> $int {
+                let mut int = [0; size_of::<$int>()];
+                int.copy_from_slice(&bytes[..size_of::<$int>()]);
+                $int::from_ne_bytes(int)
+            }
+
+            #[inline]
+            fn bits_to_bytes(bits: $int) -> [u8; 8] {
+                let mut bytes = [0; 8];
+                bytes[..size_of::<$int>()].copy_from_slice(&bits.to_ne_bytes());
+                bytes
+            }
+        }
+    )*};
+}
+
+impl_atomic_storage! {
+    AtomicU8(u8),
+    AtomicU16(u16),
+    AtomicU32(u32),
+    AtomicU64(u64),
+}
+
+/// Picks the `AtomicStorage` of an enum of `SIZE` bytes.
+#[doc(hidden)]
+pub struct Size<const SIZE: usize>;
+
+#[doc(hidden)]
+pub trait SelectStorage {
+    type Storage: AtomicStorage;
+}
+
+macro_rules! select_storage {
+    ($($size:literal => $atomic:ident,)*) => {$(
+        impl SelectStorage for Size<$size> {
+            type Storage = $atomic;
+        }
+    )*};
+}
+
+select_storage! {
+    1 => AtomicU8,
+    2 => AtomicU16,
+    3 => AtomicU32,
+    4 => AtomicU32,
+    5 => AtomicU64,
+    6 => AtomicU64,
+    7 => AtomicU64,
+    8 => AtomicU64,
+}
+
+/// Copies the discriminant of `Tag` at the start of the enum at `value`
+/// to `bytes`.
+///
+/// # Safety
+///
+/// `value` must point to an enum with a discriminant of type `Tag`.
+#[doc(hidden)]
+#[inline]
+pub unsafe fn write_tag<Tag>(value: *const u8, bytes: &mut [u8; 8]) {
+    ptr::copy_nonoverlapping(value, bytes.as_mut_ptr(), size_of::<Tag>());
+}
+
+/// Copies `field` to `bytes` at its offset in the enum at `value`.
+///
+/// # Safety
+///
+/// `field` must be a field without padding of the enum at `value`, which is
+/// at most 8 bytes.
+#[doc(hidden)]
+#[inline]
+pub unsafe fn write_field<F>(value: *const u8, field: &F, bytes: &mut [u8; 8]) {
+    let field = (field as *const F).cast::<u8>();
+    let offset = field.offset_from(value) as usize;
+    ptr::copy_nonoverlapping(field, bytes.as_mut_ptr().add(offset), size_of::<F>());
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) Rachel Powers.
+ *
+ * This source code is licensed under both the MIT license found in the
+ * LICENSE-MIT file in the root directory of this source tree and the Apache
+ * License, Version 2.0 found in the LICENSE-APACHE file in the root directory
+ * of this source tree.
+ */
+
+//! Conversions of optionals, expecteds and nullables to and from `Option`
+//! and `Result` in bulk
+
+use std::iter::Map;
+use std::mem::{align_of, size_of, ManuallyDrop};
+
+/// The `Option` or `Result` an optional, expected or nullable converts from
+/// and to. Implemented by `#[extern_type]`.
+pub trait StdEnum: Sized + From<Self::Std> + Into<Self::Std> {
+    type Std;
+}
+
+/// A `StdEnum` which is a `#[repr(transparent)]` wrapper of its `Std`: the
+/// nullables, whose slices can be viewed as slices of `Option`.
+///
+/// # Safety
+///
+/// `Self` must have the same layout and validity as `Self::Std`.
+pub unsafe trait TransparentStdEnum: StdEnum {}
+
+/// Converts a `Vec` of optionals or expecteds to a `Vec` of `Option`s or
+/// `Result`s. The allocation is reused if both have the same size and
+/// alignment, which depends on the niches of the payload: `Optional<i32>`
+/// and `Option<i32>` do, `Optional<String>` doesn't.
+pub fn vec_into_std<T: StdEnum>(values: Vec<T>) -> Vec<T::Std> {
+    convert_vec(values, Into::into)
+}
+
+/// The inverse of `vec_into_std`.
+pub fn vec_from_std<T: StdEnum>(values: Vec<T::Std>) -> Vec<T> {
+    convert_vec(values, T::from)
+}
+
+/// Views nullables as the `Option`s they wrap.
+pub fn slice_as_std<T: TransparentStdEnum>(values: &[T]) -> &[T::Std] {
+    // SAFETY: `T` is `#[repr(transparent)]` around `T::Std`.
+    unsafe { std::slice::from_raw_parts(values.as_ptr().cast(), values.len()) }
+}
+
+/// Views nullables as the `Option`s they wrap.
+pub fn slice_as_std_mut<T: TransparentStdEnum>(values: &mut [T]) -> &mut [T::Std] {
+    // SAFETY: `T` is `#[repr(transparent)]` around `T::Std`.
+    unsafe { std::slice::from_raw_parts_mut(values.as_mut_ptr().cast(), values.len()) }
+}
+
+/// Views `Option`s as the nullables wrapping them, e.g. to pass them to C++.
+pub fn slice_from_std<T: TransparentStdEnum>(values: &[T::Std]) -> &[T] {
+    // SAFETY: `T` is `#[repr(transparent)]` around `T::Std`.
+    unsafe { std::slice::from_raw_parts(values.as_ptr().cast(), values.len()) }
+}
+
+/// Adapts iterators of optionals or expecteds.
+pub trait StdEnumIterator: Iterator + Sized
+where
+    Self::Item: StdEnum,
+{
+    /// Converts each item to its `Option` or `Result`.
+    #[allow(clippy::type_complexity)]
+    fn into_std(self) -> Map<Self, fn(Self::Item) -> <Self::Item as StdEnum>::Std> {
+        self.map(Into::into)
+    }
+}
+
+impl<I: Iterator> StdEnumIterator for I where I::Item: StdEnum {}
+
+fn convert_vec<A, B>(values: Vec<A>, mut convert: impl FnMut(A) -> B) -> Vec<B> {
+    if size_of::<A>() != size_of::<B>() || align_of::<A>() != align_of::<B>() {
+        return values.into_iter().map(convert).collect();
+    }
+
+    // If `convert` panics the allocation and the values are leaked.
+    let mut values = ManuallyDrop::new(values);
+    let (data, len, capacity) = (values.as_mut_ptr(), values.len(), values.capacity());
+    for index in 0..len {
+        // SAFETY: Each value is read before the converted value is written
+        // over it, `A` and `B` have the same size and alignment.
+        unsafe {
+            let slot = data.add(index);
+            let value = slot.read();
+            slot.cast::<B>().write(convert(value));
+        }
+    }
+    // SAFETY: The allocation has the layout of `capacity` values of `B` and
+    // holds `len` of them.
+    unsafe { Vec::from_raw_parts(data.cast::<B>(), len, capacity) }
+}
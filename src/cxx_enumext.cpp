@@ -26,6 +26,7 @@
 #define RUST_CXX_ENUMEXT_MACROS_H
 
 #include "rust/cxx_enumext.h"
+#include "rust/cxx_enumext_flat.h"
 
 namespace rust {
 namespace enm {
@@ -168,13 +169,15 @@ static_assert(!std::is_assignable_v<all_variant, std_all_variant &&>);
 // Checks with a variant consisting of only movable types.
 using move_variant = variant<MoveType, CopyAndMoveType>;
 
-// Check of copy and move construction/assignment. Since we disallow move
-// constructors/assignments none of the copy and move constructors should work.
+// Check of copy and move construction/assignment. Every type can be moved, so
+// the variant can be moved as well - but not copied.
 static_assert(!std::is_default_constructible_v<move_variant>);
-static_assert(!std::is_constructible_v<move_variant, move_variant &&>);
+static_assert(std::is_constructible_v<move_variant, move_variant &&>);
 static_assert(!std::is_constructible_v<move_variant, const move_variant &>);
 static_assert(!std::is_copy_assignable_v<move_variant>);
-static_assert(!std::is_move_assignable_v<move_variant>);
+static_assert(std::is_move_assignable_v<move_variant>);
+static_assert(std::is_nothrow_move_constructible_v<move_variant>);
+static_assert(std::is_nothrow_move_assignable_v<move_variant>);
 
 // Checks with the construction from std::variant. Since we can move every type
 // we should be able to move construct from std::variant. Copy constructors
@@ -189,12 +192,15 @@ static_assert(std::is_assignable_v<move_variant, std_move_variant &&>);
 using copy_variant = variant<CopyType, CopyAndMoveType>;
 
 // Check of copy and move construction/assignment. Copy constructor/assignment
-// should work since every type can be copy constructed/assigned.
+// should work since every type can be copy constructed/assigned. CopyType can't
+// be moved, so rvalues are copied - same as for std::variant.
 static_assert(!std::is_default_constructible_v<copy_variant>);
-static_assert(!std::is_constructible_v<copy_variant, copy_variant &&>);
+static_assert(std::is_constructible_v<copy_variant, copy_variant &&>);
 static_assert(std::is_constructible_v<copy_variant, const copy_variant &>);
 static_assert(std::is_copy_assignable_v<copy_variant>);
-static_assert(!std::is_move_assignable_v<copy_variant>);
+static_assert(std::is_move_assignable_v<copy_variant>);
+static_assert(std::is_move_constructible_v<copy_variant> ==
+              std::is_move_constructible_v<std::variant<CopyType, CopyAndMoveType>>);
 
 // Checks with the construction from std::variant. Since we can copy every type
 // we should be able to copy construct from std::variant. Move constructors
@@ -240,8 +246,194 @@ static_assert(std::is_same_v<decltype(get<0>(std::declval<copy_variant>())),
 static_assert(std::is_same_v<decltype(get<1>(std::declval<copy_variant>())),
                              const copy_variant_alternative_t<1> &>);
 
+// get_if of a const variant points to a const alternative.
+static_assert(
+    std::is_same_v<decltype(get_if<0>(std::declval<const copy_variant *>())),
+                   const copy_variant_alternative_t<0> *>);
+
+static_assert(std::is_same_v<decltype(get_if<CopyAndMoveType>(
+                                 std::declval<const copy_variant *>())),
+                             const CopyAndMoveType *>);
+
+// Variants of trivial types are trivially copyable and destructible so arrays
+// of them can be memcpy'd. A single non-trivial alternative makes the whole
+// variant non-trivial.
+struct TrivialTuple {
+  std::int32_t _0;
+  std::int32_t _1;
+};
+
+using trivial_variant =
+    variant<monostate, std::int64_t, bool, TrivialTuple, monostate>;
+static_assert(std::is_trivially_copyable_v<trivial_variant>);
+static_assert(std::is_trivially_destructible_v<trivial_variant>);
+static_assert(std::is_copy_assignable_v<trivial_variant>);
+static_assert(std::is_trivially_copyable_v<optional<std::int32_t>>);
+static_assert(std::is_trivially_destructible_v<optional<std::int32_t>>);
+static_assert(std::is_copy_assignable_v<optional<std::int32_t>>);
+static_assert(std::is_trivially_copyable_v<expected<std::int32_t, bool>>);
+static_assert(std::is_trivially_destructible_v<expected<std::int32_t, bool>>);
+static_assert(std::is_trivially_copyable_v<expected<void, std::int32_t>>);
+static_assert(std::is_trivially_destructible_v<expected<void, std::int32_t>>);
+
+using string_variant = variant<std::int64_t, std::string>;
+static_assert(!std::is_trivially_copyable_v<string_variant>);
+static_assert(!std::is_trivially_destructible_v<string_variant>);
+static_assert(std::is_copy_constructible_v<string_variant>);
+static_assert(!std::is_trivially_copyable_v<optional<std::string>>);
+static_assert(!std::is_trivially_destructible_v<expected<void, std::string>>);
+
+// Variants of Rust types can be moved, so they can be stored in growing
+// containers and returned by value. The move is noexcept if the alternatives'
+// moves are.
+static_assert(std::is_nothrow_move_constructible_v<string_variant>);
+static_assert(std::is_nothrow_move_assignable_v<string_variant>);
+static_assert(std::is_nothrow_move_constructible_v<optional<std::string>>);
+static_assert(std::is_nothrow_move_assignable_v<expected<void, std::string>>);
+static_assert(std::is_trivially_move_constructible_v<trivial_variant>);
+static_assert(std::is_trivially_move_assignable_v<trivial_variant>);
+
+// Only alternatives which are moved by their bytes, like Rust moves them, are
+// relocated by `emplace` and `swap`. `std::string` may point into itself.
+static_assert(is_trivially_relocatable<std::int64_t>::value);
+static_assert(is_trivially_relocatable<trivial_variant>::value);
+static_assert(!is_trivially_relocatable<std::string>::value);
+static_assert(noexcept(std::declval<string_variant &>().swap(
+    std::declval<string_variant &>())));
+
+// Copying a vector of trivially copyable variants asks whether they can be
+// constructed from non-const lvalues, which must not recurse into the
+// converting constructor.
+inline void copy_trivial_variants(std::vector<trivial_variant> &to,
+                                  const std::vector<trivial_variant> &from) {
+  to = from;
+}
+
+// The monadic operations of rvalues move the payload along, so they chain
+// move-only types. `optional::transform` returns a rust::enm::optional.
+struct halve {
+  double operator()(int x) const { return x * 0.5; }
+};
+struct count_error {
+  long operator()(MoveType &&) const { return 1; }
+};
+static_assert(
+    std::is_same_v<decltype(std::declval<optional<int> &>().transform(halve{})),
+                   optional<double>>);
+static_assert(std::is_same_v<decltype(std::declval<expected<int, MoveType>>()
+                                          .transform_error(count_error{})),
+                             expected<int, long>>);
+
+inline MoveType chain_optional(optional<MoveType> value) {
+  return std::move(value)
+      .and_then([](MoveType &&x) { return optional<MoveType>{std::move(x)}; })
+      .transform([](MoveType &&x) { return std::move(x); })
+      .or_else([] { return optional<MoveType>{MoveType{}}; })
+      .value_or(MoveType{});
+}
+
+inline MoveType chain_expected(expected<MoveType, std::string> value) {
+  using result = expected<MoveType, std::string>;
+  return std::move(value)
+      .and_then([](MoveType &&x) { return result{std::move(x)}; })
+      .transform([](MoveType &&x) { return std::move(x); })
+      .or_else([](std::string &&e) { return result{std::move(e)}; })
+      .transform_error([](std::string &&e) { return std::move(e); })
+      .value_or(MoveType{});
+}
+
+inline std::string chain_void_expected(expected<void, std::string> value) {
+  return std::move(value)
+      .and_then([] { return expected<void, std::string>{}; })
+      .or_else([](std::string &&e) {
+        return expected<void, std::string>{std::move(e)};
+      })
+      .transform_error([](std::string &&e) { return std::move(e); })
+      .error_or(std::string{});
+}
+
+// The access errors don't allocate and the unexpected value can be moved in
+// and out of bad_rust_expected_access.
+static_assert(std::is_nothrow_constructible_v<bad_rust_variant_access,
+                                              std::size_t, std::size_t>);
+static_assert(std::is_base_of_v<std::bad_variant_access,
+                                variant<int, bool>::bad_rust_variant_access>);
+static_assert(
+    std::is_nothrow_constructible_v<bad_rust_variant_index, std::size_t>);
+static_assert(
+    std::is_base_of_v<std::bad_variant_access, bad_rust_variant_index>);
+static_assert(std::is_base_of_v<std::bad_optional_access,
+                                bad_rust_optional_access>);
+static_assert(std::is_nothrow_constructible_v<
+              bad_rust_expected_access<std::string>, std::string &&>);
+static_assert(std::is_base_of_v<bad_rust_expected_access<void>,
+                                bad_rust_expected_access<MoveType>>);
+static_assert(std::is_same_v<
+              decltype(std::declval<bad_rust_expected_access<MoveType>>()
+                           .error()),
+              MoveType &&>);
+
+// Check that visit keeps the visitor's return type and only claims to be
+// noexcept if every alternative can be visited without throwing.
+struct nothrow_visitor {
+  int operator()(const CopyType &) const noexcept { return 0; }
+  int operator()(const CopyAndMoveType &) const noexcept { return 1; }
+};
+
+struct throwing_visitor {
+  int &operator()(const CopyType &) const;
+  int &operator()(const CopyAndMoveType &) const noexcept;
+};
+
+static_assert(std::is_same_v<decltype(visit(nothrow_visitor{},
+                                            std::declval<copy_variant &>())),
+                             int>);
+static_assert(std::is_same_v<decltype(visit(throwing_visitor{},
+                                            std::declval<copy_variant &>())),
+                             int &>);
+static_assert(
+    noexcept(visit(nothrow_visitor{}, std::declval<const copy_variant &>())));
+static_assert(
+    !noexcept(visit(throwing_visitor{}, std::declval<const copy_variant &>())));
+
+// Same for visiting several variants at once: the result of the first
+// combination is used and noexcept requires every combination to be noexcept.
+struct nothrow_pair_visitor {
+  template <typename... Rs> long operator()(const Rs &...) const noexcept {
+    return 0;
+  }
+};
+
+struct throwing_pair_visitor {
+  template <typename L, typename R> long operator()(const L &, const R &) const;
+  long operator()(const CopyAndMoveType &, const CopyType &) const noexcept;
+};
+
+static_assert(std::is_same_v<decltype(visit(nothrow_pair_visitor{},
+                                            std::declval<copy_variant &>(),
+                                            std::declval<copy_variant &>())),
+                             long>);
+static_assert(noexcept(visit(nothrow_pair_visitor{},
+                             std::declval<copy_variant &>(),
+                             std::declval<const copy_variant &>(),
+                             std::declval<copy_variant &>())));
+static_assert(!noexcept(visit(throwing_pair_visitor{},
+                              std::declval<copy_variant &>(),
+                              std::declval<const copy_variant &>())));
+
 static_assert(sizeof(monostate) == sizeof(std::uint8_t));
 
+// Nullables have the size of the contained type, like Rust's `Option<T>` for
+// types with a niche.
+static_assert(sizeof(nullable<bool>) == sizeof(bool));
+static_assert(sizeof(nullable<nonzero<std::uint32_t>>) ==
+              sizeof(std::uint32_t));
+static_assert(sizeof(nullable<std::reference_wrapper<CopyType>>) ==
+              sizeof(void *));
+static_assert(std::is_trivially_copyable_v<nullable<bool>>);
+static_assert(
+    std::is_trivially_copyable_v<nullable<std::reference_wrapper<CopyType>>>);
+
 // Verify that enums are represented as ints. We kind of assume that the enums
 // with more fields would be represented by the underlying type not smaller
 // than this enum (which is our smallest...). If this fails, we would need
@@ -249,9 +441,232 @@ static_assert(sizeof(monostate) == sizeof(std::uint8_t));
 enum a_enum { AA };
 
 static_assert(sizeof(std::underlying_type_t<a_enum>) == sizeof(int));
+
+// `#[repr(C, u8)]` enums store the discriminant in the given type, followed
+// by the union of the alternatives.
+using compact_variant = basic_variant<std::uint8_t, monostate, std::int16_t>;
+static_assert(sizeof(compact_variant) == 2 * sizeof(std::int16_t));
+static_assert(alignof(compact_variant) == alignof(std::int16_t));
+static_assert(std::is_trivially_copyable_v<compact_variant>);
+static_assert(sizeof(basic_variant<std::uint16_t, monostate, std::uint8_t>) ==
+              2 * sizeof(std::uint16_t));
+static_assert(sizeof(basic_variant<std::uint8_t, std::int64_t, double>) ==
+              2 * sizeof(std::int64_t));
+static_assert(std::is_same_v<variant<std::int64_t, double>,
+                             basic_variant<int, std::int64_t, double>>);
+
+// The struct of arrays exposes the tags and every alternative as contiguous
+// arrays, bools included.
+using soa_variant = soa_vector<variant<std::int64_t, bool, CopyType>>;
+static_assert(
+    std::is_same_v<decltype(std::declval<const soa_variant &>().tags()),
+                   span<const int>>);
+static_assert(
+    std::is_same_v<decltype(std::declval<soa_variant &>().column<1>()),
+                   span<bool>>);
+static_assert(
+    std::is_same_v<
+        decltype(std::declval<const soa_variant &>().column<CopyType>()),
+        span<const CopyType>>);
+static_assert(
+    std::is_same_v<decltype(std::declval<soa_vector<compact_variant> &>()
+                                .tags()),
+                   span<const std::uint8_t>>);
+
+// Instantiates the tag scanning kernels, tests/suite/scan.cpp runs them with
+// SSE4.1 and AVX2. Strides of 4, 8 and 16 bytes are loaded, others gathered.
+template <typename Variant>
+inline std::size_t scan_tags(const std::vector<Variant> &values) {
+  return count_alternatives(values)[0] + find_alternative<1>(values) +
+         alternative_mask<0>(values).size() + has_valid_tags(values);
+}
+
+using stride6_variant =
+    basic_variant<std::uint16_t, monostate, std::array<std::uint16_t, 2>>;
+static_assert(sizeof(stride6_variant) == 6);
+
+inline std::size_t
+scan_every_stride(const std::vector<compact_variant> &stride4,
+                  const std::vector<stride6_variant> &stride6,
+                  const std::vector<variant<std::int32_t, float>> &stride8,
+                  const std::vector<variant<std::int64_t, double>> &stride16) {
+  return scan_tags(stride4) + scan_tags(stride6) + scan_tags(stride8) +
+         scan_tags(stride16);
+}
+
+// Variants of integers, `bool` and empty alternatives compare with a single
+// `memcmp`, floating point needs the alternative's `==`.
+static_assert(
+    variant_comparison<std::uint8_t, monostate, std::int16_t>::trivial);
+static_assert(!variant_comparison<int, std::int64_t, double>::trivial);
+static_assert(is_trivially_comparable_v<nonzero<std::uint32_t>>);
+
+// `==` only needs `==` of the alternatives, also when C++20 adds `<=>`.
+struct equality_only {
+  int value;
+  friend bool operator==(const equality_only &lhs, const equality_only &rhs) {
+    return lhs.value == rhs.value;
+  }
+};
+inline bool equal_without_ordering(const variant<int, equality_only> &lhs,
+                                   const variant<int, equality_only> &rhs) {
+  return lhs == rhs;
+}
+
+// Variants of trivially copyable alternatives are stored in flat files as
+// they are, the elements start at a cache line.
+static_assert(is_flat_serializable_v<compact_variant>);
+static_assert(!is_flat_serializable_v<variant<std::int64_t, std::string>>);
+static_assert(flat_layout<compact_variant>::value_offset == 2);
+static_assert(flat_layout<compact_variant>::data_offset == 128);
+
+// Integers and `nonzero` hash as their bytes, like in Rust.
+static_assert(is_contiguously_hashable_v<std::int16_t>);
+static_assert(is_contiguously_hashable_v<nonzero<std::uint32_t>>);
+static_assert(!is_contiguously_hashable_v<double>);
+static_assert(!is_contiguously_hashable_v<compact_variant>);
+static_assert(is_generically_hashable_v<std::vector<std::int32_t>>);
+
+// Variants of trivially copyable alternatives keep them in a union, which
+// doesn't change their layout.
+static_assert(is_trivial_variant_v<monostate, std::int16_t>);
+static_assert(!is_trivial_variant_v<std::int64_t, std::string>);
+static_assert(sizeof(alternatives_t<monostate, std::int16_t>) ==
+              sizeof(std::int16_t));
+
+// Aggregates, like `TUPLE` and `STRUCT` alternatives, are created in place
+// from their fields, which `emplace_into` relies on.
+struct pair_alternative {
+  std::int16_t _0;
+  std::string _1;
+};
+using pair_variant = variant<monostate, pair_alternative>;
+static_assert(is_initializable_v<pair_alternative, std::int16_t, std::string>);
+static_assert(!is_initializable_v<pair_alternative, std::string>);
+static_assert(std::is_constructible_v<pair_variant,
+                                      std::in_place_type_t<pair_alternative>,
+                                      std::int16_t, const char *>);
+static_assert(
+    std::is_nothrow_constructible_v<pair_variant, std::in_place_index_t<1>,
+                                    std::int16_t, std::string &&>);
+static_assert(
+    !std::is_nothrow_constructible_v<pair_variant, std::in_place_index_t<1>,
+                                     std::int16_t, const char *>);
+static_assert(noexcept(emplace_into<pair_alternative>(
+    std::declval<pair_variant *>(), std::int16_t{1}, std::string())));
+
+// Small trivially copyable variants are packed into an atomic integer with
+// the same layout, which Rust's `AtomicEnum` shares.
+static_assert(std::is_same_v<atomic_bits<compact_variant>::type,
+                             std::uint32_t>);
+static_assert(atomic_bits<compact_variant>::value_offset ==
+              sizeof(std::int16_t));
+static_assert(atomic_bits<compact_variant>::value_sizes[0] == 0);
+static_assert(sizeof(atomic_variant<compact_variant>) ==
+              sizeof(std::uint32_t));
+static_assert(atomic_variant<compact_variant>::is_always_lock_free);
+static_assert(!std::is_copy_constructible_v<atomic_variant<compact_variant>>);
+
+#if CXX_ENUMEXT_CONSTEXPR_VARIANT
+// ... and lets them be built, read and visited in constant expressions.
+struct constant_visitor {
+  constexpr long operator()(monostate) const noexcept { return -1; }
+  constexpr long operator()(std::int16_t value) const noexcept {
+    return value;
+  }
+};
+
+constexpr compact_variant constant_table[] = {
+    compact_variant{monostate{}},
+    compact_variant{std::int16_t{7}},
+    compact_variant{std::in_place_index<1>, std::int16_t{-3}},
+};
+
+constexpr long sum_constant_table() {
+  long sum = 0;
+  for (const auto &element : constant_table) {
+    sum += visit(constant_visitor{}, element);
+  }
+  return sum;
+}
+
+static_assert(constant_table[0].index() == 0);
+static_assert(get<1>(constant_table[1]) == 7);
+static_assert(get_if<std::int16_t>(&constant_table[2]) != nullptr);
+static_assert(get_if<monostate>(&constant_table[2]) == nullptr);
+static_assert(sum_constant_table() == 3);
+static_assert(*optional<std::int32_t>(5) == 5);
+static_assert(expected<std::int32_t, std::uint8_t>(4).value_or(0) == 4);
+#endif
+
+/// @brief A type owning heap memory whose move assignment may throw, so
+/// assigning the variant can't take the `noexcept` shortcut of the converting
+/// assignment.
+struct OwningType {
+  explicit OwningType(std::string value) : value(std::move(value)) {}
+  OwningType(const OwningType &other) = default;
+  OwningType(OwningType &&other) noexcept = default;
+
+  OwningType &operator=(const OwningType &other) = default;
+  OwningType &operator=(OwningType &&other) {
+    value = std::move(other.value);
+    return *this;
+  }
+
+  std::string value;
+};
+
+using owning_variant = variant<std::int32_t, OwningType>;
+static_assert(!std::is_nothrow_move_assignable_v<owning_variant>);
+
+#ifdef CXX_ENUMEXT_RUNTIME_CHECKS
+/// @brief Assigns variants to themselves and to each other, returns the
+/// number of them which don't hold the expected value afterwards.
+inline std::size_t self_assignment_errors() {
+  const std::string text(64, 'x');
+  const auto holds = [&text](const owning_variant &variant) {
+    return variant.index() == 1 && get<1>(variant).value == text;
+  };
+  std::size_t errors = 0;
+
+  owning_variant value(std::in_place_index<1>, text);
+  owning_variant &alias = value;
+  value = std::move(alias);
+  errors += !holds(value);
+  value = alias;
+  errors += !holds(value);
+
+  owning_variant other(std::in_place_index<1>, text);
+  other = std::move(value);
+  errors += !holds(other);
+  owning_variant number(std::in_place_index<0>, 1);
+  number = std::move(other);
+  errors += !holds(number);
+  number = owning_variant(std::in_place_index<0>, 2);
+  errors += number.index() != 0 || get<0>(number) != 2;
+
+  optional<OwningType> some(OwningType{text});
+  optional<OwningType> &some_alias = some;
+  some = std::move(some_alias);
+  errors += !some.has_value() || some->value != text;
+
+  expected<OwningType, std::int32_t> ok(OwningType{text});
+  expected<OwningType, std::int32_t> &ok_alias = ok;
+  ok = std::move(ok_alias);
+  errors += !ok.has_value() || ok->value != text;
+  return errors;
+}
+#endif
 } // namespace detail
 
 } // namespace enm
 } // namespace rust
 
+#ifdef CXX_ENUMEXT_RUNTIME_CHECKS
+// Called by tests/suite, which builds this file with the runtime checks.
+std::size_t variant_self_assignment_errors() {
+  return rust::enm::detail::self_assignment_errors();
+}
+#endif
+
 #endif
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) Rachel Powers.
+ *
+ * This source code is licensed under both the MIT license found in the
+ * LICENSE-MIT file in the root directory of this source tree and the Apache
+ * License, Version 2.0 found in the LICENSE-APACHE file in the root directory
+ * of this source tree.
+ */
+
+// cxx_enumext/src/cxx_enumext_core.cpp
+
+// This file only includes the headers the definitions of the enums include
+// (the generated ones and the macros) to make sure they stand alone, without
+// the comparisons, containers and hashing of "rust/cxx_enumext.h".
+
+#include "rust/cxx_enumext_core.h"
+#include "rust/cxx_enumext_macros.h"
+#include "rust/cxx_enumext_optional.h"
+
+#include <cstdint>
+
+#if defined(RUST_CXX_ENUMEXT_H) || defined(RUST_CXX_ENUMEXT_COMPARE_H) ||     \
+    defined(RUST_CXX_ENUMEXT_RANGES_H) || defined(RUST_CXX_ENUMEXT_HASH_H)
+#error "The definitions of the enums must not include the whole library"
+#endif
+
+CXX_DEFINE_VARIANT_REPR(CoreEnum, uint8_t,
+                        (UNIT(Empty), TYPE(Id, int64_t),
+                         TUPLE(Pair, int32_t, int32_t),
+                         STRUCT(Named, int32_t id;
+                                rust::enm::nonzero<uint32_t> tag;)), )
+
+CXX_DEFINE_OPTIONAL(CoreOption, CoreEnum)
+
+namespace rust {
+namespace enm {
+
+/// @brief Below checks that the core stands alone.
+namespace detail {
+
+static_assert(sizeof(CoreEnum) == 2 * sizeof(std::int64_t));
+static_assert(is_trivially_comparable_v<CoreEnum::Pair>);
+static_assert(is_contiguously_hashable_v<nonzero<std::uint32_t>>);
+
+// Instantiate the accessors and the visitation.
+[[maybe_unused]] static std::int64_t use_core(CoreEnum &value,
+                                              const CoreOption &option) {
+  std::int64_t sum = value.index();
+  if (const auto *id = get_if<CoreEnum::Id>(&value)) {
+    sum += *id;
+  }
+  if (holds_alternative<CoreEnum::Pair>(value)) {
+    sum += get<CoreEnum::Pair>(value)._0;
+  }
+  value.emplace<CoreEnum::Named>(CoreEnum::Named{1, nonzero<uint32_t>(2)});
+  sum += visit(
+      [](const auto &alternative) -> std::int64_t {
+        return sizeof(alternative);
+      },
+      value);
+  return sum + option.has_value();
+}
+
+} // namespace detail
+
+} // namespace enm
+} // namespace rust
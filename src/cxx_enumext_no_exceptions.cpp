@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) Rachel Powers.
+ *
+ * This source code is licensed under both the MIT license found in the
+ * LICENSE-MIT file in the root directory of this source tree and the Apache
+ * License, Version 2.0 found in the LICENSE-APACHE file in the root directory
+ * of this source tree.
+ */
+
+// cxx_enumext/src/cxx_enumext_no_exceptions.cpp
+
+// This file is compiled with exceptions disabled (`-fno-exceptions`) to make
+// sure the header stays usable in such builds.
+
+#include "rust/cxx_enumext.h"
+
+#include <string>
+
+namespace rust {
+namespace enm {
+
+/// @brief Below checks for builds without exceptions.
+namespace detail {
+
+#if !CXX_ENUMEXT_EXCEPTIONS
+static_assert(CXX_ENUMEXT_BAD_ACCESS_POLICY == CXX_ENUMEXT_BAD_ACCESS_ABORT,
+              "Builds without exceptions should abort on a bad access");
+#endif
+
+using no_exceptions_variant = variant<std::int64_t, std::string, bool>;
+
+// The unchecked accessors never fail and are therefore noexcept.
+static_assert(noexcept(get_unchecked<1>(std::declval<no_exceptions_variant &>())));
+static_assert(
+    noexcept(get_unchecked<1>(std::declval<const no_exceptions_variant &>())));
+static_assert(
+    noexcept(get_unchecked<bool>(std::declval<no_exceptions_variant &>())));
+static_assert(std::is_same_v<decltype(get_unchecked<1>(
+                                 std::declval<no_exceptions_variant &>())),
+                             std::string &>);
+static_assert(noexcept(*std::declval<optional<std::string> &>()));
+static_assert(noexcept(*std::declval<const optional<std::string> &>()));
+static_assert(noexcept(std::declval<optional<std::string> &>()->size()));
+static_assert(noexcept(*std::declval<expected<std::int64_t, std::string> &>()));
+
+// Instantiate everything reporting a bad access, so the bodies are compiled
+// without exceptions.
+[[maybe_unused]] static std::size_t
+use_checked_accessors(no_exceptions_variant &variant,
+                      const optional<std::string> &opt,
+                      const expected<std::int64_t, std::string> &exp,
+                      expected<void, std::string> &exp_void) {
+  std::size_t size = get<1>(variant).size() + get<std::string>(variant).size();
+  size += opt.value().size();
+  size += optional<std::string>(opt).value().size();
+  size += static_cast<std::size_t>(exp.value());
+  exp_void.value();
+  size += visit([](const auto &value) { return sizeof(value); }, variant);
+  size += visit([](const auto &, const auto &) { return std::size_t{1}; },
+                variant, opt);
+  visit_grouped(span<no_exceptions_variant>(&variant, 1),
+                [&size](const auto &value) { size += sizeof(value); });
+  variant.emplace<std::string>("emplaced");
+  return size;
+}
+
+} // namespace detail
+
+} // namespace enm
+} // namespace rust
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) Rachel Powers.
+ *
+ * This source code is licensed under both the MIT license found in the
+ * LICENSE-MIT file in the root directory of this source tree and the Apache
+ * License, Version 2.0 found in the LICENSE-APACHE file in the root directory
+ * of this source tree.
+ */
+
+//! Construction of enums by C++ in storage owned by Rust, the counterpart of
+//! C++'s `rust::enm::emplace_into`
+
+use std::mem::MaybeUninit;
+
+/// Lets C++ construct values right in storage owned by Rust.
+///
+/// A C++ function returning an enum by value builds it on its stack before
+/// cxx copies it into the return slot. Instead the bridge can pass a
+/// `*mut T` to uninitialized storage, which the C++ side fills with
+/// `rust::enm::emplace_into`:
+///
+/// ```ignore
+/// // unsafe fn make_enum_into<'a>(out: *mut RustEnum<'a>, val: i32);
+/// let mut slot = MaybeUninit::uninit();
+/// let value = unsafe { RustEnum::init_in_place(&mut slot, |out| ffi::make_enum_into(out, 42)) };
+/// ```
+///
+/// Implemented by `#[extern_type]` for every item.
+///
+/// # Safety
+///
+/// The methods are safe to call if `init` initializes the value(s) at the
+/// pointer it is passed before it returns (or returns `Ok` for the `try_`
+/// methods). It must not read the storage, which may be uninitialized.
+pub trait Emplace: Sized {
+    /// Returns the value `init` constructs. The value may still be moved to
+    /// the caller, use `init_in_place` or `extend_in_place` to keep it where
+    /// it was constructed.
+    ///
+    /// # Safety
+    ///
+    /// See [`Emplace`].
+    #[inline]
+    unsafe fn new_in_place(init: impl FnOnce(*mut Self)) -> Self {
+        let mut slot = MaybeUninit::uninit();
+        init(slot.as_mut_ptr());
+        slot.assume_init()
+    }
+
+    /// Like `new_in_place` for C++ functions which may throw, bridged as
+    /// returning `Result<()>`. Nothing is constructed if `init` fails.
+    ///
+    /// # Safety
+    ///
+    /// See [`Emplace`].
+    #[inline]
+    unsafe fn try_new_in_place<E>(
+        init: impl FnOnce(*mut Self) -> Result<(), E>,
+    ) -> Result<Self, E> {
+        let mut slot = MaybeUninit::uninit();
+        init(slot.as_mut_ptr())?;
+        Ok(slot.assume_init())
+    }
+
+    /// Constructs the value in `slot` (e.g. the contents of
+    /// `Box::new_uninit()`) and returns it.
+    ///
+    /// # Safety
+    ///
+    /// See [`Emplace`].
+    #[inline]
+    unsafe fn init_in_place(
+        slot: &mut MaybeUninit<Self>,
+        init: impl FnOnce(*mut Self),
+    ) -> &mut Self {
+        init(slot.as_mut_ptr());
+        slot.assume_init_mut()
+    }
+
+    /// Appends `len` values to `vec`, which `init` constructs in the spare
+    /// capacity of `vec`: it gets a pointer to the first of `len` values.
+    ///
+    /// If `init` panics `vec` keeps its length and the values it constructed
+    /// are leaked.
+    ///
+    /// # Safety
+    ///
+    /// See [`Emplace`], `init` must construct all `len` values.
+    #[inline]
+    unsafe fn extend_in_place(
+        vec: &mut Vec<Self>,
+        len: usize,
+        init: impl FnOnce(*mut Self, usize),
+    ) {
+        vec.reserve(len);
+        init(vec.spare_capacity_mut().as_mut_ptr().cast(), len);
+        vec.set_len(vec.len() + len);
+    }
+
+    /// Like `extend_in_place` for C++ functions which may throw. `vec` keeps
+    /// its length if `init` fails, the values it constructed so far are
+    /// leaked.
+    ///
+    /// # Safety
+    ///
+    /// See [`Emplace`], `init` must construct all `len` values if it returns
+    /// `Ok`.
+    #[inline]
+    unsafe fn try_extend_in_place<E>(
+        vec: &mut Vec<Self>,
+        len: usize,
+        init: impl FnOnce(*mut Self, usize) -> Result<(), E>,
+    ) -> Result<(), E> {
+        vec.reserve(len);
+        init(vec.spare_capacity_mut().as_mut_ptr().cast(), len)?;
+        vec.set_len(vec.len() + len);
+        Ok(())
+    }
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) Rachel Powers.
+ *
+ * This source code is licensed under both the MIT license found in the
+ * LICENSE-MIT file in the root directory of this source tree and the Apache
+ * License, Version 2.0 found in the LICENSE-APACHE file in the root directory
+ * of this source tree.
+ */
+
+//! Hashing shared with C++'s `rust::enm::hash_value`
+
+use std::hash::{BuildHasher, Hash, Hasher};
+
+const SEED: u64 = 0x243f_6a88_85a3_08d3;
+const MULTIPLIER: u64 = 0x9e37_79b9_7f4a_7c15;
+
+/// The hasher of `rust::enm::hasher` in C++.
+///
+/// The hash only depends on the concatenation of the written bytes, so
+/// C++ may hash structs without padding at once where Rust hashes them field
+/// by field.
+#[derive(Clone, Debug)]
+pub struct CxxHasher {
+    state: u64,
+    length: u64,
+    tail: [u8; 8],
+    tail_len: usize,
+}
+
+impl CxxHasher {
+    pub const fn new() -> Self {
+        CxxHasher {
+            state: SEED,
+            length: 0,
+            tail: [0; 8],
+            tail_len: 0,
+        }
+    }
+
+    #[inline]
+    fn mix(state: u64, word: u64) -> u64 {
+        (state.rotate_left(23) ^ word).wrapping_mul(MULTIPLIER)
+    }
+}
+
+impl Default for CxxHasher {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl Hasher for CxxHasher {
+    fn write(&mut self, mut bytes: &[u8]) {
+        self.length += bytes.len() as u64;
+        if self.tail_len != 0 {
+            let count = bytes.len().min(8 - self.tail_len);
+            self.tail[self.tail_len..self.tail_len + count].copy_from_slice(&bytes[..count]);
+            self.tail_len += count;
+            bytes = &bytes[count..];
+            if self.tail_len < 8 {
+                return;
+            }
+            self.state = Self::mix(self.state, u64::from_ne_bytes(self.tail));
+            self.tail_len = 0;
+        }
+        let mut words = bytes.chunks_exact(8);
+        for word in &mut words {
+            self.state = Self::mix(self.state, u64::from_ne_bytes(word.try_into().unwrap()));
+        }
+        let rest = words.remainder();
+        self.tail[..rest.len()].copy_from_slice(rest);
+        self.tail_len = rest.len();
+    }
+
+    #[inline]
+    fn write_u64(&mut self, value: u64) {
+        if self.tail_len == 0 {
+            self.length += 8;
+            self.state = Self::mix(self.state, value);
+        } else {
+            self.write(&value.to_ne_bytes());
+        }
+    }
+
+    fn finish(&self) -> u64 {
+        let mut state = self.state;
+        if self.tail_len != 0 {
+            let mut tail = [0; 8];
+            tail[..self.tail_len].copy_from_slice(&self.tail[..self.tail_len]);
+            state = Self::mix(state, u64::from_ne_bytes(tail));
+        }
+        state = Self::mix(state, self.length);
+        // The finalizer of MurmurHash3.
+        state ^= state >> 33;
+        state = state.wrapping_mul(0xff51_afd7_ed55_8ccd);
+        state ^= state >> 33;
+        state = state.wrapping_mul(0xc4ce_b9fe_1a85_ec53);
+        state ^= state >> 33;
+        state
+    }
+}
+
+/// Builds [`CxxHasher`]s, e.g. for a `HashMap` agreeing with C++'s
+/// `rust::enm::hash<>` on how to partition keys.
+#[derive(Clone, Copy, Debug, Default)]
+pub struct BuildCxxHasher;
+
+impl BuildHasher for BuildCxxHasher {
+    type Hasher = CxxHasher;
+
+    fn build_hasher(&self) -> CxxHasher {
+        CxxHasher::new()
+    }
+}
+
+/// The hash of `value`, equal to `rust::enm::hash_value(value)` in C++ for
+/// types generated by `#[cxx_enumext::extern_type(hash)]` and the types
+/// they contain.
+pub fn hash<T: Hash + ?Sized>(value: &T) -> u64 {
+    let mut hasher = CxxHasher::new();
+    value.hash(&mut hasher);
+    hasher.finish()
+}
@@ -108,6 +108,17 @@
 //!     Unit2,
 //! }
 //!
+//!
+//! // `#[repr(u8)]`, `#[repr(u16)]` (up to 64 bit) and `#[repr(C, u8)]` shrink the
+//! // discriminant from a C int. They are all generated as `#[repr(C, u8)]`
+//! // (a tag followed by the union of the variants) to match the C++ layout.
+//! #[cxx_enumext::extern_type]
+//! #[repr(u8)]
+//! pub enum CompactEnum {
+//!     Empty,
+//!     Pair(i16, i16),
+//! }
+//!
 //! // Declare type aliases for an Optional, "alias" can be for `Optional<T>` or
 //! // `cxx_enumext::Optional<T>`, neither type truely exists but the name will be
 //! // used to determine the enum variants to generate
@@ -126,6 +137,17 @@
 //! pub type I32StringResult = cxx_enumext::Expected<i32, String>;
 //!
 //!
+//! // `Option<T>` can be used directly when `T` has a niche (`Box<T>`, `&T`,
+//! // `&mut T`, `bool` and the `NonZero` integers). Rust stores `None` inside the
+//! // bytes of `T`, so no tag is needed and the type keeps the size of `T`.
+//! // Rust guarantees this layout except for `bool`, so the generated code
+//! // asserts it at compile time.
+//! // A `#[repr(transparent)]` wrapper struct is generated around the `Option`.
+//! #[cxx_enumext::extern_type]
+//! #[derive(Debug)]
+//! pub type OptionalBox = Option<Box<RustValue>>;
+//!
+//!
 //! #[cxx::bridge]
 //! pub mod ffi {
 //!
@@ -133,8 +155,10 @@
 //!         include!("my_crate/src/enum.h");
 //!
 //!         type RustEnum<'a> = super::RustEnum<'a>;
+//!         type CompactEnum = super::CompactEnum;
 //!         type I32StringResult = super::I32StringResult;
 //!         type OptionalInt32 = super::OptionalI32;
+//!         type OptionalBox = super::OptionalBox;
 //!     }
 //! }
 //! ```
@@ -142,8 +166,30 @@
 //! This will generate the `cxx::ExternType` impl as well as some non-exhaustive
 //! static assertions to check that contained types are at least externable.
 //!
-//! for `Optional` and `Expected` types some `std::convert::From<T>` impls will be cenerated
-//! to convert from and to `Option` and `Result` types
+//! For `Optional` and `Expected` types some `std::convert::From<T>` impls will be generated
+//! to convert from and to `Option` and `Result` types. `as_option()` and
+//! `as_result()` borrow them as `Option<&T>` and `Result<&T, &E>` instead,
+//! `as_mut()` as `Option<&mut T>` and `Result<&mut T, &mut E>`, and
+//! `into_option()` and `into_result()` convert them. Nullables have
+//! `as_option()` and `into_option()` too, and dereference to their `Option`.
+//!
+//! In bulk, `cxx_enumext::convert` converts whole `Vec`s and `StdEnumIterator`
+//! adapts iterators:
+//!
+//! ```rust
+//! use cxx_enumext::{convert, StdEnumIterator};
+//!
+//! // Reuses the allocation, `Optional<i32>` has the size of `Option<i32>`.
+//! let options: Vec<Option<i32>> = convert::vec_into_std(optionals);
+//! let results: Vec<Result<i32, String>> = expecteds.into_iter().into_std().collect();
+//! // Nullables wrap their `Option`, their slices are viewed without copies.
+//! let boxes: &[Option<Box<RustValue>>] = convert::slice_as_std(&nullables);
+//! ```
+//!
+//! `vec_into_std` and `vec_from_std` convert in place when both types have the
+//! same size and alignment. That depends on the niches of the payload:
+//! `Optional<String>` is larger than `Option<String>` and is collected into a
+//! new `Vec`.
 //!
 //! Now, in your C++ file, make sure to `#include` the right headers:
 //!
@@ -204,6 +250,11 @@
 //! )
 //!
 //!
+//! // Enums with a `repr` attribute name the discriminant type as the second argument
+//! CXX_DEFINE_VARIANT_REPR(CompactEnum, uint8_t,
+//!                         (UNIT(Empty), TUPLE(Pair, int16_t, int16_t)))
+//!
+//!
 //! // The first argument is the name of the C++ type, and the second contained type
 //! // An optional third (actualy variadic) argument is placed verbatim in the resulting struct body.
 //! CXX_DEFINE_OPTIONAL(OptionalInt32, int32_t)
@@ -213,6 +264,11 @@
 //! // An optional forth (actualy variadic) argument is placed verbatim in the resulting struct body.
 //! CXX_DEFINE_EXPECTED(I32StringResult, int32_t, rust::string)
 //!
+//! // Same as `CXX_DEFINE_OPTIONAL` for `Option<T>` aliases of types with a niche.
+//! // `&T` maps to `std::reference_wrapper<T>` and `NonZeroU32` to
+//! // `rust::enm::nonzero<uint32_t>`
+//! CXX_DEFINE_NULLABLE(OptionalBox, rust::box<RustValue>)
+//!
 //! ```
 //!
 //! You're all set! Now you can use the enum types on either side of your ffi.
@@ -221,6 +277,248 @@
 //!
 //! You will need a C++ compiler that implements c++17
 //!
+//! ### Builds without exceptions
+//!
+//! Bad accesses (e.g. `get` with the wrong index or `value()` of an empty
+//! optional) throw by default. Define `CXX_ENUMEXT_BAD_ACCESS_POLICY` before
+//! including the headers to pick another behavior:
+//!
+//! - `CXX_ENUMEXT_BAD_ACCESS_THROW`: throw the documented exception (default if
+//!   exceptions are enabled)
+//! - `CXX_ENUMEXT_BAD_ACCESS_ABORT`: call `std::abort` (default with
+//!   `-fno-exceptions`)
+//! - `CXX_ENUMEXT_BAD_ACCESS_HOOK`: call
+//!   `[[noreturn]] void rust::enm::bad_access_hook(const char *what) noexcept`,
+//!   which you have to define
+//! - `CXX_ENUMEXT_BAD_ACCESS_UNREACHABLE`: treat bad accesses as undefined
+//!   behavior, removing the checks
+//!
+//! `get_unchecked`, `*optional` and `*expected` never check and are `noexcept`.
+//!
+//! Whatever the policy, the failing checks call one out of line function marked
+//! cold, so the accessors stay small and their failure paths don't sit in the hot
+//! code. Its name depends on the policy, so libraries built with different
+//! policies can be linked together, as long as they don't share the functions
+//! using the enums. Throwing doesn't allocate: `bad_rust_variant_access` keeps the requested
+//! and the active index as numbers and formats them only when `what()` is called.
+//! An index which names no alternative (e.g. a tag read from corrupted memory)
+//! is reported with `bad_rust_variant_index` the same way.
+//!
+//! ### Batches of enums
+//!
+//! Enums declared with `#[cxx_enumext::extern_type]` can cross the bridge in
+//! bulk like any other trivial extern type: as slices (`&[T]` /
+//! `rust::Slice<const T>`), `Vec<T>` (`rust::Vec<T>`) or
+//! `UniquePtr<CxxVector<T>>` (`std::unique_ptr<std::vector<T>>`). cxx
+//! generates the container glue from the bridge signatures, an explicit
+//! `impl Vec<T> {}` / `impl CxxVector<T> {}` in the bridge is only needed when
+//! the container doesn't appear in a signature.
+//!
+//! ```rust
+//! #[cxx::bridge]
+//! mod ffi {
+//!     unsafe extern "C++" {
+//!         include!("my_crate/include/types.h");
+//!         type CompactEnum = crate::CompactEnum;
+//!
+//!         fn sum_compact(values: &[CompactEnum]) -> i32;
+//!         fn make_compact_vec(len: usize) -> Vec<CompactEnum>;
+//!     }
+//! }
+//! ```
+//!
+//! The variants themselves may hold `Vec<T>`, `&[T]`, `UniquePtr<CxxVector<T>>`
+//! and friends, the generated assertions check the element types instead of
+//! the containers.
+//!
+//! ### Constructing in place
+//!
+//! A C++ function returning an enum builds it on its stack, then cxx copies it
+//! into Rust's return slot. To construct large enums where Rust keeps them,
+//! bridge a pointer to uninitialized storage instead and fill it with
+//! `rust::enm::emplace_into`, which creates the alternative right in the
+//! storage (`TUPLE` and `STRUCT` alternatives from their fields):
+//!
+//! ```rust
+//! #[cxx::bridge]
+//! mod ffi {
+//!     unsafe extern "C++" {
+//!         include!("my_crate/include/types.h");
+//!         type RustEnum<'a> = crate::RustEnum<'a>;
+//!         type CompactEnum = crate::CompactEnum;
+//!
+//!         unsafe fn make_struct_into<'a>(out: *mut RustEnum<'a>, val: i32, str: &str);
+//!         unsafe fn make_pairs_into(out: *mut CompactEnum, len: usize);
+//!     }
+//! }
+//! ```
+//!
+//! ```cpp
+//! void make_struct_into(RustEnum *out, int32_t val, rust::Str str) {
+//!   rust::enm::emplace_into<RustEnum::Struct>(out, val, rust::String(str));
+//! }
+//!
+//! void make_pairs_into(CompactEnum *out, size_t len) {
+//!   for (size_t i = 0; i < len; ++i) {
+//!     rust::enm::emplace_into<CompactEnum::Pair>(out + i, int16_t(i), int16_t(1));
+//!   }
+//! }
+//! ```
+//!
+//! `#[extern_type]` implements `cxx_enumext::Emplace` for the Rust side, which
+//! passes the storage and takes over the values:
+//!
+//! ```rust
+//! use cxx_enumext::Emplace;
+//!
+//! let mut slot = MaybeUninit::uninit();
+//! let value = unsafe { RustEnum::init_in_place(&mut slot, |out| ffi::make_struct_into(out, 1, "a")) };
+//!
+//! let mut values = Vec::new();
+//! unsafe { CompactEnum::extend_in_place(&mut values, 64, |out, len| ffi::make_pairs_into(out, len)) };
+//! ```
+//!
+//! `new_in_place` returns the value instead, and the `try_` variants take C++
+//! functions bridged as returning `Result<()>`, which leave the storage
+//! uninitialized if they throw. The C++ function must construct every value
+//! it is given, the methods are `unsafe` since Rust can't check it.
+//!
+//! ### Constant expressions
+//!
+//! From C++20 on, enums whose variants are all trivially copyable, like
+//! `#[derive(Copy)]` enums of integers, floats and `()`, can be built and read
+//! with `index`, `get`, `get_if` and `visit` in constant expressions. Tables of
+//! them can be `constexpr` or `constinit`:
+//!
+//! ```c++
+//! constexpr Shape unit_shapes[] = {
+//!     Shape{Shape::Circle{1.0}},
+//!     Shape{Shape::Square{1.0}},
+//! };
+//! static_assert(rust::enm::get<0>(unit_shapes[0]).radius == 1.0);
+//! ```
+//!
+//! The enums keep the layout Rust gives them and the access at runtime compiles
+//! to the same code as before. Enums with a variant owning a `String`, `Box` or
+//! `Vec` can't be used in constant expressions.
+//!
+//! ### Large enums
+//!
+//! `CXX_DEFINE_VARIANT` handles up to 256 alternatives and `TUPLE` up to 64
+//! fields, a trailing comma after the last alternative is allowed. The macros
+//! expand each alternative once, so the preprocessing time grows about linearly
+//! with the number of alternatives. `tests/bench` measures it:
+//!
+//! ```sh
+//! cargo run --release -p cxx-enumext-bench --bin compile_time
+//! ```
+//!
+//! ### Generated headers
+//!
+//! Instead of mirroring each type with the macros, `cxx-enumext-build` can
+//! generate the C++ definitions from the Rust source in `build.rs`:
+//!
+//! ```rust
+//! // build.rs
+//! fn main() {
+//!     let enumext_include = cxx_enumext_build::headers(["src/types.rs"])
+//!         .include_prefix("my_crate")
+//!         .generate();
+//!
+//!     cxx_build::bridges(["src/lib.rs"])
+//!         .include(enumext_include)
+//!         .std("c++17")
+//!         .compile("my_crate");
+//! }
+//! ```
+//!
+//! ```cpp
+//! // the types named by the fields must be declared first
+//! #include "my_crate/src/data.rs.h"
+//!
+//! #include "my_crate/src/types.rs.enumext.h"
+//! ```
+//!
+//! The header defines every `#[cxx_enumext::extern_type]` item of the file as
+//! plain structs, with the same members and `using` aliases as the macros and
+//! no preprocessor work. Fields are spelled like cxx does (`String` is
+//! `rust::String`, `&T` is `std::reference_wrapper<T>`...), other types by their
+//! name, which must be visible in the namespace of the item. `#[cfg]` attributes
+//! are ignored.
+//!
+//! When the layout of every field is known (primitives, pointers, references,
+//! `Box`, `String`, `Vec` and arrays of those) the header also `static_assert`s
+//! the size and alignment of the type and of each variant, and the offsets of
+//! the fields of tuple and struct variants. `#[extern_type]` asserts the same
+//! size and alignment on the Rust side, so a mismatch fails the build instead
+//! of corrupting memory.
+//!
+//! Enums without any fields are rejected by `#[extern_type]`: Rust lays them out
+//! as only their discriminant, while `variant` keeps a byte for the alternative
+//! after the tag. Bridge them as cxx shared enums instead.
+//!
+//! ### Headers
+//!
+//! `rust/cxx_enumext.h` includes the whole library. Its parts can be included
+//! on their own, which matters in the many translation units that only define
+//! enums or pass them around:
+//!
+//! - `rust/cxx_enumext_core.h`: `variant`, `get`, `visit`, `nonzero` and
+//!   `monostate`
+//! - `rust/cxx_enumext_compare.h`: the comparison operators
+//! - `rust/cxx_enumext_optional.h`: `optional` and `nullable`
+//! - `rust/cxx_enumext_expected.h`: `expected`
+//! - `rust/cxx_enumext_ranges.h`: `soa_vector`, tag scanning and grouped
+//!   visitation (with the SIMD intrinsics headers)
+//! - `rust/cxx_enumext_hash.h`: hashing
+//! - `rust/cxx_enumext_atomic.h`: `atomic_variant`
+//!
+//! `rust/cxx_enumext_macros.h` only includes the core, `CXX_DEFINE_OPTIONAL`,
+//! `CXX_DEFINE_NULLABLE` and `CXX_DEFINE_EXPECTED` also need the header of their
+//! type. The generated headers include the core and the parts they name. With
+//! GCC 12 the core adds about 40 ms to the standard headers `rust/cxx.h`
+//! includes, against 150 ms for the whole library, and 500 ms with `-mavx2`:
+//!
+//! ```sh
+//! cargo run --release -p cxx-enumext-bench --bin include_time -- [runs]
+//! ```
+//!
+//! Translation units which include the whole library can share a precompiled
+//! header instead, e.g. `target_precompile_headers(my_target PRIVATE
+//! <rust/cxx.h> <rust/cxx_enumext.h>)` with CMake.
+//!
+//! The include directory also has an experimental C++20 module interface,
+//! `rust/cxx_enumext.cppm`, exporting the same names. Nothing here builds or
+//! imports it yet, so it is not tested with any compiler. GCC 12 compiles the
+//! interface, but code importing it doesn't see the exported names. To try it,
+//! add it to a `FILE_SET CXX_MODULES` with CMake and `import rust.cxx_enumext;`.
+//! A module can't export macros: the headers defining the enums still include
+//! the headers, and the configuration macros apply when the module is built.
+//!
+//! ### Benchmarks
+//!
+//! `tests/bench` also compares `rust::enm::variant` with `std::variant`
+//! (construction, copies, `emplace`, `visit`, `swap`, `get_if`, for 2 to 20
+//! alternatives of small and large payloads), the monadic operations of
+//! `optional` and `expected`, also over `String` and `Vec` payloads where the
+//! chains of rvalues move and the others copy, and the kernels below with the
+//! loops they replace. It prints one CSV row per benchmark, the optional
+//! arguments filter the benchmarks and set the time spent on each:
+//!
+//! ```sh
+//! cargo run --release -p cxx-enumext-bench --bin variant -- [filter] [min_ms]
+//! ```
+//!
+//! The `pipeline` binary measures whole trips across the bridge instead. One
+//! side builds enums of plain data, of `String`s or of `Box<RustValue>`s, and
+//! the other side consumes them by value, in both directions. It prints the
+//! throughput, the median and 99th percentile latency of a call, and the heap
+//! allocations per element on the Rust and the C++ side:
+//!
+//! ```sh
+//! cargo run --release -p cxx-enumext-bench --bin pipeline -- [elements]
+//! ```
+//!
 //! ## Refrence
 //!
 //! ### `rust::enm::variant`
@@ -240,6 +538,17 @@
 //! template <std::size_t I, typename... Ts>
 //! constexpr decltype(auto) get(const variant_base<Ts...> &);
 //!
+//! /// @brief The get_unchecked method which returns a reference to the
+//! /// alternative at index I without checking the index. The behavior is
+//! /// undefined if the variant holds another alternative.
+//! template <std::size_t I, typename... Ts>
+//! constexpr variant_alternative_t<I, Ts...> &
+//! get_unchecked(variant_base<Ts...> &) noexcept;
+//!
+//! template <std::size_t I, typename... Ts>
+//! constexpr const variant_alternative_t<I, Ts...> &
+//! get_unchecked(const variant_base<Ts...> &) noexcept;
+//!
 //! /// @brief The get_if method which returns a pointer to T if the variant
 //! /// contains T other wise `nullptr`.
 //! template <std::size_t I, typename... Ts>
@@ -247,7 +556,7 @@
 //! get_if(variant_base<Ts...> *variant);
 //!
 //! template <std::size_t I, typename... Ts>
-//! constexpr const std::add_pointer_t<variant_alternative_t<I, Ts...>>
+//! constexpr std::add_pointer_t<const variant_alternative_t<I, Ts...>>
 //! get_if(const variant_base<Ts...> *variant);
 //!
 //! /// @brief The visit method which will pick the right type depending on the
@@ -258,6 +567,14 @@
 //! template <typename Visitor, typename... Ts>
 //! constexpr decltype(auto) visit(Visitor &&visitor, const variant_base<Ts...> &);
 //!
+//! /// @brief Visits two or more variants at once, like the multi-variant form of
+//! /// std::visit. Dispatches through a single table holding every combination
+//! /// of alternatives.
+//! template <typename Visitor, typename First, typename Second,
+//!           typename... Remainder>
+//! constexpr decltype(auto) visit(Visitor &&visitor, First &&first,
+//!                                Second &&second, Remainder &&...remainder);
+//!
 //!
 //! /// @brief The holds_alternative method which will return true if the
 //! /// variant contains the type at index I
@@ -271,6 +588,38 @@
 //!               exactly_once<std::is_same_v<Ts, std::decay_t<T>>...>::value>>
 //! constexpr bool holds_alternative(const variant_base<Ts...> &variant);
 //!
+//! /// @brief Compares like the derived `PartialEq` of the Rust enum. Variants
+//! /// whose alternatives are integers, `bool`, enums, `nonzero`, empty or
+//! /// `TUPLE`s of such are compared bytewise without dispatching.
+//! template <typename... Ts>
+//! bool operator==(const variant_base<Ts...> &lhs, const variant_base<Ts...> &rhs);
+//!
+//! /// @brief Orders like the derived `PartialOrd` of the Rust enum: by the index
+//! /// of the alternative, then by the alternatives. `!=`, `>`, `<=` and `>=` are
+//! /// provided as well. `TUPLE` alternatives compare their fields
+//! /// lexicographically, `UNIT` alternatives are equal.
+//! template <typename... Ts>
+//! bool operator<(const variant_base<Ts...> &lhs, const variant_base<Ts...> &rhs);
+//!
+//! /// @brief C++20 only. Alternatives without `<=>` are compared with `<`.
+//! template <typename... Ts>
+//! auto operator<=>(const variant_base<Ts...> &lhs,
+//!                  const variant_base<Ts...> &rhs);
+//!
+//! /// @brief Constructs the alternative `T` of `V` (an enum, optional or
+//! /// expected) from `args` right in the uninitialized storage `out`, e.g. a
+//! /// `*mut V` passed by Rust. `emplace_into<I>` picks the alternative by index.
+//! template <typename T, typename V, typename... Args>
+//! V &emplace_into(V *out, Args &&...args);
+//!
+//! /// @brief A variant whose discriminant has the type `Tag`, matching a Rust
+//! /// enum declared with `#[repr(C, Tag)]`.
+//! template <typename Tag, typename... Ts> struct basic_variant;
+//!
+//! /// @brief The variant of a `#[repr(C)]` enum, the discriminant is an int.
+//! template <typename... Ts> using variant = basic_variant<int, Ts...>;
+//!
+//! // The interface of `basic_variant` is the one below.
 //! template <typename... Ts> struct variant {
 //!   /// @brief Converting constructor. Corresponds to (4) constructor of
 //!   /// std::variant.
@@ -281,21 +630,22 @@
 //!
 //!   /// @brief Participates in the resolution only if we can construct T from
 //!   /// Args and if T is unique in Ts. Corresponds to (5) constructor of
-//!   /// std::variant.
+//!   /// std::variant. Aggregates, like `TUPLE` and `STRUCT` alternatives, are
+//!   /// initialized from their fields as in C++20.
 //!   template <typename T, typename... Args,
 //!             typename = std::enable_if_t<is_unique_v<T>>,
-//!             typename = std::enable_if_t<std::is_constructible_v<T, Args...>>>
+//!             typename = std::enable_if_t<is_initializable_v<T, Args...>>>
 //!   explicit variant(std::in_place_type_t<T> type, Args &&...args) noexcept(
-//!       std::is_nothrow_constructible_v<T, Args...>);
+//!       is_nothrow_initializable_v<T, Args...>);
 //!
 //!   /// @brief Participates in the resolution only if the index is within range
 //!   /// and if the type can be constructor from Args. Corresponds to (7) of
 //!   /// std::variant.
 //!   template <std::size_t I, typename... Args, typename T = type_from_index_t<I>,
-//!             typename = std::enable_if_t<std::is_constructible_v<T, Args...>>>
+//!             typename = std::enable_if_t<is_initializable_v<T, Args...>>>
 //!   explicit variant(
 //!       [[maybe_unused]] std::in_place_index_t<I> index,
-//!       Args &&...args) noexcept(std::is_nothrow_constructible_v<T, Args...>);
+//!       Args &&...args) noexcept(is_nothrow_initializable_v<T, Args...>);
 //!
 //!   /// @brief Converts the std::variant to our variant. Participates only in
 //!   /// the resolution if all types in Ts are copy constructable.
@@ -313,9 +663,9 @@
 //!   /// constructable. Corresponds to (1) assignment of std::variant.
 //!   variant_base &operator=(const variant_base &other);
 //!
-//!   /// @brief Deleted move assignment. Same as for the move constructor.
-//!   /// Would correspond to (2) assignment of std::variant.
-//!   variant_base &operator=(variant_base &&other) = delete;
+//!   /// @brief Move assignment. Statically fails if not every type in Ts is move
+//!   /// constructable. Corresponds to (2) assignment of std::variant.
+//!   variant_base &operator=(variant_base &&other);
 //!
 //!   /// @brief Converting assignment. Corresponds to (3) assignment of
 //!   /// std::variant.
@@ -341,7 +691,7 @@
 //!   /// std::variant.
 //!   template <typename T, typename... Args,
 //!             typename = std::enable_if_t<is_unique_v<T>>,
-//!             typename = std::enable_if_t<std::is_constructible_v<T, Args...>>>
+//!             typename = std::enable_if_t<is_initializable_v<T, Args...>>>
 //!   T &emplace(Args &&...args);
 //!
 //!   /// @brief Emplace function. Participates in the resolution only if T can be
@@ -368,6 +718,11 @@
 //!   /// that the old object is back in its original place, destroy it and move
 //!   /// the new object from the old buffer back to the final place.
 //!   ///
+//!   /// If every alternative is trivially relocatable (which holds for the
+//!   /// types coming from Rust) the old alternative is instead relocated into
+//!   /// a backup of its exact size, relocated back if the construction fails
+//!   /// and destroyed in the backup otherwise.
+//!   ///
 //!   /// Sources
 //!   ///
 //!   /// [1]
@@ -379,20 +734,44 @@
 //!   /// [4]
 //!   /// https://www.boost.org/doc/libs/1_84_0/doc/html/variant/design.html#variant.design.never-empty
 //!   template <std::size_t I, typename... Args, typename T = type_from_index_t<I>,
-//!             typename = std::enable_if_t<std::is_constructible_v<T, Args...>>>
+//!             typename = std::enable_if_t<is_initializable_v<T, Args...>>>
 //!   T &emplace(Args &&...args);
 //!
 //!   constexpr std::size_t index() const noexcept;
 //!
+//!   /// @brief Swaps the bytes of the active alternatives if every alternative
+//!   /// is trivially relocatable, otherwise swaps or moves the alternatives.
 //!   void swap(variant_base &other);
 //!
-//!
-//!   struct bad_rust_variant_access : std::runtime_error {
-//!     bad_rust_variant_access(std::size_t index)
-//!         : std::runtime_error{"The index should be " + std::to_string(index)} {}
-//!   };
+//!   using bad_rust_variant_access = ::rust::enm::bad_rust_variant_access;
 //! }
 //!
+//! /// @brief Thrown by `get` if the variant holds another alternative than the
+//! /// requested one. Constructing it doesn't allocate, the message is formatted
+//! /// into the exception when `what()` is called.
+//! struct bad_rust_variant_access : std::bad_variant_access {
+//!   bad_rust_variant_access(std::size_t requested, std::size_t active) noexcept;
+//!
+//!   /// @brief The index of the alternative `get` asked for
+//!   std::size_t requested_index() const noexcept;
+//!
+//!   /// @brief The index of the alternative the variant holds
+//!   std::size_t active_index() const noexcept;
+//!
+//!   const char *what() const noexcept override;
+//! };
+//!
+//! /// @brief Thrown if the index stored in a variant doesn't name any of its
+//! /// alternatives. Doesn't allocate either.
+//! struct bad_rust_variant_index : std::bad_variant_access {
+//!   explicit bad_rust_variant_index(std::size_t index) noexcept;
+//!
+//!   /// @brief The invalid index
+//!   std::size_t index() const noexcept;
+//!
+//!   const char *what() const noexcept override;
+//! };
+//!
 //! } // namespace enm
 //! } // namespace rust
 //! ```
@@ -406,8 +785,9 @@
 //! namespace rust {
 //! namespace enm {
 //!
-//! struct bad_rust_optional_access : std::runtime_error {
-//!   bad_rust_optional_access() : std::runtime_error{"Optional has no value"} {}
+//! /// @brief Thrown by `value()` of an empty optional. Doesn't allocate.
+//! struct bad_rust_optional_access : std::bad_optional_access {
+//!   const char *what() const noexcept override;
 //! };
 //!
 //! template <typename T> struct optional : public variant<monostate, T> {
@@ -443,6 +823,11 @@
 //!   /// @throws bad_rust_optional_access
 //!   constexpr const T &value() const &;
 //!
+//!   /// @brief returns the contined value, moved out of `*this`
+//!   ///
+//!   /// @throws bad_rust_optional_access
+//!   constexpr T &&value() &&;
+//!
 //!   /// @brief resets the optional to an empty state
 //!   ///
 //!   /// if `has_value()` is true first calls the deconstructor
@@ -453,18 +838,26 @@
 //!
 //!   constexpr const T &operator*() const & noexcept;
 //!   constexpr T &operator*() & noexcept;
+//!   constexpr T &&operator*() && noexcept;
 //!
 //!   template <class U = std::remove_cv_t<T>>
 //!   constexpr T value_or(U &&default_value) const &;
+//!   template <class U = std::remove_cv_t<T>>
+//!   constexpr T value_or(U &&default_value) &&;
 //!
+//!   // The `&&` overloads pass the contained value to `f` as an rvalue, so
+//!   // chains on temporaries move the payload instead of copying it.
 //!   template <class F> constexpr auto and_then(F &&f) &;
 //!   template <class F> constexpr auto and_then(F &&f) const &;
-//!   template <class F> constexpr auto transform(F &&f) &;
+//!   template <class F> constexpr auto and_then(F &&f) &&;
 //!
+//!   /// @brief Returns a `rust::enm::optional` of the result of `f`
+//!   template <class F> constexpr auto transform(F &&f) &;
 //!   template <class F> constexpr auto transform(F &&f) const &;
+//!   template <class F> constexpr auto transform(F &&f) &&;
 //!
-//!   template <class F> constexpr T &or_else(F &&f) &;
-//!   template <class F> constexpr const T &or_else(F &&f) const &;
+//!   template <class F> constexpr optional or_else(F &&f) const &;
+//!   template <class F> constexpr optional or_else(F &&f) &&;
 //! };
 //!
 //!
@@ -481,6 +874,60 @@
 //! // ... and many more compare operators
 //! ```
 //!
+//! ### `rust::enm::nullable`
+//!
+//! Simplicited declaration
+//!
+//! ```c++
+//!
+//! namespace rust {
+//! namespace enm {
+//!
+//! /// Mirrors Rust's `NonZero` integers
+//! template <typename T> struct nonzero {
+//!   constexpr explicit nonzero(T value) noexcept;
+//!   constexpr T get() const noexcept;
+//! };
+//!
+//! /// How `None` is stored in the bytes of `T`, specialized for `rust::Box<T>`,
+//! /// `std::reference_wrapper<T>`, `nonzero<T>` and `bool`. Rust only documents
+//! /// the layout for the first three; the layout for `bool` is checked when the
+//! /// Rust side compiles.
+//! template <typename T> struct niche_traits;
+//!
+//! template <typename T> struct nullable {
+//!   nullable() noexcept;
+//!   nullable(std::nullopt_t) noexcept;
+//!   template <typename U = T> nullable(U &&value);
+//!   template <typename... Args> explicit nullable(std::in_place_t, Args &&...args);
+//!
+//!   using Some = T;
+//!   using None = monostate;
+//!
+//!   constexpr explicit operator bool() const noexcept;
+//!   constexpr bool has_value() const noexcept;
+//!   constexpr bool is_some() const noexcept;
+//!   constexpr bool is_none() const noexcept;
+//!
+//!   /// @throws bad_rust_optional_access
+//!   T &value() &;
+//!   /// @throws bad_rust_optional_access
+//!   const T &value() const &;
+//!
+//!   const T *operator->() const noexcept;
+//!   T *operator->() noexcept;
+//!   const T &operator*() const & noexcept;
+//!   T &operator*() & noexcept;
+//!
+//!   template <class U = std::remove_cv_t<T>>
+//!   T value_or(U &&default_value) const &;
+//!
+//!   void reset() noexcept;
+//!   /// Leaves the nullable `None` if the construction throws
+//!   template <typename... Args> T &emplace(Args &&...args);
+//! };
+//! ```
+//!
 //! ### `rust::enm::expected`
 //!
 //! Simplicited declaration
@@ -490,10 +937,24 @@
 //! namespace rust {
 //! namespace enm {
 //!
-//! template <typename E> struct bad_rust_expected_access : std::runtime_error {
-//!   bad_rust_expected_access(const E &err)
-//!       : std::runtime_error{"Expected is the unexpected value"}, error(err) {}
-//!   E error;
+//! /// @brief The base of every bad_rust_expected_access, to catch them whatever
+//! /// their unexpected value. Doesn't allocate.
+//! template <> struct bad_rust_expected_access<void> : std::exception {
+//!   const char *what() const noexcept override;
+//! };
+//!
+//! /// @brief Thrown by `value()` of an expected holding an unexpected value. The
+//! /// value is copied into the exception, or moved if `value()` was called on an
+//! /// rvalue, and can be moved out again with `std::move(e).error()`.
+//! template <typename E>
+//! struct bad_rust_expected_access : bad_rust_expected_access<void> {
+//!   explicit bad_rust_expected_access(const E &error);
+//!   explicit bad_rust_expected_access(E &&error);
+//!
+//!   E &error() & noexcept;
+//!   const E &error() const & noexcept;
+//!   E &&error() && noexcept;
+//!   const E &&error() const && noexcept;
 //! };
 //!
 //! template <typename T, typename E> struct expected : public variant<T, E> {
@@ -522,6 +983,12 @@
 //!   /// @throws bad_rust_expected_access<E> with a copy of the unexpected value
 //!   constexpr const T &value() const &;
 //!
+//!   /// @brief returns the expected value, moved out of `*this`
+//!   ///
+//!   /// @throws bad_rust_expected_access<E> with the unexpected value moved into
+//!   /// it
+//!   constexpr T &&value() &&;
+//!
 //!   /// @brief returns the unexpected value
 //!   ///
 //!   /// if has_value() is `true`, the behavior is undefined
@@ -531,34 +998,405 @@
 //!   ///
 //!   /// if has_value() is `true`, the behavior is undefined
 //!   constexpr const E &error() const &;
+//!   constexpr E &&error() &&;
 //!
 //!   constexpr const T *operator->() const noexcept;
 //!   constexpr T *operator->() noexcept;
 //!
 //!   constexpr const T &operator*() const & noexcept;
 //!   constexpr T &operator*() & noexcept;
+//!   constexpr T &&operator*() && noexcept;
 //!
 //!   /// @brief Returns the expected value if it exists, otherwise returns
 //!   /// `default_value`
 //!   template <class U = std::remove_cv_t<T>>
 //!   constexpr T value_or(U &&default_value) const &;
+//!   template <class U = std::remove_cv_t<T>>
+//!   constexpr T value_or(U &&default_value) &&;
 //!
 //!   /// @brief Returns the unexpected value if it exists, otherwise returns
 //!   /// `default_value`
 //!   template <class G = E> constexpr E error_or(G &&default_value) const &;
+//!   template <class G = E> constexpr E error_or(G &&default_value) &&;
 //!
+//!   // The `&&` overloads pass the contained value to `f` as an rvalue and move
+//!   // the other one into the result.
 //!   template <class F> constexpr auto and_then(F &&f) &;
 //!   template <class F> constexpr auto and_then(F &&f) const &;
+//!   template <class F> constexpr auto and_then(F &&f) &&;
 //!
 //!   template <class F> constexpr auto transform(F &&f) &;
 //!   template <class F> constexpr auto transform(F &&f) const &;
+//!   template <class F> constexpr auto transform(F &&f) &&;
 //!
-//!   template <class F> constexpr T &or_else(F &&f) &;
-//!   template <class F> constexpr const T &or_else(F &&f) const &;
+//!   /// @brief `f` takes the unexpected value and returns an `expected<T, G>`
+//!   template <class F> constexpr auto or_else(F &&f) &;
+//!   template <class F> constexpr auto or_else(F &&f) const &;
+//!   template <class F> constexpr auto or_else(F &&f) &&;
 //!
+//!   /// @brief Returns an `expected<T, G>` where `G` is the result of `f`
 //!   template <class F> constexpr auto transform_error(F &&f) &;
 //!   template <class F> constexpr auto transform_error(F &&f) const &;
+//!   template <class F> constexpr auto transform_error(F &&f) &&;
+//!
+//! };
+//!
+//! } // namespace enm
+//! } // namespace rust
+//! ```
+//!
+//! ### `rust::enm::soa_vector`
+//!
+//! A vector of variants stored as a struct of arrays: the tags in one dense
+//! array and every alternative in its own column. Scanning the tags does not
+//! touch the payloads and all values of one alternative are contiguous.
+//!
+//! ```c++
+//!
+//! namespace rust {
+//! namespace enm {
+//!
+//! /// The subset of C++20's `std::span` used by `soa_vector`
+//! template <typename T> class span;
+//!
+//! template <typename Variant> class soa_vector {
+//! public:
+//!   using tag_type = /* the tag type of Variant */;
+//!
+//!   soa_vector();
+//!   /// @brief Copies the variants in [first, last).
+//!   template <typename InputIt> soa_vector(InputIt first, InputIt last);
+//!
+//!   std::size_t size() const noexcept;
+//!   bool empty() const noexcept;
+//!   void reserve(std::size_t capacity);
+//!   void clear() noexcept;
+//!
+//!   void push_back(const Variant &value);
+//!   void push_back(Variant &&value);
+//!   template <std::size_t I, typename... Args>
+//!   alternative_t<I> &emplace_back(Args &&...args);
+//!
+//!   /// @brief The index of every element's alternative.
+//!   span<const tag_type> tags() const noexcept;
+//!
+//!   /// @brief The `I`-th alternative of all elements holding it, in order.
+//!   template <std::size_t I> span<alternative_t<I>> column() noexcept;
+//!   template <std::size_t I> span<const alternative_t<I>> column() const noexcept;
+//!   template <typename T> span<T> column() noexcept;
+//!   template <typename T> span<const T> column() const noexcept;
+//!   template <std::size_t I> std::size_t count() const noexcept;
+//!
+//!   template <typename Visitor>
+//!   decltype(auto) visit(Visitor &&visitor, std::size_t position);
+//!
+//!   /// @brief Converts back to contiguous variants.
+//!   Variant to_variant(std::size_t position) const;
+//!   template <typename OutputIt> OutputIt copy_to(OutputIt out) const;
+//!   std::vector<Variant> to_vector() const;
+//! };
+//!
+//! } // namespace enm
+//! } // namespace rust
+//! ```
+//!
+//!
+//! ### Tag scanning
+//!
+//! Scans over contiguous variants (`rust::Slice<const T>`, `rust::Vec<T>`,
+//! `std::vector<T>`, `std::span<const T>`, ...) reading only the tags. With
+//! SSE4.1 or AVX2 enabled (e.g. `-mavx2`) four or eight tags are compared at
+//! once, `CXX_ENUMEXT_SIMD` selects the instruction set explicitly
+//! (`CXX_ENUMEXT_SIMD_NONE`, `CXX_ENUMEXT_SIMD_SSE4` or `CXX_ENUMEXT_SIMD_AVX2`).
+//! Counting is only vectorized for up to three (SSE4.1) or four (AVX2)
+//! alternatives, beyond that the scalar loop is faster. The kernels of every
+//! instruction set are in an inline namespace of their own, so a file built
+//! with `-mavx2` and called behind a CPU check can be linked with the rest.
+//!
+//! ```c++
+//!
+//! namespace rust {
+//! namespace enm {
+//!
+//! /// @brief Counts the elements holding every alternative.
+//! template <typename Values>
+//! std::array<std::size_t, /* number of alternatives */>
+//! count_alternatives(const Values &values) noexcept;
+//!
+//! /// @brief The position of the first element holding the alternative `I`, or
+//! /// the size of `values`.
+//! template <std::size_t I, typename Values>
+//! std::size_t find_alternative(const Values &values) noexcept;
+//!
+//! /// @brief Bit `i % 64` of word `i / 64` is set if the `i`-th element holds
+//! /// one of the alternatives `Is...`.
+//! template <std::size_t... Is, typename Values>
+//! std::vector<std::uint64_t> alternative_mask(const Values &values);
+//!
+//! /// @brief Checks that every tag is valid, e.g. before trusting enums read
+//! /// from untrusted memory.
+//! template <typename Values> bool has_valid_tags(const Values &values) noexcept;
+//!
+//! } // namespace enm
+//! } // namespace rust
+//! ```
+//!
+//!
+//! ### Grouped visitation
+//!
+//! Visiting a long range of randomly mixed variants one by one makes the
+//! branch predictor guess the alternative of every element. `visit_grouped`
+//! buckets the positions by alternative first (a stable counting sort) and then
+//! runs every overload of the visitor in a loop of its own. Within a group the
+//! elements are visited in ascending position. Ranges dominated by one
+//! alternative are cheaper to visit with a plain loop.
+//!
+//! ```c++
 //!
+//! namespace rust {
+//! namespace enm {
+//!
+//! /// @brief Visits all elements holding the alternative 0, then all holding the
+//! /// alternative 1 and so on.
+//! template <typename Values, typename Visitor>
+//! void visit_grouped(Values &&values, Visitor &&visitor);
+//!
+//! /// @brief Calls the visitor once per alternative present with all elements
+//! /// holding it.
+//! template <typename Values, typename Visitor>
+//! void visit_grouped_batches(Values &&values, Visitor &&visitor);
+//!
+//! template <typename Variant, std::size_t I> class alternative_batch {
+//! public:
+//!   using element_type = /* the alternative I, const if Variant is */;
+//!   constexpr static std::size_t index = I;
+//!
+//!   std::size_t size() const noexcept;
+//!   bool empty() const noexcept;
+//!   element_type &operator[](std::size_t n) const noexcept;
+//!   /// @brief The position of the `n`-th element in the visited range.
+//!   std::size_t position(std::size_t n) const noexcept;
+//!   span<const std::size_t> positions() const noexcept;
+//!   iterator begin() const noexcept;
+//!   iterator end() const noexcept;
+//! };
+//!
+//! } // namespace enm
+//! } // namespace rust
+//! ```
+//!
+//! ### Hashing
+//!
+//! `#[cxx_enumext::extern_type(hash)]` implements `Hash` for the enum so that
+//! `cxx_enumext::hash(&value)` in Rust and `rust::enm::hash_value(value)` in C++
+//! agree. Maps keyed by enums can then be partitioned, sharded or deduplicated on
+//! either side of the bridge. `cxx_enumext::BuildCxxHasher` plugs the same hash
+//! function into a Rust `HashMap`. The fields have to hash the same on both
+//! sides: integers, `bool`, strings, `Vec`s and slices of those, boxes and
+//! references, nested extern_type enums with `hash`, and types with a
+//! `hash_append` overload matching their Rust `Hash` implementation, e.g. for
+//! `STRUCT` alternatives:
+//!
+//! ```c++
+//! CXX_DEFINE_VARIANT(
+//!     Keyed, (TYPE(Id, int64_t), STRUCT(Named, int32_t state; rust::string text;
+//!             template <typename H> friend void hash_append(H &hasher,
+//!                                                           const Named_t &v) {
+//!               hash_append(hasher, v.state);
+//!               hash_append(hasher, v.text);
+//!             })))
+//! ```
+//!
+//! ```c++
+//!
+//! namespace rust {
+//! namespace enm {
+//!
+//! /// @brief The hash function of `cxx_enumext::CxxHasher` in Rust.
+//! class hasher {
+//! public:
+//!   void write(const void *data, std::size_t size) noexcept;
+//!   std::uint64_t finish() const noexcept;
+//! };
+//!
+//! /// @brief The hash of `value`, equal to `cxx_enumext::hash(&value)` in Rust.
+//! template <typename T> std::uint64_t hash_value(const T &value);
+//!
+//! /// @brief A hash function object, e.g.
+//! /// `std::unordered_set<RustEnum, rust::enm::hash<>>`.
+//! template <typename T = void> struct hash;
+//!
+//! } // namespace enm
+//! } // namespace rust
+//! ```
+//!
+//! `std::hash` is specialized for `variant`, `optional`, `expected` and
+//! `nullable`. Types declared with the `CXX_DEFINE_*` macros are distinct
+//! structs, use `rust::enm::hash<>` for them.
+//!
+//! ### Atomic enums
+//!
+//! `#[cxx_enumext::extern_type(atomic)]` lets a small `Copy` enum, optional or
+//! expected be shared between Rust and C++ threads without a lock. The tag and
+//! the fields of the active variant are packed into one `u8` to `u64`, so the
+//! enum must be at most 8 bytes and its fields must be integers, floats,
+//! `bool`, `NonZero` integers, references, pointers or arrays of them, without
+//! padding between or after them. At least one variant needs a field of a
+//! non-zero size. An alias bridges the atomic:
+//!
+//! ```rust
+//! #[cxx_enumext::extern_type(atomic)]
+//! #[repr(u8)]
+//! #[derive(Debug, Clone, Copy, PartialEq)]
+//! pub enum JobState {
+//!     Idle,
+//!     Running(u16),
+//!     Done(i32),
+//! }
+//!
+//! #[cxx_enumext::extern_type]
+//! #[derive(Debug)]
+//! pub type AtomicJobState = cxx_enumext::AtomicEnum<JobState>;
+//!
+//! #[cxx::bridge]
+//! mod ffi {
+//!     unsafe extern "C++" {
+//!         include!("my_crate/include/jobs.h");
+//!         type AtomicJobState = crate::AtomicJobState;
+//!
+//!         fn advance_job(state: &AtomicJobState);
+//!     }
+//! }
+//! ```
+//!
+//! `AtomicEnum` has `load`, `store`, `swap`, `compare_exchange` and
+//! `fetch_update` like `AtomicU32`. The generated header declares
+//! `using AtomicJobState = rust::enm::atomic_variant<JobState>;` and asserts
+//! that it has the size of the Rust atomic, write the same alias next to the
+//! macros otherwise. Rust passes `&AtomicJobState`,
+//! which C++ modifies through a const reference:
+//!
+//! ```c++
+//! void advance_job(const AtomicJobState &state) {
+//!   // `overload` combines the lambdas into one visitor
+//!   state.update(overload{
+//!       [](const JobState::Idle &) {
+//!         return JobState(std::in_place_type<JobState::Running>, uint16_t{1});
+//!       },
+//!       [](const JobState::Running &done) {
+//!         return JobState(std::in_place_type<JobState::Running>,
+//!                         static_cast<uint16_t>(done + 1));
+//!       },
+//!       [](const JobState::Done &result) {
+//!         return JobState(std::in_place_type<JobState::Done>, result);
+//!       },
+//!   });
+//! }
+//! ```
+//!
+//! Compare-exchange compares the bytes of the tag and of the active variant,
+//! which is equality unless the variants hold floats (`0.0` and `-0.0` differ,
+//! equal NaNs are equal). Enums of up to 16 bytes would need 128-bit atomics,
+//! which Rust doesn't have on stable and GCC implements with a lock on some
+//! targets.
+//!
+//! ```c++
+//!
+//! namespace rust {
+//! namespace enm {
+//!
+//! /// @brief Holds a trivially copyable variant of at most 8 bytes which is
+//! /// loaded, stored and compared-exchanged atomically.
+//! template <typename V> class atomic_variant {
+//! public:
+//!   using value_type = V;
+//!   constexpr static bool is_always_lock_free;
+//!
+//!   atomic_variant(const V &value) noexcept;
+//!
+//!   bool is_lock_free() const noexcept;
+//!   V load(std::memory_order order = std::memory_order_seq_cst) const noexcept;
+//!   void store(const V &value, std::memory_order order = ...) const noexcept;
+//!   V exchange(const V &value, std::memory_order order = ...) const noexcept;
+//!
+//!   /// @brief Replaces the value by `desired` if it equals `expected`,
+//!   /// otherwise loads it into `expected`.
+//!   bool compare_exchange_strong(V &expected, const V &desired,
+//!                                std::memory_order success,
+//!                                std::memory_order failure) const noexcept;
+//!   bool compare_exchange_strong(V &expected, const V &desired,
+//!                                std::memory_order order = ...) const noexcept;
+//!   bool compare_exchange_weak(V &expected, const V &desired,
+//!                              std::memory_order success,
+//!                              std::memory_order failure) const noexcept;
+//!   bool compare_exchange_weak(V &expected, const V &desired,
+//!                              std::memory_order order = ...) const noexcept;
+//!
+//!   /// @brief Replaces the value by what `visitor` returns for its active
+//!   /// alternative, retrying if another thread changed it, and returns the
+//!   /// previous value.
+//!   template <typename Visitor>
+//!   V update(Visitor &&visitor, std::memory_order order = ...) const;
+//! };
+//!
+//! } // namespace enm
+//! } // namespace rust
+//! ```
+//!
+//! ### Flat files
+//!
+//! `rust/cxx_enumext_flat.h` stores sequences of variants whose alternatives are
+//! all trivially copyable in a flat, versioned file. The elements are written as
+//! they are laid out in memory, so reading maps the file and uses the elements in
+//! place, without parsing or copying. The header records the size of the tag, the
+//! size and alignment of every alternative and the element size; files written
+//! for another layout, version or byte order are rejected when opened. An
+//! optional run-length index of the tags lets readers jump to the runs of one
+//! alternative. The bytes after the active alternative are zeroed when writing,
+//! so the same values always produce the same file. `flat_view` does not check
+//! the tags of the elements, use `has_valid_tags` on files that aren't trusted.
+//!
+//! ```c++
+//! #include "rust/cxx_enumext_flat.h"
+//!
+//! namespace rust {
+//! namespace enm {
+//!
+//! template <typename Variant>
+//! constexpr bool is_flat_serializable_v;
+//!
+//! /// @brief Calls `sink(const std::byte *, std::size_t)` with the file.
+//! template <typename Values, typename Sink>
+//! void write_flat(const Values &values, Sink &&sink, bool run_index = false);
+//! template <typename Values>
+//! std::vector<std::byte> to_flat(const Values &values, bool run_index = false);
+//! template <typename Values>
+//! bool write_flat_file(const char *path, const Values &values,
+//!                      bool run_index = false);
+//!
+//! /// @brief A flat file in memory, aligned to `alignof(Variant)`.
+//! template <typename Variant> class flat_view {
+//! public:
+//!   flat_view(const void *data, std::size_t size) noexcept;
+//!   explicit operator bool() const noexcept;
+//!   flat_error error() const noexcept;
+//!   const flat_header &header() const noexcept;
+//!   span<const Variant> values() const noexcept;
+//!   span<const flat_run> runs() const noexcept;
+//!   bool has_runs() const noexcept;
+//!   /// @brief The run containing the element at `position`.
+//!   const flat_run &run_at(std::size_t position) const noexcept;
+//! };
+//!
+//! /// @brief A flat file mapped into memory (POSIX only).
+//! template <typename Variant> class flat_file {
+//! public:
+//!   explicit flat_file(const char *path) noexcept;
+//!   explicit operator bool() const noexcept;
+//!   flat_error error() const noexcept;
+//!   const flat_view<Variant> &view() const noexcept;
+//!   span<const Variant> values() const noexcept;
+//!   span<const flat_run> runs() const noexcept;
 //! };
 //!
 //! } // namespace enm
@@ -568,6 +1406,18 @@
 
 pub use cxx_enumext_macro::extern_type;
 
+pub mod atomic;
+pub use atomic::{AtomicEnum, AtomicRepr};
+
+pub mod convert;
+pub use convert::{StdEnum, StdEnumIterator, TransparentStdEnum};
+
+pub mod emplace;
+pub use emplace::Emplace;
+
+pub mod hash;
+pub use hash::{hash, BuildCxxHasher, CxxHasher};
+
 /// Private assert helpers
 pub mod private {
 
@@ -600,7 +1450,7 @@ pub mod private {
     impl<T: ?Sized> NotCxxExternOpaque for T {}
     pub struct IsCxxExternOpaque<T: ?Sized>(std::marker::PhantomData<T>);
     #[allow(dead_code)]
-    impl<T: ?Sized + ::cxx::ExternType<Kind = ::cxx::kind::Trivial>> IsCxxExternOpaque<T> {
+    impl<T: ?Sized + ::cxx::ExternType<Kind = ::cxx::kind::Opaque>> IsCxxExternOpaque<T> {
         pub const IS_CXX_EXTERN_OPAQUE: bool = true;
     }
 
@@ -625,4 +1475,23 @@ pub mod private {
     impl<T: ?Sized + ::cxx::private::ImplBox> IsCxxImplBox<T> {
         pub const IS_CXX_IMPL_BOX: bool = true;
     }
+
+    pub trait OptionInner {
+        type Inner;
+    }
+    impl<T> OptionInner for Option<T> {
+        type Inner = T;
+    }
+
+    /// Whether the `Option` is stored in the bytes of its value, as
+    /// `rust::enm::nullable` reads it.
+    pub const fn is_niche_option<O: OptionInner>() -> bool {
+        ::core::mem::size_of::<O>() == ::core::mem::size_of::<O::Inner>()
+    }
+
+    /// The byte rustc stores for `None::<bool>`, which is not documented.
+    pub const fn none_bool_byte() -> u8 {
+        // SAFETY: `Option<bool>` is a single byte without padding.
+        unsafe { ::core::mem::transmute::<Option<bool>, u8>(None) }
+    }
 }
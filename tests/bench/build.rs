@@ -0,0 +1,66 @@
+use cxx_build::CFG;
+use std::path::PathBuf;
+
+fn main() {
+    // The compile time benchmarks run the same compiler as the other crates.
+    let no_bridges: Vec<PathBuf> = vec![];
+    let mut build = cxx_build::bridges(no_bridges);
+    build.std("c++17");
+    let compiler = build.get_compiler();
+
+    println!(
+        "cargo:rustc-env=CXX_ENUMEXT_BENCH_CXX={}",
+        compiler.path().display()
+    );
+    let args: Vec<_> = compiler
+        .args()
+        .iter()
+        .map(|arg| arg.to_string_lossy().into_owned())
+        .collect();
+    println!(
+        "cargo:rustc-env=CXX_ENUMEXT_BENCH_CXXFLAGS={}",
+        args.join("\x1f")
+    );
+    println!(
+        "cargo:rustc-env=CXX_ENUMEXT_BENCH_MSVC={}",
+        compiler.is_like_msvc()
+    );
+    println!(
+        "cargo:rustc-env=CXX_ENUMEXT_BENCH_CLANG={}",
+        compiler.is_like_clang()
+    );
+
+    // The runtime benchmarks are always optimized, unoptimized numbers say
+    // nothing about the headers.
+    CFG.include_prefix = "tests/bench";
+    cxx_build::bridges(["variant.rs"])
+        .file("variant.cpp")
+        .include("../../include")
+        .std("c++17")
+        .flag_if_supported("-std=c++17")
+        .flag_if_supported("/std:c++17")
+        .opt_level(3)
+        .compile("cxx-enumext-bench");
+
+    // The pipeline benchmark replaces `operator new`. It gets a library of its
+    // own, which the other binaries never reference.
+    let enumext_include = cxx_enumext_build::headers(["pipeline_types.rs"])
+        .include_prefix("tests/bench")
+        .generate();
+    cxx_build::bridges(["pipeline_types.rs", "pipeline.rs"])
+        .include(enumext_include)
+        .file("pipeline.cpp")
+        .include("../../include")
+        .std("c++17")
+        .flag_if_supported("-std=c++17")
+        .flag_if_supported("/std:c++17")
+        .opt_level(3)
+        .compile("cxx-enumext-bench-pipeline");
+
+    println!("cargo:rerun-if-changed=variant.cpp");
+    println!("cargo:rerun-if-changed=variant.h");
+    println!("cargo:rerun-if-changed=pipeline.cpp");
+    println!("cargo:rerun-if-changed=pipeline.h");
+    println!("cargo:rerun-if-changed=../../include");
+    println!("cargo:rerun-if-changed=build.rs");
+}
@@ -0,0 +1,78 @@
+//! Measures how long the C++ compiler takes to preprocess and parse
+//! `CXX_DEFINE_VARIANT` for growing numbers of alternatives.
+//!
+//! ```sh
+//! cargo run --release -p cxx-enumext-bench --bin compile_time -- [runs]
+//! ```
+//!
+//! Prints one CSV row per variant count. The times are the fastest of `runs`
+//! compilations, minus the time taken by a translation unit that only
+//! includes the headers.
+
+mod compiler;
+
+use std::env;
+use std::fmt::Write as _;
+use std::fs;
+
+use crate::compiler::{fastest, millis, Phase};
+
+const VARIANT_COUNTS: &[usize] = &[0, 8, 16, 32, 64, 128, 256];
+
+/// A translation unit defining one variant with `count` alternatives, mixing
+/// all the alternative kinds.
+fn translation_unit(count: usize) -> String {
+    let mut source = String::from(
+        "#include <cstdint>\n#include <string>\n\n#include \"rust/cxx_enumext_macros.h\"\n\n",
+    );
+    if count == 0 {
+        return source;
+    }
+    let alternatives: Vec<String> = (0..count)
+        .map(|i| match i % 4 {
+            0 => format!("TYPE(Type{i}, int64_t)"),
+            1 => format!("TUPLE(Tuple{i}, int32_t, double, std::string)"),
+            2 => format!("UNIT(Unit{i})"),
+            _ => format!("STRUCT(Struct{i}, int64_t id; std::string name;)"),
+        })
+        .collect();
+    writeln!(
+        source,
+        "CXX_DEFINE_VARIANT_REPR(Bench, uint16_t, ({}))",
+        alternatives.join(",\n    ")
+    )
+    .unwrap();
+    source
+}
+
+fn main() {
+    let runs = env::args()
+        .nth(1)
+        .map(|runs| runs.parse().expect("`runs` must be a number"))
+        .unwrap_or(5);
+
+    let dir = env::temp_dir().join(format!("cxx-enumext-compile-time-{}", std::process::id()));
+    fs::create_dir_all(&dir).unwrap();
+
+    let mut baseline = None;
+    println!("variants,preprocess_ms,frontend_ms,preprocess_us_per_variant");
+    for &count in VARIANT_COUNTS {
+        let file = dir.join(format!("variants_{count}.cpp"));
+        fs::write(&file, translation_unit(count)).unwrap();
+        let preprocess = millis(fastest(&file, Phase::Preprocess, None, runs));
+        let frontend = millis(fastest(&file, Phase::Frontend, None, runs));
+
+        let (base_preprocess, base_frontend) = *baseline.get_or_insert((preprocess, frontend));
+        if count == 0 {
+            continue;
+        }
+        let preprocess = (preprocess - base_preprocess).max(0.0);
+        let frontend = (frontend - base_frontend).max(0.0);
+        println!(
+            "{count},{preprocess:.2},{frontend:.2},{:.1}",
+            preprocess * 1000.0 / count as f64
+        );
+    }
+
+    drop(fs::remove_dir_all(&dir));
+}
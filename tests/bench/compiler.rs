@@ -0,0 +1,88 @@
+//! Runs the C++ compiler of the other crates on translation units written by
+//! the compile time benchmarks.
+
+use std::ffi::OsString;
+use std::path::{Path, PathBuf};
+use std::process::{Command, Stdio};
+use std::time::{Duration, Instant};
+
+#[derive(Clone, Copy)]
+pub enum Phase {
+    Preprocess,
+    Frontend,
+    /// Writes a precompiled header next to the header, which `-include`
+    /// picks up. Not supported with MSVC.
+    Precompile,
+}
+
+pub fn is_msvc() -> bool {
+    env!("CXX_ENUMEXT_BENCH_MSVC") == "true"
+}
+
+fn include_dir() -> PathBuf {
+    Path::new(env!("CARGO_MANIFEST_DIR")).join("../../include")
+}
+
+/// `header.gch` for GCC, `header.pch` for Clang.
+fn precompiled(header: &Path) -> PathBuf {
+    let mut path = OsString::from(header);
+    path.push(match env!("CXX_ENUMEXT_BENCH_CLANG") {
+        "true" => ".pch",
+        _ => ".gch",
+    });
+    path.into()
+}
+
+/// Runs `phase` on `file`, after including the precompiled `prefix` if any.
+pub fn compile(file: &Path, phase: Phase, prefix: Option<&Path>) -> Duration {
+    let flags = env!("CXX_ENUMEXT_BENCH_CXXFLAGS");
+    let msvc = is_msvc();
+    assert!(
+        !msvc || (prefix.is_none() && !matches!(phase, Phase::Precompile)),
+        "precompiled headers are not supported with MSVC"
+    );
+
+    let mut command = Command::new(env!("CXX_ENUMEXT_BENCH_CXX"));
+    command.args(flags.split('\x1f').filter(|flag| !flag.is_empty()));
+    let include = include_dir();
+    if msvc {
+        command.arg(format!("/I{}", include.display()));
+    } else {
+        command.arg("-I").arg(&include);
+    }
+    if let Some(prefix) = prefix {
+        command.arg("-include").arg(prefix);
+    }
+    match phase {
+        Phase::Preprocess => {
+            command.arg(if msvc { "/E" } else { "-E" });
+            command.arg(file);
+        }
+        Phase::Frontend => {
+            command.arg(if msvc { "/Zs" } else { "-fsyntax-only" });
+            command.arg(file);
+        }
+        Phase::Precompile => {
+            command.args(["-x", "c++-header"]).arg(file);
+            command.arg("-o").arg(precompiled(file));
+        }
+    }
+    command.stdout(Stdio::null());
+
+    let start = Instant::now();
+    let status = command.status().expect("failed to run the C++ compiler");
+    let elapsed = start.elapsed();
+    assert!(status.success(), "failed to compile {}", file.display());
+    elapsed
+}
+
+pub fn fastest(file: &Path, phase: Phase, prefix: Option<&Path>, runs: usize) -> Duration {
+    (0..runs)
+        .map(|_| compile(file, phase, prefix))
+        .min()
+        .unwrap()
+}
+
+pub fn millis(duration: Duration) -> f64 {
+    duration.as_secs_f64() * 1000.0
+}
@@ -0,0 +1,96 @@
+//! Measures how long the C++ compiler takes to parse each header of the
+//! library on top of the standard headers `rust/cxx.h` includes, which every
+//! translation unit using a bridge parses anyway.
+//!
+//! ```sh
+//! cargo run --release -p cxx-enumext-bench --bin include_time -- [runs]
+//! ```
+//!
+//! Prints one CSV row per header: the time the frontend takes for a
+//! translation unit including the standard headers and the header, the
+//! fastest of `runs` compilations, and the time the header adds. The last row
+//! includes both through a precompiled header instead (not measured with
+//! MSVC).
+
+mod compiler;
+
+use std::env;
+use std::fs;
+
+use crate::compiler::{compile, fastest, is_msvc, millis, Phase};
+
+/// The standard headers included by `rust/cxx.h`.
+const CXX_STD_HEADERS: &[&str] = &[
+    "algorithm",
+    "array",
+    "cassert",
+    "cstddef",
+    "cstdint",
+    "exception",
+    "initializer_list",
+    "iosfwd",
+    "iterator",
+    "new",
+    "stdexcept",
+    "string",
+    "type_traits",
+    "utility",
+    "vector",
+];
+
+/// The core (which the generated headers include), the macros, each opt-in
+/// part and all of them.
+const HEADERS: &[&str] = &[
+    "rust/cxx_enumext_core.h",
+    "rust/cxx_enumext_macros.h",
+    "rust/cxx_enumext_compare.h",
+    "rust/cxx_enumext_optional.h",
+    "rust/cxx_enumext_expected.h",
+    "rust/cxx_enumext_ranges.h",
+    "rust/cxx_enumext_hash.h",
+    "rust/cxx_enumext_atomic.h",
+    "rust/cxx_enumext.h",
+];
+
+fn main() {
+    let runs = env::args()
+        .nth(1)
+        .map(|runs| runs.parse().expect("`runs` must be a number"))
+        .unwrap_or(5);
+
+    let dir = env::temp_dir().join(format!("cxx-enumext-include-time-{}", std::process::id()));
+    fs::create_dir_all(&dir).unwrap();
+
+    let std_includes: String = CXX_STD_HEADERS
+        .iter()
+        .map(|header| format!("#include <{header}>\n"))
+        .collect();
+    let baseline_file = dir.join("baseline.cpp");
+    fs::write(&baseline_file, &std_includes).unwrap();
+    let baseline = millis(fastest(&baseline_file, Phase::Frontend, None, runs));
+
+    println!("header,frontend_ms,added_ms");
+    println!("(standard headers),{baseline:.2},0.00");
+    for (i, header) in HEADERS.iter().enumerate() {
+        let file = dir.join(format!("header_{i}.cpp"));
+        fs::write(&file, format!("{std_includes}#include \"{header}\"\n")).unwrap();
+        let frontend = millis(fastest(&file, Phase::Frontend, None, runs));
+        println!("{header},{frontend:.2},{:.2}", frontend - baseline);
+    }
+
+    if !is_msvc() {
+        let source = format!("{std_includes}#include \"rust/cxx_enumext.h\"\n");
+        let prefix = dir.join("prefix.h");
+        fs::write(&prefix, &source).unwrap();
+        compile(&prefix, Phase::Precompile, None);
+        let file = dir.join("precompiled.cpp");
+        fs::write(&file, &source).unwrap();
+        let frontend = millis(fastest(&file, Phase::Frontend, Some(&prefix), runs));
+        println!(
+            "rust/cxx_enumext.h (precompiled),{frontend:.2},{:.2}",
+            frontend - baseline
+        );
+    }
+
+    drop(fs::remove_dir_all(&dir));
+}
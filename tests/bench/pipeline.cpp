@@ -0,0 +1,137 @@
+#include "tests/bench/pipeline.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+#include <type_traits>
+
+namespace {
+
+std::atomic<std::uint64_t> allocations{0};
+
+/// The same words as `WORDS` in `pipeline.rs`, one too long for any small
+/// string buffer.
+constexpr const char *words[] = {
+    "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf",
+    "a word too long for the small buffer of any string",
+};
+
+const char *word(std::uint64_t seed) {
+  return words[seed % std::size(words)];
+}
+
+} // namespace
+
+// Counts every allocation of the C++ side. The array and nothrow forms call
+// this one.
+void *operator new(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+
+void operator delete(void *pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+namespace pipeline {
+
+std::uint64_t take_pod(Pod value) {
+  return rust::enm::visit(
+      [](const auto &alternative) -> std::uint64_t {
+        using T = std::decay_t<decltype(alternative)>;
+        if constexpr (std::is_same_v<T, Pod::Id>) {
+          return alternative;
+        } else if constexpr (std::is_same_v<T, Pod::Point>) {
+          return static_cast<std::uint64_t>(alternative._0 + alternative._1);
+        } else if constexpr (std::is_same_v<T, Pod::Span>) {
+          return alternative.end - alternative.start;
+        } else {
+          return 0;
+        }
+      },
+      value);
+}
+
+std::uint64_t take_text(Text value) {
+  return rust::enm::visit(
+      [](const auto &alternative) -> std::uint64_t {
+        using T = std::decay_t<decltype(alternative)>;
+        if constexpr (std::is_same_v<T, Text::Word>) {
+          return alternative.size();
+        } else if constexpr (std::is_same_v<T, Text::Pair>) {
+          return alternative._0.size() + alternative._1.size();
+        } else if constexpr (std::is_same_v<T, Text::Tagged>) {
+          return alternative.tag.size() + alternative.value;
+        } else {
+          return 0;
+        }
+      },
+      value);
+}
+
+std::uint64_t take_boxed(Boxed value) {
+  return rust::enm::visit(
+      [](const auto &alternative) -> std::uint64_t {
+        using T = std::decay_t<decltype(alternative)>;
+        if constexpr (std::is_same_v<T, Boxed::Value>) {
+          return alternative->get();
+        } else if constexpr (std::is_same_v<T, Boxed::Counted>) {
+          return alternative._0->get() + alternative._1;
+        } else {
+          return 0;
+        }
+      },
+      value);
+}
+
+Pod make_pod(std::uint64_t seed) {
+  switch (seed % 4) {
+  case 0:
+    return Pod{Pod::Empty{}};
+  case 1:
+    return Pod{std::in_place_type<Pod::Id>, seed};
+  case 2:
+    return Pod{Pod::Point{static_cast<double>(seed),
+                          static_cast<double>(seed) / 2}};
+  default:
+    return Pod{Pod::Span{static_cast<std::uint32_t>(seed),
+                         static_cast<std::uint32_t>(seed) + 8}};
+  }
+}
+
+Text make_text(std::uint64_t seed) {
+  switch (seed % 4) {
+  case 0:
+    return Text{Text::Empty{}};
+  case 1:
+    return Text{rust::String{word(seed)}};
+  case 2:
+    return Text{Text::Pair{rust::String{word(seed)},
+                           rust::String{word(seed / 4)}}};
+  default:
+    return Text{Text::Tagged{rust::String{word(seed)}, seed}};
+  }
+}
+
+Boxed make_boxed(std::uint64_t seed) {
+  switch (seed % 3) {
+  case 0:
+    return Boxed{Boxed::Empty{}};
+  case 1:
+    return Boxed{new_rust_value(seed)};
+  default:
+    return Boxed{Boxed::Counted{new_rust_value(seed), seed}};
+  }
+}
+
+std::uint64_t cxx_allocations() noexcept {
+  return allocations.load(std::memory_order_relaxed);
+}
+
+} // namespace pipeline
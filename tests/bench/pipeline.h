@@ -0,0 +1,26 @@
+#pragma once
+#include "rust/cxx.h"
+
+#include <cstdint>
+
+// `RustValue`, which the generated definitions box
+#include "tests/bench/pipeline_types.rs.h"
+
+#include "tests/bench/pipeline_types.rs.enumext.h"
+
+namespace pipeline {
+
+/// Consume an enum built by Rust and return a checksum of its contents.
+std::uint64_t take_pod(Pod value);
+std::uint64_t take_text(Text value);
+std::uint64_t take_boxed(Boxed value);
+
+/// Build an enum for Rust to consume, picking the variant from `seed`.
+Pod make_pod(std::uint64_t seed);
+Text make_text(std::uint64_t seed);
+Boxed make_boxed(std::uint64_t seed);
+
+/// The number of calls to `operator new` so far.
+std::uint64_t cxx_allocations() noexcept;
+
+} // namespace pipeline
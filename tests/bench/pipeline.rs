@@ -0,0 +1,295 @@
+//! Moves enums across the bridge by value in both directions: one side builds
+//! them, the other consumes them. `Pod` only holds plain data, `Text` owns
+//! `String`s and `Boxed` owns `Box<RustValue>`s.
+//!
+//! ```sh
+//! cargo run --release -p cxx-enumext-bench --bin pipeline -- [elements]
+//! ```
+//!
+//! Prints one CSV row per enum and direction, each measured over `elements`
+//! calls (1M by default): the throughput, the median and 99th percentile
+//! latency of a call and the heap allocations per element on each side. Rust
+//! counts its allocations with a global allocator, C++ with a replaced
+//! `operator new`. The latencies are net of the time it takes to read the
+//! clock.
+
+mod pipeline_types;
+
+use std::alloc::{GlobalAlloc, Layout, System};
+use std::env;
+use std::hint::black_box;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::time::{Duration, Instant};
+
+use crate::pipeline_types::{new_rust_value, Boxed, Pod, Text};
+
+/// Counts the allocations of the Rust side, including those of the `String`s
+/// and `Box`es C++ creates through cxx.
+struct CountingAllocator;
+
+static RUST_ALLOCATIONS: AtomicU64 = AtomicU64::new(0);
+
+unsafe impl GlobalAlloc for CountingAllocator {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        RUST_ALLOCATIONS.fetch_add(1, Ordering::Relaxed);
+        System.alloc(layout)
+    }
+
+    unsafe fn alloc_zeroed(&self, layout: Layout) -> *mut u8 {
+        RUST_ALLOCATIONS.fetch_add(1, Ordering::Relaxed);
+        System.alloc_zeroed(layout)
+    }
+
+    unsafe fn realloc(&self, ptr: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+        RUST_ALLOCATIONS.fetch_add(1, Ordering::Relaxed);
+        System.realloc(ptr, layout, new_size)
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        System.dealloc(ptr, layout)
+    }
+}
+
+#[global_allocator]
+static ALLOCATOR: CountingAllocator = CountingAllocator;
+
+#[cxx::bridge(namespace = "pipeline")]
+mod ffi {
+    unsafe extern "C++" {
+        include!("tests/bench/pipeline.h");
+
+        type Pod = crate::pipeline_types::Pod;
+        type Text = crate::pipeline_types::Text;
+        type Boxed = crate::pipeline_types::Boxed;
+
+        fn take_pod(value: Pod) -> u64;
+        fn take_text(value: Text) -> u64;
+        fn take_boxed(value: Boxed) -> u64;
+
+        fn make_pod(seed: u64) -> Pod;
+        fn make_text(seed: u64) -> Text;
+        fn make_boxed(seed: u64) -> Boxed;
+
+        fn cxx_allocations() -> u64;
+    }
+}
+
+/// The same words as `words` in `pipeline.cpp`.
+const WORDS: &[&str] = &[
+    "alpha",
+    "bravo",
+    "charlie",
+    "delta",
+    "echo",
+    "foxtrot",
+    "golf",
+    "a word too long for the small buffer of any string",
+];
+
+fn word(seed: u64) -> String {
+    WORDS[(seed % WORDS.len() as u64) as usize].to_owned()
+}
+
+/// An enum both sides build from a seed and reduce to a checksum the same
+/// way.
+trait Bridged: Sized {
+    const NAME: &'static str;
+
+    fn make(seed: u64) -> Self;
+    fn take(self) -> u64;
+    fn make_cxx(seed: u64) -> Self;
+    fn take_cxx(self) -> u64;
+}
+
+impl Bridged for Pod {
+    const NAME: &'static str = "pod";
+
+    fn make(seed: u64) -> Self {
+        match seed % 4 {
+            0 => Pod::Empty,
+            1 => Pod::Id(seed),
+            2 => Pod::Point(seed as f64, seed as f64 / 2.0),
+            _ => Pod::Span {
+                start: seed as u32,
+                end: (seed as u32).wrapping_add(8),
+            },
+        }
+    }
+
+    fn take(self) -> u64 {
+        match self {
+            Pod::Empty => 0,
+            Pod::Id(id) => id,
+            Pod::Point(x, y) => (x + y) as u64,
+            Pod::Span { start, end } => end.wrapping_sub(start).into(),
+        }
+    }
+
+    fn make_cxx(seed: u64) -> Self {
+        ffi::make_pod(seed)
+    }
+
+    fn take_cxx(self) -> u64 {
+        ffi::take_pod(self)
+    }
+}
+
+impl Bridged for Text {
+    const NAME: &'static str = "text";
+
+    fn make(seed: u64) -> Self {
+        match seed % 4 {
+            0 => Text::Empty,
+            1 => Text::Word(word(seed)),
+            2 => Text::Pair(word(seed), word(seed / 4)),
+            _ => Text::Tagged {
+                tag: word(seed),
+                value: seed,
+            },
+        }
+    }
+
+    fn take(self) -> u64 {
+        match self {
+            Text::Empty => 0,
+            Text::Word(word) => word.len() as u64,
+            Text::Pair(first, second) => (first.len() + second.len()) as u64,
+            Text::Tagged { tag, value } => tag.len() as u64 + value,
+        }
+    }
+
+    fn make_cxx(seed: u64) -> Self {
+        ffi::make_text(seed)
+    }
+
+    fn take_cxx(self) -> u64 {
+        ffi::take_text(self)
+    }
+}
+
+impl Bridged for Boxed {
+    const NAME: &'static str = "boxed";
+
+    fn make(seed: u64) -> Self {
+        match seed % 3 {
+            0 => Boxed::Empty,
+            1 => Boxed::Value(new_rust_value(seed)),
+            _ => Boxed::Counted(new_rust_value(seed), seed),
+        }
+    }
+
+    fn take(self) -> u64 {
+        match self {
+            Boxed::Empty => 0,
+            Boxed::Value(value) => value.get(),
+            Boxed::Counted(value, count) => value.get() + count,
+        }
+    }
+
+    fn make_cxx(seed: u64) -> Self {
+        ffi::make_boxed(seed)
+    }
+
+    fn take_cxx(self) -> u64 {
+        ffi::take_boxed(self)
+    }
+}
+
+#[derive(Clone, Copy)]
+enum Direction {
+    /// Rust builds the enum, C++ consumes it.
+    RustToCxx,
+    /// C++ builds the enum, Rust consumes it.
+    CxxToRust,
+}
+
+impl Direction {
+    const ALL: [Direction; 2] = [Direction::RustToCxx, Direction::CxxToRust];
+
+    fn name(self) -> &'static str {
+        match self {
+            Direction::RustToCxx => "rust_to_cxx",
+            Direction::CxxToRust => "cxx_to_rust",
+        }
+    }
+
+    fn call<T: Bridged>(self, seed: u64) -> u64 {
+        match self {
+            Direction::RustToCxx => T::make(seed).take_cxx(),
+            Direction::CxxToRust => T::make_cxx(seed).take(),
+        }
+    }
+}
+
+/// The median time it takes to read the clock twice.
+fn clock_overhead() -> Duration {
+    let mut samples: Vec<Duration> = (0..10_000)
+        .map(|_| {
+            let start = Instant::now();
+            black_box(start).elapsed()
+        })
+        .collect();
+    samples.sort_unstable();
+    samples[samples.len() / 2]
+}
+
+fn percentile(sorted: &[Duration], percent: usize) -> Duration {
+    sorted[(sorted.len() - 1) * percent / 100]
+}
+
+fn nanos(duration: Duration) -> f64 {
+    duration.as_secs_f64() * 1e9
+}
+
+fn measure<T: Bridged>(direction: Direction, elements: u64, overhead: Duration) {
+    for seed in 0..elements.min(10_000) {
+        black_box(direction.call::<T>(black_box(seed)));
+    }
+
+    let rust_allocations = RUST_ALLOCATIONS.load(Ordering::Relaxed);
+    let cxx_allocations = ffi::cxx_allocations();
+    let start = Instant::now();
+    let mut checksum = 0u64;
+    for seed in 0..elements {
+        checksum = checksum.wrapping_add(direction.call::<T>(black_box(seed)));
+    }
+    let elapsed = start.elapsed();
+    let rust_allocations = RUST_ALLOCATIONS.load(Ordering::Relaxed) - rust_allocations;
+    let cxx_allocations = ffi::cxx_allocations() - cxx_allocations;
+    black_box(checksum);
+
+    let mut latencies = Vec::with_capacity(elements as usize);
+    for seed in 0..elements {
+        let start = Instant::now();
+        black_box(direction.call::<T>(black_box(seed)));
+        latencies.push(start.elapsed().saturating_sub(overhead));
+    }
+    latencies.sort_unstable();
+
+    println!(
+        "{},{},{:.0},{:.1},{:.1},{:.3},{:.3}",
+        T::NAME,
+        direction.name(),
+        elements as f64 / elapsed.as_secs_f64(),
+        nanos(percentile(&latencies, 50)),
+        nanos(percentile(&latencies, 99)),
+        rust_allocations as f64 / elements as f64,
+        cxx_allocations as f64 / elements as f64,
+    );
+}
+
+fn main() {
+    let elements = env::args()
+        .nth(1)
+        .map(|elements| elements.parse().expect("`elements` must be a number"))
+        .unwrap_or(1_000_000);
+    assert!(elements > 0, "`elements` must be positive");
+
+    let overhead = clock_overhead();
+    println!("enum,direction,elements_per_sec,p50_ns,p99_ns,rust_allocs_per_element,cxx_allocs_per_element");
+    for direction in Direction::ALL {
+        measure::<Pod>(direction, elements, overhead);
+        measure::<Text>(direction, elements, overhead);
+        measure::<Boxed>(direction, elements, overhead);
+    }
+}
@@ -0,0 +1,54 @@
+//! The enums the `pipeline` benchmark moves across the bridge. Their C++
+//! definitions are generated by `cxx-enumext-build` (see `build.rs`).
+
+#[cxx::bridge(namespace = "pipeline")]
+pub mod ffi {
+    extern "Rust" {
+        type RustValue;
+        fn get(&self) -> u64;
+
+        fn new_rust_value(value: u64) -> Box<RustValue>;
+    }
+}
+
+pub fn new_rust_value(value: u64) -> Box<RustValue> {
+    Box::new(RustValue { value })
+}
+
+pub struct RustValue {
+    value: u64,
+}
+
+impl RustValue {
+    pub fn get(&self) -> u64 {
+        self.value
+    }
+}
+
+/// Plain data, moved by copying its bytes.
+#[cxx_enumext::extern_type(namespace = pipeline)]
+#[derive(Debug, Clone, Copy)]
+pub enum Pod {
+    Empty,
+    Id(u64),
+    Point(f64, f64),
+    Span { start: u32, end: u32 },
+}
+
+/// Every variant but one owns one or two `String`s.
+#[cxx_enumext::extern_type(namespace = pipeline)]
+#[derive(Debug)]
+pub enum Text {
+    Empty,
+    Word(String),
+    Pair(String, String),
+    Tagged { tag: String, value: u64 },
+}
+
+/// Every variant but one owns a boxed opaque Rust value.
+#[cxx_enumext::extern_type(namespace = pipeline)]
+pub enum Boxed {
+    Empty,
+    Value(Box<RustValue>),
+    Counted(Box<RustValue>, u64),
+}
@@ -0,0 +1,879 @@
+#include "tests/bench/variant.h"
+#include "tests/bench/variant.rs.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "rust/cxx_enumext.h"
+#include "rust/cxx_enumext_macros.h"
+
+namespace bench {
+namespace {
+
+// =================================================
+//
+// Harness
+//
+// =================================================
+
+/// @brief Makes the compiler assume that `value` is read and that any memory
+/// may be written, so neither the computation of `value` nor stores before
+/// the call can be optimized away.
+template <typename T> void escape(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r"(&value) : "memory");
+#else
+  static const void *volatile sink;
+  sink = &value;
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+struct benchmark {
+  const char *group;
+  const char *operation;
+  std::size_t alternatives;
+  const char *payload;
+  const char *library;
+};
+
+class runner {
+public:
+  runner(rust::Str filter, std::uint64_t min_time_ms)
+      : m_Filter(filter), m_MinTime(std::chrono::milliseconds(min_time_ms)) {}
+
+  /// @brief Measures the call returned by `setup`, which performs `ops`
+  /// operations, and records the fastest of the samples. The data `setup`
+  /// creates only lives for the measurement, and isn't created at all if the
+  /// benchmark is filtered out.
+  template <typename Setup>
+  void run(const benchmark &id, std::size_t ops, Setup &&setup) {
+    const std::string name = std::string(id.group) + "/" + id.operation;
+    if (name.find(m_Filter) == std::string::npos) {
+      return;
+    }
+
+    auto call = setup();
+
+    // Double the calls per sample until a sample takes its share of the
+    // minimum time. This also warms the caches and the branch predictors.
+    const auto sample_time = m_MinTime / samples;
+    std::size_t calls = 1;
+    while (time(call, calls) < sample_time) {
+      calls *= 2;
+    }
+
+    auto fastest = std::chrono::nanoseconds::max();
+    for (std::size_t sample = 0; sample < samples; ++sample) {
+      fastest = std::min(fastest, time(call, calls));
+    }
+
+    m_Results.push_back(Measurement{
+        id.group, id.operation, id.alternatives, id.payload, id.library,
+        static_cast<double>(fastest.count()) /
+            static_cast<double>(calls * ops)});
+  }
+
+  rust::Vec<Measurement> results() && { return std::move(m_Results); }
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  constexpr static std::size_t samples = 5;
+
+  template <typename Call>
+  static std::chrono::nanoseconds time(Call &call, std::size_t calls) {
+    const auto start = clock::now();
+    for (std::size_t i = 0; i < calls; ++i) {
+      call();
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() -
+                                                                start);
+  }
+
+  std::string m_Filter;
+  std::chrono::nanoseconds m_MinTime;
+  rust::Vec<Measurement> m_Results;
+};
+
+/// The number of variants most benchmarks loop over per call, small enough
+/// for the caches.
+constexpr std::size_t batch = 1024;
+
+// =================================================
+//
+// Alternatives
+//
+// =================================================
+
+/// 8 bytes, like an integer or a `Box`.
+using small = std::int64_t;
+
+/// 128 bytes, like a struct holding a few `String`s and `Vec`s.
+using large = std::array<std::int64_t, 16>;
+
+template <typename Payload> constexpr const char *payload_name = "large";
+template <> constexpr const char *payload_name<small> = "small";
+
+void fill(small &value, std::int64_t seed) noexcept { value = seed; }
+void fill(large &value, std::int64_t seed) noexcept {
+  for (std::int64_t &word : value) {
+    word = seed++;
+  }
+}
+
+std::int64_t first_word(const small &value) noexcept { return value; }
+std::int64_t first_word(const large &value) noexcept { return value[0]; }
+
+/// @brief The `I`-th alternative. Constructing it doesn't throw, `emplace`
+/// constructs it in place.
+template <std::size_t I, typename Payload> struct alternative {
+  constexpr static std::size_t index = I;
+
+  alternative() = default;
+  explicit alternative(std::int64_t seed) noexcept { fill(value, seed); }
+
+  Payload value;
+};
+
+/// @brief Constructing may throw but moving doesn't, `emplace` constructs a
+/// temporary and moves it in.
+template <std::size_t I, typename Payload>
+struct throwing_alternative : alternative<I, Payload> {
+  explicit throwing_alternative(std::int64_t seed) noexcept(false)
+      : alternative<I, Payload>(seed) {}
+};
+
+/// @brief Constructing and moving may throw. `rust::enm::variant` backs the
+/// old alternative up to restore it if constructing throws, `std::variant`
+/// destroys it first and becomes valueless.
+template <std::size_t I, typename Payload>
+struct throwing_move_alternative : alternative<I, Payload> {
+  explicit throwing_move_alternative(std::int64_t seed) noexcept(false)
+      : alternative<I, Payload>(seed) {}
+  throwing_move_alternative(const throwing_move_alternative &other) noexcept(
+      false)
+      : alternative<I, Payload>(other) {}
+  throwing_move_alternative &
+  operator=(const throwing_move_alternative &) = default;
+};
+
+struct enm_library {
+  constexpr static const char *name = "rust::enm";
+
+  template <typename... Ts> using variant = rust::enm::variant<Ts...>;
+
+  template <typename Visitor, typename Variant>
+  static decltype(auto) visit(Visitor &&visitor, Variant &&value) {
+    return rust::enm::visit(std::forward<Visitor>(visitor),
+                            std::forward<Variant>(value));
+  }
+
+  template <std::size_t I, typename Variant>
+  static auto get_if(Variant *value) noexcept {
+    return rust::enm::get_if<I>(value);
+  }
+};
+
+struct std_library {
+  constexpr static const char *name = "std";
+
+  template <typename... Ts> using variant = std::variant<Ts...>;
+
+  template <typename Visitor, typename Variant>
+  static decltype(auto) visit(Visitor &&visitor, Variant &&value) {
+    return std::visit(std::forward<Visitor>(visitor),
+                      std::forward<Variant>(value));
+  }
+
+  template <std::size_t I, typename Variant>
+  static auto get_if(Variant *value) noexcept {
+    return std::get_if<I>(value);
+  }
+};
+
+template <typename Library, template <std::size_t, typename> class Alternative,
+          typename Payload, typename Indices>
+struct make_variant;
+
+template <typename Library, template <std::size_t, typename> class Alternative,
+          typename Payload, std::size_t... Is>
+struct make_variant<Library, Alternative, Payload,
+                    std::index_sequence<Is...>> {
+  using type = typename Library::template variant<Alternative<Is, Payload>...>;
+};
+
+/// The variant of `N` alternatives of `Library`.
+template <typename Library, std::size_t N, typename Payload,
+          template <std::size_t, typename> class Alternative = alternative>
+using variant_t = typename make_variant<Library, Alternative, Payload,
+                                        std::make_index_sequence<N>>::type;
+
+template <typename Variant, std::size_t... Is>
+Variant make_at(std::size_t index, std::int64_t seed,
+                std::index_sequence<Is...>) {
+  std::optional<Variant> value;
+  ((index == Is ? (void)value.emplace(std::in_place_index<Is>, seed)
+                : void()),
+   ...);
+  return std::move(*value);
+}
+
+/// `count` variants of `N` alternatives, the `i`-th holding `index(i)`.
+template <typename Variant, std::size_t N, typename Index>
+std::vector<Variant> make_values(std::size_t count, Index &&index) {
+  std::vector<Variant> values;
+  values.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    values.push_back(make_at<Variant>(index(i), static_cast<std::int64_t>(i),
+                                      std::make_index_sequence<N>{}));
+  }
+  return values;
+}
+
+/// Cycles through the alternatives, which is well predicted.
+template <typename Variant, std::size_t N>
+std::vector<Variant> mixed_values(std::size_t offset = 0) {
+  return make_values<Variant, N>(
+      batch, [&](std::size_t i) { return (i + offset) % N; });
+}
+
+/// Returns the first word of the payload of any alternative.
+struct first_word_of {
+  template <typename Alternative>
+  std::int64_t operator()(const Alternative &alternative) const noexcept {
+    return first_word(alternative.value);
+  }
+};
+
+// =================================================
+//
+// Variant operations
+//
+// =================================================
+
+template <typename Library, std::size_t N, typename Payload,
+          template <std::size_t, typename> class Alternative>
+void emplace_benchmark(runner &r, const char *operation) {
+  using variant = variant_t<Library, N, Payload, Alternative>;
+  r.run({"variant", operation, N, payload_name<Payload>, Library::name},
+        2 * batch, [] {
+          return [value = variant{std::in_place_index<0>, 0}]() mutable {
+            for (std::size_t i = 0; i < batch; ++i) {
+              const auto seed = static_cast<std::int64_t>(i);
+              value.template emplace<N - 1>(seed);
+              escape(value);
+              value.template emplace<0>(seed);
+              escape(value);
+            }
+          };
+        });
+}
+
+template <typename Library, std::size_t N, typename Payload, std::size_t I>
+void visit_benchmark(runner &r, const char *operation) {
+  using variant = variant_t<Library, N, Payload>;
+  r.run({"variant", operation, N, payload_name<Payload>, Library::name}, batch,
+        [] {
+          return [values = make_values<variant, N>(
+                      batch, [](std::size_t) { return I; })] {
+            std::int64_t sum = 0;
+            for (const variant &value : values) {
+              sum += Library::visit(first_word_of{}, value);
+            }
+            escape(sum);
+          };
+        });
+}
+
+template <typename Library, std::size_t N, typename Payload>
+void variant_benchmarks(runner &r) {
+  using variant = variant_t<Library, N, Payload>;
+  const auto id = [](const char *operation) {
+    return benchmark{"variant", operation, N, payload_name<Payload>,
+                     Library::name};
+  };
+
+  r.run(id("construct"), batch, [] {
+    return [] {
+      for (std::size_t i = 0; i < batch; ++i) {
+        variant value{std::in_place_index<N - 1>, static_cast<std::int64_t>(i)};
+        escape(value);
+      }
+    };
+  });
+
+  r.run(id("copy"), batch, [] {
+    return [values = mixed_values<variant, N>()] {
+      for (const variant &value : values) {
+        variant copy{value};
+        escape(copy);
+      }
+    };
+  });
+
+  emplace_benchmark<Library, N, Payload, alternative>(r, "emplace_nothrow");
+  emplace_benchmark<Library, N, Payload, throwing_alternative>(
+      r, "emplace_nothrow_move");
+  emplace_benchmark<Library, N, Payload, throwing_move_alternative>(
+      r, "emplace_strong");
+
+  visit_benchmark<Library, N, Payload, 0>(r, "visit_first");
+  visit_benchmark<Library, N, Payload, N / 2>(r, "visit_middle");
+  visit_benchmark<Library, N, Payload, N - 1>(r, "visit_last");
+
+  r.run(id("swap"), batch, [] {
+    return [lhs = mixed_values<variant, N>(),
+            rhs = mixed_values<variant, N>(1)]() mutable {
+      for (std::size_t i = 0; i < batch; ++i) {
+        lhs[i].swap(rhs[i]);
+      }
+      escape(lhs);
+      escape(rhs);
+    };
+  });
+
+  r.run(id("get_if"), batch, [] {
+    return [values = mixed_values<variant, N>()] {
+      std::int64_t sum = 0;
+      for (const variant &value : values) {
+        if (const auto *first = Library::template get_if<0>(&value)) {
+          sum += first_word(first->value);
+        }
+      }
+      escape(sum);
+    };
+  });
+}
+
+template <typename Library> void variant_benchmarks(runner &r) {
+  variant_benchmarks<Library, 2, small>(r);
+  variant_benchmarks<Library, 2, large>(r);
+  variant_benchmarks<Library, 8, small>(r);
+  variant_benchmarks<Library, 8, large>(r);
+  variant_benchmarks<Library, 20, small>(r);
+  variant_benchmarks<Library, 20, large>(r);
+}
+
+// =================================================
+//
+// optional and expected
+//
+// =================================================
+
+enum class error_code : std::int32_t { odd = 1, empty };
+
+/// Values of which every 8th is `empty`.
+template <typename T> std::vector<T> mostly_values(const T &empty) {
+  std::vector<T> values;
+  values.reserve(batch);
+  for (std::size_t i = 0; i < batch; ++i) {
+    values.push_back(i % 8 == 7 ? empty : T{static_cast<std::int64_t>(i)});
+  }
+  return values;
+}
+
+/// The standard library has no monadic operations before C++23, its chains
+/// are written out with branches.
+void monadic_benchmarks(runner &r) {
+  using enm_optional = rust::enm::optional<std::int64_t>;
+  r.run({"monadic", "optional", 2, "small", enm_library::name}, batch, [] {
+    return [values = mostly_values(enm_optional{})] {
+      std::int64_t sum = 0;
+      for (const enm_optional &value : values) {
+        sum += value
+                   .and_then([](std::int64_t x) {
+                     return x % 2 == 0 ? enm_optional{x / 2} : enm_optional{};
+                   })
+                   .transform([](std::int64_t x) { return x + 1; })
+                   .value_or(0);
+      }
+      escape(sum);
+    };
+  });
+
+  r.run({"monadic", "optional", 2, "small", std_library::name}, batch, [] {
+    return [values = mostly_values(std::optional<std::int64_t>{})] {
+      std::int64_t sum = 0;
+      for (const std::optional<std::int64_t> &value : values) {
+        const auto halved = value && *value % 2 == 0
+                                ? std::optional<std::int64_t>{*value / 2}
+                                : std::nullopt;
+        sum += halved ? *halved + 1 : 0;
+      }
+      escape(sum);
+    };
+  });
+
+  using enm_expected = rust::enm::expected<std::int64_t, error_code>;
+  r.run({"monadic", "expected", 2, "small", enm_library::name}, batch, [] {
+    return [values = mostly_values(enm_expected{error_code::empty})] {
+      std::int64_t sum = 0;
+      for (const enm_expected &value : values) {
+        sum += value
+                   .and_then([](std::int64_t x) {
+                     return x % 2 == 0 ? enm_expected{x / 2}
+                                       : enm_expected{error_code::odd};
+                   })
+                   .transform([](std::int64_t x) { return x + 1; })
+                   .value_or(0);
+      }
+      escape(sum);
+    };
+  });
+
+  using std_expected = std::variant<std::int64_t, error_code>;
+  r.run({"monadic", "expected", 2, "small", std_library::name}, batch, [] {
+    return [values = mostly_values(std_expected{error_code::empty})] {
+      std::int64_t sum = 0;
+      for (const std_expected &value : values) {
+        const std::int64_t *x = std::get_if<0>(&value);
+        const std_expected halved = x && *x % 2 == 0
+                                        ? std_expected{*x / 2}
+                                        : std_expected{error_code::odd};
+        const std::int64_t *y = std::get_if<0>(&halved);
+        sum += y ? *y + 1 : 0;
+      }
+      escape(sum);
+    };
+  });
+}
+
+/// Strings of which every 8th is empty, the others own a heap buffer.
+std::vector<rust::String> mostly_strings() {
+  std::vector<rust::String> strings;
+  strings.reserve(batch);
+  for (std::size_t i = 0; i < batch; ++i) {
+    strings.push_back(i % 8 == 7 ? rust::String{}
+                                 : rust::String{"a payload on the heap"});
+  }
+  return strings;
+}
+
+/// Chains over payloads that own heap memory. Every element goes through the
+/// chain and back into its slot, so the data is the same for every call: an
+/// empty payload comes out as `None` or an error and goes back in empty. The
+/// stages only pass the payload on, what is measured is moving it from stage
+/// to stage, which doesn't allocate, or copying it, which does. The copying
+/// baseline is what the `&` and `const &` overloads do.
+void moving_monadic_benchmarks(runner &r) {
+  using enm_optional = rust::enm::optional<rust::String>;
+  const auto optionals = [] {
+    std::vector<enm_optional> values;
+    for (rust::String &string : mostly_strings()) {
+      values.emplace_back(std::move(string));
+    }
+    return values;
+  };
+
+  r.run({"monadic", "optional", 2, "string", enm_library::name}, batch,
+        [&optionals] {
+          return [values = optionals()]() mutable {
+            for (enm_optional &value : values) {
+              value = enm_optional{
+                  std::move(value)
+                      .and_then([](rust::String &&string) {
+                        return string.empty() ? enm_optional{}
+                                              : enm_optional{std::move(string)};
+                      })
+                      .transform([](rust::String &&string) {
+                        return std::move(string);
+                      })
+                      .or_else([] { return enm_optional{}; })
+                      .value_or(rust::String{})};
+            }
+            escape(values);
+          };
+        });
+
+  r.run({"monadic", "optional", 2, "string", "rust::enm copies"}, batch,
+        [&optionals] {
+          return [values = optionals()]() mutable {
+            for (enm_optional &value : values) {
+              const enm_optional &input = value;
+              const auto kept = input.and_then([](const rust::String &string) {
+                return string.empty() ? enm_optional{} : enm_optional{string};
+              });
+              const auto passed = kept.transform(
+                  [](const rust::String &string) { return string; });
+              const auto filled = passed.or_else([] { return enm_optional{}; });
+              value = enm_optional{filled.value_or(rust::String{})};
+            }
+            escape(values);
+          };
+        });
+
+  using numbers = rust::Vec<std::int64_t>;
+  using enm_expected = rust::enm::expected<numbers, error_code>;
+  const auto expecteds = [] {
+    std::vector<enm_expected> values;
+    values.reserve(batch);
+    for (std::size_t i = 0; i < batch; ++i) {
+      numbers value;
+      if (i % 8 != 7) {
+        value.reserve(4);
+        for (std::int64_t n = 0; n < 4; ++n) {
+          value.push_back(n);
+        }
+      }
+      values.emplace_back(std::move(value));
+    }
+    return values;
+  };
+
+  r.run({"monadic", "expected", 2, "vec", enm_library::name}, batch,
+        [&expecteds] {
+          return [values = expecteds()]() mutable {
+            for (enm_expected &value : values) {
+              value = enm_expected{
+                  std::move(value)
+                      .and_then([](numbers &&value) {
+                        return value.empty() ? enm_expected{error_code::empty}
+                                             : enm_expected{std::move(value)};
+                      })
+                      .transform(
+                          [](numbers &&value) { return std::move(value); })
+                      .transform_error([](error_code error) { return error; })
+                      .value_or(numbers{})};
+            }
+            escape(values);
+          };
+        });
+
+  r.run({"monadic", "expected", 2, "vec", "rust::enm copies"}, batch,
+        [&expecteds] {
+          return [values = expecteds()]() mutable {
+            for (enm_expected &value : values) {
+              const enm_expected &input = value;
+              const auto kept = input.and_then([](const numbers &value) {
+                return value.empty() ? enm_expected{error_code::empty}
+                                     : enm_expected{value};
+              });
+              const auto passed =
+                  kept.transform([](const numbers &value) { return value; });
+              const auto mapped = passed.transform_error(
+                  [](error_code error) { return error; });
+              value = enm_expected{mapped.value_or(numbers{})};
+            }
+            escape(values);
+          };
+        });
+}
+
+// =================================================
+//
+// Tag scanning
+//
+// =================================================
+
+/// Compares `count_alternatives` and friends with the loops they replace,
+/// over 8k variants of 16 bytes. `std::variant` has no `has_valid_tags`, its
+/// tags can't come from foreign memory.
+void scan_benchmarks(runner &r) {
+  constexpr static std::size_t N = 8;
+  constexpr static std::size_t count = 8 * 1024;
+  using enm_variant = variant_t<enm_library, N, small>;
+  using std_variant = variant_t<std_library, N, small>;
+  static_assert(sizeof(enm_variant) == 16, "The kernels are tuned for this");
+
+  // The last alternative only at the end, for `find_alternative`.
+  const auto index = [](std::size_t i) {
+    return i + 1 == count ? N - 1 : (i * 7 + i / 3) % (N - 1);
+  };
+  const auto id = [](const char *operation, const char *library) {
+    return benchmark{"scan", operation, N, "small", library};
+  };
+
+  r.run(id("count_alternatives", "rust::enm"), count, [&] {
+    return [values = make_values<enm_variant, N>(count, index)] {
+      escape(rust::enm::count_alternatives(values));
+    };
+  });
+  r.run(id("count_alternatives", "rust::enm loop"), count, [&] {
+    return [values = make_values<enm_variant, N>(count, index)] {
+      std::array<std::size_t, N> counts{};
+      for (const enm_variant &value : values) {
+        ++counts[value.index()];
+      }
+      escape(counts);
+    };
+  });
+  r.run(id("count_alternatives", "std"), count, [&] {
+    return [values = make_values<std_variant, N>(count, index)] {
+      std::array<std::size_t, N> counts{};
+      for (const std_variant &value : values) {
+        ++counts[value.index()];
+      }
+      escape(counts);
+    };
+  });
+
+  r.run(id("find_alternative", "rust::enm"), count, [&] {
+    return [values = make_values<enm_variant, N>(count, index)] {
+      escape(rust::enm::find_alternative<N - 1>(values));
+    };
+  });
+  r.run(id("find_alternative", "rust::enm loop"), count, [&] {
+    return [values = make_values<enm_variant, N>(count, index)] {
+      escape(std::find_if(values.begin(), values.end(),
+                          [](const enm_variant &value) {
+                            return rust::enm::holds_alternative<N - 1>(value);
+                          }));
+    };
+  });
+  r.run(id("find_alternative", "std"), count, [&] {
+    return [values = make_values<std_variant, N>(count, index)] {
+      escape(std::find_if(values.begin(), values.end(),
+                          [](const std_variant &value) {
+                            return std::holds_alternative<
+                                std::variant_alternative_t<N - 1, std_variant>>(
+                                value);
+                          }));
+    };
+  });
+
+  r.run(id("has_valid_tags", "rust::enm"), count, [&] {
+    return [values = make_values<enm_variant, N>(count, index)] {
+      escape(rust::enm::has_valid_tags(values));
+    };
+  });
+  r.run(id("has_valid_tags", "rust::enm loop"), count, [&] {
+    return [values = make_values<enm_variant, N>(count, index)] {
+      escape(std::all_of(
+          values.begin(), values.end(),
+          [](const enm_variant &value) { return value.index() < N; }));
+    };
+  });
+}
+
+// =================================================
+//
+// Grouped visitation
+//
+// =================================================
+
+/// Adds the payload weighted by the alternative, so that every alternative
+/// does something different.
+struct weighted_sum {
+  std::int64_t &sum;
+
+  template <typename Alternative>
+  void operator()(const Alternative &alternative) const noexcept {
+    sum += alternative.value *
+           static_cast<std::int64_t>(Alternative::index + 1);
+  }
+};
+
+/// Compares `visit_grouped` with `visit` loops over 1M variants of 12
+/// alternatives, holding random alternatives or 90% the same.
+void grouped_benchmarks(runner &r) {
+  constexpr static std::size_t N = 12;
+  constexpr static std::size_t count = 1024 * 1024;
+  using enm_variant = variant_t<enm_library, N, small>;
+  using std_variant = variant_t<std_library, N, small>;
+
+  const auto random_indices = [](bool skewed) {
+    std::mt19937_64 random{42};
+    std::uniform_int_distribution<std::size_t> alternatives{0, N - 1};
+    std::uniform_int_distribution<int> percent{0, 99};
+    std::vector<std::size_t> indices(count);
+    for (std::size_t &index : indices) {
+      index = skewed && percent(random) < 90 ? 0 : alternatives(random);
+    }
+    return indices;
+  };
+
+  for (const bool skewed : {false, true}) {
+    const char *operation = skewed ? "skewed" : "random";
+    const auto id = [&](const char *library) {
+      return benchmark{"grouped", operation, N, "small", library};
+    };
+    const auto at = [indices = random_indices(skewed)](std::size_t i) {
+      return indices[i];
+    };
+
+    r.run(id("rust::enm grouped"), count, [&] {
+      return [values = make_values<enm_variant, N>(count, at)] {
+        std::int64_t sum = 0;
+        rust::enm::visit_grouped(values, weighted_sum{sum});
+        escape(sum);
+      };
+    });
+    r.run(id("rust::enm"), count, [&] {
+      return [values = make_values<enm_variant, N>(count, at)] {
+        std::int64_t sum = 0;
+        for (const enm_variant &value : values) {
+          rust::enm::visit(weighted_sum{sum}, value);
+        }
+        escape(sum);
+      };
+    });
+    r.run(id("std"), count, [&] {
+      return [values = make_values<std_variant, N>(count, at)] {
+        std::int64_t sum = 0;
+        for (const std_variant &value : values) {
+          std::visit(weighted_sum{sum}, value);
+        }
+        escape(sum);
+      };
+    });
+  }
+}
+
+// =================================================
+//
+// Comparisons
+//
+// =================================================
+
+CXX_DEFINE_VARIANT_REPR(CompactEnum, uint8_t,
+                        (UNIT(Empty), TUPLE(Pair, int16_t, int16_t),
+                         TYPE(Flag, bool)), )
+
+using StdCompactEnum =
+    std::variant<std::monostate, std::pair<std::int16_t, std::int16_t>, bool>;
+
+/// How `<` used to be written for variants, before they had operators.
+bool visitor_less(const CompactEnum &lhs, const CompactEnum &rhs) {
+  if (lhs.index() != rhs.index()) {
+    return lhs.index() < rhs.index();
+  }
+  return rust::enm::visit(
+      [&rhs](const auto &value) {
+        using T = std::decay_t<decltype(value)>;
+        if constexpr (std::is_empty_v<T>) {
+          return false;
+        } else {
+          return value < rust::enm::get_unchecked<T>(rhs);
+        }
+      },
+      lhs);
+}
+
+bool visitor_equal(const CompactEnum &lhs, const CompactEnum &rhs) {
+  if (lhs.index() != rhs.index()) {
+    return false;
+  }
+  return rust::enm::visit(
+      [&rhs](const auto &value) {
+        using T = std::decay_t<decltype(value)>;
+        if constexpr (std::is_empty_v<T>) {
+          return true;
+        } else {
+          return value == rust::enm::get_unchecked<T>(rhs);
+        }
+      },
+      lhs);
+}
+
+/// Random `CompactEnum`s, drawn from few values so that many are equal.
+template <typename Variant>
+std::vector<Variant> compact_enums(std::size_t count, std::uint64_t seed) {
+  std::mt19937_64 random{seed};
+  std::uniform_int_distribution<int> index{0, 2};
+  std::uniform_int_distribution<std::int16_t> field{0, 3};
+  std::vector<Variant> values;
+  values.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    switch (index(random)) {
+    case 0:
+      values.emplace_back(std::in_place_index<0>);
+      break;
+    case 1: {
+      const std::int16_t first = field(random);
+      const std::int16_t second = field(random);
+      if constexpr (std::is_same_v<Variant, CompactEnum>) {
+        values.emplace_back(CompactEnum::Pair{first, second});
+      } else {
+        values.emplace_back(std::in_place_index<1>, first, second);
+      }
+      break;
+    }
+    default:
+      values.emplace_back(std::in_place_index<2>, field(random) % 2 == 0);
+    }
+  }
+  return values;
+}
+
+/// Compares the comparison operators with a visitor over 1M `CompactEnum`s,
+/// `#[repr(u8)]` enums of 6 bytes. Sorting includes copying the input.
+void comparison_benchmarks(runner &r) {
+  constexpr static std::size_t count = 1024 * 1024;
+  const auto id = [](const char *operation, const char *library) {
+    return benchmark{"compare", operation, 3, "small", library};
+  };
+
+  const auto sort = [](auto less) {
+    return [less](const auto &values) {
+      return [values, less, work = values]() mutable {
+        work = values;
+        std::sort(work.begin(), work.end(), less);
+        escape(work);
+      };
+    };
+  };
+  r.run(id("sort", "rust::enm"), count, [&] {
+    return sort(std::less<CompactEnum>{})(compact_enums<CompactEnum>(count, 1));
+  });
+  r.run(id("sort", "rust::enm visitor"), count, [&] {
+    return sort(visitor_less)(compact_enums<CompactEnum>(count, 1));
+  });
+  r.run(id("sort", "std"), count, [&] {
+    return sort(std::less<StdCompactEnum>{})(
+        compact_enums<StdCompactEnum>(count, 1));
+  });
+
+  const auto equal = [](auto equal_to) {
+    return [equal_to](const auto &lhs, const auto &rhs) {
+      return [lhs, rhs, equal_to] {
+        std::size_t matches = 0;
+        for (std::size_t i = 0; i < lhs.size(); ++i) {
+          matches += equal_to(lhs[i], rhs[i]);
+        }
+        escape(matches);
+      };
+    };
+  };
+  r.run(id("equal", "rust::enm"), count, [&] {
+    return equal(std::equal_to<CompactEnum>{})(
+        compact_enums<CompactEnum>(count, 1),
+        compact_enums<CompactEnum>(count, 2));
+  });
+  r.run(id("equal", "rust::enm visitor"), count, [&] {
+    return equal(visitor_equal)(compact_enums<CompactEnum>(count, 1),
+                                compact_enums<CompactEnum>(count, 2));
+  });
+  r.run(id("equal", "std"), count, [&] {
+    return equal(std::equal_to<StdCompactEnum>{})(
+        compact_enums<StdCompactEnum>(count, 1),
+        compact_enums<StdCompactEnum>(count, 2));
+  });
+}
+
+} // namespace
+
+rust::Vec<Measurement> run_variant_benchmarks(rust::Str filter,
+                                              std::uint64_t min_time_ms) {
+  runner r{filter, min_time_ms};
+  variant_benchmarks<enm_library>(r);
+  variant_benchmarks<std_library>(r);
+  monadic_benchmarks(r);
+  moving_monadic_benchmarks(r);
+  scan_benchmarks(r);
+  grouped_benchmarks(r);
+  comparison_benchmarks(r);
+  return std::move(r).results();
+}
+
+} // namespace bench
@@ -0,0 +1,15 @@
+#pragma once
+#include "rust/cxx.h"
+
+#include <cstdint>
+
+namespace bench {
+
+struct Measurement;
+
+/// Runs the benchmarks whose `group/operation` contains `filter`, measuring
+/// each for about `min_time_ms`.
+rust::Vec<Measurement> run_variant_benchmarks(rust::Str filter,
+                                              std::uint64_t min_time_ms);
+
+} // namespace bench
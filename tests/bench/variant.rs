@@ -0,0 +1,61 @@
+//! Compares `rust::enm::variant` with `std::variant`: construction, copies,
+//! `emplace`, `visit`, `swap`, `get_if` and the monadic operations of
+//! `optional` and `expected`, for 2, 8 and 20 alternatives of small (8 byte)
+//! and large (128 byte) payloads, and of `String` and `Vec` payloads moved
+//! along chains of `&&` calls or copied. The tag scanning, grouped visitation,
+//! comparison and hashing kernels are measured against the loops they
+//! replace.
+//!
+//! ```sh
+//! cargo run --release -p cxx-enumext-bench --bin variant -- [filter] [min_ms]
+//! ```
+//!
+//! Runs the benchmarks whose `group/operation` contains `filter` (all of them
+//! by default) for about `min_ms` milliseconds each (50 by default) and
+//! prints one CSV row per benchmark. The times are the fastest of several
+//! samples. The C++ is always compiled with optimizations.
+
+use std::env;
+
+#[cxx::bridge(namespace = "bench")]
+mod ffi {
+    struct Measurement {
+        group: String,
+        operation: String,
+        alternatives: usize,
+        /// `small`, `large`, or a heap allocating payload like `string`
+        payload: String,
+        /// `rust::enm`, `std`, or a baseline written with `rust::enm` like
+        /// `rust::enm loop`
+        library: String,
+        ns_per_op: f64,
+    }
+
+    unsafe extern "C++" {
+        include!("tests/bench/variant.h");
+
+        fn run_variant_benchmarks(filter: &str, min_time_ms: u64) -> Vec<Measurement>;
+    }
+}
+
+fn main() {
+    let mut args = env::args().skip(1);
+    let filter = args.next().unwrap_or_default();
+    let min_time_ms = args
+        .next()
+        .map(|min_ms| min_ms.parse().expect("`min_ms` must be a number"))
+        .unwrap_or(50);
+
+    println!("group,operation,alternatives,payload,library,ns_per_op");
+    for measurement in ffi::run_variant_benchmarks(&filter, min_time_ms) {
+        println!(
+            "{},{},{},{},{},{:.3}",
+            measurement.group,
+            measurement.operation,
+            measurement.alternatives,
+            measurement.payload,
+            measurement.library,
+            measurement.ns_per_op
+        );
+    }
+}
@@ -0,0 +1,79 @@
+#include "tests/suite/bad_access.h"
+
+#include "rust/cxx_enumext.h"
+
+#include <csetjmp>
+#include <cstdint>
+#include <cstring>
+
+#if CXX_ENUMEXT_BAD_ACCESS_POLICY != CXX_ENUMEXT_BAD_ACCESS_HOOK
+#error "bad_access.cpp must be built with CXX_ENUMEXT_BAD_ACCESS_HOOK"
+#endif
+
+namespace {
+
+// The hook must not return, it jumps back to the access which failed. The
+// frames in between only hold trivially destructible values.
+std::jmp_buf hook_return;
+const char *hook_what = nullptr;
+
+struct flag {
+  bool value;
+};
+
+using hooked_variant = rust::enm::variant<std::int32_t, flag, std::int64_t>;
+
+template <std::size_t I> bool access_is_hooked(const hooked_variant &value) {
+  hook_what = nullptr;
+  if (setjmp(hook_return) == 0) {
+    static_cast<void>(rust::enm::get<I>(value));
+    return false;
+  }
+  return std::strcmp(hook_what, "bad variant access") == 0;
+}
+
+hooked_variant make_hooked_variant(std::size_t active) {
+  switch (active) {
+  case 0:
+    return hooked_variant(std::int32_t{1});
+  case 1:
+    return hooked_variant(flag{true});
+  default:
+    return hooked_variant(std::int64_t{2});
+  }
+}
+
+} // namespace
+
+[[noreturn]] void rust::enm::bad_access_hook(const char *what) noexcept {
+  hook_what = what;
+  std::longjmp(hook_return, 1);
+}
+
+size_t hooked_variant_accesses(size_t active) {
+  const hooked_variant value = make_hooked_variant(active);
+  return std::size_t{access_is_hooked<0>(value)} |
+         std::size_t{access_is_hooked<1>(value)} << 1 |
+         std::size_t{access_is_hooked<2>(value)} << 2;
+}
+
+bool hooked_optional_access() {
+  const rust::enm::optional<flag> empty;
+  hook_what = nullptr;
+  if (setjmp(hook_return) == 0) {
+    static_cast<void>(empty.value());
+    return false;
+  }
+  return std::strcmp(hook_what, "Optional has no value") == 0;
+}
+
+bool hooked_invalid_index() {
+  std::int64_t data = 0;
+  hook_what = nullptr;
+  if (setjmp(hook_return) == 0) {
+    rust::enm::visitor_type<std::int32_t, flag, std::int64_t>::visit(
+        [](const auto &) {}, 3, reinterpret_cast<std::byte *>(&data));
+    return false;
+  }
+  return std::strcmp(hook_what, "invalid variant index") == 0;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+
+// Implemented in bad_access.cpp, which is built without exceptions and with
+// the CXX_ENUMEXT_BAD_ACCESS_HOOK policy.
+
+// Calls `get<I>` of a variant holding its `active` alternative for every
+// index `I` and returns a bit per index for which the hook was called.
+size_t hooked_variant_accesses(size_t active);
+
+// Returns true if `value()` of an empty optional called the hook.
+bool hooked_optional_access();
+
+// Returns true if visiting with an index past the last alternative called
+// the hook.
+bool hooked_invalid_index();
@@ -2,14 +2,120 @@ use cxx_build::CFG;
 
 fn main() {
     CFG.include_prefix = "tests/suite";
+    // `tests/suite/generated.rs.enumext.h`, included by tests.h
+    let enumext_include = cxx_enumext_build::headers(["generated.rs"])
+        .include_prefix("tests/suite")
+        .generate();
+
     let sources = vec!["lib.rs", "data.rs"];
     let mut build = cxx_build::bridges(sources);
+    build.include(enumext_include);
     build.file("tests.cpp");
     build.std("c++17");
     build.flag_if_supported("-std=c++17");
     build.flag_if_supported("/std:c++17");
     build.compile("cxx-enum-ext-test-suite");
 
+    // In C++20 the variants can also be used in constant expressions, which
+    // src/cxx_enumext.cpp checks if the compiler supports it. The library
+    // itself only builds it as C++17. Its runtime checks are called by the
+    // tests.
+    let no_bridges: Vec<std::path::PathBuf> = vec![];
+    let mut checks = cxx_build::bridges(no_bridges);
+    let (cpp17, cpp20) = if checks.get_compiler().is_like_msvc() {
+        ("/std:c++17", "/std:c++20")
+    } else {
+        ("-std=c++17", "-std=c++20")
+    };
+    if checks.is_flag_supported(cpp20).unwrap_or(false) {
+        checks.flag(cpp20);
+    } else {
+        checks.flag(cpp17);
+    }
+    checks
+        .warnings(false)
+        .cargo_warnings(false)
+        .file("../../src/cxx_enumext.cpp")
+        .define("CXX_ENUMEXT_RUNTIME_CHECKS", None)
+        .compile("cxx-enum-ext-test-suite-checks");
+
+    // Make sure the definitions of the enums only need the core.
+    let no_bridges: Vec<std::path::PathBuf> = vec![];
+    cxx_build::bridges(no_bridges)
+        .std("c++17")
+        .warnings(false)
+        .cargo_warnings(false)
+        .file("../../src/cxx_enumext_core.cpp")
+        .flag_if_supported("-std=c++17")
+        .flag_if_supported("/std:c++17")
+        .compile("cxx-enum-ext-test-suite-core");
+
+    // Make sure the header also compiles without exceptions.
+    let no_bridges: Vec<std::path::PathBuf> = vec![];
+    cxx_build::bridges(no_bridges)
+        .std("c++17")
+        .warnings(false)
+        .cargo_warnings(false)
+        .file("../../src/cxx_enumext_no_exceptions.cpp")
+        .flag_if_supported("-std=c++17")
+        .flag_if_supported("/std:c++17")
+        .flag_if_supported("-fno-exceptions")
+        .compile("cxx-enum-ext-test-suite-no-exceptions");
+
+    // The bad access hook is tested in a library of its own, built without
+    // exceptions like the projects which need it.
+    let no_bridges: Vec<std::path::PathBuf> = vec![];
+    cxx_build::bridges(no_bridges)
+        .file("bad_access.cpp")
+        .std("c++17")
+        .flag_if_supported("-std=c++17")
+        .flag_if_supported("/std:c++17")
+        .flag_if_supported("-fno-exceptions")
+        .define(
+            "CXX_ENUMEXT_BAD_ACCESS_POLICY",
+            "CXX_ENUMEXT_BAD_ACCESS_HOOK",
+        )
+        .compile("cxx-enum-ext-test-suite-bad-access");
+
+    // The tag scanning kernels are checked once per instruction set. Only
+    // x86 has vectorized kernels, elsewhere all three use the scalar loops.
+    let arch = std::env::var("CARGO_CFG_TARGET_ARCH").unwrap_or_default();
+    let x86 = arch == "x86" || arch == "x86_64";
+    for (name, simd) in [
+        ("none", "CXX_ENUMEXT_SIMD_NONE"),
+        ("sse4", "CXX_ENUMEXT_SIMD_SSE4"),
+        ("avx2", "CXX_ENUMEXT_SIMD_AVX2"),
+    ] {
+        let no_bridges: Vec<std::path::PathBuf> = vec![];
+        let mut build = cxx_build::bridges(no_bridges);
+        build
+            .file("scan.cpp")
+            .std("c++17")
+            .flag_if_supported("-std=c++17")
+            .flag_if_supported("/std:c++17")
+            .define("SCAN_KERNEL_ERRORS", &*format!("scan_kernel_errors_{name}"));
+        if x86 {
+            build.define("CXX_ENUMEXT_SIMD", simd);
+            match (name, build.get_compiler().is_like_msvc()) {
+                ("sse4", false) => build.flag("-msse4.1"),
+                ("avx2", false) => build.flag("-mavx2"),
+                // MSVC compiles the SSE4.1 intrinsics without a flag.
+                ("avx2", true) => build.flag("/arch:AVX2"),
+                _ => &mut build,
+            };
+        } else {
+            build.define("CXX_ENUMEXT_SIMD", "CXX_ENUMEXT_SIMD_NONE");
+        }
+        build.compile(&format!("cxx-enum-ext-test-suite-scan-{name}"));
+    }
+
+    println!("cargo:rerun-if-changed=../../src/cxx_enumext.cpp");
+    println!("cargo:rerun-if-changed=../../src/cxx_enumext_core.cpp");
+    println!("cargo:rerun-if-changed=../../src/cxx_enumext_no_exceptions.cpp");
     println!("cargo:rerun-if-changed=tests.cpp");
     println!("cargo:rerun-if-changed=tests.h");
+    println!("cargo:rerun-if-changed=bad_access.cpp");
+    println!("cargo:rerun-if-changed=bad_access.h");
+    println!("cargo:rerun-if-changed=scan.cpp");
+    println!("cargo:rerun-if-changed=scan.h");
 }
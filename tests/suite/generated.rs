@@ -0,0 +1,41 @@
+//! Types whose C++ definitions are generated by `cxx-enumext-build` (see
+//! `build.rs`) instead of being written with the macros in `tests.h`.
+
+use crate::data::RustValue;
+
+#[cxx_enumext::extern_type]
+#[repr(u16)]
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub enum Shape {
+    Empty,
+    Circle(f64),
+    Rect { width: f32, height: f32 },
+    Polygon(u8, u32, u64),
+}
+
+#[cxx_enumext::extern_type(namespace = generated)]
+#[derive(Debug)]
+pub enum Message<'a> {
+    Quit,
+    Text(String),
+    Value(Box<RustValue>),
+    Borrowed(&'a RustValue),
+    Bytes(Vec<u8>),
+}
+
+#[cxx_enumext::extern_type]
+#[derive(Debug)]
+pub type OptionalShape = cxx_enumext::Optional<Shape>;
+
+#[cxx_enumext::extern_type(atomic)]
+#[repr(u8)]
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub enum JobState {
+    Idle,
+    Running(u16),
+    Done(i32),
+}
+
+#[cxx_enumext::extern_type]
+#[derive(Debug)]
+pub type AtomicJobState = cxx_enumext::AtomicEnum<JobState>;
@@ -1,7 +1,9 @@
 pub mod data;
+pub mod generated;
 
 pub use data::ffi::SharedData;
 pub use data::RustValue;
+pub use generated::{AtomicJobState, JobState, Message, OptionalShape, Shape};
 
 #[derive(Debug)]
 #[cxx_enumext::extern_type]
@@ -20,11 +22,87 @@ pub enum RustEnum<'a> {
     Unit2,
 }
 
+#[cxx_enumext::extern_type(hash)]
+#[repr(u8)]
+#[derive(Debug, Clone, PartialEq, Eq, PartialOrd, Ord)]
+pub enum CompactEnum {
+    Empty,
+    Pair(i16, i16),
+    Flag(bool),
+}
+
+#[cxx_enumext::extern_type]
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub enum WideEnum {
+    Unit0,
+    Unit1,
+    Unit2,
+    Unit3,
+    Unit4,
+    Unit5,
+    Unit6,
+    Unit7,
+    Unit8,
+    Unit9,
+    Unit10,
+    Unit11,
+    Unit12,
+    Unit13,
+    Unit14,
+    Unit15,
+    Unit16,
+    Unit17,
+    Unit18,
+    Unit19,
+    Unit20,
+    Unit21,
+    Unit22,
+    Unit23,
+    Unit24,
+    Unit25,
+    Unit26,
+    Unit27,
+    Unit28,
+    Unit29,
+    Unit30,
+    Unit31,
+    Unit32,
+    Unit33,
+    Unit34,
+    Unit35,
+    Unit36,
+    Unit37,
+    Unit38,
+    Tuple(
+        u8,
+        u8,
+        u8,
+        u8,
+        u8,
+        u8,
+        u8,
+        u8,
+        u8,
+        u8,
+        u8,
+        u8,
+        u8,
+        u8,
+        u8,
+        u8,
+        u8,
+        u8,
+        u8,
+        u8,
+    ),
+    Last(i64),
+}
+
 #[cxx_enumext::extern_type(cxx_name = "OptionalInt32")]
 #[derive(Debug)]
 pub type OptionalI32 = Optional<i32>;
 
-#[cxx_enumext::extern_type]
+#[cxx_enumext::extern_type(hash)]
 #[derive(Debug)]
 pub type I32StringResult = cxx_enumext::Expected<i32, String>;
 
@@ -32,16 +110,41 @@ pub type I32StringResult = cxx_enumext::Expected<i32, String>;
 #[derive(Debug)]
 pub type ExpectedVoidInt = cxx_enumext::Expected<(), i32>;
 
+#[cxx_enumext::extern_type]
+#[derive(Debug)]
+pub type OptionalBox = Option<Box<RustValue>>;
+
+#[cxx_enumext::extern_type]
+#[derive(Debug)]
+pub type OptionalRef<'a> = Option<&'a RustValue>;
+
+#[cxx_enumext::extern_type]
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub type OptionalBool = Option<bool>;
+
 #[cxx::bridge]
 pub mod ffi {
 
     unsafe extern "C++" {
         include!("tests/suite/tests.h");
+        include!("tests/suite/bad_access.h");
+        include!("tests/suite/scan.h");
 
         type RustEnum<'a> = super::RustEnum<'a>;
+        type CompactEnum = super::CompactEnum;
+        type WideEnum = super::WideEnum;
         type I32StringResult = super::I32StringResult;
         type OptionalInt32 = super::OptionalI32;
         type ExpectedVoidInt = super::ExpectedVoidInt;
+        type OptionalBox = super::OptionalBox;
+        type OptionalRef<'a> = super::OptionalRef<'a>;
+        type OptionalBool = super::OptionalBool;
+        type Shape = super::generated::Shape;
+        #[namespace = "generated"]
+        type Message<'a> = super::generated::Message<'a>;
+        type OptionalShape = super::generated::OptionalShape;
+        type JobState = super::generated::JobState;
+        type AtomicJobState = super::generated::AtomicJobState;
 
         pub fn make_enum<'a>() -> RustEnum<'a>;
         pub fn make_enum_str<'a>() -> RustEnum<'a>;
@@ -51,12 +154,79 @@ pub mod ffi {
         pub fn take_enum(enm: &RustEnum) -> i32;
         pub fn take_mut_enum(enm: &mut RustEnum) -> i32;
 
+        pub unsafe fn make_enum_struct_into<'a>(out: *mut RustEnum<'a>, val: i32, str: &str);
+        pub unsafe fn make_compact_pairs_into(out: *mut CompactEnum, len: usize);
+        pub unsafe fn make_result_into(out: *mut I32StringResult, value: i32) -> Result<()>;
+
+        pub fn emplace_over_string(text: &str, count: i32) -> String;
+
+        pub fn make_compact_pair(first: i16, second: i16) -> CompactEnum;
+        pub fn take_compact(compact: &CompactEnum) -> i32;
+
+        pub fn visit_compact_pair(first: &CompactEnum, second: &CompactEnum) -> i32;
+        pub fn visit_compact_triple(
+            first: &CompactEnum,
+            second: &CompactEnum,
+            third: &CompactEnum,
+        ) -> i32;
+
+        pub fn sum_compact(values: &[CompactEnum]) -> i32;
+        pub fn make_compact_vec(len: usize) -> Vec<CompactEnum>;
+        pub fn make_compact_cxx_vector(len: usize) -> UniquePtr<CxxVector<CompactEnum>>;
+        pub fn count_errors(results: &Vec<I32StringResult>) -> usize;
+        pub fn count_compact(values: &[CompactEnum]) -> Vec<usize>;
+        pub fn find_compact_flag(values: &[CompactEnum]) -> usize;
+        pub fn sum_compact_grouped(values: &[CompactEnum]) -> i32;
+        pub fn visit_compact_grouped(
+            values: &[CompactEnum],
+            calls: &mut Vec<usize>,
+        ) -> Vec<CompactEnum>;
+        pub fn soa_compact(values: &[CompactEnum]) -> Vec<CompactEnum>;
+        pub fn soa_compact_flags(values: &[CompactEnum]) -> Vec<bool>;
+        pub fn soa_compact_emplaced() -> Vec<CompactEnum>;
+        pub fn hash_compact(value: &CompactEnum) -> u64;
+        pub fn hash_result(result: &I32StringResult) -> u64;
+        pub fn sort_compact(values: &mut [CompactEnum]);
+        pub fn count_distinct_compact(values: &[CompactEnum]) -> usize;
+        pub fn flat_compact(values: &[CompactEnum], run_index: bool) -> Vec<u8>;
+        pub fn read_flat_compact(bytes: &[u8], values: &mut Vec<CompactEnum>) -> u8;
+        pub fn write_flat_compact_file(path: &str, values: &[CompactEnum], run_index: bool)
+            -> bool;
+        pub fn read_flat_compact_file(path: &str, values: &mut Vec<CompactEnum>) -> u8;
+        pub fn read_flat_file_as_wide(path: &str) -> u8;
+
+        pub fn variant_self_assignment_errors() -> usize;
+        pub fn make_wide(index: usize) -> WideEnum;
+        pub fn take_wide(wide: &WideEnum) -> i64;
+
         pub fn take_optional(optional: &OptionalInt32) -> bool;
         pub fn mul2_if_gt10(value: i32) -> I32StringResult;
+        pub fn value_or_moved_error(result: I32StringResult) -> String;
 
         pub fn take_expected_void(result: ExpectedVoidInt) -> i32;
         pub fn make_expected_void() -> ExpectedVoidInt;
         pub fn make_unexpected_void() -> ExpectedVoidInt;
+
+        pub fn take_optional_box(optional: OptionalBox) -> bool;
+        pub fn make_optional_box(some: bool) -> OptionalBox;
+        pub fn take_optional_ref(optional: &OptionalRef) -> bool;
+        pub fn negate_optional_bool(value: OptionalBool) -> OptionalBool;
+
+        pub fn make_shape(index: usize) -> Shape;
+        pub fn shape_area(shape: &Shape) -> f64;
+        pub fn largest_shape(shapes: &[Shape]) -> OptionalShape;
+        pub fn describe_message(message: &Message) -> String;
+
+        pub fn hooked_variant_accesses(active: usize) -> usize;
+        pub fn hooked_optional_access() -> bool;
+        pub fn hooked_invalid_index() -> bool;
+
+        pub fn scan_kernel_errors_none() -> usize;
+        pub fn scan_kernel_errors_sse4() -> usize;
+        pub fn scan_kernel_errors_avx2() -> usize;
+
+        pub fn advance_job(state: &AtomicJobState, steps: u16);
+        pub fn finish_job(state: &AtomicJobState, steps: u16) -> bool;
     }
 
     extern "Rust" {
@@ -0,0 +1,135 @@
+#include "tests/suite/scan.h"
+
+#include "rust/cxx_enumext.h"
+#include "rust/cxx_enumext_ranges.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+#ifndef SCAN_KERNEL_ERRORS
+#error "scan.cpp must be built with SCAN_KERNEL_ERRORS naming its function"
+#endif
+
+namespace {
+
+// Every variant holds a type with internal linkage, so the code instantiated
+// for it here is not merged with the same code built for another
+// instruction set.
+struct unit {};
+
+// One variant per stride with loads of its own (4, 8 and 16 bytes) and one
+// which is gathered (6 bytes). The number of alternatives decides if
+// counting is vectorized.
+using stride4 = rust::enm::basic_variant<std::uint8_t, unit, std::int16_t>;
+using stride6 = rust::enm::basic_variant<std::uint16_t, unit,
+                                         std::array<std::uint16_t, 2>>;
+using stride8 =
+    rust::enm::basic_variant<std::int32_t, unit, float, std::uint32_t, bool>;
+using stride16 = rust::enm::basic_variant<std::int32_t, unit, std::int64_t,
+                                          double, bool, std::int32_t>;
+
+static_assert(sizeof(stride4) == 4);
+static_assert(sizeof(stride6) == 6);
+static_assert(sizeof(stride8) == 8);
+static_assert(sizeof(stride16) == 16);
+
+template <typename Variant> struct scan_check;
+
+template <typename Tag, typename... Ts>
+struct scan_check<rust::enm::basic_variant<Tag, Ts...>> {
+  using variant = rust::enm::basic_variant<Tag, Ts...>;
+  constexpr static std::size_t size = sizeof...(Ts);
+
+  // Spreads the alternatives unevenly, like `tests/bench` does.
+  static std::vector<variant> make(std::size_t n) {
+    std::vector<variant> values;
+    values.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      rust::enm::detail::with_index<size>(
+          (i * 7 + i / 3) % size,
+          [&](auto index) { values.emplace_back(std::in_place_index<index>); });
+    }
+    return values;
+  }
+
+  static std::size_t count_errors(const std::vector<variant> &values) {
+    std::array<std::size_t, size> expected{};
+    for (const variant &value : values) {
+      if (value.index() < size) {
+        ++expected[value.index()];
+      }
+    }
+    return rust::enm::count_alternatives(values) != expected;
+  }
+
+  template <std::size_t I>
+  static std::size_t find_errors(const std::vector<variant> &values) {
+    std::size_t expected = 0;
+    while (expected < values.size() && values[expected].index() != I) {
+      ++expected;
+    }
+    return rust::enm::find_alternative<I>(values) != expected;
+  }
+
+  static std::size_t mask_errors(const std::vector<variant> &values) {
+    const std::vector<std::uint64_t> mask =
+        rust::enm::alternative_mask<0, size - 1>(values);
+    std::size_t errors = mask.size() != (values.size() + 63) / 64;
+    for (std::size_t i = 0; errors == 0 && i < values.size(); ++i) {
+      const bool expected =
+          values[i].index() == 0 || values[i].index() == size - 1;
+      errors += ((mask[i / 64] >> (i % 64)) & 1) != expected;
+    }
+    return errors;
+  }
+
+  template <std::size_t... Is>
+  static std::size_t errors(std::size_t n, std::size_t invalid,
+                            std::index_sequence<Is...>) {
+    std::vector<variant> values = make(n);
+    // The tag is the first member, as in the Rust enum.
+    Tag saved{};
+    if (invalid < n) {
+      const Tag tag = static_cast<Tag>(-1);
+      std::memcpy(&saved, static_cast<const void *>(&values[invalid]),
+                  sizeof(Tag));
+      std::memcpy(static_cast<void *>(&values[invalid]), &tag, sizeof(Tag));
+    }
+
+    const std::size_t errors =
+        count_errors(values) + (find_errors<Is>(values) + ...) +
+        mask_errors(values) +
+        (rust::enm::has_valid_tags(values) != (invalid >= n));
+
+    if (invalid < n) {
+      std::memcpy(static_cast<void *>(&values[invalid]), &saved, sizeof(Tag));
+    }
+    return errors;
+  }
+
+  static std::size_t errors() {
+    constexpr auto indices = std::make_index_sequence<size>{};
+    std::size_t errors = 0;
+    // Every length up to a few blocks and the remainders after them. No
+    // invalid tag, then one at the start, the middle and the end.
+    for (std::size_t n = 0; n <= 70; ++n) {
+      for (std::size_t invalid : {n, std::size_t{0}, n / 2, n - 1}) {
+        errors += scan_check::errors(n, invalid, indices);
+      }
+    }
+    errors += scan_check::errors(1000, 1000, indices);
+    errors += scan_check::errors(1000, 999, indices);
+    return errors;
+  }
+};
+
+} // namespace
+
+size_t SCAN_KERNEL_ERRORS() {
+  return scan_check<stride4>::errors() + scan_check<stride6>::errors() +
+         scan_check<stride8>::errors() + scan_check<stride16>::errors();
+}
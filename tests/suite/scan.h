@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+
+// Implemented in scan.cpp, which build.rs builds once per instruction set of
+// the tag scanning kernels. Only call the SSE4.1 and AVX2 versions if the CPU
+// supports them.
+
+// Runs the kernels over ranges of every length up to a few blocks, with and
+// without an invalid tag, and returns the number of results which differ
+// from a plain loop.
+size_t scan_kernel_errors_none();
+size_t scan_kernel_errors_sse4();
+size_t scan_kernel_errors_avx2();
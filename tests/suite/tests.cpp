@@ -1,9 +1,17 @@
 #include "tests/suite/lib.rs.h"
 
+#include "rust/cxx_enumext_flat.h"
+
+#include <algorithm>
 #include <atomic>
+#include <cstddef>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
 RustEnum make_enum() { return RustEnum{RustEnum::Num(1502)}; }
 RustEnum make_enum_str() {
   return RustEnum(RustEnum::String("String from c++"));
@@ -131,6 +139,357 @@ int32_t take_mut_enum(RustEnum &enm) {
   return ret;
 }
 
+static_assert(sizeof(CompactEnum) == 3 * sizeof(int16_t));
+static_assert(sizeof(WideEnum) == 32);
+
+// TUPLE declares its fields in order, like the tuple variant in Rust.
+CXX_DEFINE_VARIANT(MixedTuple, (TUPLE(Mixed, int8_t, int16_t, int64_t)), )
+static_assert(std::is_same_v<decltype(MixedTuple::Mixed::_0), int8_t>);
+static_assert(std::is_same_v<decltype(MixedTuple::Mixed::_1), int16_t>);
+static_assert(std::is_same_v<decltype(MixedTuple::Mixed::_2), int64_t>);
+static_assert(offsetof(MixedTuple::Mixed, _1) == sizeof(int16_t));
+
+// The storage is owned by Rust and uninitialized, see `cxx_enumext::Emplace`.
+void make_enum_struct_into(RustEnum *out, int32_t val, rust::Str str) {
+  rust::enm::emplace_into<RustEnum::Struct>(out, val, rust::String(str));
+}
+
+void make_compact_pairs_into(CompactEnum *out, size_t len) {
+  for (size_t i = 0; i < len; ++i) {
+    rust::enm::emplace_into<CompactEnum::Pair>(out + i, int16_t(i),
+                                               int16_t(-1));
+  }
+}
+
+void make_result_into(I32StringResult *out, int32_t value) {
+  if (value < 0) {
+    throw std::invalid_argument("negative value");
+  }
+  rust::enm::emplace_into<0>(out, value);
+}
+
+// Throws for negative counts and may throw when moved, so `emplace` has to
+// keep the old alternative aside while constructing it.
+struct checked_count {
+  int32_t value;
+
+  checked_count(int32_t count) : value(count) {
+    if (count < 0) {
+      throw std::invalid_argument("negative count");
+    }
+  }
+  checked_count(checked_count &&other) noexcept(false) : value(other.value) {}
+  checked_count &operator=(checked_count &&other) = default;
+};
+
+// `std::string` keeps short strings in itself, so it can't be relocated by
+// its bytes like the alternatives coming from Rust.
+rust::String emplace_over_string(rust::Str text, int32_t count) {
+  rust::enm::variant<std::string, checked_count> value(std::string{text});
+  try {
+    value.emplace<checked_count>(count);
+  } catch (const std::invalid_argument &) {
+    return rust::String(rust::enm::get<std::string>(value));
+  }
+  rust::enm::variant<std::string, checked_count> other(std::string{text});
+  value.swap(other);
+  return rust::String(rust::enm::get<std::string>(value) + ":" +
+                      std::to_string(rust::enm::get<1>(other).value));
+}
+
+CompactEnum make_compact_pair(int16_t first, int16_t second) {
+  return CompactEnum::Pair{first, second};
+}
+
+int32_t take_compact(const CompactEnum &compact) {
+  return rust::enm::visit(
+      overload{
+          [](const CompactEnum::Empty &) { return int32_t(-1); },
+          [](const CompactEnum::Pair &pair) {
+            return int32_t(pair._0) + int32_t(pair._1);
+          },
+          [](const CompactEnum::Flag &flag) { return int32_t(flag); },
+      },
+      compact);
+}
+
+// The values of the alternatives as in `take_compact`, chosen by overload
+// resolution so a visit dispatching to the wrong alternative is caught.
+struct compact_value {
+  int32_t operator()(const CompactEnum::Empty &) const { return -1; }
+  int32_t operator()(const CompactEnum::Pair &pair) const {
+    return int32_t(pair._0) + int32_t(pair._1);
+  }
+  int32_t operator()(const CompactEnum::Flag &flag) const {
+    return int32_t(flag);
+  }
+};
+
+int32_t visit_compact_pair(const CompactEnum &first,
+                           const CompactEnum &second) {
+  return rust::enm::visit(
+      [](const auto &lhs, const auto &rhs) {
+        return 100 * compact_value{}(lhs) + compact_value{}(rhs);
+      },
+      first, second);
+}
+
+int32_t visit_compact_triple(const CompactEnum &first,
+                             const CompactEnum &second,
+                             const CompactEnum &third) {
+  return rust::enm::visit(
+      [](const auto &a, const auto &b, const auto &c) {
+        return 10000 * compact_value{}(a) + 100 * compact_value{}(b) +
+               compact_value{}(c);
+      },
+      first, second, third);
+}
+
+int32_t sum_compact(rust::Slice<const CompactEnum> values) {
+  int32_t sum = 0;
+  for (const auto &value : values) {
+    sum += take_compact(value);
+  }
+  return sum;
+}
+
+rust::Vec<CompactEnum> make_compact_vec(size_t len) {
+  rust::Vec<CompactEnum> values;
+  values.reserve(len);
+  for (size_t i = 0; i < len; ++i) {
+    values.push_back(
+        i % 2 == 0 ? CompactEnum(CompactEnum::Pair{int16_t(i), int16_t(1)})
+                   : CompactEnum(CompactEnum::Empty{}));
+  }
+  return values;
+}
+
+std::unique_ptr<std::vector<CompactEnum>> make_compact_cxx_vector(size_t len) {
+  auto values = std::make_unique<std::vector<CompactEnum>>();
+  for (size_t i = 0; i < len; ++i) {
+    values->emplace_back(CompactEnum::Flag(i % 3 == 0));
+  }
+  return values;
+}
+
+size_t count_errors(const rust::Vec<I32StringResult> &results) {
+  return std::count_if(results.begin(), results.end(),
+                       [](const I32StringResult &result) {
+                         return !result.has_value();
+                       });
+}
+
+rust::Vec<size_t> count_compact(rust::Slice<const CompactEnum> values) {
+  rust::Vec<size_t> result;
+  if (!rust::enm::has_valid_tags(values)) {
+    return result;
+  }
+  for (size_t count : rust::enm::count_alternatives(values)) {
+    result.push_back(count);
+  }
+  return result;
+}
+
+size_t find_compact_flag(rust::Slice<const CompactEnum> values) {
+  return rust::enm::find_alternative<2>(values);
+}
+
+int32_t sum_compact_grouped(rust::Slice<const CompactEnum> values) {
+  int32_t sum = 0;
+  rust::enm::visit_grouped(values, [&sum](const auto &value) {
+    sum += take_compact(CompactEnum(value));
+  });
+  return sum;
+}
+
+// Copies the values into a `soa_vector` and back.
+rust::Vec<CompactEnum> soa_compact(rust::Slice<const CompactEnum> values) {
+  rust::enm::soa_vector<CompactEnum> soa(values.begin(), values.end());
+  rust::Vec<CompactEnum> result;
+  result.reserve(soa.size());
+  for (size_t i = 0; i < soa.size(); ++i) {
+    result.push_back(soa.to_variant(i));
+  }
+  return result;
+}
+
+rust::Vec<bool> soa_compact_flags(rust::Slice<const CompactEnum> values) {
+  rust::enm::soa_vector<CompactEnum> soa;
+  for (const auto &value : values) {
+    soa.push_back(value);
+  }
+  const auto &flags = soa;
+  rust::Vec<bool> result;
+  for (bool flag : flags.column<bool>()) {
+    result.push_back(flag);
+  }
+  return result;
+}
+
+// Emplaces every alternative, then changes them through their columns.
+rust::Vec<CompactEnum> soa_compact_emplaced() {
+  rust::enm::soa_vector<CompactEnum> soa;
+  soa.emplace_back<2>(false);
+  soa.emplace_back<1>(CompactEnum::Pair{1, 2});
+  soa.emplace_back<0>();
+  soa.emplace_back<2>(true) = false;
+  for (size_t i = 0; i < 20; ++i) {
+    soa.emplace_back<1>(CompactEnum::Pair{int16_t(i), 0});
+  }
+
+  soa.column<bool>()[0] = true;
+  for (auto &pair : soa.column<1>()) {
+    pair._1 = int16_t(-pair._0);
+  }
+
+  rust::Vec<CompactEnum> result;
+  soa.copy_to(std::back_inserter(result));
+  return result;
+}
+
+// Returns the values in the order `visit_grouped` visits them. `calls` gets
+// the number of calls of every overload.
+rust::Vec<CompactEnum>
+visit_compact_grouped(rust::Slice<const CompactEnum> values,
+                      rust::Vec<size_t> &calls) {
+  rust::Vec<CompactEnum> visited;
+  size_t empty = 0, pair = 0, flag = 0;
+  rust::enm::visit_grouped(
+      values, overload{
+                  [&](const CompactEnum::Empty &) {
+                    ++empty;
+                    visited.push_back(CompactEnum::Empty{});
+                  },
+                  [&](const CompactEnum::Pair &value) {
+                    ++pair;
+                    visited.push_back(value);
+                  },
+                  [&](const CompactEnum::Flag &value) {
+                    ++flag;
+                    visited.push_back(CompactEnum::Flag(value));
+                  },
+              });
+  calls = {empty, pair, flag};
+  return visited;
+}
+
+uint64_t hash_compact(const CompactEnum &value) {
+  return rust::enm::hash_value(value);
+}
+
+uint64_t hash_result(const I32StringResult &result) {
+  return rust::enm::hash<>{}(result);
+}
+
+void sort_compact(rust::Slice<CompactEnum> values) {
+  std::sort(values.begin(), values.end());
+}
+
+size_t count_distinct_compact(rust::Slice<const CompactEnum> values) {
+  std::vector<CompactEnum> sorted(values.begin(), values.end());
+  std::sort(sorted.begin(), sorted.end());
+  return static_cast<size_t>(
+      std::unique(sorted.begin(), sorted.end()) - sorted.begin());
+}
+
+rust::Vec<uint8_t> flat_compact(rust::Slice<const CompactEnum> values,
+                                bool run_index) {
+  rust::Vec<uint8_t> bytes;
+  rust::enm::write_flat(
+      values,
+      [&bytes](const void *data, size_t size) {
+        const auto *begin = static_cast<const uint8_t *>(data);
+        bytes.reserve(bytes.size() + size);
+        for (size_t i = 0; i < size; ++i) {
+          bytes.push_back(begin[i]);
+        }
+      },
+      run_index);
+  return bytes;
+}
+
+uint8_t read_flat_compact(rust::Slice<const uint8_t> bytes,
+                          rust::Vec<CompactEnum> &values) {
+  rust::enm::flat_view<CompactEnum> view(bytes.data(), bytes.size());
+  if (!view) {
+    return static_cast<uint8_t>(view.error());
+  }
+  for (const rust::enm::flat_run &run : view.runs()) {
+    if (view.values()[run.start].index() != run.index) {
+      return static_cast<uint8_t>(rust::enm::flat_error::index);
+    }
+  }
+  for (const CompactEnum &value : view.values()) {
+    values.push_back(value);
+  }
+  return 0;
+}
+
+bool write_flat_compact_file(rust::Str path,
+                             rust::Slice<const CompactEnum> values,
+                             bool run_index) {
+  return rust::enm::write_flat_file(std::string(path).c_str(), values,
+                                    run_index);
+}
+
+uint8_t read_flat_compact_file(rust::Str path,
+                               rust::Vec<CompactEnum> &values) {
+#if CXX_ENUMEXT_HAS_MMAP
+  rust::enm::flat_file<CompactEnum> file(std::string(path).c_str());
+  if (!file) {
+    return static_cast<uint8_t>(file.error());
+  }
+  for (const CompactEnum &value : file.values()) {
+    values.push_back(value);
+  }
+  return 0;
+#else
+  (void)path;
+  (void)values;
+  return static_cast<uint8_t>(rust::enm::flat_error::io);
+#endif
+}
+
+uint8_t read_flat_file_as_wide(rust::Str path) {
+#if CXX_ENUMEXT_HAS_MMAP
+  rust::enm::flat_file<WideEnum> file(std::string(path).c_str());
+  return static_cast<uint8_t>(file.error());
+#else
+  (void)path;
+  return static_cast<uint8_t>(rust::enm::flat_error::io);
+#endif
+}
+
+template <std::size_t... I>
+WideEnum make_wide_unit(size_t index, std::index_sequence<I...>) {
+  WideEnum wide = WideEnum::Last{-1};
+  ((I == index ? void(wide = WideEnum(std::in_place_index<I>)) : void()), ...);
+  return wide;
+}
+
+WideEnum make_wide(size_t index) {
+  if (index < 39) {
+    return make_wide_unit(index, std::make_index_sequence<39>());
+  }
+  if (index == 39) {
+    return WideEnum::Tuple{1,  2,  3,  4,  5,  6,  7,  8,  9,  10,
+                           11, 12, 13, 14, 15, 16, 17, 18, 19, 20};
+  }
+  return WideEnum::Last{int64_t(index)};
+}
+
+int64_t take_wide(const WideEnum &wide) {
+  return rust::enm::visit(
+      overload{
+          [](const WideEnum::Tuple &tuple) {
+            return int64_t(tuple._0) + tuple._9 + tuple._19;
+          },
+          [](const WideEnum::Last &last) { return last; },
+          [&](const auto &) { return -int64_t(wide.index()); },
+      },
+      wide);
+}
+
 bool take_optional(const OptionalInt32 &optional) {
   std::ostringstream os;
   if (optional.has_value()) {
@@ -151,6 +510,14 @@ I32StringResult mul2_if_gt10(int32_t value) {
   }
 }
 
+rust::String value_or_moved_error(I32StringResult result) {
+  try {
+    return rust::String(std::to_string(std::move(result).value()));
+  } catch (rust::enm::bad_rust_expected_access<rust::String> &error) {
+    return std::move(error).error();
+  }
+}
+
 int32_t take_expected_void(ExpectedVoidInt result) {
   if (result.has_value())
     return 1000;
@@ -163,3 +530,117 @@ ExpectedVoidInt make_expected_void() {
 ExpectedVoidInt make_unexpected_void() {
   return ExpectedVoidInt(42);
 }
+
+bool take_optional_box(OptionalBox optional) {
+  std::ostringstream os;
+  if (optional) {
+    os << "The value of optional box is '" << (*optional)->read() << "'";
+  } else {
+    os << "The value of optional box is empty";
+  }
+  rust_println(rust::string(os.str()));
+  return optional.has_value();
+}
+
+OptionalBox make_optional_box(bool some) {
+  if (some) {
+    return new_rust_value();
+  }
+  return std::nullopt;
+}
+
+bool take_optional_ref(const OptionalRef &optional) {
+  std::ostringstream os;
+  if (optional) {
+    os << "The value of optional ref is '" << optional->get().read() << "'";
+  } else {
+    os << "The value of optional ref is empty";
+  }
+  rust_println(rust::string(os.str()));
+  return optional.has_value();
+}
+
+OptionalBool negate_optional_bool(OptionalBool value) {
+  if (value.is_none()) {
+    return value;
+  }
+  return !*value;
+}
+
+Shape make_shape(size_t index) {
+  switch (index) {
+  case 0:
+    return Shape::Empty{};
+  case 1:
+    return Shape::Circle(1.5);
+  case 2:
+    return Shape::Rect{2.0f, 3.0f};
+  default:
+    return Shape::Polygon{static_cast<uint8_t>(index), 4, 5};
+  }
+}
+
+double shape_area(const Shape &shape) {
+  return rust::enm::visit(
+      overload{
+          [](const Shape::Empty &) { return 0.0; },
+          [](const Shape::Circle &radius) { return 3.0 * radius * radius; },
+          [](const Shape::Rect &rect) {
+            return double(rect.width) * double(rect.height);
+          },
+          [](const Shape::Polygon &polygon) {
+            return double(polygon._0) * double(polygon._1) *
+                   double(polygon._2) / 2.0;
+          },
+      },
+      shape);
+}
+
+OptionalShape largest_shape(rust::Slice<const Shape> shapes) {
+  OptionalShape largest;
+  for (const Shape &shape : shapes) {
+    if (!largest.has_value() || shape_area(shape) > shape_area(*largest)) {
+      largest = shape;
+    }
+  }
+  return largest;
+}
+
+rust::String describe_message(const generated::Message &message) {
+  using generated::Message;
+  return rust::enm::visit(
+      overload{
+          [](const Message::Quit &) { return rust::String("quit"); },
+          [](const Message::Text &text) { return text; },
+          [](const Message::Value &value) { return value->read(); },
+          [](const Message::Borrowed &value) { return value.get().read(); },
+          [](const Message::Bytes &bytes) {
+            return rust::String(std::to_string(bytes.size()) + " bytes");
+          },
+      },
+      message);
+}
+
+void advance_job(const AtomicJobState &state, uint16_t steps) {
+  for (uint16_t i = 0; i < steps; ++i) {
+    state.update(overload{
+        [](const JobState::Idle &) {
+          return JobState(std::in_place_type<JobState::Running>,
+                          uint16_t{1});
+        },
+        [](const JobState::Running &done) {
+          return JobState(std::in_place_type<JobState::Running>,
+                          static_cast<uint16_t>(done + 1));
+        },
+        [](const JobState::Done &result) {
+          return JobState(std::in_place_type<JobState::Done>, result);
+        },
+    });
+  }
+}
+
+bool finish_job(const AtomicJobState &state, uint16_t steps) {
+  JobState expected(std::in_place_type<JobState::Running>, steps);
+  return state.compare_exchange_strong(
+      expected, JobState(std::in_place_type<JobState::Done>, int32_t{steps}));
+}
@@ -53,12 +53,43 @@ CXX_DEFINE_VARIANT(
 )
 // clang_format on
 
+// `#[repr(u8)]` enums are generated as `#[repr(C, u8)]` and use a uint8_t tag.
+CXX_DEFINE_VARIANT_REPR(CompactEnum, uint8_t,
+                        (UNIT(Empty), TUPLE(Pair, int16_t, int16_t),
+                         TYPE(Flag, bool)), )
+
+// Enums may have up to 256 alternatives, and tuples up to 64 fields.
+CXX_DEFINE_VARIANT(
+    WideEnum,
+    (UNIT(Unit0), UNIT(Unit1), UNIT(Unit2), UNIT(Unit3), UNIT(Unit4),
+     UNIT(Unit5), UNIT(Unit6), UNIT(Unit7), UNIT(Unit8), UNIT(Unit9),
+     UNIT(Unit10), UNIT(Unit11), UNIT(Unit12), UNIT(Unit13), UNIT(Unit14),
+     UNIT(Unit15), UNIT(Unit16), UNIT(Unit17), UNIT(Unit18), UNIT(Unit19),
+     UNIT(Unit20), UNIT(Unit21), UNIT(Unit22), UNIT(Unit23), UNIT(Unit24),
+     UNIT(Unit25), UNIT(Unit26), UNIT(Unit27), UNIT(Unit28), UNIT(Unit29),
+     UNIT(Unit30), UNIT(Unit31), UNIT(Unit32), UNIT(Unit33), UNIT(Unit34),
+     UNIT(Unit35), UNIT(Unit36), UNIT(Unit37), UNIT(Unit38),
+     TUPLE(Tuple, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t,
+           uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t,
+           uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t),
+     TYPE(Last, int64_t)), )
+
 CXX_DEFINE_OPTIONAL(OptionalInt32, int32_t)
 
 CXX_DEFINE_EXPECTED(I32StringResult, int32_t, rust::string)
 
 CXX_DEFINE_EXPECTED(ExpectedVoidInt, void, int32_t)
 
+CXX_DEFINE_NULLABLE(OptionalBox, rust::box<RustValue>)
+
+CXX_DEFINE_NULLABLE(OptionalRef, std::reference_wrapper<RustValue>)
+
+CXX_DEFINE_NULLABLE(OptionalBool, bool)
+
+// `Shape`, `generated::Message` and `OptionalShape` are generated from
+// generated.rs by build.rs.
+#include "tests/suite/generated.rs.enumext.h"
+
 template <class... Ts> struct overload : Ts... {
   using Ts::operator()...;
 };
@@ -73,9 +104,71 @@ RustEnum make_enum_opaque();
 int32_t take_enum(const RustEnum &enm);
 int32_t take_mut_enum(RustEnum &);
 
+void make_enum_struct_into(RustEnum *out, int32_t val, rust::Str str);
+void make_compact_pairs_into(CompactEnum *out, size_t len);
+void make_result_into(I32StringResult *out, int32_t value);
+
+rust::String emplace_over_string(rust::Str text, int32_t count);
+
+CompactEnum make_compact_pair(int16_t first, int16_t second);
+int32_t take_compact(const CompactEnum &compact);
+int32_t visit_compact_pair(const CompactEnum &first,
+                           const CompactEnum &second);
+int32_t visit_compact_triple(const CompactEnum &first,
+                             const CompactEnum &second,
+                             const CompactEnum &third);
+
+int32_t sum_compact(rust::Slice<const CompactEnum> values);
+rust::Vec<CompactEnum> make_compact_vec(size_t len);
+std::unique_ptr<std::vector<CompactEnum>> make_compact_cxx_vector(size_t len);
+size_t count_errors(const rust::Vec<I32StringResult> &results);
+rust::Vec<size_t> count_compact(rust::Slice<const CompactEnum> values);
+size_t find_compact_flag(rust::Slice<const CompactEnum> values);
+int32_t sum_compact_grouped(rust::Slice<const CompactEnum> values);
+rust::Vec<CompactEnum>
+visit_compact_grouped(rust::Slice<const CompactEnum> values,
+                      rust::Vec<size_t> &calls);
+rust::Vec<CompactEnum> soa_compact(rust::Slice<const CompactEnum> values);
+rust::Vec<bool> soa_compact_flags(rust::Slice<const CompactEnum> values);
+rust::Vec<CompactEnum> soa_compact_emplaced();
+uint64_t hash_compact(const CompactEnum &value);
+uint64_t hash_result(const I32StringResult &result);
+void sort_compact(rust::Slice<CompactEnum> values);
+size_t count_distinct_compact(rust::Slice<const CompactEnum> values);
+rust::Vec<uint8_t> flat_compact(rust::Slice<const CompactEnum> values,
+                                bool run_index);
+uint8_t read_flat_compact(rust::Slice<const uint8_t> bytes,
+                          rust::Vec<CompactEnum> &values);
+bool write_flat_compact_file(rust::Str path,
+                             rust::Slice<const CompactEnum> values,
+                             bool run_index);
+uint8_t read_flat_compact_file(rust::Str path, rust::Vec<CompactEnum> &values);
+uint8_t read_flat_file_as_wide(rust::Str path);
+
+// Implemented in src/cxx_enumext.cpp, which build.rs builds with its
+// runtime checks. Returns the number of assignments which lost the value.
+size_t variant_self_assignment_errors();
+
+WideEnum make_wide(size_t index);
+int64_t take_wide(const WideEnum &wide);
+
 bool take_optional(const OptionalInt32 &optional);
 I32StringResult mul2_if_gt10(int32_t value);
+rust::String value_or_moved_error(I32StringResult result);
 
 int32_t take_expected_void(ExpectedVoidInt);
 ExpectedVoidInt make_expected_void();
 ExpectedVoidInt make_unexpected_void();
+
+bool take_optional_box(OptionalBox optional);
+OptionalBox make_optional_box(bool some);
+bool take_optional_ref(const OptionalRef &optional);
+OptionalBool negate_optional_bool(OptionalBool value);
+
+Shape make_shape(size_t index);
+double shape_area(const Shape &shape);
+OptionalShape largest_shape(rust::Slice<const Shape> shapes);
+rust::String describe_message(const generated::Message &message);
+
+void advance_job(const AtomicJobState &state, uint16_t steps);
+bool finish_job(const AtomicJobState &state, uint16_t steps);
@@ -1,10 +1,14 @@
+use cxx_enumext::{convert, Emplace, StdEnumIterator};
 use cxx_enumext_test_suite::{
     ffi::{
         self, make_enum, make_enum_opaque, make_enum_shared, make_enum_shared_ref, make_enum_str,
-        mul2_if_gt10, take_enum, take_mut_enum, take_optional,
+        mul2_if_gt10, take_enum, take_mut_enum, take_optional, value_or_moved_error,
     },
-    OptionalI32, RustEnum, RustValue, SharedData,
+    AtomicJobState, CompactEnum, I32StringResult, JobState, Message, OptionalBool, OptionalBox,
+    OptionalI32, OptionalRef, OptionalShape, RustEnum, RustValue, Shape, SharedData, WideEnum,
 };
+use std::mem::MaybeUninit;
+use std::sync::atomic::Ordering;
 
 fn print_enum(enm: &RustEnum) {
     match &enm {
@@ -104,6 +108,8 @@ fn test_get_expected_ffi() {
     let result: Result<_, _> = mul2_if_gt10(8).into();
     println!("result is: {result:?}");
     assert!(matches!(result, Err(s) if s == "value too small"));
+    assert_eq!(value_or_moved_error(mul2_if_gt10(12)), "24");
+    assert_eq!(value_or_moved_error(mul2_if_gt10(8)), "value too small");
 }
 
 #[test]
@@ -113,3 +119,534 @@ fn test_expected_void_specialisation() {
     assert!(matches!(ffi::make_expected_void().into(), Ok(())));
     assert!(matches!(ffi::make_unexpected_void().into(), Err(42)));
 }
+
+#[test]
+fn test_nullable_ffi() {
+    assert_eq!(
+        std::mem::size_of::<OptionalBox>(),
+        std::mem::size_of::<usize>()
+    );
+    assert_eq!(
+        std::mem::size_of::<OptionalRef>(),
+        std::mem::size_of::<usize>()
+    );
+    assert_eq!(std::mem::size_of::<OptionalBool>(), 1);
+
+    assert!(ffi::take_optional_box(
+        Some(Box::new(RustValue::new("boxed"))).into()
+    ));
+    assert!(!ffi::take_optional_box(None.into()));
+    assert!(
+        matches!(&*ffi::make_optional_box(true), Some(value) if value.read() == "A Hidden Rust String")
+    );
+    assert!(ffi::make_optional_box(false).is_none());
+
+    let value = RustValue::new("borrowed");
+    assert!(ffi::take_optional_ref(&Some(&value).into()));
+    assert!(!ffi::take_optional_ref(&None.into()));
+
+    assert_eq!(
+        ffi::negate_optional_bool(Some(true).into()),
+        Some(false).into()
+    );
+    assert_eq!(
+        ffi::negate_optional_bool(Some(false).into()),
+        Some(true).into()
+    );
+    assert_eq!(ffi::negate_optional_bool(None.into()), None.into());
+}
+
+#[test]
+fn test_std_views() {
+    let mut result = mul2_if_gt10(21);
+    assert_eq!(result.as_result(), Ok(&42));
+    *result.as_mut().unwrap() += 1;
+    assert_eq!(result.into_result(), Ok(43));
+    let result = mul2_if_gt10(1);
+    assert!(matches!(result.as_result(), Err(error) if error == "value too small"));
+
+    let mut optional = OptionalI32::Some(5);
+    assert_eq!(optional.as_option(), Some(&5));
+    *optional.as_mut().unwrap() = 6;
+    assert!(take_optional(&optional));
+    assert_eq!(optional.into_option(), Some(6));
+
+    let optionals = vec![OptionalI32::Some(1), OptionalI32::None];
+    let data = optionals.as_ptr() as usize;
+    let optionals = convert::vec_into_std(optionals);
+    assert_eq!(optionals, [Some(1), None]);
+    assert_eq!(optionals.as_ptr() as usize, data);
+    let optionals: Vec<OptionalI32> = convert::vec_from_std(optionals);
+    assert_eq!(optionals.as_ptr() as usize, data);
+
+    let results: Vec<Result<i32, String>> = [mul2_if_gt10(11), mul2_if_gt10(0)]
+        .into_iter()
+        .into_std()
+        .collect();
+    assert_eq!(results, [Ok(22), Err("value too small".to_owned())]);
+
+    let mut flags = [OptionalBool::from(Some(true)), None.into()];
+    assert_eq!(convert::slice_as_std(&flags), [Some(true), None]);
+    convert::slice_as_std_mut(&mut flags)[1] = Some(false);
+    assert_eq!(flags[1].as_option(), Some(&false));
+}
+
+#[test]
+fn test_compact_enum_ffi() {
+    assert_eq!(std::mem::size_of::<CompactEnum>(), 6);
+    assert!(matches!(
+        ffi::make_compact_pair(3, -7),
+        CompactEnum::Pair(3, -7)
+    ));
+    assert_eq!(ffi::take_compact(&CompactEnum::Empty), -1);
+    assert_eq!(ffi::take_compact(&CompactEnum::Pair(40, 2)), 42);
+    assert_eq!(ffi::take_compact(&CompactEnum::Flag(true)), 1);
+}
+
+#[test]
+fn test_emplace_over_string_ffi() {
+    assert_eq!(ffi::emplace_over_string("short", -1), "short");
+    assert_eq!(ffi::emplace_over_string("short", 3), "short:3");
+    let long = "a string too long to be stored in the std::string itself";
+    assert_eq!(ffi::emplace_over_string(long, -1), long);
+    assert_eq!(ffi::emplace_over_string(long, 3), format!("{long}:3"));
+}
+
+#[test]
+fn test_bad_access_hook_ffi() {
+    // One bit per index `get` was called with, set if the hook was called.
+    assert_eq!(ffi::hooked_variant_accesses(0), 0b110);
+    assert_eq!(ffi::hooked_variant_accesses(1), 0b101);
+    assert_eq!(ffi::hooked_variant_accesses(2), 0b011);
+    assert!(ffi::hooked_optional_access());
+    assert!(ffi::hooked_invalid_index());
+}
+
+#[test]
+fn test_scan_kernels_ffi() {
+    assert_eq!(ffi::scan_kernel_errors_none(), 0);
+    #[cfg(any(target_arch = "x86", target_arch = "x86_64"))]
+    {
+        if is_x86_feature_detected!("sse4.1") {
+            assert_eq!(ffi::scan_kernel_errors_sse4(), 0);
+        }
+        if is_x86_feature_detected!("avx2") {
+            assert_eq!(ffi::scan_kernel_errors_avx2(), 0);
+        }
+    }
+}
+
+#[test]
+fn test_multi_visit_ffi() {
+    let values = [
+        CompactEnum::Empty,
+        CompactEnum::Pair(3, 4),
+        CompactEnum::Flag(true),
+    ];
+    let value = |compact: &CompactEnum| ffi::take_compact(compact);
+    for first in &values {
+        for second in &values {
+            assert_eq!(
+                ffi::visit_compact_pair(first, second),
+                100 * value(first) + value(second)
+            );
+            for third in &values {
+                assert_eq!(
+                    ffi::visit_compact_triple(first, second, third),
+                    10000 * value(first) + 100 * value(second) + value(third)
+                );
+            }
+        }
+    }
+}
+
+#[test]
+fn test_emplace_ffi() {
+    let value =
+        unsafe { RustEnum::new_in_place(|out| ffi::make_enum_struct_into(out, 7, "in place")) };
+    assert!(matches!(value, RustEnum::Struct { val: 7, ref str } if str == "in place"));
+
+    let mut slot = MaybeUninit::uninit();
+    let value =
+        unsafe { RustEnum::init_in_place(&mut slot, |out| ffi::make_enum_struct_into(out, 8, "")) };
+    assert_eq!(take_mut_enum(value), 9);
+    unsafe { slot.assume_init_drop() };
+
+    let mut values = vec![CompactEnum::Empty];
+    unsafe {
+        CompactEnum::extend_in_place(&mut values, 3, |out, len| {
+            ffi::make_compact_pairs_into(out, len)
+        })
+    };
+    assert_eq!(
+        values,
+        [
+            CompactEnum::Empty,
+            CompactEnum::Pair(0, -1),
+            CompactEnum::Pair(1, -1),
+            CompactEnum::Pair(2, -1)
+        ]
+    );
+
+    let result = unsafe { I32StringResult::try_new_in_place(|out| ffi::make_result_into(out, 42)) };
+    assert!(matches!(result, Ok(I32StringResult::Ok(42))));
+    let result = unsafe { I32StringResult::try_new_in_place(|out| ffi::make_result_into(out, -1)) };
+    assert_eq!(result.unwrap_err().what(), "negative value");
+}
+
+#[test]
+fn test_enum_batches_ffi() {
+    let values: Vec<CompactEnum> = (0..1000)
+        .map(|i| match i % 3 {
+            0 => CompactEnum::Empty,
+            1 => CompactEnum::Pair(i as i16, 1),
+            _ => CompactEnum::Flag(true),
+        })
+        .collect();
+    let expected: i32 = values
+        .iter()
+        .map(|value| match value {
+            CompactEnum::Empty => -1,
+            CompactEnum::Pair(a, b) => i32::from(*a) + i32::from(*b),
+            CompactEnum::Flag(flag) => i32::from(*flag),
+        })
+        .sum();
+    assert_eq!(ffi::sum_compact(&values), expected);
+    assert_eq!(ffi::sum_compact_grouped(&values), expected);
+}
+
+#[test]
+fn test_visit_grouped_ffi() {
+    let values: Vec<CompactEnum> = (0..1000)
+        .map(|i| match (i * 7 + i / 3) % 3 {
+            0 => CompactEnum::Empty,
+            1 => CompactEnum::Pair(i as i16, -(i as i16)),
+            _ => CompactEnum::Flag(i % 5 < 2),
+        })
+        .collect();
+    let alternative = |value: &CompactEnum| match value {
+        CompactEnum::Empty => 0,
+        CompactEnum::Pair(..) => 1,
+        CompactEnum::Flag(_) => 2,
+    };
+
+    // Grouped by alternative, in the order of the values within a group.
+    let mut expected = values.clone();
+    expected.sort_by_key(alternative);
+    let mut calls = Vec::new();
+    assert_eq!(ffi::visit_compact_grouped(&values, &mut calls), expected);
+
+    let mut counts = [0; 3];
+    for value in &values {
+        counts[alternative(value)] += 1;
+    }
+    assert_eq!(calls, counts);
+
+    // An alternative nobody holds is not visited.
+    let pairs: Vec<CompactEnum> = (0..10).map(|i| CompactEnum::Pair(i, i)).collect();
+    assert_eq!(ffi::visit_compact_grouped(&pairs, &mut calls), pairs);
+    assert_eq!(calls, [0, 10, 0]);
+    assert!(ffi::visit_compact_grouped(&[], &mut calls).is_empty());
+    assert_eq!(calls, [0, 0, 0]);
+
+    let values = ffi::make_compact_vec(10);
+    assert_eq!(values.len(), 10);
+    assert!(matches!(values[4], CompactEnum::Pair(4, 1)));
+    assert!(matches!(values[5], CompactEnum::Empty));
+
+    let values = ffi::make_compact_cxx_vector(9);
+    assert_eq!(values.len(), 9);
+    assert_eq!(
+        values
+            .iter()
+            .filter(|value| matches!(value, CompactEnum::Flag(true)))
+            .count(),
+        3
+    );
+
+    let results: Vec<I32StringResult> = (0..100)
+        .map(|i| {
+            if i % 4 == 0 {
+                Err(format!("error {i}"))
+            } else {
+                Ok(i)
+            }
+        })
+        .map(I32StringResult::from)
+        .collect();
+    assert_eq!(ffi::count_errors(&results), 25);
+}
+
+#[test]
+fn test_soa_vector_ffi() {
+    let values: Vec<CompactEnum> = (0..100)
+        .map(|i| match i % 3 {
+            0 => CompactEnum::Pair(i, -i),
+            1 => CompactEnum::Flag(i % 4 == 1),
+            _ => CompactEnum::Empty,
+        })
+        .collect();
+    assert_eq!(ffi::soa_compact(&values), values);
+    assert!(ffi::soa_compact(&[]).is_empty());
+
+    let flags: Vec<bool> = values
+        .iter()
+        .filter_map(|value| match value {
+            CompactEnum::Flag(flag) => Some(*flag),
+            _ => None,
+        })
+        .collect();
+    assert_eq!(flags.len(), 33);
+    assert_eq!(ffi::soa_compact_flags(&values), flags);
+
+    let mut expected = vec![
+        CompactEnum::Flag(true),
+        CompactEnum::Pair(1, -1),
+        CompactEnum::Empty,
+        CompactEnum::Flag(false),
+    ];
+    expected.extend((0..20).map(|i| CompactEnum::Pair(i, -i)));
+    assert_eq!(ffi::soa_compact_emplaced(), expected);
+}
+
+#[test]
+fn test_tag_scan_ffi() {
+    let mut values: Vec<CompactEnum> = (0..1001)
+        .map(|i| {
+            if i % 4 == 1 {
+                CompactEnum::Pair(i as i16, 1)
+            } else {
+                CompactEnum::Empty
+            }
+        })
+        .collect();
+    assert_eq!(ffi::count_compact(&values), [751, 250, 0]);
+    assert_eq!(ffi::find_compact_flag(&values), values.len());
+
+    values[778] = CompactEnum::Flag(false);
+    assert_eq!(ffi::count_compact(&values), [750, 250, 1]);
+    assert_eq!(ffi::find_compact_flag(&values), 778);
+    assert_eq!(ffi::find_compact_flag(&values[..778]), 778);
+}
+
+#[test]
+fn test_hash_ffi() {
+    for value in [
+        CompactEnum::Empty,
+        CompactEnum::Pair(1, -2),
+        CompactEnum::Flag(true),
+    ] {
+        assert_eq!(ffi::hash_compact(&value), cxx_enumext::hash(&value));
+    }
+    assert_ne!(
+        ffi::hash_compact(&CompactEnum::Pair(1, 2)),
+        ffi::hash_compact(&CompactEnum::Pair(2, 1))
+    );
+
+    let ok = I32StringResult::Ok(42);
+    let err = I32StringResult::Err("bad".into());
+    assert_eq!(ffi::hash_result(&ok), cxx_enumext::hash(&ok));
+    assert_eq!(ffi::hash_result(&err), cxx_enumext::hash(&err));
+
+    let mut set = std::collections::HashSet::with_hasher(cxx_enumext::BuildCxxHasher);
+    assert!(set.insert(ffi::hash_compact(&CompactEnum::Empty)));
+    assert!(!set.insert(cxx_enumext::hash(&CompactEnum::Empty)));
+}
+
+#[test]
+fn test_compare_ffi() {
+    let mut values: Vec<CompactEnum> = (0..100)
+        .map(|i| match i % 3 {
+            0 => CompactEnum::Empty,
+            1 => CompactEnum::Pair((i % 7) as i16 - 3, (i % 5) as i16),
+            _ => CompactEnum::Flag(i % 2 == 0),
+        })
+        .collect();
+    let mut expected = values.clone();
+    expected.sort();
+    ffi::sort_compact(&mut values);
+    assert_eq!(values, expected);
+
+    expected.dedup();
+    assert_eq!(ffi::count_distinct_compact(&values), expected.len());
+}
+
+#[test]
+fn test_flat_ffi() {
+    let values: Vec<CompactEnum> = (0..1000)
+        .map(|i| match i / 100 % 3 {
+            0 => CompactEnum::Empty,
+            1 => CompactEnum::Pair(i as i16, -(i as i16)),
+            _ => CompactEnum::Flag(i % 2 == 0),
+        })
+        .collect();
+
+    for run_index in [false, true] {
+        let bytes = ffi::flat_compact(&values, run_index);
+        let mut read = Vec::new();
+        assert_eq!(ffi::read_flat_compact(&bytes, &mut read), 0);
+        assert_eq!(read, values);
+
+        // The tag width is recorded in the header, a mismatch is a layout
+        // error.
+        let mut corrupted = bytes.clone();
+        corrupted[18] = 4;
+        read.clear();
+        assert_ne!(ffi::read_flat_compact(&corrupted, &mut read), 0);
+        assert!(read.is_empty());
+
+        assert_ne!(
+            ffi::read_flat_compact(&bytes[..bytes.len() - 1], &mut read),
+            0
+        );
+    }
+}
+
+#[cfg(unix)]
+#[test]
+fn test_flat_file_ffi() {
+    let values: Vec<CompactEnum> = (0..1000)
+        .map(|i| match i / 100 % 3 {
+            0 => CompactEnum::Empty,
+            1 => CompactEnum::Pair(i as i16, -(i as i16)),
+            _ => CompactEnum::Flag(i % 2 == 0),
+        })
+        .collect();
+    let path = std::env::temp_dir().join(format!("cxx_enumext_flat_{}.bin", std::process::id()));
+    let path_str = path.to_str().unwrap();
+
+    for run_index in [false, true] {
+        assert!(ffi::write_flat_compact_file(path_str, &values, run_index));
+        let bytes = std::fs::read(&path).unwrap();
+        assert_eq!(bytes, ffi::flat_compact(&values, run_index));
+
+        // `Empty` has tag 0 and no value, nothing of the element may be left
+        // uninitialised.
+        let element_size = u64::from_ne_bytes(bytes[24..32].try_into().unwrap()) as usize;
+        let data_offset = u64::from_ne_bytes(bytes[40..48].try_into().unwrap()) as usize;
+        for (i, value) in values.iter().enumerate() {
+            if *value == CompactEnum::Empty {
+                let start = data_offset + i * element_size;
+                assert!(bytes[start..start + element_size].iter().all(|&b| b == 0));
+            }
+        }
+
+        let mut read = Vec::new();
+        assert_eq!(ffi::read_flat_compact_file(path_str, &mut read), 0);
+        assert_eq!(read, values);
+
+        // flat_error::layout, the alternatives differ.
+        assert_eq!(ffi::read_flat_file_as_wide(path_str), 6);
+    }
+
+    std::fs::remove_file(&path).unwrap();
+    let mut read = Vec::new();
+    // flat_error::io
+    assert_eq!(ffi::read_flat_compact_file(path_str, &mut read), 1);
+}
+
+#[test]
+fn test_self_assignment_ffi() {
+    assert_eq!(ffi::variant_self_assignment_errors(), 0);
+}
+
+#[test]
+fn test_wide_enum_ffi() {
+    for index in 0..41 {
+        let wide = ffi::make_wide(index);
+        match (index, wide) {
+            (39, WideEnum::Tuple(first, .., last)) => assert_eq!((first, last), (1, 20)),
+            (40, WideEnum::Last(value)) => assert_eq!(value, 40),
+            (index, wide) => assert_eq!(ffi::take_wide(&wide), -(index as i64)),
+        }
+    }
+
+    let tuple = WideEnum::Tuple(
+        1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20,
+    );
+    assert_eq!(ffi::take_wide(&tuple), 31);
+    assert_eq!(ffi::take_wide(&WideEnum::Unit38), -38);
+    assert_eq!(ffi::take_wide(&WideEnum::Last(-7)), -7);
+}
+
+#[test]
+fn test_generated_header_ffi() {
+    assert_eq!(ffi::make_shape(0), Shape::Empty);
+    assert_eq!(ffi::make_shape(1), Shape::Circle(1.5));
+    assert_eq!(
+        ffi::make_shape(2),
+        Shape::Rect {
+            width: 2.0,
+            height: 3.0
+        }
+    );
+    assert_eq!(ffi::make_shape(7), Shape::Polygon(7, 4, 5));
+
+    assert_eq!(ffi::shape_area(&Shape::Circle(2.0)), 12.0);
+    assert_eq!(
+        ffi::shape_area(&Shape::Polygon(3, 2, 1 << 33)),
+        3.0 * (1u64 << 33) as f64
+    );
+
+    let rect = Shape::Rect {
+        width: 2.0,
+        height: 2.0,
+    };
+    let largest: Option<Shape> =
+        ffi::largest_shape(&[Shape::Circle(1.0), rect, Shape::Empty]).into();
+    assert_eq!(largest, Some(rect));
+    assert!(matches!(ffi::largest_shape(&[]), OptionalShape::None));
+
+    let value = RustValue::new("borrowed");
+    assert_eq!(ffi::describe_message(&Message::Quit), "quit");
+    assert_eq!(ffi::describe_message(&Message::Text("text".into())), "text");
+    assert_eq!(
+        ffi::describe_message(&Message::Value(Box::new(RustValue::new("boxed")))),
+        "boxed"
+    );
+    assert_eq!(
+        ffi::describe_message(&Message::Borrowed(&value)),
+        "borrowed"
+    );
+    assert_eq!(
+        ffi::describe_message(&Message::Bytes(vec![1, 2, 3])),
+        "3 bytes"
+    );
+}
+
+#[test]
+fn test_atomic_ffi() {
+    let state = AtomicJobState::new(JobState::Idle);
+    std::thread::scope(|scope| {
+        for _ in 0..4 {
+            scope.spawn(|| ffi::advance_job(&state, 1000));
+            scope.spawn(|| {
+                for _ in 0..1000 {
+                    state.update(Ordering::SeqCst, |job| match job {
+                        JobState::Idle => JobState::Running(1),
+                        JobState::Running(steps) => JobState::Running(steps + 1),
+                        done => done,
+                    });
+                }
+            });
+        }
+    });
+    assert_eq!(state.load(Ordering::SeqCst), JobState::Running(8000));
+
+    assert!(!ffi::finish_job(&state, 7999));
+    assert!(ffi::finish_job(&state, 8000));
+    assert_eq!(state.load(Ordering::SeqCst), JobState::Done(8000));
+    assert_eq!(
+        state.compare_exchange(
+            JobState::Done(1),
+            JobState::Idle,
+            Ordering::SeqCst,
+            Ordering::SeqCst
+        ),
+        Err(JobState::Done(8000))
+    );
+    assert_eq!(
+        state.swap(JobState::Idle, Ordering::SeqCst),
+        JobState::Done(8000)
+    );
+}